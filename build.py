@@ -7,7 +7,7 @@ import shutil
 # ================= 配置区域 =================
 COMPILER = "g++"
 #include "Lex/Lexer.h" 就能正确映射到 src/include/Lex/Lexer.h
-CFLAGS = ["-std=c++17", "-g", "-Wall", "-Wextra", "-Isrc/include"]
+CFLAGS = ["-std=c++17", "-g", "-Wall", "-Wextra", "-pthread", "-Isrc/include"]
 BUILD_DIR = "build"
 TARGET_NAME = "sysy_rvcp" 
 # ===========================================
@@ -59,12 +59,14 @@ def build():
     
     return target_path
 
-def run(target_path):
-    """运行编译后的程序"""
-    print(f"\n🧪 正在运行测试 (Lexer Test)...")
+def run(target_path, args):
+    """运行编译后的程序, 参数原样传给编译器 (如: python build.py test.sy -dump-ast)"""
+    if not args:
+        return
+    print(f"\n🧪 正在运行: {TARGET_NAME} {' '.join(args)}")
     print("=" * 40)
     try:
-        subprocess.run([str(target_path)], check=True)
+        subprocess.run([str(target_path)] + args, check=True)
         print("=" * 40)
         print("🎉 测试运行结束。")
     except subprocess.CalledProcessError as e:
@@ -75,4 +77,4 @@ if __name__ == "__main__":
         clean()
     else:
         exe_path = build()
-        run(exe_path)
\ No newline at end of file
+        run(exe_path, sys.argv[1:])
\ No newline at end of file
@@ -0,0 +1,84 @@
+#ifndef ASTCONTEXT_H
+#define ASTCONTEXT_H
+
+#include "Basic/Allocator.h"
+#include "Basic/ArrayRef.h"
+#include <cstring>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace sysy {
+
+#define AST_NODE(Class) class Class;
+#include "AST/ASTNodes.def"
+
+enum class ASTNodeClass : unsigned {
+#define AST_NODE(Class) Class,
+#include "AST/ASTNodes.def"
+  NumClasses
+};
+
+template <typename T> struct ASTNodeClassOf;
+#define AST_NODE(Class)                                                        \
+  template <> struct ASTNodeClassOf<Class> {                                   \
+    static constexpr ASTNodeClass value = ASTNodeClass::Class;                 \
+  };
+#include "AST/ASTNodes.def"
+
+/// Owns every AST node of one translation unit.
+///
+/// Nodes are placement-new'ed into a bump-pointer arena and refer to their
+/// children through raw pointers. Nothing is destroyed node by node: the
+/// whole tree goes away with the ASTContext in a single free of the slabs.
+class ASTContext {
+  BumpPtrAllocator Allocator;
+  size_t NumNodes = 0;
+  size_t NodeCounts[static_cast<unsigned>(ASTNodeClass::NumClasses)] = {};
+
+public:
+  ASTContext() = default;
+  ASTContext(const ASTContext &) = delete;
+  ASTContext &operator=(const ASTContext &) = delete;
+
+  template <typename T, typename... Args> T *create(Args &&...args) {
+    static_assert(std::is_trivially_destructible<T>::value,
+                  "AST nodes live in the arena and are never destroyed");
+    ++NumNodes;
+    ++NodeCounts[static_cast<unsigned>(ASTNodeClassOf<T>::value)];
+    return new (Allocator.allocate<T>()) T(std::forward<Args>(args)...);
+  }
+
+  /// Copy a list collected during parsing into the arena.
+  template <typename T> ArrayRef<T> copyArray(const T *Elts, size_t Num) {
+    static_assert(std::is_trivially_copyable<T>::value, "only POD arrays");
+    if (Num == 0) return ArrayRef<T>();
+    T *Mem = Allocator.allocate<T>(Num);
+    std::memcpy(Mem, Elts, sizeof(T) * Num);
+    return ArrayRef<T>(Mem, Num);
+  }
+
+  /// Same, converting each element (e.g. from the parser's ASTNode * stack
+  /// to the ExprAST * a node stores).
+  template <typename T, typename U> ArrayRef<T> copyArrayAs(const U *Elts, size_t Num) {
+    static_assert(std::is_trivially_copyable<T>::value, "only POD arrays");
+    if (Num == 0) return ArrayRef<T>();
+    T *Mem = Allocator.allocate<T>(Num);
+    for (size_t i = 0; i < Num; ++i) Mem[i] = static_cast<T>(Elts[i]);
+    return ArrayRef<T>(Mem, Num);
+  }
+
+  std::string_view copyString(std::string_view S) {
+    char *Mem = Allocator.allocate<char>(S.size());
+    std::memcpy(Mem, S.data(), S.size());
+    return std::string_view(Mem, S.size());
+  }
+
+  size_t getNumNodes() const { return NumNodes; }
+  size_t getNumNodes(ASTNodeClass C) const { return NodeCounts[static_cast<unsigned>(C)]; }
+  const BumpPtrAllocator &getAllocator() const { return Allocator; }
+};
+
+}
+
+#endif
@@ -1,18 +1,24 @@
 #ifndef ASTNODE_H
 #define ASTNODE_H
 
-#include <memory>
-#include <string>
-#include <vector>
+#include "AST/OperationKinds.h"
+#include "Basic/ArrayRef.h"
+#include "Basic/IdentifierTable.h"
+#include "Basic/TokenKinds.h"
+#include <string_view>
 #include <iostream>
 
 namespace sysy {
 
 class ASTVisitor;
 
+// All nodes are allocated in an ASTContext arena and are never destroyed
+// individually, so they must stay trivially destructible: children are raw
+// pointers, names are interned Symbols, lists are ArrayRefs.
 class ASTNode {
+protected:
+    ~ASTNode() = default;
 public:
-    virtual ~ASTNode() = default;
     virtual void dump(int indent = 0) const = 0;
     virtual void accept(ASTVisitor &visitor) = 0;
 };
@@ -28,59 +34,77 @@ class NumberAST : public ExprAST {
 public:
     NumberAST(int val) : Kind(IntKind), IntVal(val) {}
     NumberAST(float val) : Kind(FloatKind), FloatVal(val) {}
+
+    bool isFloat() const { return Kind == FloatKind; }
+    int getIntValue() const { return IntVal; }
+    float getFloatValue() const { return FloatVal; }
+
     void dump(int indent) const override;
     void accept(ASTVisitor &visitor) override;
 };
 
 class LValAST : public ExprAST {
-    std::string Name;
+    Symbol Name;
+public:
+    LValAST(Symbol name) : Name(name) {}
+    Symbol getName() const { return Name; }
+    void dump(int indent) const override;
+    void accept(ASTVisitor &visitor) override;
+};
+
+class CallExprAST : public ExprAST {
+    Symbol Callee;
+    ArrayRef<ExprAST *> Args;
 public:
-    LValAST(const std::string &name) : Name(name) {}
-    std::string getName() const { return Name; }
+    CallExprAST(Symbol callee, ArrayRef<ExprAST *> args) : Callee(callee), Args(args) {}
+
+    Symbol getCallee() const { return Callee; }
+    ArrayRef<ExprAST *> getArgs() const { return Args; }
+
     void dump(int indent) const override;
     void accept(ASTVisitor &visitor) override;
 };
 
 class BinaryExprAST : public ExprAST {
-    std::string Op; // Use string to support "==", ">=" etc.
-    std::unique_ptr<ExprAST> LHS, RHS;
+    BinaryOpKind Op;
+    ExprAST *LHS, *RHS;
 public:
-    BinaryExprAST(std::string op, std::unique_ptr<ExprAST> lhs, std::unique_ptr<ExprAST> rhs)
-        : Op(op), LHS(std::move(lhs)), RHS(std::move(rhs)) {}
+    BinaryExprAST(BinaryOpKind op, ExprAST *lhs, ExprAST *rhs)
+        : Op(op), LHS(lhs), RHS(rhs) {}
     
-    const std::string& getOp() const { return Op; }
-    ExprAST* getLHS() const { return LHS.get(); }
-    ExprAST* getRHS() const { return RHS.get(); }
+    BinaryOpKind getOp() const { return Op; }
+    ExprAST* getLHS() const { return LHS; }
+    ExprAST* getRHS() const { return RHS; }
     
     void dump(int indent) const override;
     void accept(ASTVisitor &visitor) override;
 };
 
 class UnaryExprAST : public ExprAST {
-    std::string Op;
-    std::unique_ptr<ExprAST> Operand;
+    UnaryOpKind Op;
+    ExprAST *Operand;
 public:
-    UnaryExprAST(std::string op, std::unique_ptr<ExprAST> operand)
-        : Op(op), Operand(std::move(operand)) {}
+    UnaryExprAST(UnaryOpKind op, ExprAST *operand)
+        : Op(op), Operand(operand) {}
 
-    const std::string& getOp() const { return Op; }
-    ExprAST* getOperand() const { return Operand.get(); }
+    UnaryOpKind getOp() const { return Op; }
+    ExprAST* getOperand() const { return Operand; }
     
     void dump(int indent) const override;
     void accept(ASTVisitor &visitor) override;
 };
 
 class VarDeclAST : public ASTNode {
-    std::string Type;
-    std::string Name;
-    std::unique_ptr<ExprAST> InitExpr;
+    tok::TokenKind Type; // kw_int, kw_float
+    Symbol Name;
+    ExprAST *InitExpr;
 public:
-    VarDeclAST(const std::string &type, const std::string &name, std::unique_ptr<ExprAST> init)
-        : Type(type), Name(name), InitExpr(std::move(init)) {}
+    VarDeclAST(tok::TokenKind type, Symbol name, ExprAST *init)
+        : Type(type), Name(name), InitExpr(init) {}
 
-    const std::string& getType() const { return Type; }
-    const std::string& getName() const { return Name; }
-    ExprAST* getInit() const { return InitExpr.get(); }
+    tok::TokenKind getType() const { return Type; }
+    Symbol getName() const { return Name; }
+    ExprAST* getInit() const { return InitExpr; }
 
     void dump(int indent) const override;
     void accept(ASTVisitor &visitor) override;
@@ -89,105 +113,117 @@ public:
 class StmtAST : public ASTNode {};
 
 class ReturnStmtAST : public StmtAST {
-    std::unique_ptr<ExprAST> RetVal;
+    ExprAST *RetVal;
 public:
-    ReturnStmtAST(std::unique_ptr<ExprAST> val) : RetVal(std::move(val)) {}
+    ReturnStmtAST(ExprAST *val) : RetVal(val) {}
 
-    ExprAST* getRetVal() const { return RetVal.get(); }
+    ExprAST* getRetVal() const { return RetVal; }
 
     void dump(int indent) const override;
     void accept(ASTVisitor &visitor) override;
 };
 
 class AssignStmtAST : public StmtAST {
-    std::unique_ptr<LValAST> LVal;
-    std::unique_ptr<ExprAST> Value;
+    LValAST *LVal;
+    ExprAST *Value;
 public:
-    AssignStmtAST(std::unique_ptr<LValAST> lval, std::unique_ptr<ExprAST> val)
-        : LVal(std::move(lval)), Value(std::move(val)) {}
+    AssignStmtAST(LValAST *lval, ExprAST *val) : LVal(lval), Value(val) {}
 
-    LValAST* getLVal() const { return LVal.get(); }
-    ExprAST* getValue() const { return Value.get(); }
+    LValAST* getLVal() const { return LVal; }
+    ExprAST* getValue() const { return Value; }
 
     void dump(int indent) const override;
     void accept(ASTVisitor &visitor) override;
 };
 
 class IfStmtAST : public StmtAST {
-    std::unique_ptr<ExprAST> Cond;
-    std::unique_ptr<StmtAST> Then, Else;
+    ExprAST *Cond;
+    StmtAST *Then, *Else;
 public:
-    IfStmtAST(std::unique_ptr<ExprAST> cond, std::unique_ptr<StmtAST> thenStmt, std::unique_ptr<StmtAST> elseStmt)
-        : Cond(std::move(cond)), Then(std::move(thenStmt)), Else(std::move(elseStmt)) {}
+    IfStmtAST(ExprAST *cond, StmtAST *thenStmt, StmtAST *elseStmt)
+        : Cond(cond), Then(thenStmt), Else(elseStmt) {}
     
-    ExprAST* getCond() const { return Cond.get(); }
-    StmtAST* getThen() const { return Then.get(); }
-    StmtAST* getElse() const { return Else.get(); }
+    ExprAST* getCond() const { return Cond; }
+    StmtAST* getThen() const { return Then; }
+    StmtAST* getElse() const { return Else; }
     
     void dump(int indent) const override;
     void accept(ASTVisitor &visitor) override;
 };
 
 class WhileStmtAST : public StmtAST {
-    std::unique_ptr<ExprAST> Cond;
-    std::unique_ptr<StmtAST> Body;
+    ExprAST *Cond;
+    StmtAST *Body;
 public:
-    WhileStmtAST(std::unique_ptr<ExprAST> cond, std::unique_ptr<StmtAST> body)
-        : Cond(std::move(cond)), Body(std::move(body)) {}
+    WhileStmtAST(ExprAST *cond, StmtAST *body) : Cond(cond), Body(body) {}
 
-    ExprAST* getCond() const { return Cond.get(); }
-    StmtAST* getBody() const { return Body.get(); }
+    ExprAST* getCond() const { return Cond; }
+    StmtAST* getBody() const { return Body; }
 
     void dump(int indent) const override;
     void accept(ASTVisitor &visitor) override;
 };
 
 class ExprStmtAST : public StmtAST {
-    std::unique_ptr<ExprAST> Expr;
+    ExprAST *Expr;
 public:
-    ExprStmtAST(std::unique_ptr<ExprAST> expr) : Expr(std::move(expr)) {}
+    ExprStmtAST(ExprAST *expr) : Expr(expr) {}
 
-    ExprAST* getExpr() const { return Expr.get(); }
+    ExprAST* getExpr() const { return Expr; }
 
     void dump(int indent) const override;
     void accept(ASTVisitor &visitor) override;
 };
 
 class BlockAST : public StmtAST {
-    std::vector<std::unique_ptr<ASTNode>> Items; // 包含 Stmt 或 Decl
+    ArrayRef<ASTNode *> Items; // 包含 Stmt 或 Decl
 public:
-    void addItem(std::unique_ptr<ASTNode> item) { Items.push_back(std::move(item)); }
+    void setItems(ArrayRef<ASTNode *> items) { Items = items; }
     
-    const std::vector<std::unique_ptr<ASTNode>>& getItems() const { return Items; }
+    ArrayRef<ASTNode *> getItems() const { return Items; }
+
+    void dump(int indent) const override;
+    void accept(ASTVisitor &visitor) override;
+};
+
+class FuncFParamAST : public ASTNode {
+    tok::TokenKind Type; // kw_int, kw_float
+    Symbol Name;
+public:
+    FuncFParamAST(tok::TokenKind type, Symbol name) : Type(type), Name(name) {}
+
+    tok::TokenKind getType() const { return Type; }
+    Symbol getName() const { return Name; }
 
     void dump(int indent) const override;
     void accept(ASTVisitor &visitor) override;
 };
 
 class FuncDefAST : public ASTNode {
-    std::string Name;
-    std::string RetType; // int, float, void
-    std::unique_ptr<BlockAST> Body;
-    // std::vector<std::unique_ptr<FuncFParamAST>> Params; 
+    Symbol Name;
+    tok::TokenKind RetType; // kw_int, kw_float, kw_void
+    ArrayRef<FuncFParamAST *> Params;
+    BlockAST *Body;
 public:
-    FuncDefAST(const std::string &name, const std::string &retType, std::unique_ptr<BlockAST> body)
-        : Name(name), RetType(retType), Body(std::move(body)) {}
+    FuncDefAST(Symbol name, tok::TokenKind retType, ArrayRef<FuncFParamAST *> params,
+               BlockAST *body)
+        : Name(name), RetType(retType), Params(params), Body(body) {}
 
-    const std::string& getName() const { return Name; }
-    BlockAST* getBody() const { return Body.get(); }
+    Symbol getName() const { return Name; }
+    tok::TokenKind getRetType() const { return RetType; }
+    ArrayRef<FuncFParamAST *> getParams() const { return Params; }
+    BlockAST* getBody() const { return Body; }
 
     void dump(int indent) const override;
     void accept(ASTVisitor &visitor) override;
 };
 
 class CompUnitAST : public ASTNode {
-    std::vector<std::unique_ptr<ASTNode>> Children;
+    ArrayRef<ASTNode *> Children;
 public:
-    void addChild(std::unique_ptr<ASTNode> child) {
-        Children.push_back(std::move(child));
-    }
+    void setChildren(ArrayRef<ASTNode *> children) { Children = children; }
 
-    const std::vector<std::unique_ptr<ASTNode>>& getChildren() const { return Children; }
+    ArrayRef<ASTNode *> getChildren() const { return Children; }
 
     void dump(int indent) const override;
     void accept(ASTVisitor &visitor) override;
@@ -10,6 +10,7 @@ public:
 
     virtual void visit(CompUnitAST &node) = 0;
     virtual void visit(FuncDefAST &node) = 0;
+    virtual void visit(FuncFParamAST &node) = 0;
     virtual void visit(BlockAST &node) = 0;
     virtual void visit(VarDeclAST &node) = 0;
     virtual void visit(IfStmtAST &node) = 0;
@@ -17,6 +18,7 @@ public:
     virtual void visit(ReturnStmtAST &node) = 0;
     virtual void visit(AssignStmtAST &node) = 0;
     virtual void visit(ExprStmtAST &node) = 0;
+    virtual void visit(CallExprAST &node) = 0;
     virtual void visit(BinaryExprAST &node) = 0;
     virtual void visit(UnaryExprAST &node) = 0;
     virtual void visit(LValAST &node) = 0;
@@ -0,0 +1,55 @@
+#ifndef OPERATIONKINDS_H
+#define OPERATIONKINDS_H
+
+#include "Basic/TokenKinds.h"
+
+namespace sysy {
+
+enum class BinaryOpKind : unsigned char {
+#define BINARY_OPERATION(Name, Tok) Name,
+#include "AST/OperationKinds.def"
+  Invalid
+};
+
+enum class UnaryOpKind : unsigned char {
+#define UNARY_OPERATION(Name, Tok) Name,
+#include "AST/OperationKinds.def"
+  Invalid
+};
+
+/// Map a token to the operator it spells, or Invalid.
+inline BinaryOpKind getBinaryOpForToken(tok::TokenKind K) {
+  switch (K) {
+#define BINARY_OPERATION(Name, Tok) case tok::Tok: return BinaryOpKind::Name;
+#include "AST/OperationKinds.def"
+  default: return BinaryOpKind::Invalid;
+  }
+}
+
+inline UnaryOpKind getUnaryOpForToken(tok::TokenKind K) {
+  switch (K) {
+#define UNARY_OPERATION(Name, Tok) case tok::Tok: return UnaryOpKind::Name;
+#include "AST/OperationKinds.def"
+  default: return UnaryOpKind::Invalid;
+  }
+}
+
+const char *getOpSpelling(BinaryOpKind Op);
+const char *getOpSpelling(UnaryOpKind Op);
+
+inline bool isArithmeticOp(BinaryOpKind Op) {
+  return Op >= BinaryOpKind::Mul && Op <= BinaryOpKind::Sub;
+}
+
+/// <, >, <=, >=, ==, !=
+inline bool isComparisonOp(BinaryOpKind Op) {
+  return Op >= BinaryOpKind::LT && Op <= BinaryOpKind::NE;
+}
+
+inline bool isLogicalOp(BinaryOpKind Op) {
+  return Op == BinaryOpKind::LAnd || Op == BinaryOpKind::LOr;
+}
+
+}
+
+#endif
@@ -0,0 +1,49 @@
+#ifndef ANALYSIS_CALLGRAPH_H
+#define ANALYSIS_CALLGRAPH_H
+
+#include <unordered_map>
+#include <vector>
+
+namespace sysy {
+
+class CallInst;
+class Function;
+class Module;
+
+/// Which function calls which, and the strongly connected components of
+/// that graph in bottom-up order: every SCC comes after the SCCs it calls
+/// into. A function is recursive if its SCC has more than one member or it
+/// calls itself. Declarations take part as leaves.
+class CallGraph {
+  struct Node {
+    std::vector<Function *> Callees; // Distinct, in order of first call
+    std::vector<CallInst *> CallSites; // Calls naming this function
+    unsigned SCC = 0;
+    bool CallsItself = false;
+  };
+
+  std::unordered_map<const Function *, Node> Nodes;
+  std::vector<std::vector<Function *>> SCCs;
+
+  void computeSCCs(const std::vector<Function *> &Functions);
+
+public:
+  explicit CallGraph(Module &M);
+
+  /// Bottom-up: callees before callers.
+  const std::vector<std::vector<Function *>> &getSCCs() const { return SCCs; }
+  const std::vector<Function *> &getCallees(const Function *F) const { return Nodes.at(F).Callees; }
+  /// The calls naming \p F when the graph was built.
+  const std::vector<CallInst *> &getCallSites(const Function *F) const {
+    return Nodes.at(F).CallSites;
+  }
+
+  bool isInSameSCC(const Function *F, const Function *G) const {
+    return Nodes.at(F).SCC == Nodes.at(G).SCC;
+  }
+  bool isRecursive(const Function *F) const;
+};
+
+}
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef ANALYSIS_CONSTANTFOLDING_H
+#define ANALYSIS_CONSTANTFOLDING_H
+
+#include "Basic/ArrayRef.h"
+#include "IR/Instruction.h"
+
+namespace sysy {
+
+/// Folding follows what the program would compute at run time on RV64:
+/// i32 arithmetic wraps, division truncates toward zero and the remainder
+/// takes the sign of the dividend, and float arithmetic is done in single
+/// precision. What C leaves undefined is never folded but left to run
+/// time: division by zero, INT_MIN / -1 (and % -1), and fptosi of NaN or
+/// of a value out of int range.
+/// Each function returns a constant of \p F, or null if it cannot fold.
+
+Value *constantFoldBinaryOp(Opcode Op, Value *LHS, Value *RHS, Function &F);
+Value *constantFoldCompare(Opcode Op, CmpInst::Predicate P, Value *LHS, Value *RHS, Function &F);
+Value *constantFoldCast(Opcode Op, Value *V, Type DestTy, Function &F);
+
+/// Fold \p I as if its operands were \p Ops (constants, one per operand).
+Value *constantFoldInstruction(const Instruction *I, ArrayRef<Value *> Ops, Function &F);
+
+}
+
+#endif
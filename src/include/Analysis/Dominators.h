@@ -0,0 +1,103 @@
+#ifndef ANALYSIS_DOMINATORS_H
+#define ANALYSIS_DOMINATORS_H
+
+#include "IR/Function.h"
+#include <iosfwd>
+#include <unordered_map>
+#include <vector>
+
+namespace sysy {
+
+class DomTreeNode {
+  BasicBlock *BB;
+  DomTreeNode *IDom = nullptr;
+  std::vector<DomTreeNode *> Children;
+  unsigned Index;      // Position of BB in reverse post-order
+  unsigned Level = 0;  // Depth in the tree, the root is 0
+  unsigned DFSIn = 0, DFSOut = 0;
+
+  friend class DominatorTree;
+
+public:
+  DomTreeNode(BasicBlock *BB, unsigned Index) : BB(BB), Index(Index) {}
+
+  BasicBlock *getBlock() const { return BB; }
+  DomTreeNode *getIDom() const { return IDom; }
+  const std::vector<DomTreeNode *> &getChildren() const { return Children; }
+  unsigned getIndex() const { return Index; }
+  unsigned getLevel() const { return Level; }
+
+  /// O(1) using the DFS interval of the dominator tree.
+  bool dominates(const DomTreeNode *N) const {
+    return DFSIn <= N->DFSIn && N->DFSOut <= DFSOut;
+  }
+};
+
+/// Dominator tree of the blocks reachable from the entry block.
+///
+/// Built with the iterative algorithm of Cooper, Harvey and Kennedy ("A
+/// Simple, Fast Dominance Algorithm"), which converges in a couple of
+/// passes over the reverse post-order on the reducible CFGs that structured
+/// SysY code produces. Each node also numbers its block by its position in
+/// reverse post-order, which passes can use to index side tables.
+class DominatorTree {
+  std::vector<DomTreeNode> Nodes; // In reverse post-order, root first
+  std::unordered_map<const BasicBlock *, DomTreeNode *> NodeMap;
+
+public:
+  DominatorTree() = default;
+  explicit DominatorTree(const Function &F) { recalculate(F); }
+  DominatorTree(const DominatorTree &) = delete;
+  DominatorTree &operator=(const DominatorTree &) = delete;
+
+  void recalculate(const Function &F);
+
+  DomTreeNode *getRootNode() { return Nodes.empty() ? nullptr : &Nodes.front(); }
+  /// Null for unreachable blocks.
+  DomTreeNode *getNode(const BasicBlock *BB) const {
+    auto It = NodeMap.find(BB);
+    return It == NodeMap.end() ? nullptr : It->second;
+  }
+  BasicBlock *getIDom(const BasicBlock *BB) const {
+    DomTreeNode *N = getNode(BB);
+    return N && N->getIDom() ? N->getIDom()->getBlock() : nullptr;
+  }
+  bool isReachable(const BasicBlock *BB) const { return getNode(BB) != nullptr; }
+
+  /// Number of reachable blocks; DomTreeNode::getIndex() is below this.
+  unsigned getNumBlocks() const { return static_cast<unsigned>(Nodes.size()); }
+  /// The reachable blocks in reverse post-order.
+  BasicBlock *getBlock(unsigned Index) const { return Nodes[Index].getBlock(); }
+
+  /// Every block dominates itself. Unreachable blocks are dominated by
+  /// everything (so code in them never fails a dominance check).
+  bool dominates(const BasicBlock *A, const BasicBlock *B) const;
+  bool properlyDominates(const BasicBlock *A, const BasicBlock *B) const {
+    return A != B && dominates(A, B);
+  }
+  /// Does the value computed by \p Def dominate instruction \p User?
+  bool dominates(const Instruction *Def, const Instruction *User) const;
+  /// Is \p Def available at \p U? For phis this is the end of the
+  /// incoming block rather than the phi itself.
+  bool dominates(const Value *Def, const Use &U) const;
+
+  BasicBlock *findNearestCommonDominator(BasicBlock *A, BasicBlock *B) const;
+
+  void print(std::ostream &OS) const;
+};
+
+/// Dominance frontier of every reachable block: the blocks where its
+/// dominance ends, i.e. where definitions in it need phis.
+class DominanceFrontier {
+  std::vector<std::vector<unsigned>> Frontiers; // By RPO index, see DominatorTree
+
+public:
+  explicit DominanceFrontier(const DominatorTree &DT);
+
+  /// RPO indices of the blocks in the frontier of block \p Index.
+  const std::vector<unsigned> &getFrontier(unsigned Index) const { return Frontiers[Index]; }
+};
+
+}
+
+#endif
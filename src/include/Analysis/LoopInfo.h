@@ -0,0 +1,111 @@
+#ifndef ANALYSIS_LOOPINFO_H
+#define ANALYSIS_LOOPINFO_H
+
+#include "IR/Function.h"
+#include <iosfwd>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace sysy {
+
+class DominatorTree;
+
+/// A natural loop: a header that dominates every block of the loop, and
+/// back edges from the latches to the header. The blocks of nested loops
+/// belong to the outer loop as well.
+class Loop {
+  BasicBlock *Header;
+  Loop *ParentLoop = nullptr;
+  std::vector<Loop *> SubLoops;
+  std::vector<BasicBlock *> Blocks; // Reverse post-order, header first
+  std::unordered_set<const BasicBlock *> BlockSet;
+
+  friend class LoopInfo;
+
+public:
+  explicit Loop(BasicBlock *Header) : Header(Header) {}
+
+  BasicBlock *getHeader() const { return Header; }
+  Loop *getParentLoop() const { return ParentLoop; }
+  const std::vector<Loop *> &getSubLoops() const { return SubLoops; }
+  const std::vector<BasicBlock *> &getBlocks() const { return Blocks; }
+  unsigned getNumBlocks() const { return static_cast<unsigned>(Blocks.size()); }
+  /// 1 for outermost loops.
+  unsigned getLoopDepth() const;
+
+  bool contains(const BasicBlock *BB) const { return BlockSet.count(BB) != 0; }
+  bool contains(const Instruction *I) const { return contains(I->getParent()); }
+  bool contains(const Loop *L) const;
+  /// True if \p V is not computed inside the loop.
+  bool isLoopInvariant(const Value *V) const;
+
+  /// The only block outside the loop that branches to the header, if that
+  /// block has no other successor.
+  BasicBlock *getLoopPreheader() const;
+  /// The only block outside the loop that branches to the header.
+  BasicBlock *getLoopPredecessor() const;
+  std::vector<BasicBlock *> getLoopLatches() const;
+  BasicBlock *getLoopLatch() const;
+  /// Blocks inside the loop with a successor outside.
+  std::vector<BasicBlock *> getExitingBlocks() const;
+  /// Distinct blocks outside the loop with a predecessor inside.
+  std::vector<BasicBlock *> getExitBlocks() const;
+  BasicBlock *getExitBlock() const;
+  /// True if the only predecessors of every exit block are in the loop.
+  bool hasDedicatedExits() const;
+
+  void print(std::ostream &OS) const;
+};
+
+/// The loop nest of a function (similar to LLVM's LoopInfo).
+///
+/// Back edges are found with the dominator tree and each loop body is
+/// collected by walking predecessors backwards from its latches. Headers
+/// are handled innermost first, so a block seen again belongs to an inner
+/// loop that is already complete and only has to be nested.
+class LoopInfo {
+  std::vector<std::unique_ptr<Loop>> Loops;
+  std::vector<Loop *> TopLevelLoops;
+  std::unordered_map<const BasicBlock *, Loop *> BBMap; // Innermost loop
+
+public:
+  LoopInfo() = default;
+  explicit LoopInfo(const DominatorTree &DT) { recalculate(DT); }
+  LoopInfo(const LoopInfo &) = delete;
+  LoopInfo &operator=(const LoopInfo &) = delete;
+
+  void recalculate(const DominatorTree &DT);
+
+  const std::vector<Loop *> &getTopLevelLoops() const { return TopLevelLoops; }
+  bool empty() const { return TopLevelLoops.empty(); }
+  /// Every loop, inner loops before the loops containing them.
+  std::vector<Loop *> getLoopsInPostorder() const;
+
+  /// The innermost loop containing \p BB, or null.
+  Loop *getLoopFor(const BasicBlock *BB) const {
+    auto It = BBMap.find(BB);
+    return It == BBMap.end() ? nullptr : It->second;
+  }
+  unsigned getLoopDepth(const BasicBlock *BB) const {
+    Loop *L = getLoopFor(BB);
+    return L ? L->getLoopDepth() : 0;
+  }
+  bool isLoopHeader(const BasicBlock *BB) const {
+    Loop *L = getLoopFor(BB);
+    return L && L->getHeader() == BB;
+  }
+
+  /// Record a new block \p BB as part of \p L (and so of its parents); null
+  /// leaves it outside every loop. Blocks go at the end of the lists.
+  void addBlockToLoop(BasicBlock *BB, Loop *L);
+  /// Forget \p BB, which is about to be erased.
+  void removeBlock(BasicBlock *BB);
+
+  void print(std::ostream &OS) const;
+};
+
+}
+
+#endif
@@ -0,0 +1,146 @@
+#ifndef ANALYSIS_SCALAREVOLUTION_H
+#define ANALYSIS_SCALAREVOLUTION_H
+
+#include "Basic/Allocator.h"
+#include "IR/Function.h"
+#include <cstdint>
+#include <iosfwd>
+#include <unordered_map>
+
+namespace sysy {
+
+class Loop;
+class LoopInfo;
+
+/// A symbolic i32 value (a much smaller cousin of LLVM's SCEV).
+///
+/// The interesting node is the add recurrence {Start,+,Step}<L>: the value
+/// Start + k * Step on the k-th execution of L's header, k = 0, 1, ...
+/// Arithmetic is modulo 2^32 like the IR itself, so the forms are exact
+/// even when the program overflows. Nodes live in the ScalarEvolution's
+/// arena and are not uniqued.
+class SCEV {
+public:
+  enum Kind : unsigned char { Constant, Unknown, Add, Mul, AddRec };
+
+private:
+  Kind K;
+  unsigned short Depth; // Longest path to a leaf, bounds every walk
+
+protected:
+  SCEV(Kind K, unsigned Depth) : K(K), Depth(static_cast<unsigned short>(Depth)) {}
+
+public:
+  Kind getKind() const { return K; }
+  unsigned getDepth() const { return Depth; }
+  void print(std::ostream &OS) const;
+};
+
+class SCEVConstant : public SCEV {
+  int32_t Val;
+
+public:
+  explicit SCEVConstant(int32_t V) : SCEV(Constant, 0), Val(V) {}
+  int32_t getValue() const { return Val; }
+  static bool classof(const SCEV *S) { return S->getKind() == Constant; }
+};
+
+/// A value the analysis does not look into.
+class SCEVUnknown : public SCEV {
+  Value *V;
+
+public:
+  explicit SCEVUnknown(Value *V) : SCEV(Unknown, 0), V(V) {}
+  Value *getValue() const { return V; }
+  static bool classof(const SCEV *S) { return S->getKind() == Unknown; }
+};
+
+/// LHS + RHS or LHS * RHS.
+class SCEVBinaryExpr : public SCEV {
+  const SCEV *LHS, *RHS;
+
+public:
+  SCEVBinaryExpr(Kind K, const SCEV *L, const SCEV *R)
+    : SCEV(K, 1 + (L->getDepth() > R->getDepth() ? L->getDepth() : R->getDepth())), LHS(L), RHS(R) {}
+  const SCEV *getLHS() const { return LHS; }
+  const SCEV *getRHS() const { return RHS; }
+  static bool classof(const SCEV *S) { return S->getKind() == Add || S->getKind() == Mul; }
+};
+
+class SCEVAddRecExpr : public SCEV {
+  const SCEV *Start, *Step;
+  const Loop *L;
+
+public:
+  SCEVAddRecExpr(const SCEV *Start, const SCEV *Step, const Loop *L)
+    : SCEV(AddRec, 1 + (Start->getDepth() > Step->getDepth() ? Start->getDepth() : Step->getDepth())),
+      Start(Start), Step(Step), L(L) {}
+  const SCEV *getStart() const { return Start; }
+  const SCEV *getStep() const { return Step; }
+  const Loop *getLoop() const { return L; }
+  static bool classof(const SCEV *S) { return S->getKind() == AddRec; }
+};
+
+/// The exit test of a loop whose header is its only exiting block, in the
+/// form "the loop goes on while IV Pred Bound".
+struct LoopExitTest {
+  BranchInst *Branch;
+  CmpInst *Compare;
+  Value *IVValue;                  // The compared value that varies
+  const SCEVAddRecExpr *IV;        // Its recurrence, with a constant step
+  Value *Bound;                    // The loop invariant side
+  CmpInst::Predicate Pred;         // Holds on the edge into the loop
+  unsigned StaySuccessor;          // Branch successor that stays in the loop
+};
+
+/// Computes SCEVs for the i32 values of one function on demand.
+class ScalarEvolution {
+  Function &F;
+  LoopInfo &LI;
+  BumpPtrAllocator Allocator;
+  std::unordered_map<const Value *, const SCEV *> Cache;
+
+  template <typename T, typename... Args> const SCEV *create(Args &&...args) {
+    return new (Allocator.allocate<T>()) T(std::forward<Args>(args)...);
+  }
+  const SCEV *createSCEV(Instruction *I);
+  const SCEV *createPhiSCEV(PhiInst *Phi);
+
+public:
+  /// Deeper expressions are not built; the value stays unknown instead.
+  static constexpr unsigned MaxDepth = 16;
+
+  ScalarEvolution(Function &F, LoopInfo &LI) : F(F), LI(LI) {}
+  ScalarEvolution(const ScalarEvolution &) = delete;
+  ScalarEvolution &operator=(const ScalarEvolution &) = delete;
+
+  const SCEV *getSCEV(Value *V);
+  const SCEV *getConstant(int32_t V) { return create<SCEVConstant>(V); }
+  const SCEV *getUnknown(Value *V);
+  const SCEV *getAddExpr(const SCEV *A, const SCEV *B);
+  const SCEV *getMulExpr(const SCEV *A, const SCEV *B);
+  const SCEV *getMinusSCEV(const SCEV *A, const SCEV *B);
+  const SCEV *getAddRecExpr(const SCEV *Start, const SCEV *Step, const Loop *L);
+
+  /// True if \p S has the same value throughout every iteration of \p L.
+  bool isLoopInvariant(const SCEV *S, const Loop *L) const;
+  /// Constant value of \p S, if it is one.
+  static bool getConstantValue(const SCEV *S, int32_t &Out);
+
+  /// Recognize the exit test of \p L. Requires a single latch and the
+  /// header as the only exiting block.
+  bool getLoopExitTest(const Loop *L, LoopExitTest &Test);
+  /// Number of times the body of \p L runs, if it is a compile-time
+  /// constant and the IV does not wrap on the way; -1 otherwise.
+  int64_t getConstantTripCount(const Loop *L);
+
+  /// Materialize the loop invariant \p S before \p InsertPt.
+  Value *expand(const SCEV *S, Instruction *InsertPt);
+
+  /// Drop everything computed so far, after the IR has changed.
+  void forgetAll() { Cache.clear(); }
+};
+
+}
+
+#endif
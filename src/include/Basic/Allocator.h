@@ -0,0 +1,119 @@
+#ifndef ALLOCATOR_H
+#define ALLOCATOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+namespace sysy {
+
+/// Bump-pointer allocator (similar to LLVM's BumpPtrAllocator).
+///
+/// Memory is carved out of large slabs and is only released all at once,
+/// when the allocator is reset or destroyed. Objects placed here must not
+/// rely on their destructors being run.
+class BumpPtrAllocator {
+  static constexpr size_t SlabSize = 64 * 1024;
+
+  std::vector<void *> Slabs;
+  char *CurPtr = nullptr;
+  char *End = nullptr;
+  size_t BytesAllocated = 0;
+  size_t TotalMemory = 0;
+
+  void *allocateSlab(size_t Size) {
+    void *Slab = std::malloc(Size);
+    if (!Slab) throw std::bad_alloc();
+    Slabs.push_back(Slab);
+    TotalMemory += Size;
+    return Slab;
+  }
+
+public:
+  BumpPtrAllocator() = default;
+  BumpPtrAllocator(const BumpPtrAllocator &) = delete;
+  BumpPtrAllocator &operator=(const BumpPtrAllocator &) = delete;
+  ~BumpPtrAllocator() { reset(); }
+
+  void *allocate(size_t Size, size_t Align) {
+    BytesAllocated += Size;
+    uintptr_t P = (reinterpret_cast<uintptr_t>(CurPtr) + Align - 1) & ~(uintptr_t)(Align - 1);
+    if (CurPtr && P + Size <= reinterpret_cast<uintptr_t>(End)) {
+      CurPtr = reinterpret_cast<char *>(P + Size);
+      return reinterpret_cast<void *>(P);
+    }
+
+    // Oversized requests get a slab of their own, the current one stays open.
+    if (Size + Align > SlabSize / 2) {
+      uintptr_t Slab = reinterpret_cast<uintptr_t>(allocateSlab(Size + Align));
+      return reinterpret_cast<void *>((Slab + Align - 1) & ~(uintptr_t)(Align - 1));
+    }
+
+    CurPtr = static_cast<char *>(allocateSlab(SlabSize));
+    End = CurPtr + SlabSize;
+    P = (reinterpret_cast<uintptr_t>(CurPtr) + Align - 1) & ~(uintptr_t)(Align - 1);
+    CurPtr = reinterpret_cast<char *>(P + Size);
+    return reinterpret_cast<void *>(P);
+  }
+
+  template <typename T> T *allocate(size_t Num = 1) {
+    return static_cast<T *>(allocate(sizeof(T) * Num, alignof(T)));
+  }
+
+  /// Release every slab at once.
+  void reset() {
+    for (void *Slab : Slabs) std::free(Slab);
+    Slabs.clear();
+    CurPtr = End = nullptr;
+    BytesAllocated = TotalMemory = 0;
+  }
+
+  size_t getBytesAllocated() const { return BytesAllocated; }
+  size_t getTotalMemory() const { return TotalMemory; }
+};
+
+/// Allocator for small objects that are created and destroyed often, such
+/// as IR instructions (in the spirit of LLVM's RecyclingAllocator).
+///
+/// Freed blocks go onto a free list per size class and are handed out again
+/// before new memory is carved from the slabs, so objects stay packed in
+/// a few slabs instead of being spread over the heap with a malloc header
+/// each. Memory returns to the system only when the allocator dies.
+class RecyclingAllocator {
+  static constexpr size_t Granularity = 16;
+  static constexpr size_t NumClasses = 16; // Up to 256 bytes
+
+  struct FreeNode {
+    FreeNode *Next;
+  };
+
+  BumpPtrAllocator Slabs;
+  FreeNode *FreeLists[NumClasses] = {};
+
+public:
+  static constexpr size_t MaxSize = Granularity * NumClasses;
+
+  void *allocate(size_t Size) {
+    size_t Class = (Size + Granularity - 1) / Granularity - 1;
+    if (FreeNode *N = FreeLists[Class]) {
+      FreeLists[Class] = N->Next;
+      return N;
+    }
+    return Slabs.allocate((Class + 1) * Granularity, Granularity);
+  }
+
+  void deallocate(void *P, size_t Size) {
+    size_t Class = (Size + Granularity - 1) / Granularity - 1;
+    auto *N = static_cast<FreeNode *>(P);
+    N->Next = FreeLists[Class];
+    FreeLists[Class] = N;
+  }
+
+  size_t getTotalMemory() const { return Slabs.getTotalMemory(); }
+};
+
+}
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef ARRAYREF_H
+#define ARRAYREF_H
+
+#include <cassert>
+#include <cstddef>
+
+namespace sysy {
+
+/// Non-owning view of a contiguous array (a small stand-in for C++20 span).
+template <typename T> class ArrayRef {
+  const T *Data = nullptr;
+  size_t Length = 0;
+
+public:
+  ArrayRef() = default;
+  ArrayRef(const T *data, size_t length) : Data(data), Length(length) {}
+
+  const T *begin() const { return Data; }
+  const T *end() const { return Data + Length; }
+  size_t size() const { return Length; }
+  bool empty() const { return Length == 0; }
+
+  const T &operator[](size_t i) const {
+    assert(i < Length && "ArrayRef index out of range");
+    return Data[i];
+  }
+};
+
+}
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef CASTING_H
+#define CASTING_H
+
+#include <cassert>
+
+namespace sysy {
+
+// LLVM-style RTTI for the IR class hierarchies. A class opts in by
+// providing `static bool classof(const Base *)`.
+
+template <typename To, typename From> inline bool isa(const From *V) {
+  assert(V && "isa<> on a null pointer");
+  return To::classof(V);
+}
+
+template <typename To, typename From> inline To *cast(From *V) {
+  assert(isa<To>(V) && "cast<> to an incompatible type");
+  return static_cast<To *>(V);
+}
+
+template <typename To, typename From> inline const To *cast(const From *V) {
+  assert(isa<To>(V) && "cast<> to an incompatible type");
+  return static_cast<const To *>(V);
+}
+
+template <typename To, typename From> inline To *dyn_cast(From *V) {
+  return To::classof(V) ? static_cast<To *>(V) : nullptr;
+}
+
+template <typename To, typename From> inline const To *dyn_cast(const From *V) {
+  return To::classof(V) ? static_cast<const To *>(V) : nullptr;
+}
+
+template <typename To, typename From> inline To *dyn_cast_or_null(From *V) {
+  return V && To::classof(V) ? static_cast<To *>(V) : nullptr;
+}
+
+template <typename To, typename From>
+inline const To *dyn_cast_or_null(const From *V) {
+  return V && To::classof(V) ? static_cast<const To *>(V) : nullptr;
+}
+
+}
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef CHARINFO_H
+#define CHARINFO_H
+
+#include <array>
+#include <cstdint>
+
+namespace sysy {
+namespace charinfo {
+
+// Character classes for the Lexer, independent of the C locale
+// (similar to Clang's Basic/CharInfo.h).
+enum : uint8_t {
+  CHAR_HORZ_WS = 0x01, // ' ', '\t', '\f', '\v'
+  CHAR_VERT_WS = 0x02, // '\r', '\n'
+  CHAR_LETTER  = 0x04, // [a-zA-Z_]
+  CHAR_DIGIT   = 0x08, // [0-9]
+  CHAR_XLETTER = 0x10, // [a-fA-F]
+  CHAR_PUNCT   = 0x20, // First character of a punctuator
+};
+
+constexpr std::array<uint8_t, 256> buildCharInfoTable() {
+  std::array<uint8_t, 256> Table{};
+  Table[' '] = Table['\t'] = Table['\f'] = Table['\v'] = CHAR_HORZ_WS;
+  Table['\n'] = Table['\r'] = CHAR_VERT_WS;
+  for (int c = 'a'; c <= 'z'; ++c) Table[c] = CHAR_LETTER;
+  for (int c = 'A'; c <= 'Z'; ++c) Table[c] = CHAR_LETTER;
+  for (int c = 'a'; c <= 'f'; ++c) Table[c] |= CHAR_XLETTER;
+  for (int c = 'A'; c <= 'F'; ++c) Table[c] |= CHAR_XLETTER;
+  Table['_'] = CHAR_LETTER;
+  for (int c = '0'; c <= '9'; ++c) Table[c] = CHAR_DIGIT;
+#define PUNCTUATOR(X, Y) Table[static_cast<unsigned char>(Y[0])] |= CHAR_PUNCT;
+#include "Basic/TokenKinds.def"
+  return Table;
+}
+
+inline constexpr std::array<uint8_t, 256> InfoTable = buildCharInfoTable();
+
+} // namespace charinfo
+
+inline bool isWhitespace(unsigned char c) {
+  return charinfo::InfoTable[c] & (charinfo::CHAR_HORZ_WS | charinfo::CHAR_VERT_WS);
+}
+
+inline bool isDigit(unsigned char c) {
+  return charinfo::InfoTable[c] & charinfo::CHAR_DIGIT;
+}
+
+inline bool isHexDigit(unsigned char c) {
+  return charinfo::InfoTable[c] & (charinfo::CHAR_DIGIT | charinfo::CHAR_XLETTER);
+}
+
+inline bool isIdentifierHead(unsigned char c) {
+  return charinfo::InfoTable[c] & charinfo::CHAR_LETTER;
+}
+
+inline bool isIdentifierBody(unsigned char c) {
+  return charinfo::InfoTable[c] & (charinfo::CHAR_LETTER | charinfo::CHAR_DIGIT);
+}
+
+inline bool isPunctuatorHead(unsigned char c) {
+  return charinfo::InfoTable[c] & charinfo::CHAR_PUNCT;
+}
+
+/// ASCII-only tolower, the Lexer never needs the locale-aware version.
+inline char toLowercase(char c) {
+  return (c >= 'A' && c <= 'Z') ? c - 'A' + 'a' : c;
+}
+
+} // namespace sysy
+
+#endif
@@ -0,0 +1,73 @@
+#ifndef IDENTIFIERTABLE_H
+#define IDENTIFIERTABLE_H
+
+#include "Basic/Allocator.h"
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+namespace sysy {
+
+/// One interned identifier. Lives in the IdentifierTable's arena.
+struct IdentifierInfo {
+  std::string_view Name;
+  unsigned ID; // Dense, in order of first appearance
+};
+
+/// Handle to an interned identifier.
+///
+/// Two Symbols for the same spelling always point to the same entry, so
+/// comparing them is a pointer comparison. getID() is dense and can be used
+/// to index side tables directly.
+class Symbol {
+  const IdentifierInfo *Info = nullptr;
+
+public:
+  Symbol() = default;
+  explicit Symbol(const IdentifierInfo *info) : Info(info) {}
+
+  bool isValid() const { return Info != nullptr; }
+  unsigned getID() const { return Info->ID; }
+  std::string_view getName() const { return Info ? Info->Name : std::string_view(); }
+
+  bool operator==(Symbol RHS) const { return Info == RHS.Info; }
+  bool operator!=(Symbol RHS) const { return Info != RHS.Info; }
+  bool operator<(Symbol RHS) const { return getID() < RHS.getID(); }
+};
+
+/// Interns identifier spellings (similar to Clang's IdentifierTable).
+///
+/// Filled by the Lexer: each identifier token is looked up once and carries
+/// its Symbol from then on. Open addressing with linear probing; the table
+/// stores the full hash next to each entry so most mismatches are rejected
+/// without touching the string.
+class IdentifierTable {
+  struct Bucket {
+    uint32_t Hash = 0;
+    IdentifierInfo *Info = nullptr;
+  };
+
+  std::vector<Bucket> Buckets;
+  std::vector<IdentifierInfo *> Infos; // ID -> entry
+  BumpPtrAllocator Storage;
+
+  void grow();
+
+public:
+  IdentifierTable() : Buckets(256) {}
+  IdentifierTable(const IdentifierTable &) = delete;
+  IdentifierTable &operator=(const IdentifierTable &) = delete;
+
+  /// Return the Symbol for \p Name, interning it on first use.
+  Symbol get(std::string_view Name);
+
+  Symbol getSymbol(unsigned ID) const { return Symbol(Infos[ID]); }
+  size_t size() const { return Infos.size(); }
+  size_t getBytesAllocated() const {
+    return Storage.getBytesAllocated() + Buckets.capacity() * sizeof(Bucket);
+  }
+};
+
+}
+
+#endif
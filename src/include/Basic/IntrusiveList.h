@@ -0,0 +1,108 @@
+#ifndef INTRUSIVELIST_H
+#define INTRUSIVELIST_H
+
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+
+namespace sysy {
+
+template <typename T> class IntrusiveList;
+
+/// Base class for objects that live in an IntrusiveList. The links are
+/// stored in the object itself, so insertion and removal never allocate and
+/// walking a list touches only the objects (similar to LLVM's ilist_node).
+template <typename T> class IntrusiveListNode {
+  T *Prev = nullptr;
+  T *Next = nullptr;
+  friend class IntrusiveList<T>;
+
+public:
+  T *getPrevNode() const { return Prev; }
+  T *getNextNode() const { return Next; }
+};
+
+template <typename T> class IntrusiveList {
+  T *Head = nullptr;
+  T *Tail = nullptr;
+  size_t Size = 0;
+
+  static IntrusiveListNode<T> *node(T *N) { return N; }
+
+public:
+  class iterator {
+    T *Cur = nullptr;
+
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = T *;
+    using reference = T &;
+
+    iterator() = default;
+    explicit iterator(T *N) : Cur(N) {}
+    T &operator*() const { return *Cur; }
+    T *operator->() const { return Cur; }
+    iterator &operator++() {
+      Cur = node(Cur)->getNextNode();
+      return *this;
+    }
+    iterator operator++(int) {
+      iterator Old = *this;
+      ++*this;
+      return Old;
+    }
+    bool operator==(const iterator &RHS) const { return Cur == RHS.Cur; }
+    bool operator!=(const iterator &RHS) const { return Cur != RHS.Cur; }
+  };
+
+  IntrusiveList() = default;
+  IntrusiveList(const IntrusiveList &) = delete;
+  IntrusiveList &operator=(const IntrusiveList &) = delete;
+
+  iterator begin() const { return iterator(Head); }
+  iterator end() const { return iterator(nullptr); }
+  T *front() const { return Head; }
+  T *back() const { return Tail; }
+  bool empty() const { return Head == nullptr; }
+  size_t size() const { return Size; }
+
+  /// Insert \p N before \p Pos (nullptr = at the end).
+  void insert(T *Pos, T *N) {
+    assert(!node(N)->Prev && !node(N)->Next && "node already in a list");
+    if (!Pos) {
+      node(N)->Prev = Tail;
+      if (Tail) node(Tail)->Next = N;
+      else Head = N;
+      Tail = N;
+    } else {
+      T *P = node(Pos)->Prev;
+      node(N)->Prev = P;
+      node(N)->Next = Pos;
+      node(Pos)->Prev = N;
+      if (P) node(P)->Next = N;
+      else Head = N;
+    }
+    ++Size;
+  }
+
+  void insertAfter(T *Pos, T *N) { insert(node(Pos)->Next, N); }
+  void push_back(T *N) { insert(nullptr, N); }
+  void push_front(T *N) { insert(Head, N); }
+
+  /// Unlink \p N without destroying it.
+  void remove(T *N) {
+    T *P = node(N)->Prev, *Nx = node(N)->Next;
+    if (P) node(P)->Next = Nx;
+    else Head = Nx;
+    if (Nx) node(Nx)->Prev = P;
+    else Tail = P;
+    node(N)->Prev = node(N)->Next = nullptr;
+    --Size;
+  }
+};
+
+}
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef MEMORYBUFFER_H
+#define MEMORYBUFFER_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace sysy {
+
+/// Read-only view of a source file.
+///
+/// The file is mapped into memory whenever possible so the Lexer can scan it
+/// in place through a std::string_view. The buffer is always followed by a
+/// '\0' byte, since the Lexer peeks one character past the current position.
+class MemoryBuffer {
+  const char *Start = nullptr;
+  size_t Size = 0;
+  bool IsMapped = false;
+  std::unique_ptr<char[]> Owned; // Fallback storage when mmap cannot be used
+
+  MemoryBuffer() = default;
+
+public:
+  MemoryBuffer(const MemoryBuffer &) = delete;
+  MemoryBuffer &operator=(const MemoryBuffer &) = delete;
+  ~MemoryBuffer();
+
+  /// Open \p Path. Returns nullptr and fills \p ErrMsg on failure.
+  static std::unique_ptr<MemoryBuffer> getFile(const std::string &Path,
+                                               std::string &ErrMsg);
+
+  std::string_view getBuffer() const { return std::string_view(Start, Size); }
+  size_t getBufferSize() const { return Size; }
+  bool isMapped() const { return IsMapped; }
+};
+
+}
+
+#endif
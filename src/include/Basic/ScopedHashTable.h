@@ -0,0 +1,53 @@
+#ifndef SCOPEDHASHTABLE_H
+#define SCOPEDHASHTABLE_H
+
+#include <cassert>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace sysy {
+
+/// Hash table whose insertions are undone when the scope that made them
+/// closes (like LLVM's ScopedHashTable). As in ScopedSymbolTable, the undo
+/// log remembers what each insertion shadowed. A default-constructed ValueT
+/// means "no entry".
+template <typename KeyT, typename ValueT, typename HashT = std::hash<KeyT>>
+class ScopedHashTable {
+  std::unordered_map<KeyT, ValueT, HashT> Map;
+  std::vector<std::pair<KeyT, ValueT>> Undo; // Key and the value it shadowed
+  std::vector<size_t> ScopeStart;
+
+public:
+  void enterScope() { ScopeStart.push_back(Undo.size()); }
+
+  void exitScope() {
+    assert(!ScopeStart.empty() && "no scope to exit");
+    size_t Start = ScopeStart.back();
+    ScopeStart.pop_back();
+    while (Undo.size() > Start) {
+      auto &[Key, Old] = Undo.back();
+      if (Old == ValueT()) Map.erase(Key);
+      else Map[Key] = Old;
+      Undo.pop_back();
+    }
+  }
+
+  /// Bind \p Key to \p Val in the innermost scope, shadowing any binding.
+  void insert(const KeyT &Key, const ValueT &Val) {
+    assert(!ScopeStart.empty() && "insert outside of any scope");
+    ValueT &Slot = Map[Key];
+    Undo.emplace_back(Key, Slot);
+    Slot = Val;
+  }
+
+  ValueT lookup(const KeyT &Key) const {
+    auto It = Map.find(Key);
+    return It == Map.end() ? ValueT() : It->second;
+  }
+};
+
+}
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef SCOPEDSYMBOLTABLE_H
+#define SCOPEDSYMBOLTABLE_H
+
+#include "Basic/IdentifierTable.h"
+#include <cassert>
+#include <vector>
+
+namespace sysy {
+
+/// Symbol table for nested scopes (in the spirit of LLVM's ScopedHashTable).
+///
+/// Symbols carry a dense ID, so the "hash table" is a flat array indexed by
+/// that ID which points at the innermost visible binding. Each binding
+/// remembers the one it shadows, and the binding stack doubles as the undo
+/// log: leaving a scope pops its bindings and restores what they shadowed.
+/// Lookup is O(1) at any nesting depth and entering a scope allocates nothing.
+template <typename ValueT> class ScopedSymbolTable {
+  static constexpr unsigned None = ~0u;
+
+  struct Binding {
+    ValueT Value;
+    Symbol Name;
+    unsigned Shadowed; // Previous binding of Name, or None
+    unsigned Depth;    // Scope that introduced this binding
+  };
+
+  std::vector<Binding> Bindings;  // Innermost scope on top
+  std::vector<unsigned> Head;     // Symbol ID -> innermost binding, or None
+  std::vector<unsigned> ScopeStart; // Bindings.size() when each scope opened
+
+  unsigned headOf(Symbol Name) const {
+    unsigned ID = Name.getID();
+    return ID < Head.size() ? Head[ID] : None;
+  }
+
+public:
+  void enterScope() { ScopeStart.push_back(static_cast<unsigned>(Bindings.size())); }
+
+  void exitScope() {
+    assert(!ScopeStart.empty() && "no scope to exit");
+    unsigned Start = ScopeStart.back();
+    ScopeStart.pop_back();
+    while (Bindings.size() > Start) {
+      const Binding &B = Bindings.back();
+      Head[B.Name.getID()] = B.Shadowed;
+      Bindings.pop_back();
+    }
+  }
+
+  unsigned getDepth() const { return static_cast<unsigned>(ScopeStart.size()); }
+
+  /// Bind \p Name in the innermost scope. Returns false (and changes nothing)
+  /// if the innermost scope already has a binding for it.
+  bool insert(Symbol Name, const ValueT &Value) {
+    assert(!ScopeStart.empty() && "insert outside of any scope");
+    if (lookupInCurrentScope(Name)) return false;
+    unsigned ID = Name.getID();
+    if (ID >= Head.size()) Head.resize(ID + 1, None);
+    Bindings.push_back({Value, Name, Head[ID], getDepth()});
+    Head[ID] = static_cast<unsigned>(Bindings.size() - 1);
+    return true;
+  }
+
+  /// Innermost visible binding of \p Name, or nullptr.
+  const ValueT *lookup(Symbol Name) const {
+    unsigned Idx = headOf(Name);
+    return Idx == None ? nullptr : &Bindings[Idx].Value;
+  }
+
+  const ValueT *lookupInCurrentScope(Symbol Name) const {
+    unsigned Idx = headOf(Name);
+    if (Idx == None || Bindings[Idx].Depth != getDepth()) return nullptr;
+    return &Bindings[Idx].Value;
+  }
+};
+
+}
+
+#endif
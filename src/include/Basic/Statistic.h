@@ -0,0 +1,53 @@
+#ifndef STATISTIC_H
+#define STATISTIC_H
+
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+
+namespace sysy {
+
+/// A named counter reported by -stats (similar to LLVM's STATISTIC).
+///
+/// Declare one per TU with the STATISTIC macro; it registers itself at
+/// startup. Counters are atomic so passes may bump them from worker threads.
+/// Hot loops should count locally and add the total once.
+class Statistic {
+  const char *Group;
+  const char *Name;
+  const char *Desc;
+  std::atomic<uint64_t> Value{0};
+
+public:
+  Statistic(const char *group, const char *name, const char *desc);
+
+  const char *getGroup() const { return Group; }
+  const char *getName() const { return Name; }
+  const char *getDesc() const { return Desc; }
+  uint64_t getValue() const { return Value.load(std::memory_order_relaxed); }
+
+  Statistic &operator++() {
+    Value.fetch_add(1, std::memory_order_relaxed);
+    return *this;
+  }
+  Statistic &operator+=(uint64_t N) {
+    Value.fetch_add(N, std::memory_order_relaxed);
+    return *this;
+  }
+  /// Keep the maximum of the current value and \p N.
+  void updateMax(uint64_t N);
+};
+
+#define STATISTIC(VARNAME, GROUP, DESC)                                        \
+  static sysy::Statistic VARNAME(GROUP, #VARNAME, DESC)
+
+/// Print every non-zero statistic, as a table or as a JSON object.
+void printStatistics(std::ostream &OS);
+void printStatisticsJSON(std::ostream &OS);
+
+/// Peak resident set size of the process in KiB, 0 if unknown.
+uint64_t getPeakRSSKiB();
+
+}
+
+#endif
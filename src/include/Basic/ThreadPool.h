@@ -0,0 +1,69 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sysy {
+
+/// A fixed set of threads with one task deque each, for running
+/// independent per-function work in parallel.
+///
+/// A task started from a worker goes to that worker's own deque, which it
+/// pops LIFO so the task's data is still in its cache; an idle worker
+/// steals the oldest task of another deque. Tasks started from any other
+/// thread are dealt round-robin across the deques. wait() runs tasks on the
+/// calling thread too, so a pool of N threads starts only N-1 workers.
+class ThreadPool {
+  struct TaskQueue {
+    std::mutex Lock;
+    std::deque<std::function<void()>> Tasks;
+  };
+  std::vector<std::unique_ptr<TaskQueue>> Queues; // Workers', then the caller's
+  std::vector<std::thread> Workers;
+  std::mutex Lock; // Held to sleep or wake
+  std::condition_variable WorkAvailable, AllDone;
+  std::atomic<size_t> Queued{0};  // Tasks in a deque
+  std::atomic<size_t> Pending{0}; // Tasks queued or running
+  std::atomic<size_t> NextQueue{0};
+  bool ShuttingDown = false;
+
+  /// Run one task, preferably from deque \p Self. False if there was none.
+  bool runOneTask(size_t Self);
+  void workerLoop(size_t Index);
+
+public:
+  explicit ThreadPool(unsigned NumThreads);
+  ~ThreadPool();
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  void async(std::function<void()> Task);
+  /// Help run tasks until every task started so far has finished. Not to
+  /// be called from a task.
+  void wait();
+
+  unsigned getNumThreads() const { return static_cast<unsigned>(Queues.size()); }
+};
+
+/// Run \p F(0) ... \p F(N-1) on \p Pool and wait for all of them. Without a
+/// pool they run in order on the calling thread.
+template <typename Fn> void parallelFor(ThreadPool *Pool, size_t N, Fn F) {
+  if (!Pool || N < 2) {
+    for (size_t i = 0; i < N; ++i) F(i);
+    return;
+  }
+  for (size_t i = 0; i < N; ++i) Pool->async([&F, i] { F(i); });
+  Pool->wait();
+}
+
+}
+
+#endif
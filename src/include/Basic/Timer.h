@@ -0,0 +1,82 @@
+#ifndef TIMER_H
+#define TIMER_H
+
+#include <chrono>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sysy {
+
+/// Wall-clock and CPU time of one interval.
+struct TimeRecord {
+  double Wall = 0;
+  double CPU = 0; // Process CPU time (user + system), all threads
+
+  static TimeRecord now();
+  /// Like now(), but with the calling thread's CPU time only, for intervals
+  /// timed inside a task while other threads keep running.
+  static TimeRecord nowForThread();
+  TimeRecord &operator+=(const TimeRecord &RHS) {
+    Wall += RHS.Wall;
+    CPU += RHS.CPU;
+    return *this;
+  }
+  TimeRecord operator+(const TimeRecord &RHS) const {
+    TimeRecord R = *this;
+    return R += RHS;
+  }
+  TimeRecord operator-(const TimeRecord &RHS) const {
+    TimeRecord R;
+    R.Wall = Wall - RHS.Wall;
+    R.CPU = CPU - RHS.CPU;
+    return R;
+  }
+};
+
+/// Accumulates time per named phase for -ftime-report (similar to LLVM's
+/// TimerGroup). Phases are reported in the order they first ran; a phase
+/// that runs several times (one per function, one per input) is summed.
+class TimerGroup {
+  struct Phase {
+    std::string Name;
+    TimeRecord Time;
+    unsigned Count = 0;
+  };
+  std::string Title;
+  std::vector<Phase> Phases;
+  mutable std::mutex Lock;
+
+public:
+  explicit TimerGroup(std::string title) : Title(std::move(title)) {}
+
+  /// Add \p T, the total of \p Runs runs, to phase \p Name.
+  void addTime(std::string_view Name, const TimeRecord &T, unsigned Runs = 1);
+
+  void print(std::ostream &OS) const;
+  void printJSON(std::ostream &OS) const;
+};
+
+/// Times the enclosing scope into a TimerGroup. A null group disables it,
+/// so call sites need no if (TimeReport) around each phase.
+class TimeRegion {
+  TimerGroup *Group;
+  const char *Name;
+  TimeRecord Start;
+
+public:
+  TimeRegion(TimerGroup *group, const char *name) : Group(group), Name(name) {
+    if (Group) Start = TimeRecord::now();
+  }
+  ~TimeRegion() {
+    if (Group) Group->addTime(Name, TimeRecord::now() - Start);
+  }
+  TimeRegion(const TimeRegion &) = delete;
+  TimeRegion &operator=(const TimeRegion &) = delete;
+};
+
+}
+
+#endif
@@ -1,6 +1,7 @@
 #ifndef TOKEN_H
 #define TOKEN_H
 
+#include "Basic/IdentifierTable.h"
 #include "Basic/TokenKinds.h"
 #include <string>
 #include <string_view>
@@ -12,6 +13,7 @@ private:
   tok::TokenKind Kind;
   // Fragment pointing to the source code buffer to avoid frequent string copying
   std::string_view Text;
+  Symbol Ident;            // Interned spelling, identifiers only
   int Line;
   int Column;
 
@@ -24,6 +26,9 @@ public:
   void setText(std::string_view text) { Text = text; }
   std::string_view getText() const { return Text; }
 
+  void setIdentifier(Symbol S) { Ident = S; }
+  Symbol getIdentifier() const { return Ident; }
+
   void setLocation(int line, int col) { Line = line; Column = col; }
   int getLine() const { return Line; }
   int getColumn() const { return Column; }
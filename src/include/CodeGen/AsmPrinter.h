@@ -0,0 +1,19 @@
+#ifndef CODEGEN_ASMPRINTER_H
+#define CODEGEN_ASMPRINTER_H
+
+#include <iosfwd>
+
+namespace sysy {
+
+class MachineFunction;
+
+/// Write the directives that start an assembly file.
+void printAssemblyHeader(std::ostream &OS);
+
+/// Write \p MF as GNU assembler input: a global function symbol and its
+/// code. Registers must be allocated and the frame laid out.
+void printFunctionAssembly(const MachineFunction &MF, std::ostream &OS);
+
+}
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef CODEGEN_CODEGEN_H
+#define CODEGEN_CODEGEN_H
+
+#include <iosfwd>
+
+namespace sysy {
+
+class Module;
+class ThreadPool;
+class TimerGroup;
+struct SchedModel;
+enum class OptLevel : unsigned char;
+
+/// Compile \p M to RV64GC assembly for the GNU assembler. Each function is
+/// selected, allocated and printed on its own (in parallel on \p Pool, if
+/// any), and the functions are written in module order. -O0 allocates
+/// registers by linear scan; the other levels allocate by graph coloring
+/// and schedule the instructions for \p Model before and after allocation.
+/// With \p Timers, each code generation phase gets a row summed over all
+/// functions.
+void emitAssembly(const Module &M, std::ostream &OS, OptLevel Level, const SchedModel &Model,
+                  ThreadPool *Pool = nullptr, TimerGroup *Timers = nullptr);
+
+}
+
+#endif
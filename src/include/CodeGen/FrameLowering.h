@@ -0,0 +1,21 @@
+#ifndef CODEGEN_FRAMELOWERING_H
+#define CODEGEN_FRAMELOWERING_H
+
+namespace sysy {
+
+class MachineFunction;
+
+/// Lay out the stack frame, insert the prologue and the epilogues, and
+/// turn frame indices into offsets from sp. Runs after register allocation.
+///
+///   caller's frame   incoming stack arguments
+///   ---------------- <- sp at the call (16-byte aligned)
+///   ra and the callee-saved registers the function writes
+///   stack objects (locals, spill slots)
+///   outgoing stack arguments
+///   ---------------- <- sp (16-byte aligned)
+void lowerFrame(MachineFunction &MF);
+
+}
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef CODEGEN_INSTRUCTIONSELECTION_H
+#define CODEGEN_INSTRUCTIONSELECTION_H
+
+#include "CodeGen/MachineFunction.h"
+#include <memory>
+
+namespace sysy {
+
+class Function;
+struct SchedModel;
+
+/// Select RV64GC instructions for \p F, in virtual registers.
+///
+/// Each block is covered by maximal munch over its expression trees: a
+/// comparison used only by the block's branch becomes a compare-and-branch
+/// (blt, bge, ...), small constants become immediates (addiw, slti, ...)
+/// or the zero register, and allocas become stack objects that loads and
+/// stores address directly. i32 values are kept sign-extended to 64 bits.
+/// Phis become copies at the end of each predecessor. Calls follow the
+/// standard LP64D convention. Multiplications by constants become shifts
+/// and adds, and divisions and remainders by constants multiplications,
+/// where \p Model says that is faster.
+std::unique_ptr<MachineFunction> selectInstructions(const Function &F, const SchedModel &Model);
+
+}
+
+#endif
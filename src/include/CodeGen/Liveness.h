@@ -0,0 +1,57 @@
+#ifndef CODEGEN_LIVENESS_H
+#define CODEGEN_LIVENESS_H
+
+#include "CodeGen/MachineFunction.h"
+#include <vector>
+
+namespace sysy {
+
+/// Is \p R one of the registers liveness tracks: virtual registers and the
+/// allocatable physical ones? zero, sp and the other reserved registers are
+/// never allocated, so nothing needs to know when they are live.
+inline bool isTrackedReg(Register R) { return isVirtualReg(R) || RISCV::isAllocatable(R); }
+
+/// Call \p F with each tracked register \p MI writes, including every
+/// register a call clobbers.
+template <typename Fn> void forEachDef(const MachineInstr &MI, Fn F) {
+  for (const MachineOperand &MO : MI) {
+    if (MO.isDef() && isTrackedReg(MO.getReg())) F(MO.getReg());
+  }
+  if (MI.isCall()) {
+    for (Register R : RISCV::getCallClobberedRegs()) F(R);
+  }
+}
+
+/// Call \p F with each tracked register \p MI reads. A register read twice
+/// is reported twice.
+template <typename Fn> void forEachUse(const MachineInstr &MI, Fn F) {
+  for (const MachineOperand &MO : MI) {
+    if (MO.isUse() && isTrackedReg(MO.getReg())) F(MO.getReg());
+  }
+}
+
+/// The registers live into and out of each block of a MachineFunction, as
+/// sorted lists.
+///
+/// Computed one register at a time: from each block that reads it before
+/// writing it, the register is live back along the predecessors up to the
+/// blocks that write it. That is linear in the size of the result, where
+/// iterating dense sets over the CFG would be quadratic in large functions.
+/// Registers need not be in SSA form (a phi's input register is written in
+/// every predecessor). Any change to the code invalidates the result.
+class MachineLiveness {
+  std::vector<std::vector<Register>> LiveIn, LiveOut; // Indexed by block number
+  unsigned NumRegs;
+
+public:
+  explicit MachineLiveness(const MachineFunction &MF);
+
+  /// FirstVirtualReg plus the number of virtual registers.
+  unsigned getNumRegs() const { return NumRegs; }
+  const std::vector<Register> &getLiveIn(const MachineBasicBlock *MBB) const { return LiveIn[MBB->getNumber()]; }
+  const std::vector<Register> &getLiveOut(const MachineBasicBlock *MBB) const { return LiveOut[MBB->getNumber()]; }
+};
+
+}
+
+#endif
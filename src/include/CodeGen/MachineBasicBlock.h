@@ -0,0 +1,65 @@
+#ifndef CODEGEN_MACHINEBASICBLOCK_H
+#define CODEGEN_MACHINEBASICBLOCK_H
+
+#include "CodeGen/MachineInstr.h"
+#include <string>
+#include <vector>
+
+namespace sysy {
+
+class MachineFunction;
+
+/// A straight-line sequence of machine instructions.
+///
+/// The CFG is not stored: the successors are read off the terminators, and
+/// a block whose last instruction is not a jump or return falls through to
+/// the next block in layout order.
+class MachineBasicBlock {
+  IntrusiveList<MachineInstr> Insts;
+  MachineFunction *Parent;
+  unsigned Number; // Position in the function's layout
+  std::string Name; // Of the IR block, for dumps
+  unsigned LoopDepth = 0; // Of the IR block, to weigh spill costs
+
+  friend class MachineFunction;
+
+public:
+  MachineBasicBlock(MachineFunction *Parent, std::string Name) : Parent(Parent), Number(0), Name(std::move(Name)) {}
+  MachineBasicBlock(const MachineBasicBlock &) = delete;
+  MachineBasicBlock &operator=(const MachineBasicBlock &) = delete;
+  ~MachineBasicBlock();
+
+  MachineFunction *getParent() const { return Parent; }
+  unsigned getNumber() const { return Number; }
+  const std::string &getName() const { return Name; }
+  unsigned getLoopDepth() const { return LoopDepth; }
+  void setLoopDepth(unsigned Depth) { LoopDepth = Depth; }
+
+  using iterator = IntrusiveList<MachineInstr>::iterator;
+  iterator begin() const { return Insts.begin(); }
+  iterator end() const { return Insts.end(); }
+  MachineInstr *front() const { return Insts.front(); }
+  MachineInstr *back() const { return Insts.back(); }
+  bool empty() const { return Insts.empty(); }
+  size_t size() const { return Insts.size(); }
+
+  /// Insert \p MI before \p Pos (nullptr = at the end).
+  MachineInstr *insert(MachineInstr *Pos, MachineInstr *MI);
+  MachineInstr *push_back(MachineInstr *MI) { return insert(nullptr, MI); }
+  /// Unlink \p MI without deleting it.
+  void remove(MachineInstr *MI);
+  void erase(MachineInstr *MI);
+
+  /// The first branch, jump or return at the end of the block, or null.
+  MachineInstr *getFirstTerminator() const;
+  /// The block after this one in layout order, or null.
+  MachineBasicBlock *getNextBlock() const;
+  bool canFallThrough() const;
+  std::vector<MachineBasicBlock *> getSuccessors() const;
+
+  void print(std::ostream &OS) const;
+};
+
+}
+
+#endif
@@ -0,0 +1,105 @@
+#ifndef CODEGEN_MACHINEFUNCTION_H
+#define CODEGEN_MACHINEFUNCTION_H
+
+#include "CodeGen/MachineBasicBlock.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace sysy {
+
+/// A slot in the stack frame. Offsets are from the stack pointer after the
+/// prologue, except for fixed objects (incoming stack arguments), whose
+/// offsets are from the stack pointer at the call.
+struct FrameObject {
+  int Size;
+  int Align;
+  int64_t Offset = 0;
+  bool Fixed = false;
+};
+
+/// The machine code of one function: blocks in layout order, virtual
+/// registers and the stack frame.
+class MachineFunction {
+  std::string Name;
+  std::vector<std::unique_ptr<MachineBasicBlock>> Blocks;
+  std::vector<RegClass> VRegClasses; // Indexed by Reg - FirstVirtualReg
+  std::vector<FrameObject> FrameObjects;
+  unsigned OutgoingArgSize = 0; // Bytes of stack arguments of the largest call
+  bool HasCalls = false;
+  std::vector<Register> SavedRegs; // Callee-saved registers the function writes
+
+public:
+  explicit MachineFunction(std::string Name) : Name(std::move(Name)) {}
+  MachineFunction(const MachineFunction &) = delete;
+  MachineFunction &operator=(const MachineFunction &) = delete;
+
+  const std::string &getName() const { return Name; }
+
+  /// Append a block, or insert it before \p Pos.
+  MachineBasicBlock *createBlock(std::string Name, MachineBasicBlock *Pos = nullptr);
+  /// Delete \p MBB, which nothing may branch to.
+  void eraseBlock(MachineBasicBlock *MBB);
+  MachineBasicBlock *getBlock(unsigned Number) const {
+    return Number < Blocks.size() ? Blocks[Number].get() : nullptr;
+  }
+  MachineBasicBlock *getEntryBlock() const { return Blocks.front().get(); }
+  size_t size() const { return Blocks.size(); }
+
+  class iterator {
+    std::vector<std::unique_ptr<MachineBasicBlock>>::const_iterator It;
+
+  public:
+    explicit iterator(std::vector<std::unique_ptr<MachineBasicBlock>>::const_iterator I) : It(I) {}
+    MachineBasicBlock &operator*() const { return **It; }
+    MachineBasicBlock *operator->() const { return It->get(); }
+    iterator &operator++() {
+      ++It;
+      return *this;
+    }
+    bool operator!=(const iterator &RHS) const { return It != RHS.It; }
+    bool operator==(const iterator &RHS) const { return It == RHS.It; }
+  };
+  iterator begin() const { return iterator(Blocks.begin()); }
+  iterator end() const { return iterator(Blocks.end()); }
+
+  Register createVirtualRegister(RegClass RC) {
+    VRegClasses.push_back(RC);
+    return FirstVirtualReg + static_cast<Register>(VRegClasses.size() - 1);
+  }
+  unsigned getNumVirtualRegs() const { return static_cast<unsigned>(VRegClasses.size()); }
+  RegClass getRegClass(Register R) const {
+    return isVirtualReg(R) ? VRegClasses[R - FirstVirtualReg] : RISCV::getRegClass(R);
+  }
+
+  int createStackObject(int Size, int Align) {
+    FrameObjects.push_back({Size, Align});
+    return static_cast<int>(FrameObjects.size() - 1);
+  }
+  int createFixedObject(int Size, int64_t Offset) {
+    FrameObjects.push_back({Size, Size, Offset, true});
+    return static_cast<int>(FrameObjects.size() - 1);
+  }
+  FrameObject &getFrameObject(int FI) { return FrameObjects[FI]; }
+  const FrameObject &getFrameObject(int FI) const { return FrameObjects[FI]; }
+  unsigned getNumFrameObjects() const { return static_cast<unsigned>(FrameObjects.size()); }
+
+  void noteCall(unsigned StackArgBytes) {
+    HasCalls = true;
+    if (StackArgBytes > OutgoingArgSize) OutgoingArgSize = StackArgBytes;
+  }
+  bool hasCalls() const { return HasCalls; }
+  unsigned getOutgoingArgSize() const { return OutgoingArgSize; }
+
+  void setSavedRegs(std::vector<Register> Regs) { SavedRegs = std::move(Regs); }
+  const std::vector<Register> &getSavedRegs() const { return SavedRegs; }
+
+  size_t getInstructionCount() const;
+
+  void print(std::ostream &OS) const;
+  void dump() const;
+};
+
+}
+
+#endif
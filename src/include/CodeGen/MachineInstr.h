@@ -0,0 +1,149 @@
+#ifndef CODEGEN_MACHINEINSTR_H
+#define CODEGEN_MACHINEINSTR_H
+
+#include "Basic/IntrusiveList.h"
+#include "CodeGen/RISCV.h"
+#include <cassert>
+#include <cstdint>
+#include <iosfwd>
+#include <vector>
+
+namespace sysy {
+
+class MachineBasicBlock;
+
+/// One operand of a MachineInstr.
+class MachineOperand {
+public:
+  enum Kind : unsigned char {
+    Reg,
+    Imm,
+    Block,      // Branch target
+    FrameIndex, // A stack object, until the frame is laid out
+    Symbol,     // Callee of a call
+  };
+
+private:
+  Kind K;
+  bool Def = false;
+  bool Implicit = false; // Not printed: argument registers of a call, ...
+  union {
+    Register R;
+    int64_t Val;
+    MachineBasicBlock *MBB;
+    int FI;
+    const char *Sym;
+  };
+
+  explicit MachineOperand(Kind K) : K(K), Val(0) {}
+
+public:
+  static MachineOperand createReg(Register R, bool IsDef = false, bool IsImplicit = false) {
+    MachineOperand MO(Reg);
+    MO.R = R;
+    MO.Def = IsDef;
+    MO.Implicit = IsImplicit;
+    return MO;
+  }
+  static MachineOperand createImm(int64_t V) {
+    MachineOperand MO(Imm);
+    MO.Val = V;
+    return MO;
+  }
+  static MachineOperand createBlock(MachineBasicBlock *BB) {
+    MachineOperand MO(Block);
+    MO.MBB = BB;
+    return MO;
+  }
+  static MachineOperand createFrameIndex(int Idx) {
+    MachineOperand MO(FrameIndex);
+    MO.FI = Idx;
+    return MO;
+  }
+  static MachineOperand createSymbol(const char *Name) {
+    MachineOperand MO(Symbol);
+    MO.Sym = Name;
+    return MO;
+  }
+
+  Kind getKind() const { return K; }
+  bool isReg() const { return K == Reg; }
+  bool isImm() const { return K == Imm; }
+  bool isBlock() const { return K == Block; }
+  bool isFrameIndex() const { return K == FrameIndex; }
+  bool isSymbol() const { return K == Symbol; }
+  bool isDef() const { return K == Reg && Def; }
+  bool isUse() const { return K == Reg && !Def; }
+  bool isImplicit() const { return Implicit; }
+
+  Register getReg() const { assert(isReg()); return R; }
+  int64_t getImm() const { assert(isImm()); return Val; }
+  MachineBasicBlock *getBlock() const { assert(isBlock()); return MBB; }
+  int getFrameIndex() const { assert(isFrameIndex()); return FI; }
+  const char *getSymbol() const { assert(isSymbol()); return Sym; }
+
+  void setReg(Register NewR) { assert(isReg()); R = NewR; }
+  void setImm(int64_t V) { assert(isImm()); Val = V; }
+  void setBlock(MachineBasicBlock *BB) { assert(isBlock()); MBB = BB; }
+  /// Turn a frame index into a register base, once the frame is laid out.
+  void changeToReg(Register NewR) {
+    K = Reg;
+    Def = Implicit = false;
+    R = NewR;
+  }
+};
+
+/// A target instruction: an opcode and operands, defs first.
+///
+/// Registers are virtual until register allocation. A call also clobbers
+/// every register RISCV::isCallClobbered() names, without listing them.
+class MachineInstr : public IntrusiveListNode<MachineInstr> {
+  RISCV::Opcode Op;
+  std::vector<MachineOperand> Operands;
+  MachineBasicBlock *Parent = nullptr;
+
+  friend class MachineBasicBlock;
+
+public:
+  MachineInstr(RISCV::Opcode Op, std::vector<MachineOperand> Ops) : Op(Op), Operands(std::move(Ops)) {}
+  MachineInstr(const MachineInstr &) = delete;
+  MachineInstr &operator=(const MachineInstr &) = delete;
+
+  RISCV::Opcode getOpcode() const { return Op; }
+  void setOpcode(RISCV::Opcode NewOp) { Op = NewOp; }
+  MachineBasicBlock *getParent() const { return Parent; }
+
+  unsigned getNumOperands() const { return static_cast<unsigned>(Operands.size()); }
+  MachineOperand &getOperand(unsigned i) { return Operands[i]; }
+  const MachineOperand &getOperand(unsigned i) const { return Operands[i]; }
+  void addOperand(const MachineOperand &MO) { Operands.push_back(MO); }
+  void removeOperand(unsigned i) { Operands.erase(Operands.begin() + i); }
+  auto begin() { return Operands.begin(); }
+  auto end() { return Operands.end(); }
+  auto begin() const { return Operands.begin(); }
+  auto end() const { return Operands.end(); }
+
+  RISCV::Format getFormat() const { return RISCV::getFormat(Op); }
+  bool isCopy() const { return Op == RISCV::MV || Op == RISCV::FMV_S; }
+  bool isCall() const { return Op == RISCV::CALL; }
+  bool isReturn() const { return Op == RISCV::RET; }
+  bool isBranch() const { return getFormat() == RISCV::Format::Branch; }
+  bool isJump() const { return Op == RISCV::J; }
+  bool isTerminator() const { return isBranch() || isJump() || isReturn(); }
+  bool mayLoad() const { return getFormat() == RISCV::Format::Load; }
+  bool mayStore() const { return getFormat() == RISCV::Format::Store; }
+
+  /// Computes a constant: reads nothing but immediates and the zero
+  /// register, so it can be repeated anywhere.
+  bool isRematerializable() const;
+
+  /// The target of a branch or jump.
+  MachineBasicBlock *getTarget() const;
+
+  void print(std::ostream &OS) const;
+  void dump() const;
+};
+
+}
+
+#endif
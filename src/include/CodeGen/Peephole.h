@@ -0,0 +1,30 @@
+#ifndef CODEGEN_PEEPHOLE_H
+#define CODEGEN_PEEPHOLE_H
+
+namespace sysy {
+
+class MachineFunction;
+
+// Cleanups over the machine code, before register allocation (where a copy
+// left behind may still be coalesced) and again after it, once spill code
+// has added its stores and reloads. Both work on virtual and physical
+// registers alike and need the stack slots still addressed by frame index,
+// so they run before the frame is laid out.
+
+/// Rewrite the patterns of the rule table in Peephole.cpp, each looking at
+/// an instruction and the one before it: copies of a register to itself,
+/// arithmetic that adds zero, a reload of the slot the previous instruction
+/// stored, and a conditional branch over a jump. -stats counts the hits of
+/// each rule.
+void runPeepholes(MachineFunction &MF);
+
+/// Numbers the values in registers and stack slots through each block, to
+/// delete a copy into a register that already holds the value and turn a
+/// load of a slot whose value is still in a register into a copy (or
+/// nothing). Stack objects are only reached through their frame index, so
+/// only a store to the same object changes one.
+void propagateCopies(MachineFunction &MF);
+
+}
+
+#endif
@@ -0,0 +1,112 @@
+#ifndef CODEGEN_RISCV_H
+#define CODEGEN_RISCV_H
+
+#include "Basic/ArrayRef.h"
+#include <cstdint>
+
+namespace sysy {
+
+/// Registers are numbers: 0-31 are x0-x31, 32-63 are f0-f31 and everything
+/// from FirstVirtualReg on is a virtual register of the MachineFunction.
+using Register = unsigned;
+constexpr Register NoRegister = ~0u;
+constexpr Register FirstVirtualReg = 64;
+inline bool isVirtualReg(Register R) { return R >= FirstVirtualReg && R != NoRegister; }
+inline bool isPhysicalReg(Register R) { return R < FirstVirtualReg; }
+
+enum class RegClass : unsigned char {
+  GPR, // x registers: i32, i1 and addresses
+  FPR, // f registers: f32
+};
+
+namespace RISCV {
+
+enum : Register {
+  // x registers by ABI name
+  ZERO, RA, SP, GP, TP, T0, T1, T2, S0, S1,
+  A0, A1, A2, A3, A4, A5, A6, A7,
+  S2, S3, S4, S5, S6, S7, S8, S9, S10, S11,
+  T3, T4, T5, T6,
+  // f registers by ABI name
+  FT0, FT1, FT2, FT3, FT4, FT5, FT6, FT7, FS0, FS1,
+  FA0, FA1, FA2, FA3, FA4, FA5, FA6, FA7,
+  FS2, FS3, FS4, FS5, FS6, FS7, FS8, FS9, FS10, FS11,
+  FT8, FT9, FT10, FT11,
+};
+
+/// Reserved for rebuilding addresses that do not fit a 12-bit offset
+/// (large frames), so it is never allocated.
+constexpr Register ScratchReg = T6;
+
+constexpr unsigned NumArgRegs = 8; // a0-a7, fa0-fa7
+
+enum Opcode : unsigned short {
+#define HANDLE_MINST(Name, Mnemonic, Format, Sched) Name,
+#include "CodeGen/RISCVInstrInfo.def"
+};
+
+/// How an instruction's operands are laid out and printed; defs come first.
+enum class Format : unsigned char {
+  RRR,    // rd, rs1, rs2
+  RRI,    // rd, rs1, imm
+  RR,     // rd, rs1
+  RI,     // rd, imm
+  Load,   // rd, base, offset       printed as rd, offset(base)
+  Store,  // rs2, base, offset      printed as rs2, offset(base)
+  Branch, // rs1, rs2, block
+  Jump,   // block
+  Call,   // symbol, then implicit register operands
+  None,
+};
+
+/// What an instruction keeps busy in the pipeline. A SchedModel gives each
+/// class its latency and functional unit on a particular core.
+enum class SchedClass : unsigned char {
+  IntALU,
+  IntMul,
+  IntDiv, // Also remainder
+  Load,
+  Store,
+  FPAdd,
+  FPMul,
+  FPDiv,
+  FPMisc, // Compares, sign injection, conversions, moves between files
+  Branch, // Also jumps and returns
+  Call,
+};
+constexpr unsigned NumSchedClasses = 11;
+
+const char *getMnemonic(Opcode Op);
+Format getFormat(Opcode Op);
+SchedClass getSchedClass(Opcode Op);
+/// The branch taken exactly when \p Br is not: beq and bne, blt and bge.
+Opcode getInvertedBranch(Opcode Br);
+const char *getRegName(Register R);
+
+inline RegClass getRegClass(Register R) { return R < FT0 ? RegClass::GPR : RegClass::FPR; }
+inline Register getArgReg(RegClass RC, unsigned i) { return (RC == RegClass::GPR ? A0 : FA0) + i; }
+
+/// Saved by the callee under the standard ABI (s0-s11, fs0-fs11). sp is
+/// restored by the epilogue and not counted.
+bool isCalleeSaved(Register R);
+/// Clobbered by a call: everything not callee-saved except zero, sp, gp
+/// and tp.
+bool isCallClobbered(Register R);
+/// The call-clobbered registers the allocator may assign, for walking.
+ArrayRef<Register> getCallClobberedRegs();
+/// Registers the allocator may assign: all but zero, ra, sp, gp, tp and
+/// the scratch register.
+bool isAllocatable(Register R);
+/// The allocatable registers of \p RC in the order to try them:
+/// caller-saved first, so that only values live across a call (which
+/// interfere with all of those) take a callee-saved register and cost a
+/// save in the prologue.
+ArrayRef<Register> getAllocationOrder(RegClass RC);
+
+inline bool isInt12(int64_t V) { return V >= -2048 && V <= 2047; }
+
+}
+
+}
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef CODEGEN_REGALLOC_H
+#define CODEGEN_REGALLOC_H
+
+#include "CodeGen/RISCV.h"
+#include <vector>
+
+namespace sysy {
+
+class MachineFunction;
+
+// The register allocators replace every virtual register with a physical
+// one, spilling values to stack slots where registers run out, and record
+// the callee-saved registers they used (MachineFunction::getSavedRegs) for
+// the prologue. A call clobbers every caller-saved register, so a value
+// live across a call always ends up in a callee-saved one or on the stack.
+
+/// Iterated register coalescing (George and Appel), for optimized code.
+///
+/// Builds the interference graph from liveness, then alternates
+/// simplifying low-degree nodes, conservatively coalescing copies (Briggs
+/// for two virtual registers, George against a physical one), freezing
+/// copies and picking spill candidates by use count weighted with loop
+/// depth over degree. Colors are picked optimistically, preferring the
+/// register of a copy partner. Spilled constants are rematerialized; other
+/// spills get a slot, and allocation starts over on the rewritten code.
+void allocateRegistersGraphColoring(MachineFunction &MF);
+
+/// Linear scan (Poletto and Sarkar) over one interval per virtual register,
+/// for fast unoptimized builds. When registers run out, the interval that
+/// ends last is spilled and allocation starts over on the rewritten code.
+void allocateRegistersLinearScan(MachineFunction &MF);
+
+/// Shared by the allocators: rewrite \p MF so that each register of \p Regs
+/// lives in memory, through a fresh virtual register per instruction that
+/// reads or writes it (loaded before, stored after). A register whose only
+/// definition is a constant is recomputed before each use instead. Returns
+/// the fresh registers; spilling them again would not help.
+std::vector<Register> spillRegisters(MachineFunction &MF, const std::vector<Register> &Regs);
+
+/// Shared by the allocators: replace each virtual register R with
+/// \p Assignment[R - FirstVirtualReg], delete the copies that became no-ops
+/// and record the callee-saved registers in use.
+void rewriteVirtualRegisters(MachineFunction &MF, const std::vector<Register> &Assignment);
+
+}
+
+#endif
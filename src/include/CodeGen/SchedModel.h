@@ -0,0 +1,53 @@
+#ifndef CODEGEN_SCHEDMODEL_H
+#define CODEGEN_SCHEDMODEL_H
+
+#include "CodeGen/RISCV.h"
+#include <string_view>
+
+namespace sysy {
+
+/// The functional units of a core, as far as scheduling is concerned.
+enum class SchedUnit : unsigned char {
+  ALU,
+  LoadStore,
+  Mul,
+  Div,   // Integer divider, usually not pipelined
+  FPU,
+  FPDiv, // FP divider, usually not pipelined
+  Branch,
+};
+constexpr unsigned NumSchedUnits = 7;
+
+/// A core's pipeline as the instruction scheduler sees it: in order, up to
+/// IssueWidth instructions per cycle, each taking a unit of its kind for
+/// Occupancy cycles and producing its result Latency cycles after issue.
+///
+/// Each core is one table in SchedModel.cpp; adding a core means adding a
+/// table and naming it there.
+struct SchedModel {
+  struct ClassInfo {
+    unsigned Latency;
+    SchedUnit Unit;
+    unsigned Occupancy; // 1 if the unit is pipelined
+  };
+
+  const char *Name;
+  unsigned IssueWidth;
+  unsigned NumUnits[NumSchedUnits]; // Indexed by SchedUnit
+  ClassInfo Classes[RISCV::NumSchedClasses]; // Indexed by RISCV::SchedClass
+
+  const ClassInfo &getClassInfo(RISCV::SchedClass SC) const { return Classes[static_cast<unsigned>(SC)]; }
+  unsigned getNumUnits(SchedUnit U) const { return NumUnits[static_cast<unsigned>(U)]; }
+};
+
+/// The model of the core called \p CPU (the -mtune names), or null.
+const SchedModel *findSchedModel(std::string_view CPU);
+/// What -mtune defaults to: the SiFive U74, a dual-issue in-order core.
+const SchedModel &getDefaultSchedModel();
+/// The class called \p Name (IntALU, IntMul, IntDiv, ... as in
+/// RISCV::SchedClass), for -msched-latency. Returns false if there is none.
+bool findSchedClass(std::string_view Name, RISCV::SchedClass &SC);
+
+}
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef CODEGEN_SCHEDULER_H
+#define CODEGEN_SCHEDULER_H
+
+namespace sysy {
+
+class MachineFunction;
+struct SchedModel;
+
+// List scheduling for in-order cores: the instructions between calls and
+// terminators are reordered, cycle by cycle on the model's pipeline, so
+// that loads, multiplies, divides and FP operations issue early and their
+// users late, and dual-issue cores find a second instruction to pair. The
+// dependences follow registers (physical ones included), stack slots, and
+// the call and branch at the ends of each region. A region keeps its order
+// unless the new one is estimated to take fewer cycles.
+
+/// Before register allocation, where there is the most freedom. Keeps the
+/// number of values live at once within the allocatable registers where
+/// the original order did, reads argument and result registers right away
+/// and writes them as late as possible, so as not to cause spills.
+void scheduleBeforeRegAlloc(MachineFunction &MF, const SchedModel &Model);
+
+/// After the frame is laid out, to also move the reloads, spills and
+/// callee-saved register saves the allocator and the prologue added.
+void scheduleAfterRegAlloc(MachineFunction &MF, const SchedModel &Model);
+
+}
+
+#endif
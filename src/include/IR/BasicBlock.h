@@ -0,0 +1,76 @@
+#ifndef IR_BASICBLOCK_H
+#define IR_BASICBLOCK_H
+
+#include "IR/Instruction.h"
+#include <string>
+#include <vector>
+
+namespace sysy {
+
+/// A straight-line sequence of instructions ending in a terminator.
+///
+/// Blocks are Values so that branches refer to them through ordinary
+/// operands: the predecessors of a block are the terminators in its use
+/// list, and retargeting a branch keeps them up to date for free.
+class BasicBlock : public Value, public IntrusiveListNode<BasicBlock> {
+  IntrusiveList<Instruction> InstList;
+  Function *Parent = nullptr;
+  std::string Name; // Hint for the printer, need not be unique
+
+  friend class Function;
+  friend class Instruction;
+
+public:
+  explicit BasicBlock(std::string Name = "") : Value(BasicBlockVal, Type::Label), Name(std::move(Name)) {}
+  ~BasicBlock() override;
+
+  Function *getParent() const { return Parent; }
+  const std::string &getName() const { return Name; }
+  void setName(std::string N) { Name = std::move(N); }
+
+  using iterator = IntrusiveList<Instruction>::iterator;
+  iterator begin() const { return InstList.begin(); }
+  iterator end() const { return InstList.end(); }
+  Instruction *front() const { return InstList.front(); }
+  Instruction *back() const { return InstList.back(); }
+  bool empty() const { return InstList.empty(); }
+  size_t size() const { return InstList.size(); }
+
+  void push_back(Instruction *I) { I->insertInto(this, nullptr); }
+
+  /// The terminator, or null while the block is still being built.
+  Instruction *getTerminator() const;
+  Instruction *getFirstNonPhi() const;
+
+  unsigned getNumSuccessors() const;
+  BasicBlock *getSuccessor(unsigned i) const;
+  std::vector<BasicBlock *> getSuccessors() const;
+  /// Distinct predecessors, found through the use list.
+  std::vector<BasicBlock *> getPredecessors() const;
+  BasicBlock *getSinglePredecessor() const;
+  BasicBlock *getSingleSuccessor() const;
+
+  /// Forget the edge from \p Pred: drop its entries from our phis.
+  void removePredecessor(BasicBlock *Pred);
+  /// Our successors' phis name \p Old as incoming block; make it this one.
+  void replacePhiUsesWith(BasicBlock *Old, BasicBlock *New);
+
+  /// Move the instructions from \p I to the end into a new block placed
+  /// after this one, and branch to it. Successor phis are updated.
+  BasicBlock *splitBasicBlock(Instruction *I, std::string NewName = "");
+
+  /// Link into \p F before \p Pos (nullptr = at the end).
+  void insertInto(Function *F, BasicBlock *Pos = nullptr);
+  void removeFromParent();
+  /// Unlink and delete, with all instructions. Nothing may branch here.
+  void eraseFromParent();
+
+  void print(std::ostream &OS) const;
+  void dump() const;
+
+  static bool classof(const Value *V) { return V->getValueKind() == BasicBlockVal; }
+};
+
+}
+
+#endif
@@ -0,0 +1,93 @@
+#ifndef IR_FUNCTION_H
+#define IR_FUNCTION_H
+
+#include "IR/BasicBlock.h"
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace sysy {
+
+class Module;
+
+/// A formal parameter, the value the caller passed in.
+class Argument : public Value {
+  Function *Parent;
+  unsigned ArgNo;
+
+public:
+  Argument(Type T, Function *F, unsigned ArgNo) : Value(ArgumentVal, T), Parent(F), ArgNo(ArgNo) {}
+
+  Function *getParent() const { return Parent; }
+  unsigned getArgNo() const { return ArgNo; }
+
+  static bool classof(const Value *V) { return V->getValueKind() == ArgumentVal; }
+};
+
+/// A function and everything it owns: arguments, blocks, instructions and
+/// constants. A function without blocks is a declaration of an external
+/// function (the SysY runtime library).
+///
+/// Nothing mutable is shared between functions (calls name their callee
+/// without a use-list entry, constants are uniqued per function), so
+/// different functions can be transformed concurrently.
+class Function {
+  std::string Name;
+  Type RetTy;
+  Module *Parent = nullptr;
+  std::vector<std::unique_ptr<Argument>> Args;
+  IntrusiveList<BasicBlock> Blocks;
+
+  std::unordered_map<int32_t, std::unique_ptr<ConstantInt>> Int32Constants;
+  std::unique_ptr<ConstantInt> BoolConstants[2];
+  std::unordered_map<uint32_t, std::unique_ptr<ConstantFloat>> FloatConstants; // By bit pattern
+  std::unique_ptr<UndefValue> Undefs[4];                                       // i1, i32, f32, ptr
+
+  friend class BasicBlock;
+  friend class Module;
+
+public:
+  Function(std::string Name, Type RetTy, const std::vector<Type> &ParamTys = {});
+  Function(const Function &) = delete;
+  Function &operator=(const Function &) = delete;
+  ~Function();
+
+  const std::string &getName() const { return Name; }
+  Type getReturnType() const { return RetTy; }
+  Module *getParent() const { return Parent; }
+  bool isDeclaration() const { return Blocks.empty(); }
+
+  unsigned getNumArgs() const { return static_cast<unsigned>(Args.size()); }
+  Argument *getArg(unsigned i) const { return Args[i].get(); }
+
+  using iterator = IntrusiveList<BasicBlock>::iterator;
+  iterator begin() const { return Blocks.begin(); }
+  iterator end() const { return Blocks.end(); }
+  BasicBlock *getEntryBlock() const { return Blocks.front(); }
+  BasicBlock *back() const { return Blocks.back(); }
+  bool empty() const { return Blocks.empty(); }
+  size_t size() const { return Blocks.size(); }
+
+  void push_back(BasicBlock *BB) { BB->insertInto(this); }
+
+  ConstantInt *getInt32(int32_t V);
+  ConstantInt *getBool(bool V);
+  ConstantFloat *getFloat(float V);
+  UndefValue *getUndef(Type T);
+  /// 0, 0.0 or false.
+  Value *getZeroValue(Type T);
+
+  /// Delete the blocks that cannot be reached from the entry block.
+  /// Returns the number of blocks removed.
+  unsigned removeUnreachableBlocks();
+
+  size_t getInstructionCount() const;
+
+  void print(std::ostream &OS) const;
+  void dump() const;
+};
+
+}
+
+#endif
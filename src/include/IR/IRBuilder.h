@@ -0,0 +1,65 @@
+#ifndef IR_IRBUILDER_H
+#define IR_IRBUILDER_H
+
+#include "IR/Function.h"
+
+namespace sysy {
+
+/// Creates instructions at an insertion point (similar to LLVM's IRBuilder).
+class IRBuilder {
+  BasicBlock *BB = nullptr;
+  Instruction *InsertPt = nullptr; // Insert before this, or at the end of BB
+
+  template <typename InstT> InstT *insert(InstT *I) {
+    I->insertInto(BB, InsertPt);
+    return I;
+  }
+
+public:
+  IRBuilder() = default;
+  explicit IRBuilder(BasicBlock *TheBB) { setInsertPoint(TheBB); }
+
+  /// Append to the end of \p TheBB.
+  void setInsertPoint(BasicBlock *TheBB) { BB = TheBB; InsertPt = nullptr; }
+  /// Insert before \p I.
+  void setInsertPoint(Instruction *I) { BB = I->getParent(); InsertPt = I; }
+  BasicBlock *getInsertBlock() const { return BB; }
+  Function *getFunction() const { return BB->getParent(); }
+
+  ConstantInt *getInt32(int32_t V) const { return getFunction()->getInt32(V); }
+  ConstantInt *getBool(bool V) const { return getFunction()->getBool(V); }
+  ConstantFloat *getFloat(float V) const { return getFunction()->getFloat(V); }
+
+  BinaryInst *createBinOp(Opcode Op, Value *LHS, Value *RHS) {
+    return insert(new BinaryInst(Op, LHS, RHS));
+  }
+  FNegInst *createFNeg(Value *V) { return insert(new FNegInst(V)); }
+  CmpInst *createICmp(CmpInst::Predicate P, Value *LHS, Value *RHS) {
+    return insert(new CmpInst(Opcode::ICmp, P, LHS, RHS));
+  }
+  CmpInst *createFCmp(CmpInst::Predicate P, Value *LHS, Value *RHS) {
+    return insert(new CmpInst(Opcode::FCmp, P, LHS, RHS));
+  }
+  CastInst *createCast(Opcode Op, Value *V, Type DestTy) {
+    return insert(new CastInst(Op, V, DestTy));
+  }
+  AllocaInst *createAlloca(Type T) { return insert(new AllocaInst(T)); }
+  LoadInst *createLoad(Type T, Value *Ptr) { return insert(new LoadInst(T, Ptr)); }
+  StoreInst *createStore(Value *V, Value *Ptr) { return insert(new StoreInst(V, Ptr)); }
+  CallInst *createCall(Function *Callee, ArrayRef<Value *> Args) {
+    return insert(new CallInst(Callee, Args));
+  }
+  PhiInst *createPhi(Type T, unsigned ReservedPreds = 2) {
+    return insert(new PhiInst(T, ReservedPreds));
+  }
+  BranchInst *createBr(BasicBlock *Dest) { return insert(new BranchInst(Dest)); }
+  BranchInst *createCondBr(Value *Cond, BasicBlock *IfTrue, BasicBlock *IfFalse) {
+    return insert(new BranchInst(Cond, IfTrue, IfFalse));
+  }
+  ReturnInst *createRet(Value *V) { return insert(new ReturnInst(V)); }
+  ReturnInst *createRetVoid() { return insert(new ReturnInst()); }
+};
+
+}
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef IR_IRGEN_H
+#define IR_IRGEN_H
+
+#include "AST/ASTVisitor.h"
+#include "Basic/ScopedSymbolTable.h"
+#include "IR/IRBuilder.h"
+#include "IR/Module.h"
+
+namespace sysy {
+
+class ThreadPool;
+
+/// Lowers a checked AST to IR.
+///
+/// Every local variable and parameter gets a stack slot (alloca) in the
+/// entry block and is read and written with loads and stores; mem2reg turns
+/// them into SSA values later. Expressions are computed in their natural type (i1 for
+/// comparisons and logical operators) and converted where C would convert.
+/// Conditions of if and while branch directly on each operand of && and ||.
+class IRGen : public ASTVisitor {
+    Module &M;
+    IRBuilder Builder;
+    Function *CurFn = nullptr;
+    AllocaInst *LastAlloca = nullptr; // Allocas are kept at the top of the entry block
+    ScopedSymbolTable<AllocaInst *> Locals;
+    Value *Result = nullptr;          // Value of the expression just visited
+    unsigned NumErrors = 0;
+
+    Value *genExpr(ExprAST *E) {
+        E->accept(*this);
+        return Result;
+    }
+    /// Evaluate \p E as a branch condition (i1).
+    Value *genCond(ExprAST *E) { return toBool(genExpr(E)); }
+    /// Branch to \p True or \p False on \p E. &&, || and ! become a chain
+    /// of branches instead of a 0/1 value that is tested again.
+    void genCondBr(ExprAST *E, BasicBlock *True, BasicBlock *False);
+    Value *genLogicalOp(BinaryExprAST &node);
+
+    /// The function a call names; runtime library functions are declared
+    /// on first use.
+    Function *getCallee(Symbol Name);
+
+    Value *toBool(Value *V);
+    Value *convertTo(Value *V, Type T);
+    AllocaInst *createEntryAlloca(Type T);
+    /// Append \p BB to the current function and continue emitting there.
+    void startBlock(BasicBlock *BB);
+    void error(const char *Msg);
+
+public:
+    explicit IRGen(Module &M) : M(M) {}
+
+    unsigned getNumErrors() const { return NumErrors; }
+
+    /// Create every function \p CU defines, with its signature but no body
+    /// yet, so that the bodies can be lowered in any order.
+    void declareFunctions(CompUnitAST &CU);
+
+    static Type getIRType(tok::TokenKind K);
+
+    void visit(CompUnitAST &node) override;
+    void visit(FuncDefAST &node) override;
+    void visit(FuncFParamAST &node) override;
+    void visit(BlockAST &node) override;
+    void visit(VarDeclAST &node) override;
+    void visit(IfStmtAST &node) override;
+    void visit(WhileStmtAST &node) override;
+    void visit(ReturnStmtAST &node) override;
+    void visit(AssignStmtAST &node) override;
+    void visit(ExprStmtAST &node) override;
+    void visit(CallExprAST &node) override;
+    void visit(BinaryExprAST &node) override;
+    void visit(UnaryExprAST &node) override;
+    void visit(LValAST &node) override;
+    void visit(NumberAST &node) override;
+};
+
+/// Lower \p CU into \p M, one function body per task on \p Pool (if any).
+/// The module comes out the same either way. Returns the number of errors.
+unsigned generateIR(CompUnitAST &CU, Module &M, ThreadPool *Pool = nullptr);
+
+}
+
+#endif
@@ -0,0 +1,295 @@
+#ifndef IR_INSTRUCTION_H
+#define IR_INSTRUCTION_H
+
+#include "Basic/ArrayRef.h"
+#include "Basic/IntrusiveList.h"
+#include "IR/Value.h"
+
+namespace sysy {
+
+class BasicBlock;
+class Function;
+
+enum class Opcode : unsigned char {
+#define HANDLE_INST(Name, Spelling) Name,
+#include "IR/Instructions.def"
+};
+
+const char *getOpcodeName(Opcode Op);
+
+/// Base class of all instructions.
+///
+/// Instructions with a fixed number of operands keep them in an array
+/// member of the subclass, so creating one is a single allocation and the
+/// operands sit next to the opcode. Phis start with a small heap array and
+/// grow it, relinking the uses.
+class Instruction : public Value, public IntrusiveListNode<Instruction> {
+  Opcode Op;
+  bool HungOffOperands = false; // Operands is a heap array we own
+  unsigned NumOperands = 0;
+  unsigned Capacity = 0;
+  BasicBlock *Parent = nullptr;
+  Use *Operands = nullptr;
+
+  friend class BasicBlock;
+
+protected:
+  Instruction(Opcode Op, Type T) : Value(InstructionVal, T), Op(Op) {}
+
+  /// Called by subclass constructors before the first addOperand():
+  /// \p Ops is their inline array, or null to get a heap array.
+  void initOperands(Use *Ops, unsigned Capacity);
+  void addOperand(Value *V);
+  /// Drop the last \p N operands.
+  void shrinkOperands(unsigned N);
+
+public:
+  ~Instruction() override;
+
+  Opcode getOpcode() const { return Op; }
+  const char *getOpcodeName() const { return sysy::getOpcodeName(Op); }
+  BasicBlock *getParent() const { return Parent; }
+  Function *getFunction() const;
+
+  unsigned getNumOperands() const { return NumOperands; }
+  Value *getOperand(unsigned i) const { return Operands[i].get(); }
+  void setOperand(unsigned i, Value *V) { Operands[i].set(V); }
+  Use &getOperandUse(unsigned i) { return Operands[i]; }
+  Use *op_begin() const { return Operands; }
+  Use *op_end() const { return Operands + NumOperands; }
+
+  /// Replace every operand equal to \p From with \p To.
+  void replaceUsesOfWith(Value *From, Value *To);
+
+  /// Set all operands to null, so that instructions referring to each other
+  /// can be deleted in any order.
+  void dropAllReferences();
+
+  bool isTerminator() const { return Op == Opcode::Br || Op == Opcode::Ret; }
+  bool isBinaryOp() const { return Op >= Opcode::Add && Op <= Opcode::FDiv; }
+  bool isCommutative() const {
+    return Op == Opcode::Add || Op == Opcode::Mul || Op == Opcode::FAdd ||
+           Op == Opcode::FMul;
+  }
+  /// Memory here means the function's own stack slots. No address ever
+  /// escapes, so a call cannot read or write them.
+  bool mayReadMemory() const { return Op == Opcode::Load; }
+  bool mayWriteMemory() const { return Op == Opcode::Store; }
+  /// False if the instruction can be deleted when its result is unused.
+  /// Calls may do I/O.
+  bool mayHaveSideEffects() const {
+    return mayWriteMemory() || isTerminator() || Op == Opcode::Call;
+  }
+
+  /// Link into \p BB before \p Pos (nullptr = at the end).
+  void insertInto(BasicBlock *BB, Instruction *Pos);
+  void insertBefore(Instruction *Pos);
+  void insertAfter(Instruction *Pos);
+  void moveBefore(Instruction *Pos);
+  /// Unlink from the parent block without deleting.
+  void removeFromParent();
+  /// Unlink and delete. The instruction must have no uses left.
+  void eraseFromParent();
+
+  /// A copy with the same operands that is not in any block yet.
+  Instruction *clone() const;
+
+  void print(std::ostream &OS) const;
+  void dump() const;
+
+  // Instructions come from a per-thread RecyclingAllocator.
+  static void *operator new(size_t Size);
+  static void operator delete(void *P, size_t Size);
+
+  static bool classof(const Value *V) { return V->getValueKind() == InstructionVal; }
+};
+
+class BinaryInst : public Instruction {
+  Use Ops[2];
+
+public:
+  BinaryInst(Opcode Op, Value *LHS, Value *RHS);
+
+  Value *getLHS() const { return getOperand(0); }
+  Value *getRHS() const { return getOperand(1); }
+
+  static bool classof(const Value *V) {
+    return Instruction::classof(V) && cast<Instruction>(V)->isBinaryOp();
+  }
+};
+
+class FNegInst : public Instruction {
+  Use Ops[1];
+
+public:
+  explicit FNegInst(Value *Operand);
+
+  static bool classof(const Value *V) {
+    return Instruction::classof(V) && cast<Instruction>(V)->getOpcode() == Opcode::FNeg;
+  }
+};
+
+/// icmp (signed) / fcmp. The predicates follow C: for floats every relation
+/// with a NaN is false except !=, which is true.
+class CmpInst : public Instruction {
+public:
+  enum Predicate : unsigned char { EQ, NE, LT, LE, GT, GE };
+
+private:
+  Predicate Pred;
+  Use Ops[2];
+
+public:
+  CmpInst(Opcode Op, Predicate P, Value *LHS, Value *RHS);
+
+  Predicate getPredicate() const { return Pred; }
+  void setPredicate(Predicate P) { Pred = P; }
+  Value *getLHS() const { return getOperand(0); }
+  Value *getRHS() const { return getOperand(1); }
+  bool isFloat() const { return getOpcode() == Opcode::FCmp; }
+
+  static Predicate getInversePredicate(Predicate P);
+  /// Predicate that holds for (RHS, LHS) when P holds for (LHS, RHS).
+  static Predicate getSwappedPredicate(Predicate P);
+  const char *getPredicateName() const;
+
+  static bool classof(const Value *V) {
+    if (!Instruction::classof(V)) return false;
+    Opcode Op = cast<Instruction>(V)->getOpcode();
+    return Op == Opcode::ICmp || Op == Opcode::FCmp;
+  }
+};
+
+/// zext (i1 -> i32), sitofp, fptosi (truncating toward zero).
+class CastInst : public Instruction {
+  Use Ops[1];
+
+public:
+  CastInst(Opcode Op, Value *V, Type DestTy);
+
+  static bool classof(const Value *V) {
+    if (!Instruction::classof(V)) return false;
+    Opcode Op = cast<Instruction>(V)->getOpcode();
+    return Op >= Opcode::ZExt && Op <= Opcode::FPToSI;
+  }
+};
+
+/// A stack slot for one scalar of AllocatedType.
+class AllocaInst : public Instruction {
+  Type AllocatedType;
+
+public:
+  explicit AllocaInst(Type T);
+
+  Type getAllocatedType() const { return AllocatedType; }
+
+  static bool classof(const Value *V) {
+    return Instruction::classof(V) && cast<Instruction>(V)->getOpcode() == Opcode::Alloca;
+  }
+};
+
+class LoadInst : public Instruction {
+  Use Ops[1];
+
+public:
+  LoadInst(Type T, Value *Ptr);
+
+  Value *getPointerOperand() const { return getOperand(0); }
+
+  static bool classof(const Value *V) {
+    return Instruction::classof(V) && cast<Instruction>(V)->getOpcode() == Opcode::Load;
+  }
+};
+
+class StoreInst : public Instruction {
+  Use Ops[2];
+
+public:
+  StoreInst(Value *Val, Value *Ptr);
+
+  Value *getValueOperand() const { return getOperand(0); }
+  Value *getPointerOperand() const { return getOperand(1); }
+
+  static bool classof(const Value *V) {
+    return Instruction::classof(V) && cast<Instruction>(V)->getOpcode() == Opcode::Store;
+  }
+};
+
+/// "call i32 @f(i32 %a, f32 %b)". The operands are the arguments; the
+/// callee is a plain pointer rather than an operand, so a function's use
+/// list never links instructions of other functions.
+class CallInst : public Instruction {
+  Function *Callee;
+
+public:
+  CallInst(Function *Callee, ArrayRef<Value *> Args);
+
+  Function *getCallee() const { return Callee; }
+  unsigned getNumArgs() const { return getNumOperands(); }
+  Value *getArg(unsigned i) const { return getOperand(i); }
+
+  static bool classof(const Value *V) {
+    return Instruction::classof(V) && cast<Instruction>(V)->getOpcode() == Opcode::Call;
+  }
+};
+
+/// Operands are (value, block) pairs, one per predecessor.
+class PhiInst : public Instruction {
+public:
+  explicit PhiInst(Type T, unsigned ReservedPreds = 2);
+
+  unsigned getNumIncomingValues() const { return getNumOperands() / 2; }
+  Value *getIncomingValue(unsigned i) const { return getOperand(2 * i); }
+  void setIncomingValue(unsigned i, Value *V) { setOperand(2 * i, V); }
+  BasicBlock *getIncomingBlock(unsigned i) const;
+  void setIncomingBlock(unsigned i, BasicBlock *BB);
+
+  void addIncoming(Value *V, BasicBlock *BB);
+  /// Remove entry \p i; the last entry takes its place.
+  void removeIncoming(unsigned i);
+  /// Index of the entry for \p BB, or -1.
+  int getBasicBlockIndex(const BasicBlock *BB) const;
+  Value *getIncomingValueForBlock(const BasicBlock *BB) const;
+  /// The value all entries agree on (ignoring self references), or null.
+  Value *hasConstantValue() const;
+
+  static bool classof(const Value *V) {
+    return Instruction::classof(V) && cast<Instruction>(V)->getOpcode() == Opcode::Phi;
+  }
+};
+
+/// Unconditional "br label %dest" or conditional "br i1 %c, label %t, label %f".
+class BranchInst : public Instruction {
+  Use Ops[3];
+
+public:
+  explicit BranchInst(BasicBlock *Dest);
+  BranchInst(Value *Cond, BasicBlock *IfTrue, BasicBlock *IfFalse);
+
+  bool isConditional() const { return getNumOperands() == 3; }
+  Value *getCondition() const { return getOperand(0); }
+  unsigned getNumSuccessors() const { return isConditional() ? 2 : 1; }
+  BasicBlock *getSuccessor(unsigned i) const;
+  void setSuccessor(unsigned i, BasicBlock *BB);
+
+  static bool classof(const Value *V) {
+    return Instruction::classof(V) && cast<Instruction>(V)->getOpcode() == Opcode::Br;
+  }
+};
+
+class ReturnInst : public Instruction {
+  Use Ops[1];
+
+public:
+  explicit ReturnInst(Value *RetVal = nullptr);
+
+  Value *getReturnValue() const { return getNumOperands() ? getOperand(0) : nullptr; }
+
+  static bool classof(const Value *V) {
+    return Instruction::classof(V) && cast<Instruction>(V)->getOpcode() == Opcode::Ret;
+  }
+};
+
+}
+
+#endif
@@ -0,0 +1,58 @@
+#ifndef IR_MODULE_H
+#define IR_MODULE_H
+
+#include "IR/Function.h"
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace sysy {
+
+class ThreadPool;
+
+/// The IR of one translation unit.
+///
+/// Functions may be created and looked up from several threads at once,
+/// as long as nothing iterates over or erases functions meanwhile.
+class Module {
+  std::vector<std::unique_ptr<Function>> Functions; // In definition order
+  std::unordered_map<std::string_view, Function *> FunctionMap;
+  mutable std::mutex Lock; // Guards the two above while functions are added
+
+  Function *createFunctionImpl(std::string Name, Type RetTy, const std::vector<Type> &ParamTys);
+
+public:
+  Module() = default;
+  Module(const Module &) = delete;
+  Module &operator=(const Module &) = delete;
+
+  /// Create an empty function and take ownership of it.
+  Function *createFunction(std::string Name, Type RetTy, const std::vector<Type> &ParamTys = {});
+  Function *getFunction(std::string_view Name) const;
+  /// The function named \p Name, created with this signature if there is
+  /// none yet. Two threads asking at once get the same function.
+  Function *getOrInsertFunction(std::string_view Name, Type RetTy, const std::vector<Type> &ParamTys);
+  /// Move the declarations behind the definitions and sort them by name,
+  /// so the layout does not depend on which function declared one first.
+  void sortDeclarations();
+  /// Delete the functions in \p Dead, which no call may name any more.
+  void eraseFunctions(const std::unordered_set<const Function *> &Dead);
+
+  auto begin() const { return Functions.begin(); }
+  auto end() const { return Functions.end(); }
+  size_t size() const { return Functions.size(); }
+
+  size_t getInstructionCount() const;
+
+  /// With \p Pool, the functions are printed in parallel, each to its own
+  /// buffer, and written out in order.
+  void print(std::ostream &OS, ThreadPool *Pool = nullptr) const;
+  void dump() const;
+};
+
+}
+
+#endif
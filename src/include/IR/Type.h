@@ -0,0 +1,33 @@
+#ifndef IR_TYPE_H
+#define IR_TYPE_H
+
+namespace sysy {
+
+/// IR types. SysY only has scalars, so a type is a plain tag; pointers are
+/// opaque (loads say what they read, allocas say what they hold).
+enum class Type : unsigned char {
+  Void,
+  I1,    // Result of comparisons, branch conditions
+  I32,
+  F32,
+  Ptr,
+  Label, // Basic blocks
+};
+
+inline bool isIntegerType(Type T) { return T == Type::I1 || T == Type::I32; }
+
+inline const char *getTypeName(Type T) {
+  switch (T) {
+  case Type::Void: return "void";
+  case Type::I1: return "i1";
+  case Type::I32: return "i32";
+  case Type::F32: return "f32";
+  case Type::Ptr: return "ptr";
+  case Type::Label: return "label";
+  }
+  return "<invalid>";
+}
+
+}
+
+#endif
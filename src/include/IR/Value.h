@@ -0,0 +1,158 @@
+#ifndef IR_VALUE_H
+#define IR_VALUE_H
+
+#include "Basic/Casting.h"
+#include "IR/Type.h"
+#include <cstdint>
+#include <iosfwd>
+
+namespace sysy {
+
+class Value;
+class Instruction;
+
+/// One operand slot of an Instruction.
+///
+/// Every Use is also linked into the use list of the Value it refers to, so
+/// def->use (users of a value) and use->def (operands of an instruction)
+/// are both walked without any lookup.
+class Use {
+  Value *Val = nullptr;
+  Instruction *User = nullptr;
+  Use *Next = nullptr;
+  Use **Prev = nullptr; // The pointer that points at this Use
+
+  friend class Value;
+  friend class Instruction;
+
+  void addToList(Use **List) {
+    Next = *List;
+    if (Next) Next->Prev = &Next;
+    Prev = List;
+    *List = this;
+  }
+  void removeFromList() {
+    *Prev = Next;
+    if (Next) Next->Prev = Prev;
+  }
+
+public:
+  Use() = default;
+  Use(const Use &) = delete;
+  Use &operator=(const Use &) = delete;
+  ~Use() { if (Val) removeFromList(); }
+
+  Value *get() const { return Val; }
+  void set(Value *V);
+  Instruction *getUser() const { return User; }
+  Use *getNext() const { return Next; }
+  unsigned getOperandNo() const;
+
+  operator Value *() const { return Val; }
+  Value *operator->() const { return Val; }
+};
+
+class Value {
+public:
+  enum ValueKind : unsigned char {
+    ArgumentVal,
+    BasicBlockVal,
+    ConstantIntVal,
+    ConstantFloatVal,
+    UndefVal,
+    InstructionVal,
+  };
+
+private:
+  const ValueKind Kind;
+  Type Ty;
+  Use *UseList = nullptr;
+  friend class Use;
+
+protected:
+  Value(ValueKind K, Type T) : Kind(K), Ty(T) {}
+
+public:
+  Value(const Value &) = delete;
+  Value &operator=(const Value &) = delete;
+  virtual ~Value();
+
+  ValueKind getValueKind() const { return Kind; }
+  Type getType() const { return Ty; }
+  void mutateType(Type T) { Ty = T; }
+
+  class use_iterator {
+    Use *U;
+
+  public:
+    explicit use_iterator(Use *u) : U(u) {}
+    Use &operator*() const { return *U; }
+    Use *operator->() const { return U; }
+    use_iterator &operator++() { U = U->getNext(); return *this; }
+    bool operator!=(const use_iterator &RHS) const { return U != RHS.U; }
+    bool operator==(const use_iterator &RHS) const { return U == RHS.U; }
+  };
+  struct use_range {
+    Use *First;
+    use_iterator begin() const { return use_iterator(First); }
+    use_iterator end() const { return use_iterator(nullptr); }
+  };
+
+  /// The uses of this value. Changing a Use unlinks it, so code that
+  /// rewrites uses while walking should grab getNext() first.
+  use_range uses() const { return {UseList}; }
+  Use *getFirstUse() const { return UseList; }
+  bool use_empty() const { return UseList == nullptr; }
+  bool hasOneUse() const { return UseList && !UseList->getNext(); }
+  unsigned getNumUses() const;
+
+  /// Point every use of this value at \p V instead.
+  void replaceAllUsesWith(Value *V);
+
+  /// Print the value as an operand ("i32 %3", "i32 42", ...). Instruction
+  /// numbers are only meaningful within the printed function, see
+  /// IRPrinter.cpp.
+  void printAsOperand(std::ostream &OS) const;
+};
+
+/// Constants are uniqued per Function (see Function::getInt32()), so that
+/// functions share no mutable state and can be compiled in parallel.
+class ConstantInt : public Value {
+  int32_t Val;
+
+public:
+  ConstantInt(Type T, int32_t V) : Value(ConstantIntVal, T), Val(V) {}
+  int32_t getValue() const { return Val; }
+  bool isZero() const { return Val == 0; }
+  bool isOne() const { return Val == 1; }
+
+  static bool classof(const Value *V) { return V->getValueKind() == ConstantIntVal; }
+};
+
+class ConstantFloat : public Value {
+  float Val;
+
+public:
+  explicit ConstantFloat(float V) : Value(ConstantFloatVal, Type::F32), Val(V) {}
+  float getValue() const { return Val; }
+
+  static bool classof(const Value *V) { return V->getValueKind() == ConstantFloatVal; }
+};
+
+/// A value the program never defined, e.g. a local read before its first
+/// assignment. Any concrete value may be substituted for it.
+class UndefValue : public Value {
+public:
+  explicit UndefValue(Type T) : Value(UndefVal, T) {}
+
+  static bool classof(const Value *V) { return V->getValueKind() == UndefVal; }
+};
+
+inline bool isConstant(const Value *V) {
+  return V->getValueKind() >= Value::ConstantIntVal &&
+         V->getValueKind() <= Value::UndefVal;
+}
+
+}
+
+#endif
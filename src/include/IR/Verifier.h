@@ -0,0 +1,19 @@
+#ifndef IR_VERIFIER_H
+#define IR_VERIFIER_H
+
+#include <iosfwd>
+
+namespace sysy {
+
+class Function;
+class Module;
+
+/// Check the structural invariants of the IR: terminators, phis matching
+/// the predecessors, operand types, use lists, definitions before uses.
+/// Problems are reported to \p OS. Returns true if the IR is well formed.
+bool verifyFunction(const Function &F, std::ostream &OS);
+bool verifyModule(const Module &M, std::ostream &OS);
+
+}
+
+#endif
@@ -8,21 +8,29 @@ namespace sysy {
 
 class Lexer {
 private:
-  std::string_view Buffer; // input
+  std::string_view Buffer; // input, must be followed by a '\0' (see MemoryBuffer)
   const char *CurPtr;      // Current scanning position
+  IdentifierTable &Idents; // Receives every identifier spelling
   int CurLine;
   int CurCol;
+  unsigned NumTokens = 0;
+  unsigned NumErrors = 0;
 
 public:
-  Lexer(std::string_view buffer) 
-    : Buffer(buffer), CurPtr(buffer.data()), CurLine(1), CurCol(1) {}
+  Lexer(std::string_view buffer, IdentifierTable &idents)
+    : Buffer(buffer), CurPtr(buffer.data()), Idents(idents), CurLine(1), CurCol(1) {}
 
   Token nextToken();
 
+  unsigned getNumTokens() const { return NumTokens; }
+  unsigned getNumErrors() const { return NumErrors; }
+
 private:
   void skipWhitespace();
   void skipComment();      // Handle // and /* */
   Token lexNumericConstant();
+  // Moves CurPtr forward to NewPtr, updating the line and column in bulk.
+  void advanceTo(const char *NewPtr);
   char peek() const { return *CurPtr; }
   char consume() { 
     char c = *CurPtr++; 
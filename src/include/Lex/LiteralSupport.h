@@ -0,0 +1,33 @@
+#ifndef LITERALSUPPORT_H
+#define LITERALSUPPORT_H
+
+#include <cstdint>
+#include <string_view>
+
+namespace sysy {
+
+enum class LiteralError {
+  None,
+  InvalidDigit,      // '8' in an octal constant, 'g' in a hex constant, ...
+  TooLarge,          // Does not fit in 32 bits / overflows float
+  MissingExponent,   // "1e", "0x1p+", or a hex float without 'p'
+  Malformed,         // "0x", "1.2.3", ...
+};
+
+const char *getLiteralErrorMessage(LiteralError E);
+
+/// Evaluate an int_const token: decimal, octal (leading 0) or hex (0x).
+///
+/// Works on the token text in place, without allocating or throwing. Hex and
+/// octal values up to 2^32-1 are accepted and wrap to int, so "0x80000000"
+/// means INT_MIN as in other SysY compilers. Decimal values go up to 2^31
+/// only, for "-2147483648"; anything larger is TooLarge.
+LiteralError evalIntLiteral(std::string_view Spelling, int32_t &Value);
+
+/// Evaluate a float_const token: decimal ("1.5", ".5", "1.", "1e-3") or
+/// hexadecimal ("0x1.8p3"), rounded to the nearest float.
+LiteralError evalFloatLiteral(std::string_view Spelling, float &Value);
+
+}
+
+#endif
@@ -2,20 +2,40 @@
 #define PARSER_H
 
 #include "Lex/Lexer.h"
+#include "Lex/LiteralSupport.h"
+#include "AST/ASTContext.h"
 #include "AST/ASTNode.h"
+#include <vector>
 
 namespace sysy {
 
 class Parser {
     Lexer &L;
+    ASTContext &Ctx;
     Token CurTok;
+    // Scratch stack shared by all (nested) lists being parsed. Each list
+    // remembers where it started and moves its items into the arena when
+    // it is complete, so parsing a block does not allocate a vector.
+    std::vector<ASTNode *> ItemStack;
+
+    // Stacks of the operator-precedence expression parser, see parseExpr().
+    struct PendingOp {
+        tok::TokenKind Kind;  // Operator token, or l_paren
+        unsigned char Prec;   // Binding strength, see Parser.cpp
+    };
+    std::vector<PendingOp> OpStack;
+    std::vector<ExprAST *> OperandStack;
+    unsigned NumErrors = 0;
 
 public:
-    Parser(Lexer &lexer) : L(lexer) {
+    Parser(Lexer &lexer, ASTContext &ctx) : L(lexer), Ctx(ctx) {
         getNextToken();
     }
 
-    std::unique_ptr<CompUnitAST> parseCompUnit();
+    CompUnitAST *parseCompUnit();
+
+    /// Lexical and syntax errors reported so far.
+    unsigned getNumErrors() const { return NumErrors + L.getNumErrors(); }
 
 private:
     void getNextToken() { CurTok = L.nextToken(); }
@@ -25,22 +45,30 @@ private:
     // (similar to Clang's ExpectAndConsume)
     bool expect(tok::TokenKind K);
 
-    std::unique_ptr<FuncDefAST> parseFuncDef();
-    std::string parseType();
+    // Diagnose a numeric constant that cannot be represented (at CurTok).
+    void reportLiteralError(LiteralError E);
+
+    // Copy ItemStack[Start..] into the arena and pop it off the stack.
+    ArrayRef<ASTNode *> takeItems(size_t Start);
+    // Same, for a list whose items are all of class T.
+    template <typename T> ArrayRef<T *> takeItemsAs(size_t Start) {
+        auto Items = Ctx.copyArrayAs<T *>(ItemStack.data() + Start, ItemStack.size() - Start);
+        ItemStack.resize(Start);
+        return Items;
+    }
+
+    FuncDefAST *parseFuncDef();
+    FuncFParamAST *parseFuncFParam(); // FuncFParam -> (int|float) Identifier
+    tok::TokenKind parseType();   // kw_int/kw_float/kw_void, or unknown
 
-    std::unique_ptr<BlockAST> parseBlock();       // {...}
-    std::unique_ptr<StmtAST> parseStmt();         // (return, block, etc.)
-    std::unique_ptr<VarDeclAST> parseDecl();      // Decl -> Type Identifier [ = Expr ] ;
+    BlockAST *parseBlock();       // {...}
+    StmtAST *parseStmt();         // (return, block, etc.)
+    VarDeclAST *parseDecl();      // Decl -> Type Identifier [ = Expr ] ;
     
-    std::unique_ptr<ExprAST> parseExpr();         // Expr -> AddExpr
-    std::unique_ptr<ExprAST> parseLogicOrExpr(); // ||
-    std::unique_ptr<ExprAST> parseLogicAndExpr(); // &&
-    std::unique_ptr<ExprAST> parseEqExpr(); // == | !=
-    std::unique_ptr<ExprAST> parseRelExpr();      // < | > | <= | >=
-    std::unique_ptr<ExprAST> parseAddExpr();      // AddExpr -> MulExpr { (+|-) MulExpr }
-    std::unique_ptr<ExprAST> parseMulExpr();      // MulExpr -> PrimaryExpr { (*|/|%) PrimaryExpr }
-    std::unique_ptr<ExprAST> parseUnaryExpr();   // UnaryExpr -> (+|-) UnaryExpr | PrimaryExpr
-    std::unique_ptr<ExprAST> parsePrimaryExpr();  // PrimaryExpr -> Number | (Expr)
+    ExprAST *parseExpr();         // Expr -> { (+|-|!) | ( } Primary { ) } { BinOp Expr }
+    ExprAST *parsePrimaryExpr();  // PrimaryExpr -> Number | Identifier | Call
+    ExprAST *parseCallArgs(Symbol callee); // Call -> Identifier ( [Expr {, Expr}] )
+    void reduceOperator();        // Pop one operator and build its node
 };
 
 }
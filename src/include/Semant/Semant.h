@@ -2,34 +2,45 @@
 #define SEMANT_H
 
 #include "AST/ASTVisitor.h"
-#include <vector>
-#include <map>
+#include "Basic/ScopedSymbolTable.h"
 #include <iostream>
-#include <string>
 
 namespace sysy {
 
+struct SymbolInfo {
+    bool IsFunc;
+    tok::TokenKind Type;    // Variable type, or return type of a function
+    unsigned NumParams = 0; // Functions only
+};
+
 class Semant : public ASTVisitor {
-    // Maintain a Scope stack, each of which is a map (variable name -> type).
-    std::vector<std::map<std::string, std::string>> Scopes;
+    // All scopes share one flat table indexed by Symbol ID; see
+    // ScopedSymbolTable for how shadowing and scope exit work.
+    ScopedSymbolTable<SymbolInfo> Symbols;
+    bool Verbose;
+    unsigned NumErrors = 0;
 public:
-    Semant() {
+    Semant(bool verbose = false) : Verbose(verbose) {
         enterScope(); // Global scope
     }
 
-    void enterScope() { Scopes.emplace_back(); }
+    void enterScope() { Symbols.enterScope(); }
     void exitScope() {
-        if (!Scopes.empty()) {
-            Scopes.pop_back();
+        if (Symbols.getDepth() > 0) {
+            Symbols.exitScope();
         }
     }
     
-    bool defineSymbol(const std::string &name, const std::string &type);
+    bool defineSymbol(Symbol name, SymbolInfo info);
+
+    // The visible binding of \p name, or nullptr after reporting an error.
+    const SymbolInfo *checkSymbol(Symbol name);
 
-    bool checkSymbol(const std::string &name);
+    unsigned getNumErrors() const { return NumErrors; }
 
     void visit(CompUnitAST &node) override;
     void visit(FuncDefAST &node) override;
+    void visit(FuncFParamAST &node) override;
     void visit(BlockAST &node) override;
     void visit(VarDeclAST &node) override;
     void visit(IfStmtAST &node) override;
@@ -37,6 +48,7 @@ public:
     void visit(ReturnStmtAST &node) override;
     void visit(AssignStmtAST &node) override;
     void visit(ExprStmtAST &node) override;
+    void visit(CallExprAST &node) override;
     void visit(BinaryExprAST &node) override;
     void visit(UnaryExprAST &node) override;
     void visit(LValAST &node) override;
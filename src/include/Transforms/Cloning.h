@@ -0,0 +1,42 @@
+#ifndef TRANSFORMS_CLONING_H
+#define TRANSFORMS_CLONING_H
+
+#include <string>
+#include <unordered_map>
+
+namespace sysy {
+
+class BasicBlock;
+class CallInst;
+class Function;
+class Instruction;
+class Value;
+
+/// Original value -> its copy.
+using ValueMap = std::unordered_map<const Value *, Value *>;
+
+/// The copy of \p V in \p VMap, or \p V itself if it was not copied.
+Value *lookupValue(const ValueMap &VMap, Value *V);
+
+/// Copy \p BB and its instructions into a new block placed before
+/// \p InsertBefore (nullptr = at the end) in function \p F, by default the
+/// one \p BB is in, named with \p Suffix appended. The block and every
+/// instruction are entered in \p VMap. The copies still use the original
+/// operands until remapInstruction is run on them, which lets a group of
+/// blocks be cloned first and then rewired together.
+BasicBlock *cloneBasicBlock(const BasicBlock *BB, ValueMap &VMap, const std::string &Suffix,
+                            BasicBlock *InsertBefore, Function *F = nullptr);
+
+/// Replace every operand of \p I that has an entry in \p VMap.
+void remapInstruction(Instruction *I, const ValueMap &VMap);
+
+/// Replace \p Call by a copy of the callee's body. The call's block is
+/// split after the call, the callee's returns branch to the second half
+/// (joined by a phi for the result), and the callee's allocas move to the
+/// caller's entry block. The callee must have a body and must not be the
+/// caller itself.
+void inlineFunction(CallInst *Call);
+
+}
+
+#endif
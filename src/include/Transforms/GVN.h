@@ -0,0 +1,22 @@
+#ifndef TRANSFORMS_GVN_H
+#define TRANSFORMS_GVN_H
+
+namespace sysy {
+
+class DominatorTree;
+class Function;
+
+/// Dominator-scoped value numbering (in the spirit of LLVM's EarlyCSE).
+///
+/// Walks the dominator tree keeping a scoped table of the pure expressions
+/// (opcode, type, predicate and operands; commutative operands and compare
+/// sides in a canonical order) computed by the dominating blocks, and
+/// replaces recomputations with the dominating value. Loads are reused, and
+/// stored values forwarded to loads, as long as no store can have run in
+/// between. The CFG is not changed, so \p DT stays valid.
+/// Returns true if anything changed.
+bool runGVN(Function &F, DominatorTree &DT);
+
+}
+
+#endif
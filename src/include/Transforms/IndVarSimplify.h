@@ -0,0 +1,26 @@
+#ifndef TRANSFORMS_INDVARSIMPLIFY_H
+#define TRANSFORMS_INDVARSIMPLIFY_H
+
+namespace sysy {
+
+class Function;
+class LoopInfo;
+
+/// Induction variable simplification, driven by ScalarEvolution.
+///
+///  - Strength reduction: a multiply whose value steps by a loop invariant
+///    amount each iteration becomes a new induction variable, advanced by
+///    an add in the latch.
+///  - Exit values: with a constant trip count, values leaving the loop
+///    through its exit phis are replaced by their final value.
+///  - Exit test rewriting: an induction variable kept alive only by the
+///    exit test and its own increment is dropped, and the test is made on
+///    another induction variable instead.
+///
+/// Expects the loops in simplified LCSSA form; the CFG is not changed.
+/// Returns true if anything changed.
+bool runIndVarSimplify(Function &F, LoopInfo &LI);
+
+}
+
+#endif
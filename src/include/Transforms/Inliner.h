@@ -0,0 +1,22 @@
+#ifndef TRANSFORMS_INLINER_H
+#define TRANSFORMS_INLINER_H
+
+namespace sysy {
+
+class Module;
+
+/// Inline calls whose estimated cost is below a threshold.
+///
+/// Functions are visited bottom-up over the call graph's SCCs, so a callee
+/// has already absorbed its own callees when its size is estimated. The
+/// cost is the callee's size minus what the call itself costs, less a bonus
+/// for each constant argument; the threshold is raised for calls inside
+/// loops and for the only call of a function. Recursive functions are
+/// never inlined. Functions other than main that have no callers left are
+/// deleted. Best run after mem2reg, so that the sizes are realistic.
+/// Returns true if anything changed.
+bool runInliner(Module &M);
+
+}
+
+#endif
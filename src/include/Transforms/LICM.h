@@ -0,0 +1,22 @@
+#ifndef TRANSFORMS_LICM_H
+#define TRANSFORMS_LICM_H
+
+namespace sysy {
+
+class Function;
+class LoopInfo;
+
+/// Loop-invariant code motion, innermost loops first.
+///
+/// Pure computations whose operands do not change in the loop, and loads
+/// that no store in the loop can clobber, move to the preheader. A local
+/// variable that the loop only ever reaches through its own loads and
+/// stores is promoted: it is loaded once in the preheader, carried in
+/// registers around the loop, and stored back once in each exit block.
+/// Expects the loops in simplified form (see simplifyLoops); the CFG is
+/// not changed. Returns true if anything changed.
+bool runLICM(Function &F, LoopInfo &LI);
+
+}
+
+#endif
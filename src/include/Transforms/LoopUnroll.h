@@ -0,0 +1,22 @@
+#ifndef TRANSFORMS_LOOPUNROLL_H
+#define TRANSFORMS_LOOPUNROLL_H
+
+namespace sysy {
+
+class Function;
+class LoopInfo;
+
+/// Unroll innermost loops whose exit test ScalarEvolution understands.
+///
+/// A loop with a small constant trip count is unrolled completely. Other
+/// small loops counting towards an invariant bound are unrolled by
+/// UnrollCount: the unrolled loop only tests, once per round, whether
+/// UnrollCount more trips are left, and a copy of the original loop runs
+/// the remaining ones. Expects simplified loops in LCSSA form. The CFG
+/// changes, so the dominator tree and \p LI must be recomputed afterwards.
+/// Returns true if anything changed.
+bool runLoopUnroll(Function &F, LoopInfo &LI);
+
+}
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef TRANSFORMS_LOOPUTILS_H
+#define TRANSFORMS_LOOPUTILS_H
+
+#include <string>
+#include <vector>
+
+namespace sysy {
+
+class BasicBlock;
+class DominatorTree;
+class Function;
+class Loop;
+class LoopInfo;
+
+/// Route the edges from \p Preds to \p BB through a new block placed
+/// before \p BB and named after it with \p Suffix. Phis in \p BB get a
+/// single entry for the new block, merged there by a new phi if needed.
+BasicBlock *splitBlockPredecessors(BasicBlock *BB, const std::vector<BasicBlock *> &Preds,
+                                   const std::string &Suffix);
+
+/// Give \p L a preheader and dedicated exit blocks, recording the new
+/// blocks in \p LI. The dominator tree is not updated. Returns true if the
+/// CFG changed.
+bool simplifyLoop(Loop *L, LoopInfo &LI);
+
+/// Put \p L into loop-closed SSA form: a value defined in the loop is only
+/// used outside through a phi in an exit block. Uses that no single exit
+/// dominates are left alone. Returns true if phis were added.
+bool formLCSSA(Loop &L, const DominatorTree &DT);
+bool isLCSSAForm(const Loop &L);
+
+/// Run simplifyLoop and then formLCSSA on every loop of \p F, outermost
+/// last. \p DT and \p LI are recomputed if the CFG changed.
+bool simplifyLoops(Function &F, DominatorTree &DT, LoopInfo &LI);
+
+}
+
+#endif
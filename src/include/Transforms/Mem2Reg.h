@@ -0,0 +1,22 @@
+#ifndef TRANSFORMS_MEM2REG_H
+#define TRANSFORMS_MEM2REG_H
+
+namespace sysy {
+
+class AllocaInst;
+class DominatorTree;
+class Function;
+
+/// True if \p AI is only loaded from and stored to, so its value can be
+/// carried in SSA registers instead.
+bool isAllocaPromotable(const AllocaInst *AI);
+
+/// Promote every promotable alloca of \p F to SSA values, inserting phis at
+/// the iterated dominance frontier of its stores (pruned to the blocks where
+/// the variable is live). The CFG is not changed, so \p DT stays valid.
+/// Returns true if anything changed.
+bool promoteMemoryToRegister(Function &F, DominatorTree &DT);
+
+}
+
+#endif
@@ -0,0 +1,117 @@
+#ifndef TRANSFORMS_PASSMANAGER_H
+#define TRANSFORMS_PASSMANAGER_H
+
+#include "Analysis/Dominators.h"
+#include "Analysis/LoopInfo.h"
+#include "Basic/Timer.h"
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sysy {
+
+class Module;
+class ThreadPool;
+
+/// Which analyses are still valid after a pass ran; anything but All means
+/// the function changed. A pass that keeps an analysis up to date itself
+/// (simplifyLoops) reports it as preserved.
+enum class PreservedAnalyses : unsigned char {
+  None, // The CFG changed
+  CFG,  // Only instructions changed; dominators and loops still hold
+  All,
+};
+
+/// Time spent computing analyses, kept apart from the passes asking for
+/// them so that -ftime-report shows what recomputation costs.
+struct AnalysisTimes {
+  TimeRecord DomTree, Loops;
+  unsigned NumDomTrees = 0, NumLoopInfos = 0;
+};
+
+/// Computes the analyses of one function on first request and keeps them
+/// until a pass reports that it invalidated them.
+class FunctionAnalysisManager {
+  Function &F;
+  std::unique_ptr<DominatorTree> DT;
+  std::unique_ptr<LoopInfo> LI;
+  AnalysisTimes *Times; // Null unless timing
+
+public:
+  explicit FunctionAnalysisManager(Function &F, AnalysisTimes *Times = nullptr)
+      : F(F), Times(Times) {}
+
+  DominatorTree &getDomTree();
+  LoopInfo &getLoopInfo();
+  void invalidate(PreservedAnalyses PA);
+};
+
+class FunctionPass {
+public:
+  virtual ~FunctionPass() = default;
+  virtual const char *getName() const = 0;
+  virtual PreservedAnalyses run(Function &F, FunctionAnalysisManager &AM) = 0;
+};
+
+/// A pass over the whole module, e.g. one that changes several functions.
+/// Every cached analysis is dropped after it ran.
+class ModulePass {
+public:
+  virtual ~ModulePass() = default;
+  virtual const char *getName() const = 0;
+  virtual bool run(Module &M) = 0;
+};
+
+enum class OptLevel : unsigned char { O0, O1, O2 };
+
+/// Runs a sequence of passes over a module.
+///
+/// Consecutive function passes form a group that runs to completion on one
+/// function before the next function starts, so a function's analyses stay
+/// cached across the group and its IR stays in cache. Declarations are
+/// skipped. With a ThreadPool, the functions of a group run in parallel;
+/// module passes always run alone. With a TimerGroup, each pass and
+/// analysis gets a row summed over all functions (so with several threads,
+/// the rows may add up to more than the time that passed).
+class PassManager {
+  struct FunctionStep {
+    std::unique_ptr<FunctionPass> P;
+    bool OnlyAfterChange;
+  };
+  struct Step {
+    std::unique_ptr<ModulePass> MP;
+    std::vector<FunctionStep> FPs; // Used if MP is null
+  };
+  std::vector<Step> Steps;
+
+  void runFunctionPasses(const Step &S, Module &M, TimerGroup *Timers, ThreadPool *Pool);
+
+public:
+  /// With \p OnlyAfterChange, \p P only runs on the functions that the
+  /// last pass added without the flag changed: a cleanup that has nothing
+  /// to do otherwise.
+  void addPass(std::unique_ptr<FunctionPass> P, bool OnlyAfterChange = false);
+  void addPass(std::unique_ptr<ModulePass> P);
+  bool empty() const { return Steps.empty(); }
+
+  void run(Module &M, TimerGroup *Timers = nullptr, ThreadPool *Pool = nullptr);
+};
+
+/// The standard pipelines:
+///  -O0: nothing, for the fastest compile.
+///  -O1: mem2reg and the cheap scalar cleanups (SCCP, GVN, SimplifyCFG).
+///  -O2: -O1 plus inlining and the loop passes (LICM, induction variable
+///       simplification, unrolling).
+void buildPipeline(PassManager &PM, OptLevel Level);
+
+/// Adds the passes named in the comma-separated \p Names, in that order,
+/// for -passes: mem2reg, inline, sccp, simplifycfg, gvn, loop-simplify,
+/// licm, indvars and loop-unroll. Nothing is added implicitly, so loop
+/// passes need loop-simplify before them. Returns false, with the name in
+/// \p Unknown, if a name is not one of these.
+bool buildPipeline(PassManager &PM, std::string_view Names, std::string &Unknown);
+
+}
+
+#endif
@@ -0,0 +1,20 @@
+#ifndef TRANSFORMS_SCCP_H
+#define TRANSFORMS_SCCP_H
+
+namespace sysy {
+
+class Function;
+
+/// Sparse conditional constant propagation (Wegman & Zadeck).
+///
+/// Values and CFG edges start out unknown and are only lowered once they
+/// are reached, so constants flowing around loops and through branches that
+/// are never taken are found. Values proven constant are replaced, branches
+/// on constants become unconditional and the blocks no edge reaches are
+/// deleted. Folding follows C semantics (see Analysis/ConstantFolding.h).
+/// Returns true if anything changed.
+bool runSCCP(Function &F);
+
+}
+
+#endif
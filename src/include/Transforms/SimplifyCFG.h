@@ -0,0 +1,24 @@
+#ifndef TRANSFORMS_SIMPLIFYCFG_H
+#define TRANSFORMS_SIMPLIFYCFG_H
+
+namespace sysy {
+
+class Function;
+
+/// Clean up the CFG, until nothing changes:
+///  - delete unreachable blocks,
+///  - turn branches on a constant, or with both edges to one block, into
+///    jumps,
+///  - replace phis whose entries all agree by that value,
+///  - merge a block into its predecessor when it is that block's only
+///    successor,
+///  - let the predecessors of a block holding just a jump go straight to
+///    its target,
+/// and finally delete the instructions no side effect depends on. Loops may lose their preheader or single latch, so
+/// simplifyLoops must be run again before loop passes. Returns true if
+/// anything changed.
+bool runSimplifyCFG(Function &F);
+
+}
+
+#endif
@@ -1,9 +1,11 @@
 #include "AST/ASTNode.h"
 #include "AST/ASTVisitor.h"
+#include <string>
 using namespace sysy;
 
 void NumberAST::accept(ASTVisitor &v) { v.visit(*this); }
 void LValAST::accept(ASTVisitor &v) { v.visit(*this); }
+void CallExprAST::accept(ASTVisitor &v) { v.visit(*this); }
 void BinaryExprAST::accept(ASTVisitor &v) { v.visit(*this); }
 void UnaryExprAST::accept(ASTVisitor &v) { v.visit(*this); }
 void ReturnStmtAST::accept(ASTVisitor &v) { v.visit(*this); }
@@ -13,6 +15,7 @@ void WhileStmtAST::accept(ASTVisitor &v) { v.visit(*this); }
 void ExprStmtAST::accept(ASTVisitor &v) { v.visit(*this); }
 void BlockAST::accept(ASTVisitor &v) { v.visit(*this); }
 void VarDeclAST::accept(ASTVisitor &v) { v.visit(*this); }
+void FuncFParamAST::accept(ASTVisitor &v) { v.visit(*this); }
 void FuncDefAST::accept(ASTVisitor &v) { v.visit(*this); }
 void CompUnitAST::accept(ASTVisitor &v) { v.visit(*this); }
 
@@ -22,25 +25,30 @@ void NumberAST::dump(int indent) const {
 }
 
 void LValAST::dump(int indent) const {
-    std::cout << std::string(indent, ' ') << "LValAST: " << Name << std::endl;
+    std::cout << std::string(indent, ' ') << "LValAST: " << Name.getName() << std::endl;
+}
+
+void CallExprAST::dump(int indent) const {
+    std::cout << std::string(indent, ' ') << "CallExprAST: " << Callee.getName() << std::endl;
+    for (auto *arg : Args) arg->dump(indent + 2);
 }
 
 void BinaryExprAST::dump(int indent) const {
     std::string space(indent, ' ');
-    std::cout << space << "BinaryExprAST: " << Op << std::endl;
+    std::cout << space << "BinaryExprAST: " << getOpSpelling(Op) << std::endl;
     if (LHS) LHS->dump(indent + 2);
     if (RHS) RHS->dump(indent + 2);
 }
 
 void UnaryExprAST::dump(int indent) const {
     std::string space(indent, ' ');
-    std::cout << space << "UnaryExprAST: " << Op << std::endl;
+    std::cout << space << "UnaryExprAST: " << getOpSpelling(Op) << std::endl;
     if (Operand) Operand->dump(indent + 2);
 }
 
 void VarDeclAST::dump(int indent) const {
     std::string space(indent, ' ');
-    std::cout << space << "VarDeclAST: " << Type << " " << Name;
+    std::cout << space << "VarDeclAST: " << tok::getKeywordSpelling(Type) << " " << Name.getName();
     if (InitExpr) {
         std::cout << " =" << std::endl;
         InitExpr->dump(indent + 2);
@@ -65,7 +73,7 @@ void IfStmtAST::dump(int indent) const {
     std::cout << std::string(indent+2, ' ') << "Cond:" << std::endl;
     Cond->dump(indent + 4);
     std::cout << std::string(indent+2, ' ') << "Then:" << std::endl;
-    Then->dump(indent + 4);
+    if (Then) Then->dump(indent + 4);
     if (Else) {
         std::cout << std::string(indent+2, ' ') << "Else:" << std::endl;
         Else->dump(indent + 4);
@@ -75,7 +83,7 @@ void IfStmtAST::dump(int indent) const {
 void WhileStmtAST::dump(int indent) const {
     std::cout << std::string(indent, ' ') << "WhileStmtAST" << std::endl;
     Cond->dump(indent + 2);
-    Body->dump(indent + 2);
+    if (Body) Body->dump(indent + 2);
 }
 
 void ExprStmtAST::dump(int indent) const {
@@ -88,11 +96,16 @@ void BlockAST::dump(int indent) const {
     for (auto &item : Items) item->dump(indent + 2);
 }
 
+void FuncFParamAST::dump(int indent) const {
+    std::cout << std::string(indent, ' ') << "FuncFParamAST: " << tok::getKeywordSpelling(Type)
+              << " " << Name.getName() << std::endl;
+}
+
 void FuncDefAST::dump(int indent) const {
     std::string space(indent, ' ');
-    std::cout << space << "FuncDefAST: " << Name 
-              << " [" << RetType << "]" << std::endl;
-    // if (Params) Params->dump(indent + 2);
+    std::cout << space << "FuncDefAST: " << Name.getName()
+              << " [" << tok::getKeywordSpelling(RetType) << "]" << std::endl;
+    for (auto *param : Params) param->dump(indent + 2);
     if (Body) Body->dump(indent + 2);
 }
 
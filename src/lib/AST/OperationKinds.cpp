@@ -0,0 +1,19 @@
+#include "AST/OperationKinds.h"
+
+using namespace sysy;
+
+const char *sysy::getOpSpelling(BinaryOpKind Op) {
+    switch (Op) {
+#define BINARY_OPERATION(Name, Tok) case BinaryOpKind::Name: return tok::getPunctuatorSpelling(tok::Tok);
+#include "AST/OperationKinds.def"
+        default: return "<invalid>";
+    }
+}
+
+const char *sysy::getOpSpelling(UnaryOpKind Op) {
+    switch (Op) {
+#define UNARY_OPERATION(Name, Tok) case UnaryOpKind::Name: return tok::getPunctuatorSpelling(tok::Tok);
+#include "AST/OperationKinds.def"
+        default: return "<invalid>";
+    }
+}
@@ -0,0 +1,89 @@
+#include "Analysis/CallGraph.h"
+#include "IR/Module.h"
+#include <algorithm>
+#include <unordered_set>
+
+using namespace sysy;
+
+CallGraph::CallGraph(Module &M) {
+    std::vector<Function *> Functions;
+    for (const auto &F : M) {
+        Functions.push_back(F.get());
+        Nodes[F.get()];
+    }
+    std::unordered_set<const Function *> Seen; // Callees of F so far
+    for (Function *F : Functions) {
+        Node &N = Nodes[F];
+        Seen.clear();
+        for (BasicBlock &BB : *F) {
+            for (Instruction &I : BB) {
+                auto *Call = dyn_cast<CallInst>(&I);
+                if (!Call) continue;
+                Function *Callee = Call->getCallee();
+                Nodes[Callee].CallSites.push_back(Call);
+                if (Callee == F) N.CallsItself = true;
+                if (Seen.insert(Callee).second) N.Callees.push_back(Callee);
+            }
+        }
+    }
+    computeSCCs(Functions);
+}
+
+// Tarjan's algorithm with an explicit stack of (function, next callee)
+// frames. An SCC is complete when its root is popped, after everything it
+// reaches, so the SCCs come out in bottom-up order.
+void CallGraph::computeSCCs(const std::vector<Function *> &Functions) {
+    std::unordered_map<const Function *, unsigned> Index, LowLink;
+    std::vector<Function *> Stack;
+    std::unordered_map<const Function *, bool> OnStack;
+    std::vector<std::pair<Function *, unsigned>> Frames;
+    unsigned NextIndex = 0;
+
+    for (Function *Root : Functions) {
+        if (Index.count(Root)) continue;
+        Frames.push_back({Root, 0});
+        Index[Root] = LowLink[Root] = NextIndex++;
+        Stack.push_back(Root);
+        OnStack[Root] = true;
+
+        while (!Frames.empty()) {
+            Function *F = Frames.back().first;
+            unsigned &Next = Frames.back().second;
+            const std::vector<Function *> &Callees = Nodes[F].Callees;
+            if (Next < Callees.size()) {
+                Function *Callee = Callees[Next++];
+                if (!Index.count(Callee)) {
+                    Index[Callee] = LowLink[Callee] = NextIndex++;
+                    Stack.push_back(Callee);
+                    OnStack[Callee] = true;
+                    Frames.push_back({Callee, 0});
+                } else if (OnStack[Callee]) {
+                    LowLink[F] = std::min(LowLink[F], Index[Callee]);
+                }
+                continue;
+            }
+
+            Frames.pop_back();
+            if (!Frames.empty()) {
+                Function *Parent = Frames.back().first;
+                LowLink[Parent] = std::min(LowLink[Parent], LowLink[F]);
+            }
+            if (LowLink[F] != Index[F]) continue;
+            unsigned SCCNo = static_cast<unsigned>(SCCs.size());
+            SCCs.emplace_back();
+            Function *Member;
+            do {
+                Member = Stack.back();
+                Stack.pop_back();
+                OnStack[Member] = false;
+                Nodes[Member].SCC = SCCNo;
+                SCCs.back().push_back(Member);
+            } while (Member != F);
+        }
+    }
+}
+
+bool CallGraph::isRecursive(const Function *F) const {
+    const Node &N = Nodes.at(F);
+    return N.CallsItself || SCCs[N.SCC].size() > 1;
+}
@@ -0,0 +1,109 @@
+#include "Analysis/ConstantFolding.h"
+#include "IR/Function.h"
+#include <cmath>
+#include <cstdint>
+
+using namespace sysy;
+
+namespace {
+
+bool getInt(Value *V, int32_t &Out) {
+    auto *C = dyn_cast<ConstantInt>(V);
+    if (!C) return false;
+    Out = C->getValue();
+    return true;
+}
+
+bool getFloat(Value *V, float &Out) {
+    auto *C = dyn_cast<ConstantFloat>(V);
+    if (!C) return false;
+    Out = C->getValue();
+    return true;
+}
+
+template <typename T> bool compare(CmpInst::Predicate P, T A, T B) {
+    switch (P) {
+        case CmpInst::EQ: return A == B;
+        case CmpInst::NE: return A != B; // True if either float is NaN
+        case CmpInst::LT: return A < B;
+        case CmpInst::LE: return A <= B;
+        case CmpInst::GT: return A > B;
+        case CmpInst::GE: return A >= B;
+    }
+    return false;
+}
+
+} // namespace
+
+Value *sysy::constantFoldBinaryOp(Opcode Op, Value *LHS, Value *RHS, Function &F) {
+    int32_t A, B;
+    if (getInt(LHS, A) && getInt(RHS, B)) {
+        // Wrap through unsigned arithmetic, signed overflow is undefined in C++.
+        uint32_t UA = static_cast<uint32_t>(A), UB = static_cast<uint32_t>(B);
+        switch (Op) {
+            case Opcode::Add: return F.getInt32(static_cast<int32_t>(UA + UB));
+            case Opcode::Sub: return F.getInt32(static_cast<int32_t>(UA - UB));
+            case Opcode::Mul: return F.getInt32(static_cast<int32_t>(UA * UB));
+            case Opcode::SDiv:
+                if (B == 0 || (A == INT32_MIN && B == -1)) return nullptr;
+                return F.getInt32(A / B);
+            case Opcode::SRem:
+                if (B == 0 || (A == INT32_MIN && B == -1)) return nullptr;
+                return F.getInt32(A % B);
+            default: return nullptr;
+        }
+    }
+    float X, Y;
+    if (getFloat(LHS, X) && getFloat(RHS, Y)) {
+        switch (Op) {
+            case Opcode::FAdd: return F.getFloat(X + Y);
+            case Opcode::FSub: return F.getFloat(X - Y);
+            case Opcode::FMul: return F.getFloat(X * Y);
+            case Opcode::FDiv: return F.getFloat(X / Y); // IEEE: inf or NaN
+            default: return nullptr;
+        }
+    }
+    return nullptr;
+}
+
+Value *sysy::constantFoldCompare(Opcode Op, CmpInst::Predicate P, Value *LHS, Value *RHS, Function &F) {
+    if (Op == Opcode::ICmp) {
+        int32_t A, B;
+        if (getInt(LHS, A) && getInt(RHS, B)) return F.getBool(compare(P, A, B));
+        return nullptr;
+    }
+    float X, Y;
+    if (getFloat(LHS, X) && getFloat(RHS, Y)) return F.getBool(compare(P, X, Y));
+    return nullptr;
+}
+
+Value *sysy::constantFoldCast(Opcode Op, Value *V, Type DestTy, Function &F) {
+    int32_t A;
+    float X;
+    switch (Op) {
+        case Opcode::ZExt:
+            if (!getInt(V, A)) return nullptr;
+            return F.getInt32(A & 1);
+        case Opcode::SIToFP:
+            if (!getInt(V, A)) return nullptr;
+            return F.getFloat(static_cast<float>(A));
+        case Opcode::FPToSI:
+            if (!getFloat(V, X) || std::isnan(X) || X >= 2147483648.0f || X < -2147483648.0f) return nullptr;
+            return F.getInt32(static_cast<int32_t>(X));
+        default:
+            (void)DestTy;
+            return nullptr;
+    }
+}
+
+Value *sysy::constantFoldInstruction(const Instruction *I, ArrayRef<Value *> Ops, Function &F) {
+    if (I->isBinaryOp()) return constantFoldBinaryOp(I->getOpcode(), Ops[0], Ops[1], F);
+    if (auto *Cmp = dyn_cast<CmpInst>(I))
+        return constantFoldCompare(I->getOpcode(), Cmp->getPredicate(), Ops[0], Ops[1], F);
+    if (isa<CastInst>(I)) return constantFoldCast(I->getOpcode(), Ops[0], I->getType(), F);
+    if (isa<FNegInst>(I)) {
+        float X;
+        return getFloat(Ops[0], X) ? F.getFloat(-X) : nullptr;
+    }
+    return nullptr;
+}
@@ -0,0 +1,169 @@
+#include "Analysis/Dominators.h"
+#include <iostream>
+
+using namespace sysy;
+
+namespace {
+
+// Post-order of the blocks reachable from the entry, without recursion
+// (nesting in real programs can be deeper than the stack allows).
+std::vector<BasicBlock *> computePostOrder(const Function &F) {
+    std::vector<BasicBlock *> PostOrder;
+    std::unordered_map<const BasicBlock *, bool> Visited;
+    std::vector<std::pair<BasicBlock *, unsigned>> Stack; // Block, next successor
+    Stack.push_back({F.getEntryBlock(), 0});
+    Visited[F.getEntryBlock()] = true;
+    while (!Stack.empty()) {
+        auto &[BB, Next] = Stack.back();
+        if (Next < BB->getNumSuccessors()) {
+            BasicBlock *Succ = BB->getSuccessor(Next++);
+            if (!Visited[Succ]) {
+                Visited[Succ] = true;
+                Stack.push_back({Succ, 0});
+            }
+            continue;
+        }
+        PostOrder.push_back(BB);
+        Stack.pop_back();
+    }
+    return PostOrder;
+}
+
+} // namespace
+
+void DominatorTree::recalculate(const Function &F) {
+    Nodes.clear();
+    NodeMap.clear();
+    if (F.empty()) return;
+
+    std::vector<BasicBlock *> PostOrder = computePostOrder(F);
+    unsigned N = static_cast<unsigned>(PostOrder.size());
+    Nodes.reserve(N);
+    for (unsigned i = 0; i < N; ++i) {
+        Nodes.emplace_back(PostOrder[N - 1 - i], i);
+        NodeMap[Nodes.back().getBlock()] = &Nodes.back();
+    }
+
+    // Predecessors as RPO indices; edges from unreachable blocks do not count.
+    std::vector<std::vector<unsigned>> Preds(N);
+    for (unsigned i = 0; i < N; ++i) {
+        for (BasicBlock *P : Nodes[i].getBlock()->getPredecessors()) {
+            if (DomTreeNode *PN = getNode(P)) Preds[i].push_back(PN->getIndex());
+        }
+    }
+
+    // Cooper/Harvey/Kennedy. IDom[i] is an RPO index, Undefined until the
+    // block has been reached by the iteration.
+    constexpr unsigned Undefined = ~0u;
+    std::vector<unsigned> IDom(N, Undefined);
+    IDom[0] = 0;
+    auto Intersect = [&](unsigned A, unsigned B) {
+        while (A != B) {
+            while (A > B) A = IDom[A];
+            while (B > A) B = IDom[B];
+        }
+        return A;
+    };
+    for (bool Changed = true; Changed;) {
+        Changed = false;
+        for (unsigned i = 1; i < N; ++i) {
+            unsigned NewIDom = Undefined;
+            for (unsigned P : Preds[i]) {
+                if (IDom[P] == Undefined) continue;
+                NewIDom = NewIDom == Undefined ? P : Intersect(P, NewIDom);
+            }
+            if (NewIDom != IDom[i]) {
+                IDom[i] = NewIDom;
+                Changed = true;
+            }
+        }
+    }
+
+    for (unsigned i = 1; i < N; ++i) {
+        Nodes[i].IDom = &Nodes[IDom[i]];
+        Nodes[IDom[i]].Children.push_back(&Nodes[i]);
+        Nodes[i].Level = Nodes[IDom[i]].Level + 1; // The IDom comes first in RPO
+    }
+
+    // DFS intervals for O(1) dominance queries.
+    unsigned Clock = 0;
+    std::vector<std::pair<DomTreeNode *, size_t>> Stack{{&Nodes[0], 0}};
+    Nodes[0].DFSIn = Clock++;
+    while (!Stack.empty()) {
+        auto &[Node, Next] = Stack.back();
+        if (Next < Node->Children.size()) {
+            DomTreeNode *Child = Node->Children[Next++];
+            Child->DFSIn = Clock++;
+            Stack.push_back({Child, 0});
+            continue;
+        }
+        Node->DFSOut = Clock++;
+        Stack.pop_back();
+    }
+}
+
+bool DominatorTree::dominates(const BasicBlock *A, const BasicBlock *B) const {
+    DomTreeNode *NB = getNode(B);
+    if (!NB) return true;
+    DomTreeNode *NA = getNode(A);
+    return NA && NA->dominates(NB);
+}
+
+bool DominatorTree::dominates(const Instruction *Def, const Instruction *User) const {
+    const BasicBlock *DefBB = Def->getParent(), *UseBB = User->getParent();
+    if (DefBB != UseBB) return dominates(DefBB, UseBB);
+    if (Def == User) return false;
+    // Phis all execute "at once" on block entry.
+    if (isa<PhiInst>(User) && isa<PhiInst>(Def)) return true;
+    for (const Instruction *I = Def->getNextNode(); I; I = I->getNextNode()) {
+        if (I == User) return true;
+    }
+    return false;
+}
+
+bool DominatorTree::dominates(const Value *Def, const Use &U) const {
+    auto *DefI = dyn_cast<Instruction>(Def);
+    if (!DefI) return true; // Constants are available everywhere
+    Instruction *User = U.getUser();
+    if (auto *Phi = dyn_cast<PhiInst>(User)) {
+        BasicBlock *Incoming = Phi->getIncomingBlock(U.getOperandNo() / 2);
+        return dominates(DefI->getParent(), Incoming);
+    }
+    return dominates(DefI, User);
+}
+
+BasicBlock *DominatorTree::findNearestCommonDominator(BasicBlock *A, BasicBlock *B) const {
+    DomTreeNode *NA = getNode(A), *NB = getNode(B);
+    if (!NA) return B;
+    if (!NB) return A;
+    while (NA != NB) {
+        if (NA->getLevel() < NB->getLevel()) std::swap(NA, NB);
+        NA = NA->getIDom();
+    }
+    return NA->getBlock();
+}
+
+void DominatorTree::print(std::ostream &OS) const {
+    for (const DomTreeNode &N : Nodes) {
+        OS << std::string(2 * N.getLevel(), ' ') << "[" << N.getLevel() << "] "
+           << N.getBlock()->getName() << " (rpo " << N.getIndex() << ")\n";
+    }
+}
+
+DominanceFrontier::DominanceFrontier(const DominatorTree &DT) : Frontiers(DT.getNumBlocks()) {
+    // For each join point, walk up from every predecessor to the join's
+    // immediate dominator; the join is in the frontier of every block passed.
+    for (unsigned i = 0, e = DT.getNumBlocks(); i != e; ++i) {
+        BasicBlock *BB = DT.getBlock(i);
+        std::vector<BasicBlock *> Preds = BB->getPredecessors();
+        if (Preds.size() < 2) continue;
+        DomTreeNode *IDom = DT.getNode(BB)->getIDom();
+        for (BasicBlock *P : Preds) {
+            for (DomTreeNode *Runner = DT.getNode(P); Runner && Runner != IDom;
+                 Runner = Runner->getIDom()) {
+                auto &DF = Frontiers[Runner->getIndex()];
+                if (DF.empty() || DF.back() != i) DF.push_back(i);
+            }
+        }
+    }
+}
@@ -0,0 +1,202 @@
+#include "Analysis/LoopInfo.h"
+#include "Analysis/Dominators.h"
+#include <algorithm>
+#include <iostream>
+
+using namespace sysy;
+
+unsigned Loop::getLoopDepth() const {
+    unsigned Depth = 1;
+    for (Loop *P = ParentLoop; P; P = P->ParentLoop) ++Depth;
+    return Depth;
+}
+
+bool Loop::contains(const Loop *L) const {
+    for (; L; L = L->ParentLoop) {
+        if (L == this) return true;
+    }
+    return false;
+}
+
+bool Loop::isLoopInvariant(const Value *V) const {
+    auto *I = dyn_cast<Instruction>(V);
+    return !I || !contains(I);
+}
+
+BasicBlock *Loop::getLoopPredecessor() const {
+    BasicBlock *Out = nullptr;
+    for (BasicBlock *P : Header->getPredecessors()) {
+        if (contains(P)) continue;
+        if (Out) return nullptr;
+        Out = P;
+    }
+    return Out;
+}
+
+BasicBlock *Loop::getLoopPreheader() const {
+    BasicBlock *Out = getLoopPredecessor();
+    return Out && Out->getNumSuccessors() == 1 ? Out : nullptr;
+}
+
+std::vector<BasicBlock *> Loop::getLoopLatches() const {
+    std::vector<BasicBlock *> Latches;
+    for (BasicBlock *P : Header->getPredecessors()) {
+        if (contains(P)) Latches.push_back(P);
+    }
+    return Latches;
+}
+
+BasicBlock *Loop::getLoopLatch() const {
+    std::vector<BasicBlock *> Latches = getLoopLatches();
+    return Latches.size() == 1 ? Latches[0] : nullptr;
+}
+
+std::vector<BasicBlock *> Loop::getExitingBlocks() const {
+    std::vector<BasicBlock *> Exiting;
+    for (BasicBlock *BB : Blocks) {
+        for (unsigned i = 0, e = BB->getNumSuccessors(); i != e; ++i) {
+            if (!contains(BB->getSuccessor(i))) {
+                Exiting.push_back(BB);
+                break;
+            }
+        }
+    }
+    return Exiting;
+}
+
+std::vector<BasicBlock *> Loop::getExitBlocks() const {
+    std::vector<BasicBlock *> Exits;
+    for (BasicBlock *BB : Blocks) {
+        for (unsigned i = 0, e = BB->getNumSuccessors(); i != e; ++i) {
+            BasicBlock *Succ = BB->getSuccessor(i);
+            if (!contains(Succ) && std::find(Exits.begin(), Exits.end(), Succ) == Exits.end())
+                Exits.push_back(Succ);
+        }
+    }
+    return Exits;
+}
+
+BasicBlock *Loop::getExitBlock() const {
+    std::vector<BasicBlock *> Exits = getExitBlocks();
+    return Exits.size() == 1 ? Exits[0] : nullptr;
+}
+
+bool Loop::hasDedicatedExits() const {
+    for (BasicBlock *Exit : getExitBlocks()) {
+        for (BasicBlock *P : Exit->getPredecessors()) {
+            if (!contains(P)) return false;
+        }
+    }
+    return true;
+}
+
+void Loop::print(std::ostream &OS) const {
+    OS << std::string(2 * (getLoopDepth() - 1), ' ') << "Loop at depth " << getLoopDepth()
+       << " containing:";
+    for (BasicBlock *BB : Blocks) {
+        OS << " " << BB->getName();
+        if (BB == Header) OS << "<header>";
+    }
+    OS << "\n";
+    for (Loop *Sub : SubLoops) Sub->print(OS);
+}
+
+void LoopInfo::recalculate(const DominatorTree &DT) {
+    Loops.clear();
+    TopLevelLoops.clear();
+    BBMap.clear();
+
+    // The header of an inner loop comes after the header of every loop
+    // containing it in RPO, so walking the RPO backwards meets inner loops
+    // first.
+    std::vector<BasicBlock *> Worklist;
+    for (unsigned i = DT.getNumBlocks(); i-- > 0;) {
+        BasicBlock *Header = DT.getBlock(i);
+        for (BasicBlock *P : Header->getPredecessors()) {
+            if (DT.isReachable(P) && DT.dominates(Header, P)) Worklist.push_back(P);
+        }
+        if (Worklist.empty()) continue;
+
+        Loops.push_back(std::make_unique<Loop>(Header));
+        Loop *L = Loops.back().get();
+        BBMap[Header] = L;
+        while (!Worklist.empty()) {
+            BasicBlock *BB = Worklist.back();
+            Worklist.pop_back();
+            auto It = BBMap.find(BB);
+            if (It == BBMap.end()) {
+                BBMap[BB] = L;
+                for (BasicBlock *P : BB->getPredecessors()) {
+                    if (DT.isReachable(P)) Worklist.push_back(P);
+                }
+                continue;
+            }
+            // Part of a finished inner loop: nest its outermost loop in L
+            // and go on from that loop's header.
+            Loop *Sub = It->second;
+            while (Sub->ParentLoop) Sub = Sub->ParentLoop;
+            if (Sub == L) continue;
+            Sub->ParentLoop = L;
+            L->SubLoops.push_back(Sub);
+            for (BasicBlock *P : Sub->Header->getPredecessors()) {
+                if (DT.isReachable(P) && !Sub->contains(P)) Worklist.push_back(P);
+            }
+        }
+    }
+
+    // Fill in the block lists in RPO, which puts every header first.
+    for (unsigned i = 0, e = DT.getNumBlocks(); i != e; ++i) {
+        BasicBlock *BB = DT.getBlock(i);
+        for (Loop *L = getLoopFor(BB); L; L = L->ParentLoop) {
+            L->Blocks.push_back(BB);
+            L->BlockSet.insert(BB);
+        }
+    }
+    for (auto &L : Loops) {
+        if (!L->ParentLoop) TopLevelLoops.push_back(L.get());
+        std::reverse(L->SubLoops.begin(), L->SubLoops.end());
+    }
+    std::reverse(TopLevelLoops.begin(), TopLevelLoops.end());
+}
+
+std::vector<Loop *> LoopInfo::getLoopsInPostorder() const {
+    std::vector<Loop *> Order;
+    std::vector<std::pair<Loop *, unsigned>> Stack; // Loop, next subloop
+    for (Loop *Top : TopLevelLoops) {
+        Stack.push_back({Top, 0});
+        while (!Stack.empty()) {
+            auto &[L, Next] = Stack.back();
+            if (Next < L->getSubLoops().size()) {
+                Loop *Sub = L->getSubLoops()[Next++];
+                Stack.push_back({Sub, 0});
+                continue;
+            }
+            Order.push_back(L);
+            Stack.pop_back();
+        }
+    }
+    return Order;
+}
+
+void LoopInfo::addBlockToLoop(BasicBlock *BB, Loop *L) {
+    if (!L) return;
+    BBMap[BB] = L;
+    for (; L; L = L->ParentLoop) {
+        L->Blocks.push_back(BB);
+        L->BlockSet.insert(BB);
+    }
+}
+
+void LoopInfo::removeBlock(BasicBlock *BB) {
+    auto It = BBMap.find(BB);
+    if (It == BBMap.end()) return;
+    for (Loop *L = It->second; L; L = L->ParentLoop) {
+        L->Blocks.erase(std::find(L->Blocks.begin(), L->Blocks.end(), BB));
+        L->BlockSet.erase(BB);
+    }
+    BBMap.erase(It);
+}
+
+void LoopInfo::print(std::ostream &OS) const {
+    for (Loop *L : TopLevelLoops) L->print(OS);
+}
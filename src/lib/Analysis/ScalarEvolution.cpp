@@ -0,0 +1,310 @@
+#include "Analysis/ScalarEvolution.h"
+#include "Analysis/LoopInfo.h"
+#include <iostream>
+
+using namespace sysy;
+
+namespace {
+
+int32_t wrapAdd(int32_t A, int32_t B) {
+    return static_cast<int32_t>(static_cast<uint32_t>(A) + static_cast<uint32_t>(B));
+}
+
+int32_t wrapMul(int32_t A, int32_t B) {
+    return static_cast<int32_t>(static_cast<uint32_t>(A) * static_cast<uint32_t>(B));
+}
+
+} // namespace
+
+void SCEV::print(std::ostream &OS) const {
+    switch (K) {
+        case Constant: OS << cast<SCEVConstant>(this)->getValue(); return;
+        case Unknown: cast<SCEVUnknown>(this)->getValue()->printAsOperand(OS); return;
+        case Add:
+        case Mul: {
+            auto *B = cast<SCEVBinaryExpr>(this);
+            OS << "(";
+            B->getLHS()->print(OS);
+            OS << (K == Add ? " + " : " * ");
+            B->getRHS()->print(OS);
+            OS << ")";
+            return;
+        }
+        case AddRec: {
+            auto *AR = cast<SCEVAddRecExpr>(this);
+            OS << "{";
+            AR->getStart()->print(OS);
+            OS << ",+,";
+            AR->getStep()->print(OS);
+            OS << "}<" << AR->getLoop()->getHeader()->getName() << ">";
+            return;
+        }
+    }
+}
+
+bool ScalarEvolution::getConstantValue(const SCEV *S, int32_t &Out) {
+    auto *C = dyn_cast<SCEVConstant>(S);
+    if (!C) return false;
+    Out = C->getValue();
+    return true;
+}
+
+const SCEV *ScalarEvolution::getUnknown(Value *V) {
+    if (auto *C = dyn_cast<ConstantInt>(V)) {
+        if (C->getType() == Type::I32) return getConstant(C->getValue());
+    }
+    return create<SCEVUnknown>(V);
+}
+
+const SCEV *ScalarEvolution::getAddExpr(const SCEV *A, const SCEV *B) {
+    int32_t CA = 0, CB = 0;
+    bool AC = getConstantValue(A, CA), BC = getConstantValue(B, CB);
+    if (AC && BC) return getConstant(wrapAdd(CA, CB));
+    if (AC && CA == 0) return B;
+    if (BC && CB == 0) return A;
+    if (!isa<SCEVAddRecExpr>(A) && isa<SCEVAddRecExpr>(B)) std::swap(A, B);
+    if (auto *AR = dyn_cast<SCEVAddRecExpr>(A)) {
+        const Loop *L = AR->getLoop();
+        if (auto *BR = dyn_cast<SCEVAddRecExpr>(B)) {
+            if (BR->getLoop() == L)
+                return getAddRecExpr(getAddExpr(AR->getStart(), BR->getStart()),
+                                     getAddExpr(AR->getStep(), BR->getStep()), L);
+        } else if (isLoopInvariant(B, L)) {
+            return getAddRecExpr(getAddExpr(AR->getStart(), B), AR->getStep(), L);
+        }
+    }
+    return create<SCEVBinaryExpr>(SCEV::Add, A, B);
+}
+
+const SCEV *ScalarEvolution::getMulExpr(const SCEV *A, const SCEV *B) {
+    int32_t CA = 0, CB = 0;
+    bool AC = getConstantValue(A, CA), BC = getConstantValue(B, CB);
+    if (AC && BC) return getConstant(wrapMul(CA, CB));
+    if ((AC && CA == 0) || (BC && CB == 1)) return A;
+    if ((BC && CB == 0) || (AC && CA == 1)) return B;
+    if (!isa<SCEVAddRecExpr>(A) && isa<SCEVAddRecExpr>(B)) std::swap(A, B);
+    if (auto *AR = dyn_cast<SCEVAddRecExpr>(A)) {
+        // Only affine results: a recurrence times something invariant.
+        if (isLoopInvariant(B, AR->getLoop()))
+            return getAddRecExpr(getMulExpr(AR->getStart(), B), getMulExpr(AR->getStep(), B),
+                                 AR->getLoop());
+    }
+    return create<SCEVBinaryExpr>(SCEV::Mul, A, B);
+}
+
+const SCEV *ScalarEvolution::getMinusSCEV(const SCEV *A, const SCEV *B) {
+    return getAddExpr(A, getMulExpr(B, getConstant(-1)));
+}
+
+const SCEV *ScalarEvolution::getAddRecExpr(const SCEV *Start, const SCEV *Step, const Loop *L) {
+    return create<SCEVAddRecExpr>(Start, Step, L);
+}
+
+bool ScalarEvolution::isLoopInvariant(const SCEV *S, const Loop *L) const {
+    switch (S->getKind()) {
+        case SCEV::Constant: return true;
+        case SCEV::Unknown: return L->isLoopInvariant(cast<SCEVUnknown>(S)->getValue());
+        case SCEV::Add:
+        case SCEV::Mul: {
+            auto *B = cast<SCEVBinaryExpr>(S);
+            return isLoopInvariant(B->getLHS(), L) && isLoopInvariant(B->getRHS(), L);
+        }
+        case SCEV::AddRec: {
+            // A recurrence of an enclosing loop holds still while L runs.
+            auto *AR = cast<SCEVAddRecExpr>(S);
+            return !L->contains(AR->getLoop()) && isLoopInvariant(AR->getStart(), L) &&
+                   isLoopInvariant(AR->getStep(), L);
+        }
+    }
+    return false;
+}
+
+/// A header phi {Start,+,Step} whose value around the back edge is the phi
+/// plus (or minus) something invariant.
+const SCEV *ScalarEvolution::createPhiSCEV(PhiInst *Phi) {
+    Loop *L = LI.getLoopFor(Phi->getParent());
+    BasicBlock *Latch = L->getLoopLatch();
+    BasicBlock *Pred = L->getLoopPredecessor();
+    if (!Latch || !Pred || Phi->getNumIncomingValues() != 2) return getUnknown(Phi);
+
+    auto *Inc = dyn_cast<BinaryInst>(Phi->getIncomingValueForBlock(Latch));
+    if (!Inc || (Inc->getOpcode() != Opcode::Add && Inc->getOpcode() != Opcode::Sub)) return getUnknown(Phi);
+    Value *StepV;
+    if (Inc->getLHS() == Phi) StepV = Inc->getRHS();
+    else if (Inc->getRHS() == Phi && Inc->getOpcode() == Opcode::Add) StepV = Inc->getLHS();
+    else return getUnknown(Phi);
+    if (!L->isLoopInvariant(StepV)) return getUnknown(Phi);
+
+    const SCEV *Step = getSCEV(StepV);
+    if (Inc->getOpcode() == Opcode::Sub) Step = getMulExpr(Step, getConstant(-1));
+    return getAddRecExpr(getSCEV(Phi->getIncomingValueForBlock(Pred)), Step, L);
+}
+
+const SCEV *ScalarEvolution::createSCEV(Instruction *I) {
+    if (auto *Phi = dyn_cast<PhiInst>(I)) {
+        if (LI.isLoopHeader(Phi->getParent())) return createPhiSCEV(Phi);
+        return getUnknown(I);
+    }
+    const SCEV *LHS = getSCEV(I->getOperand(0));
+    const SCEV *RHS = getSCEV(I->getOperand(1));
+    const SCEV *S;
+    switch (I->getOpcode()) {
+        case Opcode::Add: S = getAddExpr(LHS, RHS); break;
+        case Opcode::Sub: S = getMinusSCEV(LHS, RHS); break;
+        default: S = getMulExpr(LHS, RHS); break;
+    }
+    // Only recurrences are worth remembering in symbolic form.
+    if (isa<SCEVAddRecExpr>(S) || isa<SCEVConstant>(S)) return S->getDepth() <= MaxDepth ? S : getUnknown(I);
+    return getUnknown(I);
+}
+
+/// Values outside every loop, and anything that is not i32 arithmetic or a
+/// phi, are unknowns. The rest is evaluated operands first with an explicit
+/// stack. While a header phi is being worked out it reads as unknown; if
+/// it turns out to be a recurrence, whatever was computed from that
+/// placeholder is forgotten and redone on demand.
+const SCEV *ScalarEvolution::getSCEV(Value *V) {
+    auto It = Cache.find(V);
+    if (It != Cache.end()) return It->second;
+
+    auto IsLeaf = [&](Value *X) {
+        auto *I = dyn_cast<Instruction>(X);
+        if (!I || I->getType() != Type::I32 || !LI.getLoopFor(I->getParent())) return true;
+        Opcode Op = I->getOpcode();
+        return Op != Opcode::Add && Op != Opcode::Sub && Op != Opcode::Mul && Op != Opcode::Phi;
+    };
+
+    struct Entry {
+        Value *V;
+        bool Expanded;
+        size_t LogStart; // Phis: Log size when the placeholder went in
+    };
+    std::vector<Entry> Stack{{V, false, 0}};
+    std::vector<const Value *> Log; // Cache entries made during this call
+    while (!Stack.empty()) {
+        Entry &E = Stack.back();
+        Value *X = E.V;
+        if (E.Expanded) {
+            size_t LogStart = E.LogStart;
+            Stack.pop_back();
+            const SCEV *S = createSCEV(cast<Instruction>(X));
+            if (isa<PhiInst>(X) && isa<SCEVAddRecExpr>(S)) {
+                for (size_t i = LogStart; i < Log.size(); ++i) Cache.erase(Log[i]);
+                Log.resize(LogStart);
+            }
+            Cache[X] = S;
+            Log.push_back(X);
+            continue;
+        }
+        if (Cache.count(X)) {
+            Stack.pop_back();
+            continue;
+        }
+        if (IsLeaf(X)) {
+            Cache[X] = getUnknown(X);
+            Log.push_back(X);
+            Stack.pop_back();
+            continue;
+        }
+        E.Expanded = true;
+        if (auto *Phi = dyn_cast<PhiInst>(X)) {
+            E.LogStart = Log.size();
+            Cache[Phi] = getUnknown(Phi);
+            for (unsigned i = 0, e = Phi->getNumIncomingValues(); i != e; ++i)
+                Stack.push_back({Phi->getIncomingValue(i), false, 0});
+        } else {
+            auto *I = cast<Instruction>(X);
+            Stack.push_back({I->getOperand(0), false, 0});
+            Stack.push_back({I->getOperand(1), false, 0});
+        }
+    }
+    return Cache[V];
+}
+
+bool ScalarEvolution::getLoopExitTest(const Loop *L, LoopExitTest &Test) {
+    BasicBlock *Header = L->getHeader();
+    if (!L->getLoopLatch() || !L->getLoopPredecessor()) return false;
+    std::vector<BasicBlock *> Exiting = L->getExitingBlocks();
+    if (Exiting.size() != 1 || Exiting[0] != Header) return false;
+
+    auto *Br = dyn_cast<BranchInst>(Header->getTerminator());
+    if (!Br || !Br->isConditional()) return false;
+    auto *Cmp = dyn_cast<CmpInst>(Br->getCondition());
+    if (!Cmp || Cmp->isFloat()) return false;
+
+    Value *LHS = Cmp->getLHS(), *RHS = Cmp->getRHS();
+    CmpInst::Predicate Pred = Cmp->getPredicate();
+    if (!L->isLoopInvariant(RHS)) {
+        std::swap(LHS, RHS);
+        Pred = CmpInst::getSwappedPredicate(Pred);
+    }
+    if (!L->isLoopInvariant(RHS)) return false;
+    auto *IV = dyn_cast<SCEVAddRecExpr>(getSCEV(LHS));
+    int32_t Step;
+    if (!IV || IV->getLoop() != L || !getConstantValue(IV->getStep(), Step) || Step == 0) return false;
+
+    Test.StaySuccessor = L->contains(Br->getSuccessor(0)) ? 0 : 1;
+    if (Test.StaySuccessor == 1) Pred = CmpInst::getInversePredicate(Pred);
+    Test.Branch = Br;
+    Test.Compare = Cmp;
+    Test.IVValue = LHS;
+    Test.IV = IV;
+    Test.Bound = RHS;
+    Test.Pred = Pred;
+    return true;
+}
+
+int64_t ScalarEvolution::getConstantTripCount(const Loop *L) {
+    LoopExitTest T;
+    if (!getLoopExitTest(L, T)) return -1;
+    int32_t Start32, Step32, Bound32;
+    if (!getConstantValue(T.IV->getStart(), Start32) || !getConstantValue(T.IV->getStep(), Step32) ||
+        !getConstantValue(getSCEV(T.Bound), Bound32))
+        return -1;
+    int64_t Start = Start32, Step = Step32, Bound = Bound32;
+
+    // Number of k >= 0 for which Start + k * Step satisfies the test,
+    // with the values walked through staying in range.
+    int64_t Count;
+    switch (T.Pred) {
+        case CmpInst::LT: Bound -= 1; [[fallthrough]];
+        case CmpInst::LE:
+            if (Step < 0) return Start > Bound ? 0 : -1;
+            Count = Start > Bound ? 0 : (Bound - Start) / Step + 1;
+            break;
+        case CmpInst::GT: Bound += 1; [[fallthrough]];
+        case CmpInst::GE:
+            if (Step > 0) return Start < Bound ? 0 : -1;
+            Count = Start < Bound ? 0 : (Start - Bound) / -Step + 1;
+            break;
+        case CmpInst::NE:
+            if ((Bound - Start) % Step != 0 || (Bound - Start) / Step < 0) return -1;
+            Count = (Bound - Start) / Step;
+            break;
+        case CmpInst::EQ: return Start == Bound ? 1 : 0;
+        default: return -1;
+    }
+    // The value that fails the test must be reached without wrapping.
+    int64_t Last = Start + Count * Step;
+    if (Last < INT32_MIN || Last > INT32_MAX) return -1;
+    return Count;
+}
+
+Value *ScalarEvolution::expand(const SCEV *S, Instruction *InsertPt) {
+    switch (S->getKind()) {
+        case SCEV::Constant: return F.getInt32(cast<SCEVConstant>(S)->getValue());
+        case SCEV::Unknown: return cast<SCEVUnknown>(S)->getValue();
+        case SCEV::Add:
+        case SCEV::Mul: {
+            auto *B = cast<SCEVBinaryExpr>(S);
+            Value *LHS = expand(B->getLHS(), InsertPt);
+            Value *RHS = expand(B->getRHS(), InsertPt);
+            auto *I = new BinaryInst(S->getKind() == SCEV::Add ? Opcode::Add : Opcode::Mul, LHS, RHS);
+            I->insertBefore(InsertPt);
+            return I;
+        }
+        case SCEV::AddRec: break;
+    }
+    assert(false && "cannot expand a recurrence outside its loop");
+    return nullptr;
+}
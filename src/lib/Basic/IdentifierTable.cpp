@@ -0,0 +1,57 @@
+#include "Basic/IdentifierTable.h"
+#include <cstring>
+
+using namespace sysy;
+
+namespace {
+
+// FNV-1a, good enough for short identifiers.
+uint32_t hashString(std::string_view S) {
+    uint32_t H = 2166136261u;
+    for (unsigned char c : S) {
+        H ^= c;
+        H *= 16777619u;
+    }
+    return H;
+}
+
+} // namespace
+
+Symbol IdentifierTable::get(std::string_view Name) {
+    uint32_t H = hashString(Name);
+    size_t Mask = Buckets.size() - 1;
+    for (size_t i = H & Mask;; i = (i + 1) & Mask) {
+        Bucket &B = Buckets[i];
+        if (!B.Info) break;
+        if (B.Hash == H && B.Info->Name == Name) return Symbol(B.Info);
+    }
+
+    // Keep the load factor under 3/4.
+    if ((Infos.size() + 1) * 4 > Buckets.size() * 3) grow();
+
+    char *Spelling = Storage.allocate<char>(Name.size());
+    std::memcpy(Spelling, Name.data(), Name.size());
+    auto *Info = Storage.allocate<IdentifierInfo>();
+    Info->Name = std::string_view(Spelling, Name.size());
+    Info->ID = static_cast<unsigned>(Infos.size());
+    Infos.push_back(Info);
+
+    Mask = Buckets.size() - 1;
+    size_t i = H & Mask;
+    while (Buckets[i].Info) i = (i + 1) & Mask;
+    Buckets[i].Hash = H;
+    Buckets[i].Info = Info;
+    return Symbol(Info);
+}
+
+void IdentifierTable::grow() {
+    std::vector<Bucket> Old(Buckets.size() * 2);
+    Old.swap(Buckets);
+    size_t Mask = Buckets.size() - 1;
+    for (const Bucket &B : Old) {
+        if (!B.Info) continue;
+        size_t i = B.Hash & Mask;
+        while (Buckets[i].Info) i = (i + 1) & Mask;
+        Buckets[i] = B;
+    }
+}
@@ -0,0 +1,96 @@
+#include "Basic/MemoryBuffer.h"
+#include <cerrno>
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#endif
+
+using namespace sysy;
+
+MemoryBuffer::~MemoryBuffer() {
+#ifndef _WIN32
+    if (IsMapped) ::munmap(const_cast<char *>(Start), Size);
+#endif
+}
+
+#ifndef _WIN32
+
+std::unique_ptr<MemoryBuffer> MemoryBuffer::getFile(const std::string &Path,
+                                                    std::string &ErrMsg) {
+    int fd = ::open(Path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        ErrMsg = std::strerror(errno);
+        return nullptr;
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ErrMsg = std::strerror(errno);
+        ::close(fd);
+        return nullptr;
+    }
+
+    std::unique_ptr<MemoryBuffer> MB(new MemoryBuffer());
+    MB->Size = static_cast<size_t>(st.st_size);
+
+    // The tail of the last page is zero-filled by the kernel, which gives us
+    // the trailing '\0' for free. If the file ends exactly on a page boundary
+    // there is no such byte, so fall back to a copy (same rule as LLVM).
+    static const long PageSize = ::sysconf(_SC_PAGESIZE);
+    if (MB->Size != 0 && MB->Size % PageSize != 0) {
+        void *Addr = ::mmap(nullptr, MB->Size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (Addr != MAP_FAILED) {
+#ifdef MADV_SEQUENTIAL
+            ::madvise(Addr, MB->Size, MADV_SEQUENTIAL);
+#endif
+            ::close(fd);
+            MB->Start = static_cast<const char *>(Addr);
+            MB->IsMapped = true;
+            return MB;
+        }
+    }
+
+    MB->Owned.reset(new char[MB->Size + 1]);
+    size_t Done = 0;
+    while (Done < MB->Size) {
+        ssize_t n = ::read(fd, MB->Owned.get() + Done, MB->Size - Done);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            ErrMsg = n < 0 ? std::strerror(errno) : "unexpected end of file";
+            ::close(fd);
+            return nullptr;
+        }
+        Done += static_cast<size_t>(n);
+    }
+    ::close(fd);
+    MB->Owned[MB->Size] = '\0';
+    MB->Start = MB->Owned.get();
+    return MB;
+}
+
+#else
+
+std::unique_ptr<MemoryBuffer> MemoryBuffer::getFile(const std::string &Path,
+                                                    std::string &ErrMsg) {
+    std::ifstream In(Path, std::ios::binary | std::ios::ate);
+    if (!In) {
+        ErrMsg = "cannot open file";
+        return nullptr;
+    }
+    std::unique_ptr<MemoryBuffer> MB(new MemoryBuffer());
+    MB->Size = static_cast<size_t>(In.tellg());
+    MB->Owned.reset(new char[MB->Size + 1]);
+    In.seekg(0);
+    In.read(MB->Owned.get(), MB->Size);
+    MB->Owned[MB->Size] = '\0';
+    MB->Start = MB->Owned.get();
+    return MB;
+}
+
+#endif
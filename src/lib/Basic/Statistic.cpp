@@ -0,0 +1,81 @@
+#include "Basic/Statistic.h"
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+using namespace sysy;
+
+namespace {
+
+std::vector<Statistic *> &getRegistry() {
+    static std::vector<Statistic *> Registry;
+    return Registry;
+}
+
+// Sorted by group then name, so the report is stable across link orders.
+std::vector<Statistic *> getSortedStatistics() {
+    std::vector<Statistic *> Stats = getRegistry();
+    std::sort(Stats.begin(), Stats.end(), [](Statistic *A, Statistic *B) {
+        int C = std::strcmp(A->getGroup(), B->getGroup());
+        return C != 0 ? C < 0 : std::strcmp(A->getName(), B->getName()) < 0;
+    });
+    return Stats;
+}
+
+} // namespace
+
+Statistic::Statistic(const char *group, const char *name, const char *desc)
+    : Group(group), Name(name), Desc(desc) {
+    getRegistry().push_back(this);
+}
+
+void Statistic::updateMax(uint64_t N) {
+    uint64_t Cur = Value.load(std::memory_order_relaxed);
+    while (N > Cur && !Value.compare_exchange_weak(Cur, N, std::memory_order_relaxed)) {
+    }
+}
+
+void sysy::printStatistics(std::ostream &OS) {
+    OS << "===" << std::string(73, '-') << "===\n"
+       << std::string(26, ' ') << "... Statistics Collected ...\n"
+       << "===" << std::string(73, '-') << "===\n\n";
+    for (Statistic *S : getSortedStatistics()) {
+        if (S->getValue() == 0) continue;
+        OS << std::setw(12) << S->getValue() << " " << std::left << std::setw(10)
+           << S->getGroup() << std::right << " - " << S->getDesc() << "\n";
+    }
+    OS << std::setw(12) << getPeakRSSKiB() << " " << std::left << std::setw(10)
+       << "process" << std::right << " - Peak resident set size (KiB)\n\n";
+}
+
+void sysy::printStatisticsJSON(std::ostream &OS) {
+    OS << "{";
+    bool First = true;
+    for (Statistic *S : getSortedStatistics()) {
+        if (S->getValue() == 0) continue;
+        OS << (First ? "" : ",") << "\n  \"" << S->getGroup() << "." << S->getName()
+           << "\": " << S->getValue();
+        First = false;
+    }
+    OS << (First ? "" : ",") << "\n  \"process.PeakRSSKiB\": " << getPeakRSSKiB() << "\n}";
+}
+
+uint64_t sysy::getPeakRSSKiB() {
+#ifndef _WIN32
+    struct rusage RU;
+    if (getrusage(RUSAGE_SELF, &RU) != 0) return 0;
+#ifdef __APPLE__
+    return static_cast<uint64_t>(RU.ru_maxrss) / 1024; // bytes on macOS
+#else
+    return static_cast<uint64_t>(RU.ru_maxrss);
+#endif
+#else
+    return 0;
+#endif
+}
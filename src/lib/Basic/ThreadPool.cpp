@@ -0,0 +1,95 @@
+#include "Basic/ThreadPool.h"
+#include <cassert>
+
+using namespace sysy;
+
+namespace {
+
+// The pool and deque of the worker running on this thread, if any.
+thread_local const ThreadPool *CurrentPool = nullptr;
+thread_local size_t CurrentQueue = 0;
+
+} // namespace
+
+ThreadPool::ThreadPool(unsigned NumThreads) {
+    if (NumThreads == 0) NumThreads = 1;
+    for (unsigned i = 0; i < NumThreads; ++i) Queues.push_back(std::make_unique<TaskQueue>());
+    // The last deque belongs to whoever calls wait().
+    for (unsigned i = 0; i + 1 < NumThreads; ++i)
+        Workers.emplace_back([this, i] { workerLoop(i); });
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> Guard(Lock);
+        ShuttingDown = true;
+    }
+    WorkAvailable.notify_all();
+    for (std::thread &T : Workers) T.join();
+}
+
+void ThreadPool::async(std::function<void()> Task) {
+    size_t Index = CurrentPool == this ? CurrentQueue
+                                       : NextQueue.fetch_add(1, std::memory_order_relaxed) % Queues.size();
+    ++Pending;
+    ++Queued;
+    {
+        TaskQueue &Q = *Queues[Index];
+        std::lock_guard<std::mutex> Guard(Q.Lock);
+        Q.Tasks.push_back(std::move(Task));
+    }
+    // Taking the lock orders this after a worker's check of Queued, so the
+    // worker cannot miss the wakeup and sleep with work queued.
+    { std::lock_guard<std::mutex> Guard(Lock); }
+    WorkAvailable.notify_one();
+}
+
+bool ThreadPool::runOneTask(size_t Self) {
+    std::function<void()> Task;
+    {
+        TaskQueue &Own = *Queues[Self];
+        std::lock_guard<std::mutex> Guard(Own.Lock);
+        if (!Own.Tasks.empty()) {
+            Task = std::move(Own.Tasks.back());
+            Own.Tasks.pop_back();
+        }
+    }
+    for (size_t i = 1; !Task && i < Queues.size(); ++i) {
+        TaskQueue &Victim = *Queues[(Self + i) % Queues.size()];
+        std::lock_guard<std::mutex> Guard(Victim.Lock);
+        if (!Victim.Tasks.empty()) {
+            Task = std::move(Victim.Tasks.front());
+            Victim.Tasks.pop_front();
+        }
+    }
+    if (!Task) return false;
+
+    --Queued;
+    Task();
+    if (--Pending == 0) {
+        { std::lock_guard<std::mutex> Guard(Lock); }
+        AllDone.notify_all();
+    }
+    return true;
+}
+
+void ThreadPool::workerLoop(size_t Index) {
+    CurrentPool = this;
+    CurrentQueue = Index;
+    while (true) {
+        if (runOneTask(Index)) continue;
+        std::unique_lock<std::mutex> Guard(Lock);
+        WorkAvailable.wait(Guard, [this] { return ShuttingDown || Queued > 0; });
+        if (ShuttingDown && Queued == 0) return;
+    }
+}
+
+void ThreadPool::wait() {
+    assert(CurrentPool != this && "waiting from inside a task");
+    size_t Self = Queues.size() - 1;
+    while (Pending > 0) {
+        if (runOneTask(Self)) continue;
+        std::unique_lock<std::mutex> Guard(Lock);
+        AllDone.wait(Guard, [this] { return Pending == 0 || Queued > 0; });
+    }
+}
@@ -0,0 +1,69 @@
+#include "Basic/Timer.h"
+#include <ctime>
+#include <iomanip>
+
+using namespace sysy;
+
+TimeRecord TimeRecord::now() {
+    TimeRecord R;
+    R.Wall = std::chrono::duration<double>(
+                 std::chrono::steady_clock::now().time_since_epoch()).count();
+    R.CPU = static_cast<double>(std::clock()) / CLOCKS_PER_SEC;
+    return R;
+}
+
+TimeRecord TimeRecord::nowForThread() {
+    TimeRecord R;
+    R.Wall = std::chrono::duration<double>(
+                 std::chrono::steady_clock::now().time_since_epoch()).count();
+    timespec TS;
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &TS) == 0)
+        R.CPU = static_cast<double>(TS.tv_sec) + static_cast<double>(TS.tv_nsec) / 1e9;
+    return R;
+}
+
+void TimerGroup::addTime(std::string_view Name, const TimeRecord &T, unsigned Runs) {
+    std::lock_guard<std::mutex> Guard(Lock);
+    for (Phase &P : Phases) {
+        if (P.Name == Name) {
+            P.Time += T;
+            P.Count += Runs;
+            return;
+        }
+    }
+    Phases.push_back({std::string(Name), T, Runs});
+}
+
+void TimerGroup::print(std::ostream &OS) const {
+    std::lock_guard<std::mutex> Guard(Lock);
+    TimeRecord Total;
+    for (const Phase &P : Phases) Total += P.Time;
+
+    OS << "===" << std::string(73, '-') << "===\n"
+       << "  " << Title << "\n"
+       << "===" << std::string(73, '-') << "===\n"
+       << "  Total Execution Time: " << std::fixed << std::setprecision(4)
+       << Total.Wall << " seconds (wall clock)\n\n"
+       << "   ---CPU Time---   --Wall Time--    Runs  --- Name ---\n";
+    for (const Phase &P : Phases) {
+        double Pct = Total.Wall > 0 ? 100.0 * P.Time.Wall / Total.Wall : 0;
+        OS << "   " << std::setw(8) << P.Time.CPU << "         "
+           << std::setw(8) << P.Time.Wall << " (" << std::setprecision(1)
+           << std::setw(5) << Pct << "%)" << std::setprecision(4)
+           << std::setw(7) << P.Count << "  " << P.Name << "\n";
+    }
+    OS << "   " << std::setw(8) << Total.CPU << "         " << std::setw(8)
+       << Total.Wall << " (100.0%)         Total\n\n";
+    OS.unsetf(std::ios::floatfield);
+}
+
+void TimerGroup::printJSON(std::ostream &OS) const {
+    std::lock_guard<std::mutex> Guard(Lock);
+    OS << "[";
+    for (size_t i = 0; i < Phases.size(); ++i) {
+        const Phase &P = Phases[i];
+        OS << (i ? "," : "") << "\n  {\"name\": \"" << P.Name << "\", \"wall\": "
+           << P.Time.Wall << ", \"cpu\": " << P.Time.CPU << ", \"runs\": " << P.Count << "}";
+    }
+    OS << "\n]";
+}
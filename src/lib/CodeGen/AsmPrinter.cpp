@@ -0,0 +1,114 @@
+#include "CodeGen/AsmPrinter.h"
+#include "CodeGen/MachineFunction.h"
+#include <iostream>
+
+using namespace sysy;
+
+namespace {
+
+// Function names are identifiers, so '.' cannot clash with them.
+void printBlockLabel(std::ostream &OS, const MachineBasicBlock *MBB) {
+    OS << ".L" << MBB->getParent()->getName() << "." << MBB->getNumber();
+}
+
+void printReg(std::ostream &OS, Register R) {
+    if (isVirtualReg(R)) OS << "%v" << (R - FirstVirtualReg);
+    else OS << RISCV::getRegName(R);
+}
+
+void printOperand(std::ostream &OS, const MachineOperand &MO) {
+    switch (MO.getKind()) {
+    case MachineOperand::Reg: printReg(OS, MO.getReg()); break;
+    case MachineOperand::Imm: OS << MO.getImm(); break;
+    case MachineOperand::Block: printBlockLabel(OS, MO.getBlock()); break;
+    case MachineOperand::FrameIndex: OS << "%stack." << MO.getFrameIndex(); break;
+    case MachineOperand::Symbol: OS << MO.getSymbol(); break;
+    }
+}
+
+} // namespace
+
+void MachineInstr::print(std::ostream &OS) const {
+    using RISCV::Format;
+    const MachineOperand *Ops = Operands.data();
+    OS << "\t";
+    // beq/bne against zero have shorter spellings.
+    if ((Op == RISCV::BEQ || Op == RISCV::BNE) && Ops[1].isReg() && Ops[1].getReg() == RISCV::ZERO) {
+        OS << (Op == RISCV::BEQ ? "beqz\t" : "bnez\t");
+        printOperand(OS, Ops[0]);
+        OS << ", ";
+        printOperand(OS, Ops[2]);
+        OS << "\n";
+        return;
+    }
+    OS << RISCV::getMnemonic(Op);
+    switch (getFormat()) {
+    case Format::RRR:
+    case Format::RRI:
+    case Format::RR:
+    case Format::RI:
+    case Format::Branch:
+    case Format::Jump:
+    case Format::Call: {
+        bool First = true;
+        for (const MachineOperand &MO : Operands) {
+            if (MO.isImplicit()) continue;
+            OS << (First ? "\t" : ", ");
+            First = false;
+            printOperand(OS, MO);
+        }
+        if (Op == RISCV::FCVT_W_S) OS << ", rtz";
+        break;
+    }
+    case Format::Load:
+    case Format::Store:
+        OS << "\t";
+        printOperand(OS, Ops[0]);
+        OS << ", " << Ops[2].getImm() << "(";
+        printOperand(OS, Ops[1]);
+        OS << ")";
+        break;
+    case Format::None: break;
+    }
+    OS << "\n";
+}
+
+void MachineBasicBlock::print(std::ostream &OS) const {
+    printBlockLabel(OS, this);
+    OS << ":";
+    if (!Name.empty()) OS << "\t\t\t# " << Name;
+    OS << "\n";
+    for (const MachineInstr &MI : *this) MI.print(OS);
+}
+
+void MachineFunction::print(std::ostream &OS) const {
+    OS << "# Machine code for " << Name << ":\n";
+    for (unsigned i = 0; i < FrameObjects.size(); ++i) {
+        const FrameObject &FO = FrameObjects[i];
+        OS << "#   %stack." << i << ": size " << FO.Size << (FO.Fixed ? ", fixed at " : ", offset ")
+           << FO.Offset << "\n";
+    }
+    for (const auto &MBB : Blocks) MBB->print(OS);
+}
+
+void sysy::printAssemblyHeader(std::ostream &OS) {
+    OS << "\t.option nopic\n"
+       << "\t.text\n";
+}
+
+void sysy::printFunctionAssembly(const MachineFunction &MF, std::ostream &OS) {
+    const std::string &Name = MF.getName();
+    OS << "\t.globl\t" << Name << "\n"
+       << "\t.p2align\t1\n"
+       << "\t.type\t" << Name << ", @function\n"
+       << Name << ":\n";
+    for (const MachineBasicBlock &MBB : MF) {
+        // The entry block is the function's label.
+        if (MBB.getNumber() != 0) {
+            printBlockLabel(OS, &MBB);
+            OS << ":\n";
+        }
+        for (const MachineInstr &MI : MBB) MI.print(OS);
+    }
+    OS << "\t.size\t" << Name << ", .-" << Name << "\n";
+}
@@ -0,0 +1,160 @@
+#include "CodeGen/CodeGen.h"
+#include "Basic/Statistic.h"
+#include "Basic/ThreadPool.h"
+#include "Basic/Timer.h"
+#include "CodeGen/AsmPrinter.h"
+#include "CodeGen/FrameLowering.h"
+#include "CodeGen/InstructionSelection.h"
+#include "CodeGen/Peephole.h"
+#include "CodeGen/RegAlloc.h"
+#include "CodeGen/Scheduler.h"
+#include "IR/Module.h"
+#include "Transforms/PassManager.h"
+#include <sstream>
+
+using namespace sysy;
+
+STATISTIC(NumMachineInstrs, "codegen", "Number of machine instructions emitted");
+STATISTIC(NumJumpsRemoved, "codegen", "Number of jumps to the next block removed");
+STATISTIC(NumBranchesRelaxed, "codegen", "Number of branches out of range rewritten with a jump");
+
+namespace {
+
+enum Phase { ISel, Peephole, Sched, RegAlloc, Frame, Emit, NumPhases };
+const char *const PhaseNames[NumPhases] = {
+    "Instruction selection",
+    "Peephole optimization",
+    "Instruction scheduling",
+    "Register allocation",
+    "Prologue/epilogue insertion",
+    "Assembly printing",
+};
+
+// Blocks keep IR order, so a jump to the next block is a fall-through.
+void removeJumpsToNextBlock(MachineFunction &MF) {
+    for (MachineBasicBlock &MBB : MF) {
+        MachineInstr *Last = MBB.back();
+        if (Last && Last->isJump() && Last->getTarget() == MBB.getNextBlock()) {
+            MBB.erase(Last);
+            ++NumJumpsRemoved;
+        }
+    }
+}
+
+// The most an instruction can take once assembled: li expands to up to
+// eight instructions for a 64-bit constant, and call to two.
+int64_t getMaxSize(const MachineInstr &MI) {
+    if (MI.getOpcode() == RISCV::LI) {
+        int64_t V = MI.getOperand(1).getImm();
+        return RISCV::isInt12(V) ? 4 : V == static_cast<int32_t>(V) ? 8 : 32;
+    }
+    return MI.isCall() ? 8 : 4;
+}
+
+// A conditional branch reaches 4 KiB either way, a jump 1 MiB. A branch
+// that may be out of reach goes to a new block next to it that jumps:
+//   blt a0, a1, .Lfar          bge a0, a1, .Lnext      blt a0, a1, .Lnew
+//   (falls through)      =>    .Lnew: j .Lfar      or  j .Lother
+//                              .Lnext:                 .Lnew: j .Lfar
+// Block addresses are computed from the largest size of each
+// instruction, so the distances are never underestimated.
+void relaxBranches(MachineFunction &MF) {
+    for (;;) {
+        std::vector<int64_t> Start(MF.size() + 1, 0);
+        for (MachineBasicBlock &MBB : MF) {
+            int64_t Size = 0;
+            for (MachineInstr &MI : MBB) Size += getMaxSize(MI);
+            Start[MBB.getNumber() + 1] = Start[MBB.getNumber()] + Size;
+        }
+        std::vector<MachineInstr *> OutOfRange;
+        for (MachineBasicBlock &MBB : MF) {
+            int64_t Addr = Start[MBB.getNumber()];
+            for (MachineInstr &MI : MBB) {
+                if (MI.isBranch()) {
+                    int64_t Dist = Start[MI.getTarget()->getNumber()] - Addr;
+                    if (Dist < -4096 || Dist > 4094) OutOfRange.push_back(&MI);
+                }
+                Addr += getMaxSize(MI);
+            }
+        }
+        if (OutOfRange.empty()) return;
+        for (MachineInstr *Br : OutOfRange) {
+            MachineBasicBlock *MBB = Br->getParent(), *Next = MBB->getNextBlock();
+            MachineBasicBlock *New = MF.createBlock(MBB->getName(), Next);
+            New->setLoopDepth(MBB->getLoopDepth());
+            New->push_back(new MachineInstr(RISCV::J, {MachineOperand::createBlock(Br->getTarget())}));
+            if (Br->getNextNode()) {
+                Br->getOperand(2).setBlock(New);
+            } else {
+                Br->setOpcode(RISCV::getInvertedBranch(Br->getOpcode()));
+                Br->getOperand(2).setBlock(Next);
+            }
+            ++NumBranchesRelaxed;
+        }
+    }
+}
+
+} // namespace
+
+void sysy::emitAssembly(const Module &M, std::ostream &OS, OptLevel Level, const SchedModel &Model, ThreadPool *Pool,
+                        TimerGroup *Timers) {
+    std::vector<const Function *> Defs;
+    for (const auto &F : M) {
+        if (!F->isDeclaration()) Defs.push_back(F.get());
+    }
+    std::vector<std::string> Texts(Defs.size());
+    TimeRecord Totals[NumPhases];
+    std::mutex TotalsLock;
+
+    parallelFor(Pool, Defs.size(), [&](size_t i) {
+        TimeRecord Times[NumPhases];
+        TimeRecord Last = Timers ? TimeRecord::nowForThread() : TimeRecord();
+        auto endPhase = [&](Phase P) {
+            if (!Timers) return;
+            TimeRecord Now = TimeRecord::nowForThread();
+            Times[P] += Now - Last;
+            Last = Now;
+        };
+
+        std::unique_ptr<MachineFunction> MF = selectInstructions(*Defs[i], Model);
+        endPhase(ISel);
+        if (Level != OptLevel::O0) {
+            runPeepholes(*MF);
+            propagateCopies(*MF);
+            endPhase(Peephole);
+            scheduleBeforeRegAlloc(*MF, Model);
+            endPhase(Sched);
+        }
+        if (Level == OptLevel::O0) allocateRegistersLinearScan(*MF);
+        else allocateRegistersGraphColoring(*MF);
+        endPhase(RegAlloc);
+        if (Level != OptLevel::O0) {
+            runPeepholes(*MF);
+            propagateCopies(*MF);
+            endPhase(Peephole);
+        }
+        lowerFrame(*MF);
+        removeJumpsToNextBlock(*MF);
+        endPhase(Frame);
+        if (Level != OptLevel::O0) {
+            scheduleAfterRegAlloc(*MF, Model);
+            endPhase(Sched);
+        }
+        relaxBranches(*MF);
+        NumMachineInstrs += MF->getInstructionCount();
+        std::ostringstream S;
+        printFunctionAssembly(*MF, S);
+        Texts[i] = S.str();
+        endPhase(Emit);
+
+        if (!Timers) return;
+        std::lock_guard<std::mutex> Guard(TotalsLock);
+        for (unsigned P = 0; P < NumPhases; ++P) Totals[P] += Times[P];
+    });
+
+    printAssemblyHeader(OS);
+    for (const std::string &Text : Texts) OS << Text;
+    if (!Timers || Defs.empty()) return;
+    for (unsigned P = 0; P < NumPhases; ++P)
+        Timers->addTime(PhaseNames[P], Totals[P], static_cast<unsigned>(Defs.size()));
+}
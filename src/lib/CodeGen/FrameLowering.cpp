@@ -0,0 +1,97 @@
+#include "CodeGen/FrameLowering.h"
+#include "CodeGen/MachineFunction.h"
+
+using namespace sysy;
+using namespace RISCV;
+
+namespace {
+
+int64_t alignTo(int64_t V, int64_t Align) { return (V + Align - 1) / Align * Align; }
+
+MachineInstr *insertBefore(MachineBasicBlock &MBB, MachineInstr *Pos, Opcode Op,
+                           std::vector<MachineOperand> Ops) {
+    return MBB.insert(Pos, new MachineInstr(Op, std::move(Ops)));
+}
+
+// Offsets beyond 12 bits are added to sp in the scratch register first.
+void emitSPAccess(MachineBasicBlock &MBB, MachineInstr *Pos, Opcode Op, Register Reg, int64_t Offset) {
+    Register Base = SP;
+    if (!isInt12(Offset)) {
+        insertBefore(MBB, Pos, LI, {MachineOperand::createReg(ScratchReg, true), MachineOperand::createImm(Offset)});
+        insertBefore(MBB, Pos, ADD, {MachineOperand::createReg(ScratchReg, true),
+                                     MachineOperand::createReg(SP), MachineOperand::createReg(ScratchReg)});
+        Base = ScratchReg;
+        Offset = 0;
+    }
+    bool IsStore = getFormat(Op) == Format::Store;
+    insertBefore(MBB, Pos, Op, {MachineOperand::createReg(Reg, !IsStore), MachineOperand::createReg(Base),
+                                MachineOperand::createImm(Offset)});
+}
+
+void adjustSP(MachineBasicBlock &MBB, MachineInstr *Pos, int64_t Amount) {
+    if (isInt12(Amount)) {
+        insertBefore(MBB, Pos, ADDI, {MachineOperand::createReg(SP, true), MachineOperand::createReg(SP),
+                                      MachineOperand::createImm(Amount)});
+        return;
+    }
+    insertBefore(MBB, Pos, LI, {MachineOperand::createReg(ScratchReg, true), MachineOperand::createImm(Amount)});
+    insertBefore(MBB, Pos, ADD, {MachineOperand::createReg(SP, true), MachineOperand::createReg(SP),
+                                 MachineOperand::createReg(ScratchReg)});
+}
+
+} // namespace
+
+void sysy::lowerFrame(MachineFunction &MF) {
+    int64_t Offset = MF.getOutgoingArgSize();
+    for (unsigned i = 0; i < MF.getNumFrameObjects(); ++i) {
+        FrameObject &FO = MF.getFrameObject(static_cast<int>(i));
+        if (FO.Fixed) continue;
+        Offset = alignTo(Offset, FO.Align);
+        FO.Offset = Offset;
+        Offset += FO.Size;
+    }
+    // The callee-saved registers are saved in full: 64 bits, also for the
+    // f registers, which may hold a caller's double.
+    std::vector<Register> Saved = MF.getSavedRegs();
+    if (MF.hasCalls()) Saved.insert(Saved.begin(), RA);
+    Offset = alignTo(Offset, 8);
+    std::vector<int64_t> SaveOffsets;
+    for (size_t i = 0; i < Saved.size(); ++i, Offset += 8) SaveOffsets.push_back(Offset);
+    int64_t FrameSize = alignTo(Offset, 16);
+
+    for (MachineBasicBlock &MBB : MF) {
+        for (MachineInstr &MI : MBB) {
+            for (MachineOperand &MO : MI) {
+                if (!MO.isFrameIndex()) continue;
+                const FrameObject &FO = MF.getFrameObject(MO.getFrameIndex());
+                // Loads and stores are the only users: base, then offset.
+                MachineOperand &Imm = MI.getOperand(2);
+                int64_t Off = FO.Offset + (FO.Fixed ? FrameSize : 0) + Imm.getImm();
+                if (isInt12(Off)) {
+                    MO.changeToReg(SP);
+                    Imm.setImm(Off);
+                    continue;
+                }
+                insertBefore(MBB, &MI, LI, {MachineOperand::createReg(ScratchReg, true), MachineOperand::createImm(Off)});
+                insertBefore(MBB, &MI, ADD, {MachineOperand::createReg(ScratchReg, true),
+                                             MachineOperand::createReg(SP), MachineOperand::createReg(ScratchReg)});
+                MO.changeToReg(ScratchReg);
+                Imm.setImm(0);
+            }
+        }
+    }
+
+    MachineBasicBlock &Entry = *MF.getEntryBlock();
+    MachineInstr *First = Entry.front();
+    if (FrameSize) adjustSP(Entry, First, -FrameSize);
+    for (size_t i = 0; i < Saved.size(); ++i)
+        emitSPAccess(Entry, First, getRegClass(Saved[i]) == RegClass::FPR ? FSD : SD, Saved[i], SaveOffsets[i]);
+
+    for (MachineBasicBlock &MBB : MF) {
+        MachineInstr *Ret = MBB.back();
+        if (!Ret || !Ret->isReturn()) continue;
+        for (size_t i = 0; i < Saved.size(); ++i)
+            emitSPAccess(MBB, Ret, getRegClass(Saved[i]) == RegClass::FPR ? FLD : LD, Saved[i], SaveOffsets[i]);
+        if (FrameSize) adjustSP(MBB, Ret, FrameSize);
+    }
+}
@@ -0,0 +1,673 @@
+#include "CodeGen/InstructionSelection.h"
+#include "Analysis/Dominators.h"
+#include "Analysis/LoopInfo.h"
+#include "Basic/Statistic.h"
+#include "CodeGen/SchedModel.h"
+#include "IR/Function.h"
+#include <cstring>
+#include <unordered_map>
+#include <unordered_set>
+
+using namespace sysy;
+
+STATISTIC(NumFoldedCompares, "isel", "Number of compares folded into branches");
+STATISTIC(NumFoldedImms, "isel", "Number of constants folded into immediates");
+STATISTIC(NumMulsByConstant, "isel", "Number of multiplications by constants done by shifts and adds");
+STATISTIC(NumDivsByConstant, "isel", "Number of divisions and remainders by constants done by multiplication");
+
+namespace {
+
+using namespace RISCV;
+
+class InstructionSelector {
+    const Function &F;
+    MachineFunction &MF;
+    const SchedModel &Model; // For the cost of multiplies and divides
+    MachineBasicBlock *MBB = nullptr; // Where instructions are emitted
+    std::unordered_map<const BasicBlock *, MachineBasicBlock *> BlockMap;
+    std::unordered_map<const Value *, Register> ValueRegs;
+    // Each phi reads its own register at the top of its block, and every
+    // predecessor writes it last thing before its branch. Nothing else reads
+    // it, so the write is harmless when the branch goes elsewhere: critical
+    // edges need no splitting. And all phis of a block switch at once.
+    std::unordered_map<const PhiInst *, Register> PhiInRegs;
+    std::unordered_map<const AllocaInst *, int> FrameIndices;
+    std::unordered_set<const Instruction *> Folded; // Selected with their user
+
+    static RegClass getRegClass(Type T) { return T == Type::F32 ? RegClass::FPR : RegClass::GPR; }
+
+    MachineInstr *emit(RISCV::Opcode Op, std::vector<MachineOperand> Ops) {
+        return MBB->push_back(new MachineInstr(Op, std::move(Ops)));
+    }
+    static MachineOperand def(Register R) { return MachineOperand::createReg(R, true); }
+    static MachineOperand use(Register R) { return MachineOperand::createReg(R); }
+    static MachineOperand imm(int64_t V) { return MachineOperand::createImm(V); }
+    Register newReg(RegClass RC) { return MF.createVirtualRegister(RC); }
+
+    /// The register \p V is defined in, created on first mention (phis and
+    /// loops mention values before their definition is selected).
+    Register getValueReg(const Value *V);
+    /// A register holding \p V. Constants are materialized right here,
+    /// except that 0 and undef integers are the zero register.
+    Register getReg(const Value *V);
+    /// Make \p I's value \p R: emits a copy if \p I already has a register.
+    void setValueReg(const Instruction *I, Register R);
+    void emitCopy(Register Dst, Register Src);
+
+    static const ConstantInt *getImm12(const Value *V) {
+        auto *C = dyn_cast<ConstantInt>(V);
+        return C && isInt12(C->getValue()) ? C : nullptr;
+    }
+
+    void lowerArguments();
+    void selectBlock(const BasicBlock &BB);
+    void select(const Instruction &I);
+    void selectBinary(const BinaryInst &I);
+    bool selectMulByConstant(Register Dst, Register Src, int32_t C);
+    bool selectDivByConstant(Register Dst, Register Src, int32_t D, bool IsRem);
+    void selectICmp(const CmpInst &I);
+    void selectFCmp(const CmpInst &I);
+    void selectCall(const CallInst &CI);
+    void selectBranch(const BranchInst &Br);
+    void selectReturn(const ReturnInst &Ret);
+    Register getPhiInReg(const PhiInst *Phi);
+    void emitPhiCopies(const BasicBlock *Pred, const BasicBlock *Succ);
+
+public:
+    InstructionSelector(const Function &F, MachineFunction &MF, const SchedModel &Model) : F(F), MF(MF), Model(Model) {}
+    void run();
+};
+
+Register InstructionSelector::getValueReg(const Value *V) {
+    auto [It, Inserted] = ValueRegs.try_emplace(V, NoRegister);
+    if (Inserted) It->second = newReg(getRegClass(V->getType()));
+    return It->second;
+}
+
+Register InstructionSelector::getReg(const Value *V) {
+    if (auto *C = dyn_cast<ConstantInt>(V)) {
+        if (C->isZero()) return ZERO;
+        Register R = newReg(RegClass::GPR);
+        emit(LI, {def(R), imm(C->getValue())});
+        return R;
+    }
+    if (auto *C = dyn_cast<ConstantFloat>(V)) {
+        uint32_t Bits;
+        float Val = C->getValue();
+        std::memcpy(&Bits, &Val, sizeof(Bits));
+        Register R = newReg(RegClass::FPR);
+        Register Int = ZERO;
+        if (Bits) {
+            Int = newReg(RegClass::GPR);
+            emit(LI, {def(Int), imm(static_cast<int32_t>(Bits))});
+        }
+        emit(FMV_W_X, {def(R), use(Int)});
+        return R;
+    }
+    if (isa<UndefValue>(V)) {
+        if (V->getType() != Type::F32) return ZERO;
+        Register R = newReg(RegClass::FPR);
+        emit(FMV_W_X, {def(R), use(ZERO)});
+        return R;
+    }
+    return getValueReg(V);
+}
+
+void InstructionSelector::emitCopy(Register Dst, Register Src) {
+    emit(MF.getRegClass(Dst) == RegClass::FPR ? FMV_S : MV, {def(Dst), use(Src)});
+}
+
+void InstructionSelector::setValueReg(const Instruction *I, Register R) {
+    auto It = ValueRegs.find(I);
+    if (It == ValueRegs.end()) ValueRegs.emplace(I, R);
+    else emitCopy(It->second, R);
+}
+
+// Under LP64D the first eight integer and eight float arguments go in
+// a0-a7 and fa0-fa7, further floats in the integer registers left over and
+// everything else on the stack, 8 bytes each.
+struct ArgLocation {
+    Register Reg; // NoRegister: on the stack
+    unsigned StackOffset;
+};
+
+std::vector<ArgLocation> assignArguments(const std::vector<Type> &Types) {
+    std::vector<ArgLocation> Locs;
+    unsigned NextGPR = 0, NextFPR = 0, StackOffset = 0;
+    for (Type T : Types) {
+        if (T == Type::F32 && NextFPR < NumArgRegs) {
+            Locs.push_back({getArgReg(RegClass::FPR, NextFPR++), 0});
+        } else if (NextGPR < NumArgRegs) {
+            Locs.push_back({getArgReg(RegClass::GPR, NextGPR++), 0});
+        } else {
+            Locs.push_back({NoRegister, StackOffset});
+            StackOffset += 8;
+        }
+    }
+    return Locs;
+}
+
+void InstructionSelector::lowerArguments() {
+    std::vector<Type> Types;
+    for (unsigned i = 0; i < F.getNumArgs(); ++i) Types.push_back(F.getArg(i)->getType());
+    std::vector<ArgLocation> Locs = assignArguments(Types);
+    for (unsigned i = 0; i < F.getNumArgs(); ++i) {
+        const Argument *Arg = F.getArg(i);
+        Register R = getValueReg(Arg);
+        bool IsFloat = Arg->getType() == Type::F32;
+        if (Locs[i].Reg == NoRegister) {
+            int FI = MF.createFixedObject(8, Locs[i].StackOffset);
+            emit(IsFloat ? FLW : LW, {def(R), MachineOperand::createFrameIndex(FI), imm(0)});
+        } else if (IsFloat && RISCV::getRegClass(Locs[i].Reg) == RegClass::GPR) {
+            emit(FMV_W_X, {def(R), use(Locs[i].Reg)});
+        } else {
+            emitCopy(R, Locs[i].Reg);
+        }
+    }
+}
+
+void InstructionSelector::selectBinary(const BinaryInst &I) {
+    const Value *LHS = I.getLHS(), *RHS = I.getRHS();
+    Register Dst = newReg(getRegClass(I.getType()));
+    RISCV::Opcode Op;
+    switch (I.getOpcode()) {
+    case sysy::Opcode::Add:
+    case sysy::Opcode::Sub: {
+        if (I.getOpcode() == sysy::Opcode::Add && getImm12(LHS)) std::swap(LHS, RHS);
+        // x - c is x + (-c); -c must fit as well.
+        const ConstantInt *C = getImm12(RHS);
+        int64_t Imm = C ? C->getValue() : 0;
+        if (C && I.getOpcode() == sysy::Opcode::Sub) Imm = -Imm;
+        if (C && isInt12(Imm)) {
+            ++NumFoldedImms;
+            emit(ADDIW, {def(Dst), use(getReg(LHS)), imm(Imm)});
+            setValueReg(&I, Dst);
+            return;
+        }
+        Op = I.getOpcode() == sysy::Opcode::Add ? ADDW : SUBW;
+        break;
+    }
+    case sysy::Opcode::Mul:
+        if (isa<ConstantInt>(LHS)) std::swap(LHS, RHS);
+        if (auto *C = dyn_cast<ConstantInt>(RHS)) {
+            if (selectMulByConstant(Dst, getReg(LHS), C->getValue())) {
+                setValueReg(&I, Dst);
+                return;
+            }
+        }
+        Op = MULW;
+        break;
+    case sysy::Opcode::SDiv:
+    case sysy::Opcode::SRem: {
+        bool IsRem = I.getOpcode() == sysy::Opcode::SRem;
+        if (auto *C = dyn_cast<ConstantInt>(RHS)) {
+            if (selectDivByConstant(Dst, getReg(LHS), C->getValue(), IsRem)) {
+                setValueReg(&I, Dst);
+                return;
+            }
+        }
+        Op = IsRem ? REMW : DIVW;
+        break;
+    }
+    case sysy::Opcode::FAdd: Op = FADD_S; break;
+    case sysy::Opcode::FSub: Op = FSUB_S; break;
+    case sysy::Opcode::FMul: Op = FMUL_S; break;
+    case sysy::Opcode::FDiv: Op = FDIV_S; break;
+    default: assert(false && "not a binary operator"); return;
+    }
+    Register L = getReg(LHS);
+    emit(Op, {def(Dst), use(L), use(getReg(RHS))});
+    setValueReg(&I, Dst);
+}
+
+// x * C by Horner's rule over the non-adjacent form of C: digits -1, 0
+// and 1, no two adjacent nonzero, so the fewest of them. Each digit after
+// the first costs a shift and an add or subtract of x. Only the low 32
+// bits count, so digits from bit 32 up are dropped: x * -1 is 0 - x.
+// Nothing is emitted unless the chain takes fewer cycles than li and mulw.
+bool InstructionSelector::selectMulByConstant(Register Dst, Register Src, int32_t C) {
+    std::vector<std::pair<int, unsigned>> Digits; // Sign and position, highest first
+    int64_t V = static_cast<uint32_t>(C);
+    for (unsigned Pos = 0; V; ++Pos, V >>= 1) {
+        if (!(V & 1)) continue;
+        int Digit = (V & 3) == 1 ? 1 : -1;
+        V -= Digit;
+        if (Pos < 32) Digits.insert(Digits.begin(), {Digit, Pos});
+    }
+    if (Digits.empty()) {
+        emit(MV, {def(Dst), use(ZERO)});
+        return true;
+    }
+    unsigned NumOps = (Digits[0].first < 0) + 2 * (Digits.size() - 1) + (Digits.back().second != 0);
+    unsigned ALU = Model.getClassInfo(SchedClass::IntALU).Latency;
+    unsigned Mul = Model.getClassInfo(SchedClass::IntMul).Latency + (isInt12(C) ? 1 : 2) * ALU;
+    if (NumOps * ALU >= Mul) return false;
+
+    MachineInstr *Last = nullptr;
+    Register Acc = Src;
+    auto emitStep = [&](RISCV::Opcode Op, MachineOperand RHS) {
+        Register R = newReg(RegClass::GPR);
+        Last = emit(Op, {def(R), use(Acc), RHS});
+        Acc = R;
+    };
+    if (Digits[0].first < 0) {
+        Acc = ZERO;
+        emitStep(SUBW, use(Src));
+    }
+    for (size_t i = 1; i < Digits.size(); ++i) {
+        emitStep(SLLIW, imm(Digits[i - 1].second - Digits[i].second));
+        emitStep(Digits[i].first > 0 ? ADDW : SUBW, use(Src));
+    }
+    if (Digits.back().second) emitStep(SLLIW, imm(Digits.back().second));
+    if (Last) Last->getOperand(0).setReg(Dst);
+    else emitCopy(Dst, Src);
+    ++NumMulsByConstant;
+    return true;
+}
+
+// Signed division by D, |D| >= 2, is a multiplication by a magic number M
+// (Granlund and Montgomery; Hacker's Delight, 10-4): the high 32 bits of
+// M * n, plus or minus n where M came out with the wrong sign, shifted
+// right by S and rounded up by one if negative, to truncate toward zero.
+struct DivMagic {
+    int32_t M;
+    unsigned S;
+};
+
+DivMagic getDivMagic(int32_t D) {
+    const uint32_t Two31 = 0x80000000u;
+    uint32_t AD = D < 0 ? 0u - static_cast<uint32_t>(D) : static_cast<uint32_t>(D);
+    uint32_t T = Two31 + (static_cast<uint32_t>(D) >> 31);
+    uint32_t ANC = T - 1 - T % AD; // |nc|, the largest multiple of D less 1
+    unsigned P = 31;
+    uint32_t Q1 = Two31 / ANC, R1 = Two31 - Q1 * ANC;
+    uint32_t Q2 = Two31 / AD, R2 = Two31 - Q2 * AD;
+    uint32_t Delta;
+    do {
+        ++P;
+        Q1 *= 2;
+        R1 *= 2;
+        if (R1 >= ANC) {
+            ++Q1;
+            R1 -= ANC;
+        }
+        Q2 *= 2;
+        R2 *= 2;
+        if (R2 >= AD) {
+            ++Q2;
+            R2 -= AD;
+        }
+        Delta = AD - R2;
+    } while (Q1 < Delta || (Q1 == Delta && R1 == 0));
+    uint32_t M = Q2 + 1;
+    return {static_cast<int32_t>(D < 0 ? 0u - M : M), P - 32};
+}
+
+// n / D and n % D, truncating toward zero like divw and remw:
+//   D = 2^k:  (n + (n < 0 ? 2^k - 1 : 0)) >> k
+//   other D:  mulh by M << 32 gives the high word of M * n directly
+// A remainder is n - (n / |D|) * |D|. Division by 0 and by INT_MIN are
+// left to divw and remw, as is anything the model says divides faster.
+bool InstructionSelector::selectDivByConstant(Register Dst, Register Src, int32_t D, bool IsRem) {
+    if (D == 0 || D == INT32_MIN) return false;
+    if (IsRem && D < 0) D = -D;
+    uint32_t AD = D < 0 ? 0u - static_cast<uint32_t>(D) : static_cast<uint32_t>(D);
+    if (AD == 1) {
+        ++NumDivsByConstant;
+        if (IsRem) emit(MV, {def(Dst), use(ZERO)});
+        else if (D > 0) emitCopy(Dst, Src);
+        else emit(SUBW, {def(Dst), use(ZERO), use(Src)});
+        return true;
+    }
+
+    bool IsPow2 = (AD & (AD - 1)) == 0;
+    unsigned ALU = Model.getClassInfo(SchedClass::IntALU).Latency;
+    unsigned Cost = IsPow2 ? 4 * ALU : Model.getClassInfo(SchedClass::IntMul).Latency + 3 * ALU;
+    if (IsRem) Cost += Model.getClassInfo(SchedClass::IntMul).Latency + ALU;
+    if (Cost >= Model.getClassInfo(SchedClass::IntDiv).Latency) return false;
+    ++NumDivsByConstant;
+
+    Register Quot = IsRem ? newReg(RegClass::GPR) : Dst;
+    if (IsPow2) {
+        unsigned K = 0;
+        while ((1u << K) != AD) ++K;
+        // 2^k - 1 for negative n: the sign bit, or all ones shifted down.
+        Register Bias = newReg(RegClass::GPR);
+        if (K == 1) {
+            emit(SRLIW, {def(Bias), use(Src), imm(31)});
+        } else {
+            Register Sign = newReg(RegClass::GPR);
+            emit(SRAIW, {def(Sign), use(Src), imm(31)});
+            emit(SRLIW, {def(Bias), use(Sign), imm(32 - K)});
+        }
+        Register Biased = newReg(RegClass::GPR);
+        emit(ADDW, {def(Biased), use(Src), use(Bias)});
+        if (IsRem && isInt12(-static_cast<int64_t>(AD))) {
+            Register Rounded = newReg(RegClass::GPR);
+            emit(ANDI, {def(Rounded), use(Biased), imm(-static_cast<int64_t>(AD))});
+            emit(SUBW, {def(Dst), use(Src), use(Rounded)});
+            return true;
+        }
+        if (D > 0) {
+            emit(SRAIW, {def(Quot), use(Biased), imm(K)});
+        } else {
+            Register Pos = newReg(RegClass::GPR);
+            emit(SRAIW, {def(Pos), use(Biased), imm(K)});
+            emit(SUBW, {def(Quot), use(ZERO), use(Pos)});
+        }
+    } else {
+        DivMagic Magic = getDivMagic(D);
+        Register M = newReg(RegClass::GPR), High = newReg(RegClass::GPR);
+        emit(LI, {def(M), imm(static_cast<int64_t>(static_cast<uint64_t>(static_cast<int64_t>(Magic.M)) << 32))});
+        emit(MULH, {def(High), use(Src), use(M)});
+        if (D > 0 && Magic.M < 0) {
+            Register Sum = newReg(RegClass::GPR);
+            emit(ADDW, {def(Sum), use(High), use(Src)});
+            High = Sum;
+        } else if (D < 0 && Magic.M > 0) {
+            Register Diff = newReg(RegClass::GPR);
+            emit(SUBW, {def(Diff), use(High), use(Src)});
+            High = Diff;
+        }
+        if (Magic.S) {
+            Register Shifted = newReg(RegClass::GPR);
+            emit(SRAIW, {def(Shifted), use(High), imm(Magic.S)});
+            High = Shifted;
+        }
+        Register Sign = newReg(RegClass::GPR);
+        emit(SRLIW, {def(Sign), use(High), imm(31)});
+        emit(ADDW, {def(Quot), use(High), use(Sign)});
+    }
+    if (!IsRem) return true;
+    Register Product = newReg(RegClass::GPR);
+    if (!selectMulByConstant(Product, Quot, D)) {
+        Register C = newReg(RegClass::GPR);
+        emit(LI, {def(C), imm(D)});
+        emit(MULW, {def(Product), use(Quot), use(C)});
+    }
+    emit(SUBW, {def(Dst), use(Src), use(Product)});
+    return true;
+}
+
+// slt and friends compute the 0/1 result directly; the other predicates
+// need a second instruction to invert or test against zero.
+void InstructionSelector::selectICmp(const CmpInst &I) {
+    const Value *LHS = I.getLHS(), *RHS = I.getRHS();
+    CmpInst::Predicate P = I.getPredicate();
+    if (isa<ConstantInt>(LHS) && !isa<ConstantInt>(RHS)) {
+        std::swap(LHS, RHS);
+        P = CmpInst::getSwappedPredicate(P);
+    }
+    auto *C = dyn_cast<ConstantInt>(RHS);
+    int64_t CVal = C ? C->getValue() : 0;
+    Register Dst = newReg(RegClass::GPR);
+    Register L = getReg(LHS);
+    switch (P) {
+    case CmpInst::EQ:
+    case CmpInst::NE: {
+        Register Diff = L;
+        if (!C || CVal != 0) {
+            Diff = newReg(RegClass::GPR);
+            if (C && isInt12(-CVal)) {
+                ++NumFoldedImms;
+                emit(ADDI, {def(Diff), use(L), imm(-CVal)});
+            } else {
+                emit(XOR, {def(Diff), use(L), use(getReg(RHS))});
+            }
+        }
+        emit(P == CmpInst::EQ ? SEQZ : SNEZ, {def(Dst), use(Diff)});
+        break;
+    }
+    case CmpInst::LT:
+    case CmpInst::GE: {
+        Register Lt = P == CmpInst::LT ? Dst : newReg(RegClass::GPR);
+        if (C && isInt12(CVal)) {
+            ++NumFoldedImms;
+            emit(SLTI, {def(Lt), use(L), imm(CVal)});
+        } else {
+            emit(SLT, {def(Lt), use(L), use(getReg(RHS))});
+        }
+        if (P == CmpInst::GE) emit(XORI, {def(Dst), use(Lt), imm(1)});
+        break;
+    }
+    case CmpInst::LE:
+    case CmpInst::GT: {
+        // x <= c is x < c + 1.
+        if (C && isInt12(CVal + 1)) {
+            ++NumFoldedImms;
+            Register Le = P == CmpInst::LE ? Dst : newReg(RegClass::GPR);
+            emit(SLTI, {def(Le), use(L), imm(CVal + 1)});
+            if (P == CmpInst::GT) emit(XORI, {def(Dst), use(Le), imm(1)});
+            break;
+        }
+        Register Gt = P == CmpInst::GT ? Dst : newReg(RegClass::GPR);
+        emit(SLT, {def(Gt), use(getReg(RHS)), use(L)});
+        if (P == CmpInst::LE) emit(XORI, {def(Dst), use(Gt), imm(1)});
+        break;
+    }
+    }
+    setValueReg(&I, Dst);
+}
+
+void InstructionSelector::selectFCmp(const CmpInst &I) {
+    Register L = getReg(I.getLHS()), R = getReg(I.getRHS());
+    Register Dst = newReg(RegClass::GPR);
+    Register Set = I.getPredicate() == CmpInst::NE ? newReg(RegClass::GPR) : Dst;
+    switch (I.getPredicate()) {
+    case CmpInst::EQ:
+    case CmpInst::NE: emit(FEQ_S, {def(Set), use(L), use(R)}); break;
+    case CmpInst::LT: emit(FLT_S, {def(Set), use(L), use(R)}); break;
+    case CmpInst::LE: emit(FLE_S, {def(Set), use(L), use(R)}); break;
+    case CmpInst::GT: emit(FLT_S, {def(Set), use(R), use(L)}); break;
+    case CmpInst::GE: emit(FLE_S, {def(Set), use(R), use(L)}); break;
+    }
+    if (Set != Dst) emit(XORI, {def(Dst), use(Set), imm(1)});
+    setValueReg(&I, Dst);
+}
+
+void InstructionSelector::selectCall(const CallInst &CI) {
+    const Function *Callee = CI.getCallee();
+    std::vector<Type> Types;
+    for (unsigned i = 0; i < CI.getNumArgs(); ++i) Types.push_back(CI.getArg(i)->getType());
+    std::vector<ArgLocation> Locs = assignArguments(Types);
+
+    // Compute every argument first, so that the argument registers are
+    // only live from the copies to the call.
+    std::vector<Register> Regs;
+    unsigned StackBytes = 0;
+    for (unsigned i = 0; i < CI.getNumArgs(); ++i) {
+        if (Locs[i].Reg != NoRegister && isa<ConstantInt>(CI.getArg(i))) {
+            Regs.push_back(NoRegister); // li straight into the argument register
+            continue;
+        }
+        Regs.push_back(getReg(CI.getArg(i)));
+        if (Locs[i].Reg == NoRegister) {
+            emit(Types[i] == Type::F32 ? FSW : SD, {use(Regs[i]), use(SP), imm(Locs[i].StackOffset)});
+            StackBytes = Locs[i].StackOffset + 8;
+        }
+    }
+    auto *Call = new MachineInstr(CALL, {MachineOperand::createSymbol(Callee->getName().c_str())});
+    for (unsigned i = 0; i < CI.getNumArgs(); ++i) {
+        Register ArgReg = Locs[i].Reg;
+        if (ArgReg == NoRegister) continue;
+        if (Regs[i] == NoRegister) emit(LI, {def(ArgReg), imm(cast<ConstantInt>(CI.getArg(i))->getValue())});
+        else if (Types[i] == Type::F32 && RISCV::getRegClass(ArgReg) == RegClass::GPR) emit(FMV_X_W, {def(ArgReg), use(Regs[i])});
+        else emitCopy(ArgReg, Regs[i]);
+        Call->addOperand(MachineOperand::createReg(ArgReg, false, true));
+    }
+    Type RetTy = Callee->getReturnType();
+    Register RetReg = RetTy == Type::F32 ? FA0 : A0;
+    if (RetTy != Type::Void) Call->addOperand(MachineOperand::createReg(RetReg, true, true));
+    MBB->push_back(Call);
+    MF.noteCall(StackBytes);
+    if (RetTy != Type::Void && !CI.use_empty()) {
+        Register Dst = newReg(getRegClass(RetTy));
+        emitCopy(Dst, RetReg);
+        setValueReg(&CI, Dst);
+    }
+}
+
+Register InstructionSelector::getPhiInReg(const PhiInst *Phi) {
+    auto [It, Inserted] = PhiInRegs.try_emplace(Phi, NoRegister);
+    if (Inserted) It->second = newReg(getRegClass(Phi->getType()));
+    return It->second;
+}
+
+void InstructionSelector::emitPhiCopies(const BasicBlock *Pred, const BasicBlock *Succ) {
+    for (const Instruction &I : *Succ) {
+        auto *Phi = dyn_cast<PhiInst>(&I);
+        if (!Phi) break;
+        emitCopy(getPhiInReg(Phi), getReg(Phi->getIncomingValueForBlock(Pred)));
+    }
+}
+
+void InstructionSelector::selectBranch(const BranchInst &Br) {
+    const BasicBlock *BB = Br.getParent();
+    for (unsigned i = 0; i < Br.getNumSuccessors(); ++i) {
+        if (i == 1 && Br.getSuccessor(1) == Br.getSuccessor(0)) break;
+        emitPhiCopies(BB, Br.getSuccessor(i));
+    }
+    MachineBasicBlock *True = BlockMap.at(Br.getSuccessor(0));
+    if (!Br.isConditional() || Br.getSuccessor(0) == Br.getSuccessor(1)) {
+        emit(J, {MachineOperand::createBlock(True)});
+        return;
+    }
+
+    MachineBasicBlock *False = BlockMap.at(Br.getSuccessor(1));
+    const Value *Cond = Br.getCondition();
+    auto *Cmp = dyn_cast<CmpInst>(Cond);
+    if (Cmp && Folded.count(Cmp) && !Cmp->isFloat()) {
+        ++NumFoldedCompares;
+        const Value *LHS = Cmp->getLHS(), *RHS = Cmp->getRHS();
+        CmpInst::Predicate P = Cmp->getPredicate();
+        // Only lt and ge exist; gt and le swap their operands.
+        if (P == CmpInst::GT || P == CmpInst::LE) {
+            std::swap(LHS, RHS);
+            P = CmpInst::getSwappedPredicate(P);
+        }
+        static const RISCV::Opcode Branches[] = {BEQ, BNE, BLT, BGE, BLT, BGE};
+        Register L = getReg(LHS);
+        emit(Branches[P], {use(L), use(getReg(RHS)), MachineOperand::createBlock(True)});
+    } else if (Cmp && Folded.count(Cmp)) {
+        ++NumFoldedCompares;
+        // fcmp une is the inverse of feq: branch when feq says false.
+        Register L = getReg(Cmp->getLHS()), R = getReg(Cmp->getRHS());
+        Register Set = newReg(RegClass::GPR);
+        switch (Cmp->getPredicate()) {
+        case CmpInst::EQ:
+        case CmpInst::NE: emit(FEQ_S, {def(Set), use(L), use(R)}); break;
+        case CmpInst::LT: emit(FLT_S, {def(Set), use(L), use(R)}); break;
+        case CmpInst::LE: emit(FLE_S, {def(Set), use(L), use(R)}); break;
+        case CmpInst::GT: emit(FLT_S, {def(Set), use(R), use(L)}); break;
+        case CmpInst::GE: emit(FLE_S, {def(Set), use(R), use(L)}); break;
+        }
+        emit(Cmp->getPredicate() == CmpInst::NE ? BEQ : BNE,
+             {use(Set), use(ZERO), MachineOperand::createBlock(True)});
+    } else {
+        emit(BNE, {use(getReg(Cond)), use(ZERO), MachineOperand::createBlock(True)});
+    }
+    emit(J, {MachineOperand::createBlock(False)});
+}
+
+void InstructionSelector::selectReturn(const ReturnInst &Ret) {
+    auto *MI = new MachineInstr(RET, {});
+    if (const Value *V = Ret.getReturnValue()) {
+        Register RetReg = V->getType() == Type::F32 ? FA0 : A0;
+        if (auto *C = dyn_cast<ConstantInt>(V)) emit(LI, {def(RetReg), imm(C->getValue())});
+        else emitCopy(RetReg, getReg(V));
+        MI->addOperand(MachineOperand::createReg(RetReg, false, true));
+    }
+    MBB->push_back(MI);
+}
+
+void InstructionSelector::select(const Instruction &I) {
+    if (Folded.count(&I)) return;
+    switch (I.getOpcode()) {
+    case sysy::Opcode::FNeg: {
+        Register Dst = newReg(RegClass::FPR);
+        emit(FNEG_S, {def(Dst), use(getReg(I.getOperand(0)))});
+        setValueReg(&I, Dst);
+        return;
+    }
+    case sysy::Opcode::ICmp: selectICmp(*cast<CmpInst>(&I)); return;
+    case sysy::Opcode::FCmp: selectFCmp(*cast<CmpInst>(&I)); return;
+    case sysy::Opcode::ZExt:
+        // i1 values are 0 or 1 already.
+        setValueReg(&I, getReg(I.getOperand(0)));
+        return;
+    case sysy::Opcode::SIToFP:
+    case sysy::Opcode::FPToSI: {
+        bool ToFloat = I.getOpcode() == sysy::Opcode::SIToFP;
+        Register Dst = newReg(ToFloat ? RegClass::FPR : RegClass::GPR);
+        emit(ToFloat ? FCVT_S_W : FCVT_W_S, {def(Dst), use(getReg(I.getOperand(0)))});
+        setValueReg(&I, Dst);
+        return;
+    }
+    case sysy::Opcode::Alloca: return; // A stack object, see run()
+    case sysy::Opcode::Load: {
+        auto &Ld = *cast<LoadInst>(&I);
+        auto *Slot = cast<AllocaInst>(Ld.getPointerOperand());
+        Register Dst = newReg(getRegClass(Ld.getType()));
+        emit(Ld.getType() == Type::F32 ? FLW : LW,
+             {def(Dst), MachineOperand::createFrameIndex(FrameIndices.at(Slot)), imm(0)});
+        setValueReg(&I, Dst);
+        return;
+    }
+    case sysy::Opcode::Store: {
+        auto &St = *cast<StoreInst>(&I);
+        auto *Slot = cast<AllocaInst>(St.getPointerOperand());
+        const Value *V = St.getValueOperand();
+        emit(V->getType() == Type::F32 ? FSW : SW,
+             {use(getReg(V)), MachineOperand::createFrameIndex(FrameIndices.at(Slot)), imm(0)});
+        return;
+    }
+    case sysy::Opcode::Call: selectCall(*cast<CallInst>(&I)); return;
+    case sysy::Opcode::Phi: return; // See selectBlock()
+    case sysy::Opcode::Br: selectBranch(*cast<BranchInst>(&I)); return;
+    case sysy::Opcode::Ret: selectReturn(*cast<ReturnInst>(&I)); return;
+    default: selectBinary(*cast<BinaryInst>(&I)); return;
+    }
+}
+
+void InstructionSelector::selectBlock(const BasicBlock &BB) {
+    MBB = BlockMap.at(&BB);
+    if (&BB == F.getEntryBlock()) lowerArguments();
+    for (const Instruction &I : BB) {
+        auto *Phi = dyn_cast<PhiInst>(&I);
+        if (!Phi) break;
+        emitCopy(getValueReg(Phi), getPhiInReg(Phi));
+    }
+    // A compare whose only user is this block's branch becomes part of it.
+    if (auto *Br = dyn_cast<BranchInst>(BB.getTerminator()); Br && Br->isConditional()) {
+        auto *Cmp = dyn_cast<CmpInst>(Br->getCondition());
+        if (Cmp && Cmp->getParent() == &BB && Cmp->hasOneUse()) Folded.insert(Cmp);
+    }
+    for (const Instruction &I : BB) select(I);
+}
+
+void InstructionSelector::run() {
+    // Unreachable blocks are dropped: their values need not be defined.
+    // Loop depths weigh the spill costs of the register allocator.
+    DominatorTree DT(F);
+    LoopInfo LI(DT);
+    std::vector<const BasicBlock *> Order;
+    for (const BasicBlock &BB : F) {
+        if (!DT.isReachable(&BB)) continue;
+        Order.push_back(&BB);
+        MachineBasicBlock *MBB = MF.createBlock(BB.getName());
+        MBB->setLoopDepth(LI.getLoopDepth(&BB));
+        BlockMap[&BB] = MBB;
+        for (const Instruction &I : BB) {
+            if (auto *AI = dyn_cast<AllocaInst>(&I)) FrameIndices[AI] = MF.createStackObject(4, 4);
+        }
+    }
+    for (const BasicBlock *BB : Order) selectBlock(*BB);
+}
+
+} // namespace
+
+std::unique_ptr<MachineFunction> sysy::selectInstructions(const Function &F, const SchedModel &Model) {
+    auto MF = std::make_unique<MachineFunction>(F.getName());
+    InstructionSelector(F, *MF, Model).run();
+    return MF;
+}
@@ -0,0 +1,71 @@
+#include "CodeGen/Liveness.h"
+
+using namespace sysy;
+
+MachineLiveness::MachineLiveness(const MachineFunction &MF)
+    : NumRegs(FirstVirtualReg + MF.getNumVirtualRegs()) {
+    size_t NumBlocks = MF.size();
+    std::vector<std::vector<unsigned>> Preds(NumBlocks);
+    // Per register, the blocks that write it and the blocks that read it
+    // before writing it, gathered as pairs and then bucketed by register.
+    std::vector<std::pair<Register, unsigned>> DefPairs, UsePairs;
+    std::vector<unsigned> LastDefBlock(NumRegs, ~0u), LastUseBlock(NumRegs, ~0u);
+    for (const MachineBasicBlock &MBB : MF) {
+        unsigned N = MBB.getNumber();
+        for (const MachineInstr &MI : MBB) {
+            forEachUse(MI, [&](Register R) {
+                if (LastDefBlock[R] == N || LastUseBlock[R] == N) return;
+                LastUseBlock[R] = N;
+                UsePairs.push_back({R, N});
+            });
+            forEachDef(MI, [&](Register R) {
+                if (LastDefBlock[R] == N) return;
+                LastDefBlock[R] = N;
+                DefPairs.push_back({R, N});
+            });
+        }
+        for (MachineBasicBlock *S : MBB.getSuccessors()) Preds[S->getNumber()].push_back(N);
+    }
+    std::vector<unsigned> DefStart, DefBlocks, UseStart, UseBlocks;
+    auto bucket = [&](const std::vector<std::pair<Register, unsigned>> &Pairs, std::vector<unsigned> &Start,
+                      std::vector<unsigned> &Blocks) {
+        Start.assign(NumRegs + 1, 0);
+        for (const auto &P : Pairs) ++Start[P.first + 1];
+        for (unsigned R = 0; R < NumRegs; ++R) Start[R + 1] += Start[R];
+        Blocks.resize(Pairs.size());
+        std::vector<unsigned> Next(Start.begin(), Start.end() - 1);
+        for (const auto &P : Pairs) Blocks[Next[P.first]++] = P.second;
+    };
+    bucket(DefPairs, DefStart, DefBlocks);
+    bucket(UsePairs, UseStart, UseBlocks);
+
+    // Walking the registers in order keeps every list sorted.
+    LiveIn.assign(NumBlocks, {});
+    LiveOut.assign(NumBlocks, {});
+    std::vector<Register> DefMark(NumBlocks, NoRegister), InMark(NumBlocks, NoRegister),
+        OutMark(NumBlocks, NoRegister);
+    std::vector<unsigned> Worklist;
+    for (Register R = 0; R < NumRegs; ++R) {
+        if (UseStart[R] == UseStart[R + 1]) continue;
+        for (unsigned i = DefStart[R]; i < DefStart[R + 1]; ++i) DefMark[DefBlocks[i]] = R;
+        for (unsigned i = UseStart[R]; i < UseStart[R + 1]; ++i) {
+            unsigned N = UseBlocks[i];
+            InMark[N] = R;
+            LiveIn[N].push_back(R);
+            Worklist.push_back(N);
+        }
+        while (!Worklist.empty()) {
+            unsigned N = Worklist.back();
+            Worklist.pop_back();
+            for (unsigned P : Preds[N]) {
+                if (OutMark[P] == R) continue;
+                OutMark[P] = R;
+                LiveOut[P].push_back(R);
+                if (DefMark[P] == R || InMark[P] == R) continue;
+                InMark[P] = R;
+                LiveIn[P].push_back(R);
+                Worklist.push_back(P);
+            }
+        }
+    }
+}
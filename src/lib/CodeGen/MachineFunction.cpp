@@ -0,0 +1,95 @@
+#include "CodeGen/MachineFunction.h"
+#include <iostream>
+
+using namespace sysy;
+
+MachineBasicBlock *MachineInstr::getTarget() const {
+    for (const MachineOperand &MO : Operands) {
+        if (MO.isBlock()) return MO.getBlock();
+    }
+    return nullptr;
+}
+
+bool MachineInstr::isRematerializable() const {
+    if (Operands.empty() || !Operands[0].isDef() || mayLoad() || isCall()) return false;
+    for (const MachineOperand &MO : Operands) {
+        if (MO.isUse() && MO.getReg() != RISCV::ZERO) return false;
+        if (MO.isFrameIndex() || MO.isSymbol()) return false;
+    }
+    return true;
+}
+
+void MachineInstr::dump() const { print(std::cerr); }
+
+MachineBasicBlock::~MachineBasicBlock() {
+    while (!Insts.empty()) erase(Insts.front());
+}
+
+MachineInstr *MachineBasicBlock::insert(MachineInstr *Pos, MachineInstr *MI) {
+    assert(!MI->Parent && "instruction is already in a block");
+    Insts.insert(Pos, MI);
+    MI->Parent = this;
+    return MI;
+}
+
+void MachineBasicBlock::remove(MachineInstr *MI) {
+    Insts.remove(MI);
+    MI->Parent = nullptr;
+}
+
+void MachineBasicBlock::erase(MachineInstr *MI) {
+    remove(MI);
+    delete MI;
+}
+
+MachineInstr *MachineBasicBlock::getFirstTerminator() const {
+    MachineInstr *First = nullptr;
+    for (MachineInstr *MI = back(); MI && MI->isTerminator(); MI = MI->getPrevNode()) First = MI;
+    return First;
+}
+
+MachineBasicBlock *MachineBasicBlock::getNextBlock() const { return Parent->getBlock(Number + 1); }
+
+bool MachineBasicBlock::canFallThrough() const {
+    return empty() || (!back()->isJump() && !back()->isReturn());
+}
+
+std::vector<MachineBasicBlock *> MachineBasicBlock::getSuccessors() const {
+    std::vector<MachineBasicBlock *> Succs;
+    auto Add = [&](MachineBasicBlock *BB) {
+        for (MachineBasicBlock *S : Succs) {
+            if (S == BB) return;
+        }
+        Succs.push_back(BB);
+    };
+    for (MachineInstr *MI = getFirstTerminator(); MI; MI = MI->getNextNode()) {
+        if (MachineBasicBlock *Target = MI->getTarget()) Add(Target);
+    }
+    if (canFallThrough()) {
+        if (MachineBasicBlock *Next = getNextBlock()) Add(Next);
+    }
+    return Succs;
+}
+
+MachineBasicBlock *MachineFunction::createBlock(std::string BlockName, MachineBasicBlock *Pos) {
+    auto MBB = std::make_unique<MachineBasicBlock>(this, std::move(BlockName));
+    MachineBasicBlock *Raw = MBB.get();
+    size_t Idx = Pos ? Pos->getNumber() : Blocks.size();
+    Blocks.insert(Blocks.begin() + Idx, std::move(MBB));
+    for (size_t i = Idx; i < Blocks.size(); ++i) Blocks[i]->Number = static_cast<unsigned>(i);
+    return Raw;
+}
+
+void MachineFunction::eraseBlock(MachineBasicBlock *MBB) {
+    size_t Idx = MBB->getNumber();
+    Blocks.erase(Blocks.begin() + Idx);
+    for (size_t i = Idx; i < Blocks.size(); ++i) Blocks[i]->Number = static_cast<unsigned>(i);
+}
+
+size_t MachineFunction::getInstructionCount() const {
+    size_t N = 0;
+    for (const auto &MBB : Blocks) N += MBB->size();
+    return N;
+}
+
+void MachineFunction::dump() const { print(std::cerr); }
@@ -0,0 +1,235 @@
+#include "CodeGen/Peephole.h"
+#include "Basic/Statistic.h"
+#include "CodeGen/MachineFunction.h"
+
+using namespace sysy;
+using namespace RISCV;
+
+STATISTIC(NumIdentityCopies, "peephole", "Number of copies of a register to itself deleted");
+STATISTIC(NumIdentityArith, "peephole", "Number of additions of zero and the like turned into copies");
+STATISTIC(NumStoreReloads, "peephole", "Number of reloads of a value just stored turned into copies");
+STATISTIC(NumBranchesInverted, "peephole", "Number of branches over a jump inverted");
+STATISTIC(NumRedundantCopies, "peephole", "Number of copies of a value already in place deleted");
+STATISTIC(NumLoadsForwarded, "peephole", "Number of loads of a value still in a register removed");
+
+namespace {
+
+// What a rule did to the instruction it was given.
+enum class Action { None, Rewritten, Erased };
+
+struct PeepholeRule {
+    Action (*Apply)(MachineInstr &MI);
+    Statistic *Hits;
+};
+
+void turnIntoCopy(MachineInstr &MI, Register Dst, Register Src) {
+    const MachineFunction &MF = *MI.getParent()->getParent();
+    MI.setOpcode(MF.getRegClass(Dst) == RegClass::FPR ? FMV_S : MV);
+    while (MI.getNumOperands()) MI.removeOperand(MI.getNumOperands() - 1);
+    MI.addOperand(MachineOperand::createReg(Dst, true));
+    MI.addOperand(MachineOperand::createReg(Src));
+}
+
+// The store a load reads back, opcode for opcode.
+Opcode getMatchingStore(Opcode Load) {
+    switch (Load) {
+    case LW: return SW;
+    case LD: return SD;
+    case FLW: return FSW;
+    default: assert(Load == FLD); return FSD;
+    }
+}
+
+bool isSameAddress(const MachineInstr &A, const MachineInstr &B) {
+    const MachineOperand &BaseA = A.getOperand(1), &BaseB = B.getOperand(1);
+    if (A.getOperand(2).getImm() != B.getOperand(2).getImm() || BaseA.getKind() != BaseB.getKind()) return false;
+    if (BaseA.isFrameIndex()) return BaseA.getFrameIndex() == BaseB.getFrameIndex();
+    return BaseA.isReg() && BaseA.getReg() == BaseB.getReg();
+}
+
+//   mv a0, a0   =>   (nothing)
+Action removeIdentityCopy(MachineInstr &MI) {
+    if (!MI.isCopy() || MI.getOperand(0).getReg() != MI.getOperand(1).getReg()) return Action::None;
+    MI.getParent()->erase(&MI);
+    return Action::Erased;
+}
+
+//   addiw a0, a1, 0   =>   mv a0, a1
+//   add a0, a1, zero  =>   mv a0, a1
+// The *W forms also sign-extend from bit 31, which i32 values already are.
+Action simplifyIdentityArith(MachineInstr &MI) {
+    Format F = MI.getFormat();
+    if ((F != Format::RRR && F != Format::RRI) || !MI.getOperand(1).isReg()) return Action::None;
+    Register Dst = MI.getOperand(0).getReg(), LHS = MI.getOperand(1).getReg();
+    const MachineOperand &RHS = MI.getOperand(2);
+    switch (MI.getOpcode()) {
+    case ADDI:
+    case ADDIW:
+    case ORI:
+    case XORI:
+    case SLLI:
+    case SRLI:
+    case SRAI:
+    case SLLIW:
+    case SRLIW:
+    case SRAIW:
+        if (RHS.getImm() != 0) return Action::None;
+        turnIntoCopy(MI, Dst, LHS);
+        return Action::Rewritten;
+    case ADD:
+    case ADDW:
+    case OR:
+    case XOR:
+        if (LHS == ZERO) {
+            turnIntoCopy(MI, Dst, RHS.getReg());
+            return Action::Rewritten;
+        }
+        [[fallthrough]];
+    case SUB:
+    case SUBW:
+    case SLL:
+    case SRL:
+    case SRA:
+    case SLLW:
+    case SRLW:
+    case SRAW:
+        if (RHS.getReg() != ZERO) return Action::None;
+        turnIntoCopy(MI, Dst, LHS);
+        return Action::Rewritten;
+    default: return Action::None;
+    }
+}
+
+//   sw a0, 4(sp)        sw a0, 4(sp)
+//   lw a1, 4(sp)   =>   mv a1, a0
+Action forwardStoreToReload(MachineInstr &MI) {
+    MachineInstr *Prev = MI.getPrevNode();
+    if (!MI.mayLoad() || !Prev || Prev->getOpcode() != getMatchingStore(MI.getOpcode()) || !isSameAddress(*Prev, MI))
+        return Action::None;
+    turnIntoCopy(MI, MI.getOperand(0).getReg(), Prev->getOperand(0).getReg());
+    return Action::Rewritten;
+}
+
+//   blt a0, a1, .L1        bge a0, a1, .L2
+//   j .L2             =>
+// .L1:                   .L1:
+Action invertBranchOverJump(MachineInstr &MI) {
+    MachineBasicBlock *MBB = MI.getParent();
+    MachineInstr *Br = MI.getPrevNode();
+    if (!MI.isJump() || &MI != MBB->back() || !Br || !Br->isBranch() || Br->getTarget() != MBB->getNextBlock())
+        return Action::None;
+    Br->setOpcode(getInvertedBranch(Br->getOpcode()));
+    Br->getOperand(2).setBlock(MI.getTarget());
+    MBB->erase(&MI);
+    return Action::Erased;
+}
+
+// Tried in order on each instruction, and again on an instruction a rule
+// rewrote.
+const PeepholeRule Rules[] = {
+    {removeIdentityCopy, &NumIdentityCopies},
+    {simplifyIdentityArith, &NumIdentityArith},
+    {forwardStoreToReload, &NumStoreReloads},
+    {invertBranchOverJump, &NumBranchesInverted},
+};
+constexpr unsigned NumRules = sizeof(Rules) / sizeof(Rules[0]);
+
+} // namespace
+
+void sysy::runPeepholes(MachineFunction &MF) {
+    uint64_t Hits[NumRules] = {};
+    for (MachineBasicBlock &MBB : MF) {
+        for (MachineInstr *MI = MBB.front(), *Next; MI; MI = Next) {
+            Next = MI->getNextNode();
+            Action A = Action::Rewritten;
+            while (A == Action::Rewritten) {
+                A = Action::None;
+                for (unsigned i = 0; i < NumRules && A == Action::None; ++i) {
+                    A = Rules[i].Apply(*MI);
+                    if (A != Action::None) ++Hits[i];
+                }
+            }
+        }
+    }
+    for (unsigned i = 0; i < NumRules; ++i) *Rules[i].Hits += Hits[i];
+}
+
+void sysy::propagateCopies(MachineFunction &MF) {
+    // Value numbers count up through the function; those below BlockStart
+    // were given out in other blocks and mean nothing here.
+    struct SlotValue {
+        int64_t Offset;
+        Opcode Store;
+        unsigned Value;
+    };
+    std::vector<unsigned> ValueOf(FirstVirtualReg + MF.getNumVirtualRegs(), 0);
+    std::vector<SlotValue> Slots(MF.getNumFrameObjects(), SlotValue{0, SW, 0});
+    std::vector<Register> Holder = {NoRegister}; // A register with each value
+    unsigned BlockStart = 0;
+    auto define = [&](Register R) {
+        ValueOf[R] = static_cast<unsigned>(Holder.size());
+        Holder.push_back(R);
+    };
+    auto getValue = [&](Register R) {
+        if (ValueOf[R] < BlockStart) define(R);
+        return ValueOf[R];
+    };
+    // Give \p R the value \p V, which some other register may still hold.
+    auto assign = [&](Register R, unsigned V) {
+        if (ValueOf[Holder[V]] != V) Holder[V] = R;
+        ValueOf[R] = V;
+    };
+    uint64_t CopiesRemoved = 0, LoadsForwarded = 0;
+
+    for (MachineBasicBlock &MBB : MF) {
+        BlockStart = static_cast<unsigned>(Holder.size());
+        for (MachineInstr *MI = MBB.front(), *Next; MI; MI = Next) {
+            Next = MI->getNextNode();
+            if (MI->isCopy()) {
+                Register Dst = MI->getOperand(0).getReg();
+                unsigned V = getValue(MI->getOperand(1).getReg());
+                if (ValueOf[Dst] == V) {
+                    MBB.erase(MI);
+                    ++CopiesRemoved;
+                    continue;
+                }
+                assign(Dst, V);
+                continue;
+            }
+            if ((MI->mayLoad() || MI->mayStore()) && MI->getOperand(1).isFrameIndex()) {
+                SlotValue &Slot = Slots[MI->getOperand(1).getFrameIndex()];
+                int64_t Offset = MI->getOperand(2).getImm();
+                Register R = MI->getOperand(0).getReg();
+                if (MI->mayStore()) {
+                    Slot = {Offset, MI->getOpcode(), getValue(R)};
+                    continue;
+                }
+                if (Slot.Value < BlockStart || Slot.Offset != Offset || Slot.Store != getMatchingStore(MI->getOpcode())) {
+                    define(R);
+                    Slot = {Offset, getMatchingStore(MI->getOpcode()), ValueOf[R]};
+                    continue;
+                }
+                unsigned V = Slot.Value;
+                if (ValueOf[R] == V) {
+                    MBB.erase(MI);
+                    ++LoadsForwarded;
+                    continue;
+                }
+                if (ValueOf[Holder[V]] == V) {
+                    turnIntoCopy(*MI, R, Holder[V]);
+                    ++LoadsForwarded;
+                }
+                assign(R, V);
+                continue;
+            }
+            for (const MachineOperand &MO : *MI) {
+                if (MO.isDef()) define(MO.getReg());
+            }
+            if (MI->isCall()) {
+                for (Register R : getCallClobberedRegs()) define(R);
+            }
+        }
+    }
+    NumRedundantCopies += CopiesRemoved;
+    NumLoadsForwarded += LoadsForwarded;
+}
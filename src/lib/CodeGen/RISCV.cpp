@@ -0,0 +1,87 @@
+#include "CodeGen/RISCV.h"
+#include <cassert>
+#include <vector>
+
+using namespace sysy;
+
+const char *RISCV::getMnemonic(Opcode Op) {
+    switch (Op) {
+#define HANDLE_MINST(Name, Mnemonic, Format, Sched) case Name: return Mnemonic;
+#include "CodeGen/RISCVInstrInfo.def"
+    }
+    return "<invalid>";
+}
+
+RISCV::Format RISCV::getFormat(Opcode Op) {
+    switch (Op) {
+#define HANDLE_MINST(Name, Mnemonic, Fmt, Sched) case Name: return Format::Fmt;
+#include "CodeGen/RISCVInstrInfo.def"
+    }
+    return Format::None;
+}
+
+RISCV::SchedClass RISCV::getSchedClass(Opcode Op) {
+    switch (Op) {
+#define HANDLE_MINST(Name, Mnemonic, Format, Sched) case Name: return SchedClass::Sched;
+#include "CodeGen/RISCVInstrInfo.def"
+    }
+    return SchedClass::IntALU;
+}
+
+RISCV::Opcode RISCV::getInvertedBranch(Opcode Br) {
+    switch (Br) {
+    case BEQ: return BNE;
+    case BNE: return BEQ;
+    case BLT: return BGE;
+    default: assert(Br == BGE && "not a branch"); return BLT;
+    }
+}
+
+const char *RISCV::getRegName(Register R) {
+    static const char *const Names[] = {
+        "zero", "ra",  "sp",  "gp",  "tp",  "t0",   "t1",   "t2",  "s0",  "s1",  "a0",
+        "a1",   "a2",  "a3",  "a4",  "a5",  "a6",   "a7",   "s2",  "s3",  "s4",  "s5",
+        "s6",   "s7",  "s8",  "s9",  "s10", "s11",  "t3",   "t4",  "t5",  "t6",
+        "ft0",  "ft1", "ft2", "ft3", "ft4", "ft5",  "ft6",  "ft7", "fs0", "fs1", "fa0",
+        "fa1",  "fa2", "fa3", "fa4", "fa5", "fa6",  "fa7",  "fs2", "fs3", "fs4", "fs5",
+        "fs6",  "fs7", "fs8", "fs9", "fs10", "fs11", "ft8", "ft9", "ft10", "ft11",
+    };
+    return R < FirstVirtualReg ? Names[R] : "<vreg>";
+}
+
+bool RISCV::isCalleeSaved(Register R) {
+    return R == S0 || R == S1 || (R >= S2 && R <= S11) ||
+           R == FS0 || R == FS1 || (R >= FS2 && R <= FS11);
+}
+
+bool RISCV::isCallClobbered(Register R) {
+    return R < FirstVirtualReg && R != ZERO && R != SP && R != GP && R != TP && !isCalleeSaved(R);
+}
+
+ArrayRef<Register> RISCV::getCallClobberedRegs() {
+    static const std::vector<Register> Regs = [] {
+        std::vector<Register> V;
+        for (Register R = 0; R < FirstVirtualReg; ++R) {
+            if (isCallClobbered(R) && isAllocatable(R)) V.push_back(R);
+        }
+        return V;
+    }();
+    return ArrayRef<Register>(Regs.data(), Regs.size());
+}
+
+bool RISCV::isAllocatable(Register R) {
+    return R < FirstVirtualReg && R != ZERO && R != RA && R != SP && R != GP && R != TP && R != ScratchReg;
+}
+
+ArrayRef<Register> RISCV::getAllocationOrder(RegClass RC) {
+    static const Register GPRs[] = {
+        A0, A1, A2, A3, A4, A5, A6, A7, T0, T1, T2, T3, T4, T5,
+        S0, S1, S2, S3, S4, S5, S6, S7, S8, S9, S10, S11,
+    };
+    static const Register FPRs[] = {
+        FA0, FA1, FA2, FA3, FA4, FA5, FA6, FA7, FT0, FT1, FT2, FT3, FT4, FT5, FT6, FT7, FT8, FT9, FT10, FT11,
+        FS0, FS1, FS2, FS3, FS4, FS5, FS6, FS7, FS8, FS9, FS10, FS11,
+    };
+    if (RC == RegClass::GPR) return ArrayRef<Register>(GPRs, sizeof(GPRs) / sizeof(GPRs[0]));
+    return ArrayRef<Register>(FPRs, sizeof(FPRs) / sizeof(FPRs[0]));
+}
@@ -0,0 +1,122 @@
+#include "CodeGen/RegAlloc.h"
+#include "Basic/Statistic.h"
+#include "CodeGen/MachineFunction.h"
+#include <algorithm>
+
+using namespace sysy;
+
+STATISTIC(NumReloads, "regalloc", "Number of reloads inserted");
+STATISTIC(NumSpills, "regalloc", "Number of spills inserted");
+STATISTIC(NumRemats, "regalloc", "Number of constants rematerialized");
+STATISTIC(NumCopiesRemoved, "regalloc", "Number of copies deleted after allocation");
+
+std::vector<Register> sysy::spillRegisters(MachineFunction &MF, const std::vector<Register> &Regs) {
+    using namespace RISCV;
+    // Per spilled register: its constant definition, or its stack slot.
+    std::vector<bool> Spilled(MF.getNumVirtualRegs());
+    std::vector<MachineInstr *> Remat(MF.getNumVirtualRegs());
+    std::vector<unsigned> NumDefs(MF.getNumVirtualRegs());
+    std::vector<int> Slots(MF.getNumVirtualRegs(), -1);
+    for (Register R : Regs) Spilled[R - FirstVirtualReg] = true;
+    for (MachineBasicBlock &MBB : MF) {
+        for (MachineInstr &MI : MBB) {
+            for (MachineOperand &MO : MI) {
+                if (!MO.isDef() || !isVirtualReg(MO.getReg()) || !Spilled[MO.getReg() - FirstVirtualReg]) continue;
+                unsigned Idx = MO.getReg() - FirstVirtualReg;
+                if (++NumDefs[Idx] == 1 && MI.isRematerializable()) Remat[Idx] = &MI;
+                else Remat[Idx] = nullptr;
+            }
+        }
+    }
+
+    std::vector<Register> NewRegs;
+    for (MachineBasicBlock &MBB : MF) {
+        for (MachineInstr *MI = MBB.front(), *Next; MI; MI = Next) {
+            Next = MI->getNextNode();
+            // The rematerialized definitions themselves go away.
+            if (MI->getNumOperands() && MI->getOperand(0).isDef()) {
+                Register D = MI->getOperand(0).getReg();
+                if (isVirtualReg(D) && Remat[D - FirstVirtualReg] == MI) {
+                    MBB.remove(MI);
+                    continue;
+                }
+            }
+            // One fresh register per spilled register in this instruction,
+            // for both its uses and its def.
+            std::vector<std::pair<Register, Register>> Temps;
+            auto getTemp = [&](Register R, bool &IsNew) {
+                IsNew = false;
+                for (auto &[Old, New] : Temps) {
+                    if (Old == R) return New;
+                }
+                IsNew = true;
+                Register New = MF.createVirtualRegister(MF.getRegClass(R));
+                Temps.push_back({R, New});
+                NewRegs.push_back(New);
+                return New;
+            };
+            auto getSlot = [&](Register R) {
+                int &FI = Slots[R - FirstVirtualReg];
+                if (FI < 0) FI = MF.createStackObject(4, 4);
+                return MachineOperand::createFrameIndex(FI);
+            };
+            auto isSpilled = [&](const MachineOperand &MO) {
+                return MO.isReg() && isVirtualReg(MO.getReg()) && Spilled[MO.getReg() - FirstVirtualReg];
+            };
+            for (MachineOperand &MO : *MI) {
+                if (!MO.isUse() || !isSpilled(MO)) continue;
+                Register R = MO.getReg();
+                bool IsNew;
+                Register T = getTemp(R, IsNew);
+                MO.setReg(T);
+                if (!IsNew) continue;
+                if (MachineInstr *Def = Remat[R - FirstVirtualReg]) {
+                    std::vector<MachineOperand> Ops(Def->begin(), Def->end());
+                    Ops[0].setReg(T);
+                    MBB.insert(MI, new MachineInstr(Def->getOpcode(), std::move(Ops)));
+                    ++NumRemats;
+                    continue;
+                }
+                bool IsFloat = MF.getRegClass(R) == RegClass::FPR;
+                MBB.insert(MI, new MachineInstr(IsFloat ? FLW : LW, {MachineOperand::createReg(T, true), getSlot(R),
+                                                                     MachineOperand::createImm(0)}));
+                ++NumReloads;
+            }
+            for (MachineOperand &MO : *MI) {
+                if (!MO.isDef() || !isSpilled(MO)) continue;
+                Register R = MO.getReg();
+                bool IsNew;
+                Register T = getTemp(R, IsNew);
+                MO.setReg(T);
+                bool IsFloat = MF.getRegClass(R) == RegClass::FPR;
+                MBB.insert(Next, new MachineInstr(IsFloat ? FSW : SW, {MachineOperand::createReg(T), getSlot(R),
+                                                                       MachineOperand::createImm(0)}));
+                ++NumSpills;
+            }
+        }
+    }
+    for (MachineInstr *Def : Remat) delete Def;
+    return NewRegs;
+}
+
+void sysy::rewriteVirtualRegisters(MachineFunction &MF, const std::vector<Register> &Assignment) {
+    std::vector<Register> Saved;
+    for (MachineBasicBlock &MBB : MF) {
+        for (MachineInstr *MI = MBB.front(), *Next; MI; MI = Next) {
+            Next = MI->getNextNode();
+            for (MachineOperand &MO : *MI) {
+                if (!MO.isReg()) continue;
+                Register R = MO.getReg();
+                if (isVirtualReg(R)) MO.setReg(R = Assignment[R - FirstVirtualReg]);
+                if (MO.isDef() && RISCV::isCalleeSaved(R)) Saved.push_back(R);
+            }
+            if (MI->isCopy() && MI->getOperand(0).getReg() == MI->getOperand(1).getReg()) {
+                MBB.erase(MI);
+                ++NumCopiesRemoved;
+            }
+        }
+    }
+    std::sort(Saved.begin(), Saved.end());
+    Saved.erase(std::unique(Saved.begin(), Saved.end()), Saved.end());
+    MF.setSavedRegs(std::move(Saved));
+}
@@ -0,0 +1,504 @@
+#include "CodeGen/RegAlloc.h"
+#include "Basic/Statistic.h"
+#include "CodeGen/Liveness.h"
+#include <unordered_set>
+
+using namespace sysy;
+
+STATISTIC(NumCoalesced, "regalloc", "Number of copies coalesced");
+STATISTIC(NumSpilledRegs, "regalloc", "Number of virtual registers spilled");
+STATISTIC(NumColoringRounds, "regalloc", "Number of graph coloring rounds");
+
+namespace {
+
+// The worklists of "Iterated Register Coalescing" (George and Appel, 1996),
+// with Appel's names. Nodes are registers: the allocatable physical ones
+// are precolored, the virtual ones get colored. A node is on the list its
+// state names; lists are cleaned lazily, so an entry whose node has moved
+// on is skipped.
+//
+// Precolored nodes keep no adjacency lists (as in the paper) nor move
+// lists, and a virtual register's precolored neighbours are a bit mask
+// rather than edges: a value live across a call interferes with some 40
+// registers, and large functions make hundreds of thousands of calls.
+class GraphColoring {
+    enum NodeState : unsigned char {
+        Precolored, Initial, SimplifyList, FreezeList, SpillList, Spilled, Coalesced, Colored, OnStack,
+    };
+    enum MoveState : unsigned char { WorklistMove, ActiveMove, CoalescedMove, ConstrainedMove, FrozenMove };
+    struct Move {
+        Register Dst, Src;
+    };
+
+    MachineFunction &MF;
+    const std::vector<bool> &NoSpill; // Spill temporaries, by virtual register
+    unsigned NumRegs;
+
+    // Edges between virtual registers: a triangular bit matrix, or for
+    // functions too large for one, a hash set.
+    std::vector<uint64_t> AdjMatrix;
+    std::unordered_set<uint64_t> AdjSet;
+    std::vector<std::vector<Register>> AdjList; // Virtual neighbours
+    std::vector<uint64_t> PhysAdj; // Precolored neighbours
+    std::vector<unsigned> Degree;
+    std::vector<NodeState> State;
+    std::vector<Register> Alias, Color;
+    std::vector<double> SpillCost;
+    std::vector<Register> SimplifyWorklist, FreezeWorklist, SpillWorklist, SelectStack;
+
+    std::vector<Move> Moves;
+    std::vector<MoveState> MoveStates;
+    std::vector<unsigned> WorklistMoves;
+    std::vector<std::vector<unsigned>> MoveList;
+
+    std::vector<unsigned> Mark; // For isConservative(), stamped with MarkEpoch
+    unsigned MarkEpoch = 0;
+
+    // The live registers while building: O(1) updates and iteration over
+    // just the members.
+    std::vector<Register> Living;
+    std::vector<unsigned> LivingPos;
+
+    /// Test for the edge between virtual registers \p U and \p V, and
+    /// with \p Insert, add it.
+    bool findEdge(Register U, Register V, bool Insert);
+    bool isPrecolored(Register N) const { return State[N] == Precolored; }
+    unsigned getK(Register N) const {
+        return static_cast<unsigned>(RISCV::getAllocationOrder(MF.getRegClass(N)).size());
+    }
+
+    bool interferes(Register U, Register V);
+    void addEdge(Register U, Register V);
+    void setLive(Register R);
+    void resetLive(Register R);
+    void build(const MachineLiveness &Live);
+    void makeWorklist();
+    template <typename Fn> void forEachAdjacent(Register N, Fn F);
+    template <typename Fn> void forEachNodeMove(Register N, Fn F);
+    bool isMoveRelated(Register N);
+    void decrementDegree(Register M);
+    void enableMoves(Register N);
+    void addWorklist(Register U);
+    bool isOK(Register T, Register R);
+    bool isConservative(Register U, Register V);
+    Register getAlias(Register N);
+    void combine(Register U, Register V);
+    void simplify();
+    void coalesce();
+    void freeze();
+    void freezeMoves(Register U);
+    void selectSpill();
+    void assignColors(std::vector<Register> &SpilledNodes);
+
+public:
+    GraphColoring(MachineFunction &MF, const std::vector<bool> &NoSpill) : MF(MF), NoSpill(NoSpill) {}
+
+    /// Color the current code; returns the registers that must be spilled,
+    /// or fills \p Assignment if there are none.
+    std::vector<Register> run(std::vector<Register> &Assignment);
+};
+
+bool GraphColoring::interferes(Register U, Register V) {
+    if (isPrecolored(U)) return PhysAdj[V] >> U & 1;
+    if (isPrecolored(V)) return PhysAdj[U] >> V & 1;
+    return findEdge(U, V, false);
+}
+
+bool GraphColoring::findEdge(Register U, Register V, bool Insert) {
+    if (U < V) std::swap(U, V);
+    uint64_t I = U - FirstVirtualReg, J = V - FirstVirtualReg;
+    if (AdjMatrix.empty()) {
+        uint64_t Key = I << 32 | J;
+        return Insert ? !AdjSet.insert(Key).second : AdjSet.count(Key) != 0;
+    }
+    uint64_t Bit = I * (I - 1) / 2 + J;
+    uint64_t &Word = AdjMatrix[Bit / 64], Mask = uint64_t(1) << (Bit % 64);
+    bool Found = Word & Mask;
+    if (Insert) Word |= Mask;
+    return Found;
+}
+
+void GraphColoring::addEdge(Register U, Register V) {
+    if (U == V || MF.getRegClass(U) != MF.getRegClass(V)) return;
+    if (isPrecolored(U)) std::swap(U, V);
+    if (isPrecolored(U)) return;
+    if (isPrecolored(V)) {
+        if (PhysAdj[U] >> V & 1) return;
+        PhysAdj[U] |= uint64_t(1) << V;
+        ++Degree[U];
+        return;
+    }
+    if (findEdge(U, V, true)) return;
+    AdjList[U].push_back(V);
+    ++Degree[U];
+    AdjList[V].push_back(U);
+    ++Degree[V];
+}
+
+void GraphColoring::setLive(Register R) {
+    if (LivingPos[R] != ~0u) return;
+    LivingPos[R] = static_cast<unsigned>(Living.size());
+    Living.push_back(R);
+}
+
+void GraphColoring::resetLive(Register R) {
+    unsigned Pos = LivingPos[R];
+    if (Pos == ~0u) return;
+    Living[Pos] = Living.back();
+    LivingPos[Living[Pos]] = Pos;
+    Living.pop_back();
+    LivingPos[R] = ~0u;
+}
+
+// A def interferes with everything live after it; a copy's source is
+// exempt, so that the copy can be coalesced.
+void GraphColoring::build(const MachineLiveness &Live) {
+    uint64_t CallClobbers[2] = {0, 0}; // By register class
+    for (Register R : RISCV::getCallClobberedRegs())
+        CallClobbers[RISCV::getRegClass(R) == RegClass::FPR] |= uint64_t(1) << R;
+    LivingPos.assign(NumRegs, ~0u);
+    for (MachineBasicBlock &MBB : MF) {
+        double Weight = 1;
+        for (unsigned d = 0; d < MBB.getLoopDepth() && d < 8; ++d) Weight *= 10;
+        for (Register R : Live.getLiveOut(&MBB)) setLive(R);
+        for (MachineInstr *MI = MBB.back(); MI; MI = MI->getPrevNode()) {
+            for (const MachineOperand &MO : *MI) {
+                if (MO.isReg() && isVirtualReg(MO.getReg())) SpillCost[MO.getReg()] += Weight;
+            }
+            if (MI->isCopy() && isTrackedReg(MI->getOperand(1).getReg())) {
+                Register Dst = MI->getOperand(0).getReg(), Src = MI->getOperand(1).getReg();
+                resetLive(Src);
+                unsigned Idx = static_cast<unsigned>(Moves.size());
+                Moves.push_back({Dst, Src});
+                MoveStates.push_back(WorklistMove);
+                WorklistMoves.push_back(Idx);
+                if (!isPrecolored(Dst)) MoveList[Dst].push_back(Idx);
+                if (!isPrecolored(Src)) MoveList[Src].push_back(Idx);
+            }
+            // The clobbers of a call, in bulk; then its operands.
+            if (MI->isCall()) {
+                for (Register L : Living) {
+                    if (isPrecolored(L)) continue;
+                    uint64_t New = CallClobbers[MF.getRegClass(L) == RegClass::FPR] & ~PhysAdj[L];
+                    PhysAdj[L] |= New;
+                    Degree[L] += static_cast<unsigned>(__builtin_popcountll(New));
+                }
+            }
+            for (const MachineOperand &MO : *MI) {
+                if (MO.isDef() && isTrackedReg(MO.getReg())) setLive(MO.getReg());
+            }
+            for (const MachineOperand &MO : *MI) {
+                if (!MO.isDef() || !isTrackedReg(MO.getReg())) continue;
+                for (Register L : Living) addEdge(L, MO.getReg());
+            }
+            forEachDef(*MI, [&](Register D) { resetLive(D); });
+            forEachUse(*MI, [&](Register U) { setLive(U); });
+        }
+        while (!Living.empty()) resetLive(Living.back());
+    }
+}
+
+void GraphColoring::makeWorklist() {
+    for (Register N = FirstVirtualReg; N < NumRegs; ++N) {
+        if (Degree[N] >= getK(N)) {
+            State[N] = SpillList;
+            SpillWorklist.push_back(N);
+        } else if (isMoveRelated(N)) {
+            State[N] = FreezeList;
+            FreezeWorklist.push_back(N);
+        } else {
+            State[N] = SimplifyList;
+            SimplifyWorklist.push_back(N);
+        }
+    }
+}
+
+template <typename Fn> void GraphColoring::forEachAdjacent(Register N, Fn F) {
+    for (Register M : AdjList[N]) {
+        if (State[M] != OnStack && State[M] != Coalesced) F(M);
+    }
+}
+
+template <typename Fn> void GraphColoring::forEachNodeMove(Register N, Fn F) {
+    for (unsigned M : MoveList[N]) {
+        if (MoveStates[M] == ActiveMove || MoveStates[M] == WorklistMove) F(M);
+    }
+}
+
+bool GraphColoring::isMoveRelated(Register N) {
+    for (unsigned M : MoveList[N]) {
+        if (MoveStates[M] == ActiveMove || MoveStates[M] == WorklistMove) return true;
+    }
+    return false;
+}
+
+void GraphColoring::decrementDegree(Register M) {
+    if (isPrecolored(M)) return;
+    if (Degree[M]-- != getK(M)) return;
+    enableMoves(M);
+    forEachAdjacent(M, [&](Register N) { enableMoves(N); });
+    if (State[M] != SpillList) return;
+    if (isMoveRelated(M)) {
+        State[M] = FreezeList;
+        FreezeWorklist.push_back(M);
+    } else {
+        State[M] = SimplifyList;
+        SimplifyWorklist.push_back(M);
+    }
+}
+
+void GraphColoring::enableMoves(Register N) {
+    forEachNodeMove(N, [&](unsigned M) {
+        if (MoveStates[M] != ActiveMove) return;
+        MoveStates[M] = WorklistMove;
+        WorklistMoves.push_back(M);
+    });
+}
+
+void GraphColoring::addWorklist(Register U) {
+    if (isPrecolored(U) || isMoveRelated(U) || Degree[U] >= getK(U)) return;
+    if (State[U] != FreezeList) return;
+    State[U] = SimplifyList;
+    SimplifyWorklist.push_back(U);
+}
+
+// George: coalescing V into precolored R is safe if every neighbour of V
+// is insignificant or already interferes with R.
+bool GraphColoring::isOK(Register T, Register R) {
+    return Degree[T] < getK(T) || isPrecolored(T) || interferes(T, R);
+}
+
+// Briggs: the combined node has fewer than K significant neighbours.
+bool GraphColoring::isConservative(Register U, Register V) {
+    unsigned K = getK(U);
+    unsigned Significant = static_cast<unsigned>(__builtin_popcountll(PhysAdj[U] | PhysAdj[V]));
+    ++MarkEpoch;
+    auto Count = [&](Register N) {
+        if (Mark[N] == MarkEpoch) return;
+        Mark[N] = MarkEpoch;
+        if (Degree[N] >= K) ++Significant;
+    };
+    forEachAdjacent(U, Count);
+    forEachAdjacent(V, Count);
+    return Significant < K;
+}
+
+Register GraphColoring::getAlias(Register N) {
+    while (State[N] == Coalesced) N = Alias[N];
+    return N;
+}
+
+void GraphColoring::combine(Register U, Register V) {
+    State[V] = Coalesced;
+    Alias[V] = U;
+    if (!isPrecolored(U)) MoveList[U].insert(MoveList[U].end(), MoveList[V].begin(), MoveList[V].end());
+    enableMoves(V);
+    forEachAdjacent(V, [&](Register T) {
+        addEdge(T, U);
+        decrementDegree(T);
+    });
+    if (!isPrecolored(U)) {
+        for (uint64_t Bits = PhysAdj[V]; Bits; Bits &= Bits - 1)
+            addEdge(static_cast<Register>(__builtin_ctzll(Bits)), U);
+    }
+    if (!isPrecolored(U) && Degree[U] >= getK(U) && State[U] == FreezeList) {
+        State[U] = SpillList;
+        SpillWorklist.push_back(U);
+    }
+    // Spilling U now spills V's uses and defs as well.
+    SpillCost[U] += SpillCost[V];
+}
+
+void GraphColoring::simplify() {
+    Register N = SimplifyWorklist.back();
+    SimplifyWorklist.pop_back();
+    if (State[N] != SimplifyList) return;
+    State[N] = OnStack;
+    SelectStack.push_back(N);
+    forEachAdjacent(N, [&](Register M) { decrementDegree(M); });
+}
+
+void GraphColoring::coalesce() {
+    unsigned M = WorklistMoves.back();
+    WorklistMoves.pop_back();
+    if (MoveStates[M] != WorklistMove) return;
+    Register X = getAlias(Moves[M].Src), Y = getAlias(Moves[M].Dst);
+    Register U = X, V = Y;
+    if (isPrecolored(Y)) std::swap(U, V);
+    if (U == V) {
+        MoveStates[M] = CoalescedMove;
+        addWorklist(U);
+        return;
+    }
+    if (isPrecolored(V) || interferes(U, V)) {
+        MoveStates[M] = ConstrainedMove;
+        addWorklist(U);
+        addWorklist(V);
+        return;
+    }
+    bool Safe;
+    if (isPrecolored(U)) {
+        Safe = true;
+        forEachAdjacent(V, [&](Register T) { Safe &= isOK(T, U); });
+    } else {
+        Safe = isConservative(U, V);
+    }
+    if (!Safe) {
+        MoveStates[M] = ActiveMove;
+        return;
+    }
+    MoveStates[M] = CoalescedMove;
+    ++NumCoalesced;
+    combine(U, V);
+    addWorklist(U);
+}
+
+void GraphColoring::freeze() {
+    Register U = FreezeWorklist.back();
+    FreezeWorklist.pop_back();
+    if (State[U] != FreezeList) return;
+    State[U] = SimplifyList;
+    SimplifyWorklist.push_back(U);
+    freezeMoves(U);
+}
+
+void GraphColoring::freezeMoves(Register U) {
+    forEachNodeMove(U, [&](unsigned M) {
+        Register X = Moves[M].Src, Y = Moves[M].Dst;
+        Register V = getAlias(Y) == getAlias(U) ? getAlias(X) : getAlias(Y);
+        MoveStates[M] = FrozenMove;
+        if (State[V] != FreezeList || isMoveRelated(V) || Degree[V] >= getK(V)) return;
+        State[V] = SimplifyList;
+        SimplifyWorklist.push_back(V);
+    });
+}
+
+// Spill the node that is cheapest per interference it removes: uses and
+// defs weighted by 10^loop depth over degree. Constants are cheap, as
+// they are recomputed instead of reloaded; spill temporaries are never
+// picked while anything else is left.
+void GraphColoring::selectSpill() {
+    size_t Best = 0;
+    double BestCost = 0;
+    size_t Out = 0;
+    for (size_t i = 0; i < SpillWorklist.size(); ++i) {
+        Register N = SpillWorklist[i];
+        if (State[N] != SpillList) continue;
+        SpillWorklist[Out] = N;
+        double Cost = SpillCost[N] / Degree[N];
+        if (NoSpill[N - FirstVirtualReg]) Cost += 1e30;
+        if (Out == 0 || Cost < BestCost) {
+            Best = Out;
+            BestCost = Cost;
+        }
+        ++Out;
+    }
+    SpillWorklist.resize(Out);
+    if (Out == 0) return;
+    Register M = SpillWorklist[Best];
+    SpillWorklist.erase(SpillWorklist.begin() + static_cast<std::ptrdiff_t>(Best));
+    State[M] = SimplifyList;
+    SimplifyWorklist.push_back(M);
+    freezeMoves(M);
+}
+
+// Take the register of a copy partner if it is free, to leave a copy of a
+// register to itself; otherwise the first free one in allocation order.
+void GraphColoring::assignColors(std::vector<Register> &SpilledNodes) {
+    while (!SelectStack.empty()) {
+        Register N = SelectStack.back();
+        SelectStack.pop_back();
+        uint64_t Used = PhysAdj[N];
+        for (Register W : AdjList[N]) {
+            Register A = getAlias(W);
+            if (State[A] == Colored || State[A] == Precolored) Used |= uint64_t(1) << Color[A];
+        }
+        Register Choice = NoRegister;
+        for (unsigned M : MoveList[N]) {
+            Register Other = getAlias(Moves[M].Src) == N ? getAlias(Moves[M].Dst) : getAlias(Moves[M].Src);
+            if (State[Other] != Colored && State[Other] != Precolored) continue;
+            if (!(Used >> Color[Other] & 1)) {
+                Choice = Color[Other];
+                break;
+            }
+        }
+        if (Choice == NoRegister) {
+            for (Register R : RISCV::getAllocationOrder(MF.getRegClass(N))) {
+                if (!(Used >> R & 1)) {
+                    Choice = R;
+                    break;
+                }
+            }
+        }
+        if (Choice == NoRegister) {
+            State[N] = Spilled;
+            SpilledNodes.push_back(N);
+            continue;
+        }
+        State[N] = Colored;
+        Color[N] = Choice;
+    }
+}
+
+std::vector<Register> GraphColoring::run(std::vector<Register> &Assignment) {
+    MachineLiveness Live(MF);
+    NumRegs = Live.getNumRegs();
+    AdjList.assign(NumRegs, {});
+    PhysAdj.assign(NumRegs, 0);
+    uint64_t NumVRegs = MF.getNumVirtualRegs();
+    if (NumVRegs <= 4096) AdjMatrix.assign(NumVRegs * (NumVRegs - 1) / 128 + 1, 0);
+    Degree.assign(NumRegs, 0);
+    State.assign(NumRegs, Initial);
+    Alias.assign(NumRegs, NoRegister);
+    Color.assign(NumRegs, NoRegister);
+    SpillCost.assign(NumRegs, 0);
+    MoveList.assign(NumRegs, {});
+    Mark.assign(NumRegs, 0);
+    for (Register R = 0; R < FirstVirtualReg; ++R) {
+        if (!RISCV::isAllocatable(R)) continue;
+        State[R] = Precolored;
+        Color[R] = R;
+        Degree[R] = ~0u / 2;
+    }
+
+    build(Live);
+    // Recomputing a constant costs about as much as a reload, but saves
+    // the store.
+    for (MachineBasicBlock &MBB : MF) {
+        for (MachineInstr &MI : MBB) {
+            if (MI.isRematerializable() && isVirtualReg(MI.getOperand(0).getReg()))
+                SpillCost[MI.getOperand(0).getReg()] *= 0.5;
+        }
+    }
+    makeWorklist();
+    for (;;) {
+        if (!SimplifyWorklist.empty()) simplify();
+        else if (!WorklistMoves.empty()) coalesce();
+        else if (!FreezeWorklist.empty()) freeze();
+        else if (!SpillWorklist.empty()) selectSpill();
+        else break;
+    }
+    std::vector<Register> SpilledNodes;
+    assignColors(SpilledNodes);
+    if (!SpilledNodes.empty()) return SpilledNodes;
+
+    Assignment.resize(MF.getNumVirtualRegs());
+    for (Register N = FirstVirtualReg; N < NumRegs; ++N) Assignment[N - FirstVirtualReg] = Color[getAlias(N)];
+    return {};
+}
+
+} // namespace
+
+void sysy::allocateRegistersGraphColoring(MachineFunction &MF) {
+    std::vector<bool> NoSpill(MF.getNumVirtualRegs());
+    std::vector<Register> Assignment;
+    for (;;) {
+        ++NumColoringRounds;
+        std::vector<Register> Spills = GraphColoring(MF, NoSpill).run(Assignment);
+        if (Spills.empty()) break;
+        NumSpilledRegs += Spills.size();
+        spillRegisters(MF, Spills);
+        NoSpill.resize(MF.getNumVirtualRegs(), true);
+    }
+    rewriteVirtualRegisters(MF, Assignment);
+}
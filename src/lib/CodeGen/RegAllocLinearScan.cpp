@@ -0,0 +1,177 @@
+#include "CodeGen/RegAlloc.h"
+#include "Basic/Statistic.h"
+#include "CodeGen/Liveness.h"
+#include <algorithm>
+
+using namespace sysy;
+
+STATISTIC(NumIntervalsSpilled, "regalloc", "Number of live intervals spilled");
+
+namespace {
+
+// Instructions are numbered by twos in layout order: an instruction at P
+// reads its operands at P and writes its results at P + 1, so a register
+// can be both the last use and the def of one instruction.
+struct Interval {
+    unsigned Start, End; // Inclusive
+    Register Reg;
+};
+
+class LinearScan {
+    MachineFunction &MF;
+    const std::vector<bool> &NoSpill;
+    std::vector<Interval> Intervals; // One per virtual register that occurs
+    // Where each allocatable physical register is busy (live, or clobbered
+    // by a call), as sorted disjoint ranges.
+    std::vector<std::vector<std::pair<unsigned, unsigned>>> Fixed;
+
+    void computeIntervals();
+    bool isFixedFree(Register R, const Interval &I) const;
+
+public:
+    LinearScan(MachineFunction &MF, const std::vector<bool> &NoSpill) : MF(MF), NoSpill(NoSpill) {}
+
+    /// Scan the current code; returns the registers that must be spilled,
+    /// or fills \p Assignment if there are none.
+    std::vector<Register> run(std::vector<Register> &Assignment);
+};
+
+void LinearScan::computeIntervals() {
+    MachineLiveness Live(MF);
+    unsigned NumRegs = Live.getNumRegs();
+    std::vector<unsigned> Start(NumRegs, ~0u), End(NumRegs, 0);
+    auto extend = [&](Register R, unsigned P) {
+        Start[R] = std::min(Start[R], P);
+        End[R] = std::max(End[R], P);
+    };
+    Fixed.assign(FirstVirtualReg, {});
+    // The end of the range each live physical register is in, walking up.
+    std::vector<unsigned> FixedEnd(FirstVirtualReg, ~0u);
+
+    unsigned BlockStart = 0;
+    for (MachineBasicBlock &MBB : MF) {
+        unsigned BlockEnd = BlockStart + 2 * static_cast<unsigned>(MBB.size());
+        for (Register R : Live.getLiveOut(&MBB)) {
+            if (isVirtualReg(R)) extend(R, BlockEnd);
+            else FixedEnd[R] = BlockEnd;
+        }
+        for (Register R : Live.getLiveIn(&MBB)) {
+            if (isVirtualReg(R)) extend(R, BlockStart);
+        }
+        unsigned P = BlockEnd;
+        for (MachineInstr *MI = MBB.back(); MI; MI = MI->getPrevNode()) {
+            P -= 2;
+            forEachDef(*MI, [&](Register R) {
+                if (isVirtualReg(R)) {
+                    extend(R, P + 1);
+                    return;
+                }
+                unsigned E = FixedEnd[R] == ~0u ? P + 1 : FixedEnd[R];
+                Fixed[R].push_back({P + 1, E});
+                FixedEnd[R] = ~0u;
+            });
+            forEachUse(*MI, [&](Register R) {
+                if (isVirtualReg(R)) extend(R, P);
+                else if (FixedEnd[R] == ~0u) FixedEnd[R] = P;
+            });
+        }
+        for (Register R = 0; R < FirstVirtualReg; ++R) {
+            if (FixedEnd[R] == ~0u) continue;
+            Fixed[R].push_back({BlockStart, FixedEnd[R]});
+            FixedEnd[R] = ~0u;
+        }
+        BlockStart = BlockEnd;
+    }
+    // A call's result register is both an operand and clobbered, so ranges
+    // may overlap.
+    for (auto &Ranges : Fixed) {
+        std::sort(Ranges.begin(), Ranges.end());
+        size_t Out = 0;
+        for (const auto &Range : Ranges) {
+            if (Out && Range.first <= Ranges[Out - 1].second) {
+                Ranges[Out - 1].second = std::max(Ranges[Out - 1].second, Range.second);
+                continue;
+            }
+            Ranges[Out++] = Range;
+        }
+        Ranges.resize(Out);
+    }
+
+    Intervals.clear();
+    for (Register R = FirstVirtualReg; R < NumRegs; ++R) {
+        if (Start[R] != ~0u) Intervals.push_back({Start[R], End[R], R});
+    }
+    std::sort(Intervals.begin(), Intervals.end(),
+              [](const Interval &A, const Interval &B) { return A.Start < B.Start; });
+}
+
+bool LinearScan::isFixedFree(Register R, const Interval &I) const {
+    const auto &Ranges = Fixed[R];
+    // The first range ending at or after I starts.
+    auto It = std::lower_bound(Ranges.begin(), Ranges.end(), I.Start,
+                               [](const std::pair<unsigned, unsigned> &Range, unsigned P) { return Range.second < P; });
+    return It == Ranges.end() || It->first > I.End;
+}
+
+// Poletto and Sarkar: walk the intervals by start, freeing the registers
+// of the intervals that ended. With no register left, spill whichever of
+// the new interval and the active ones ends last, provided its register
+// suits the new one.
+std::vector<Register> LinearScan::run(std::vector<Register> &Assignment) {
+    computeIntervals();
+    Assignment.assign(MF.getNumVirtualRegs(), RISCV::ZERO);
+    std::vector<const Interval *> Active;
+    std::vector<Register> Spills;
+    for (const Interval &I : Intervals) {
+        uint64_t Used = 0;
+        size_t Out = 0;
+        for (const Interval *A : Active) {
+            if (A->End < I.Start) continue;
+            Active[Out++] = A;
+            Used |= uint64_t(1) << Assignment[A->Reg - FirstVirtualReg];
+        }
+        Active.resize(Out);
+
+        RegClass RC = MF.getRegClass(I.Reg);
+        Register Choice = NoRegister;
+        for (Register R : RISCV::getAllocationOrder(RC)) {
+            if (!(Used >> R & 1) && isFixedFree(R, I)) {
+                Choice = R;
+                break;
+            }
+        }
+        if (Choice != NoRegister) {
+            Assignment[I.Reg - FirstVirtualReg] = Choice;
+            Active.push_back(&I);
+            continue;
+        }
+
+        const Interval *Victim = NoSpill[I.Reg - FirstVirtualReg] ? nullptr : &I;
+        for (const Interval *A : Active) {
+            Register R = Assignment[A->Reg - FirstVirtualReg];
+            if (MF.getRegClass(A->Reg) != RC || NoSpill[A->Reg - FirstVirtualReg] || !isFixedFree(R, I)) continue;
+            if (!Victim || A->End > Victim->End) Victim = A;
+        }
+        if (!Victim) Victim = &I; // Cannot happen with a few temporaries per instruction
+        Spills.push_back(Victim->Reg);
+        ++NumIntervalsSpilled;
+        if (Victim == &I) continue;
+        Assignment[I.Reg - FirstVirtualReg] = Assignment[Victim->Reg - FirstVirtualReg];
+        std::replace(Active.begin(), Active.end(), Victim, &I);
+    }
+    return Spills;
+}
+
+} // namespace
+
+void sysy::allocateRegistersLinearScan(MachineFunction &MF) {
+    std::vector<bool> NoSpill(MF.getNumVirtualRegs());
+    std::vector<Register> Assignment;
+    for (;;) {
+        std::vector<Register> Spills = LinearScan(MF, NoSpill).run(Assignment);
+        if (Spills.empty()) break;
+        spillRegisters(MF, Spills);
+        NoSpill.resize(MF.getNumVirtualRegs(), true);
+    }
+    rewriteVirtualRegisters(MF, Assignment);
+}
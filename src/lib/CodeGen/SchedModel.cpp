@@ -0,0 +1,82 @@
+#include "CodeGen/SchedModel.h"
+
+using namespace sysy;
+
+namespace {
+
+using U = SchedUnit;
+
+// Latencies approximate the cores' documented figures. The dividers take a
+// variable number of cycles and are modeled at about their worst case.
+
+// SiFive U74 (and the other 7-series cores): dual issue, in order, with
+// two integer pipes of which only one loads and stores, multiplies or
+// branches.
+const SchedModel SiFiveU74 = {
+    "sifive-u74",
+    2,
+    // ALU LoadStore Mul Div FPU FPDiv Branch
+    {2, 1, 1, 1, 1, 1, 1},
+    {
+        {1, U::ALU, 1},        // IntALU
+        {3, U::Mul, 1},        // IntMul
+        {66, U::Div, 65},      // IntDiv
+        {3, U::LoadStore, 1},  // Load
+        {1, U::LoadStore, 1},  // Store
+        {5, U::FPU, 1},        // FPAdd
+        {5, U::FPU, 1},        // FPMul
+        {27, U::FPDiv, 26},    // FPDiv
+        {3, U::FPU, 1},        // FPMisc
+        {1, U::Branch, 1},     // Branch
+        {1, U::Branch, 1},     // Call
+    },
+};
+
+// Rocket: single issue, in order, five stages.
+const SchedModel Rocket = {
+    "rocket",
+    1,
+    // ALU LoadStore Mul Div FPU FPDiv Branch
+    {1, 1, 1, 1, 1, 1, 1},
+    {
+        {1, U::ALU, 1},        // IntALU
+        {4, U::Mul, 1},        // IntMul
+        {34, U::Div, 34},      // IntDiv
+        {3, U::LoadStore, 1},  // Load
+        {1, U::LoadStore, 1},  // Store
+        {4, U::FPU, 1},        // FPAdd
+        {4, U::FPU, 1},        // FPMul
+        {20, U::FPDiv, 20},    // FPDiv
+        {2, U::FPU, 1},        // FPMisc
+        {1, U::Branch, 1},     // Branch
+        {1, U::Branch, 1},     // Call
+    },
+};
+
+const SchedModel *const Models[] = {&SiFiveU74, &Rocket};
+
+// Indexed by RISCV::SchedClass.
+const char *const ClassNames[RISCV::NumSchedClasses] = {
+    "IntALU", "IntMul", "IntDiv", "Load",   "Store", "FPAdd",
+    "FPMul",  "FPDiv",  "FPMisc", "Branch", "Call",
+};
+
+} // namespace
+
+const SchedModel *sysy::findSchedModel(std::string_view CPU) {
+    for (const SchedModel *M : Models) {
+        if (CPU == M->Name) return M;
+    }
+    return nullptr;
+}
+
+const SchedModel &sysy::getDefaultSchedModel() { return SiFiveU74; }
+
+bool sysy::findSchedClass(std::string_view Name, RISCV::SchedClass &SC) {
+    for (unsigned i = 0; i < RISCV::NumSchedClasses; ++i) {
+        if (Name != ClassNames[i]) continue;
+        SC = static_cast<RISCV::SchedClass>(i);
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,559 @@
+#include "CodeGen/Scheduler.h"
+#include "Basic/ArrayRef.h"
+#include "Basic/Statistic.h"
+#include "CodeGen/Liveness.h"
+#include "CodeGen/SchedModel.h"
+#include <algorithm>
+#include <memory>
+
+using namespace sysy;
+
+STATISTIC(NumRegionsScheduled, "sched", "Number of regions reordered");
+STATISTIC(NumCyclesSaved, "sched", "Estimated cycles saved by scheduling");
+
+namespace {
+
+// Longer runs of instructions are scheduled in pieces of this size, which
+// bounds the cost of the dependence graph in huge blocks.
+constexpr unsigned MaxRegionSize = 256;
+
+constexpr unsigned None = ~0u;
+
+struct Edge {
+    unsigned From, To, Latency;
+};
+
+// An instruction of the region being scheduled. Its successors and
+// registers are ranges of arrays shared by the region, which saves
+// allocating for each of the many small regions.
+struct SUnit {
+    MachineInstr *MI;
+    const SchedModel::ClassInfo *Info;
+    unsigned SuccBegin = 0, SuccEnd = 0;
+    unsigned NumPreds = 0;
+    unsigned Height = 0; // Cycles from issue to the end of the region, at least
+    // Before register allocation only: the virtual registers read and
+    // written, without repeats.
+    unsigned UseBegin = 0, UseEnd = 0, DefBegin = 0, DefEnd = 0;
+    bool ReadsPhysReg = false, WritesPhysReg = false;
+
+    SUnit(MachineInstr *MI, const SchedModel::ClassInfo *Info) : MI(MI), Info(Info) {}
+};
+
+// Where a load or store goes: a frame index, or a base register and the
+// node that last wrote it in the region (the same register may hold
+// another address later on), plus an offset.
+struct MemLoc {
+    bool IsFrameIndex;
+    unsigned Base;
+    unsigned BaseDef;
+    int64_t Offset;
+    unsigned Size;
+};
+
+bool mayAlias(const MemLoc &A, const MemLoc &B) {
+    if (A.IsFrameIndex != B.IsFrameIndex) return true;
+    if (A.Base != B.Base || A.BaseDef != B.BaseDef) return !A.IsFrameIndex; // Stack objects are disjoint
+    return A.Offset < B.Offset + B.Size && B.Offset < A.Offset + A.Size;
+}
+
+unsigned getAccessSize(RISCV::Opcode Op) {
+    using namespace RISCV;
+    return Op == LD || Op == SD || Op == FLD || Op == FSD ? 8 : 4;
+}
+
+bool isSchedulingBoundary(const MachineInstr &MI) { return MI.isCall() || MI.isTerminator(); }
+
+unsigned classIndex(RegClass RC) { return RC == RegClass::GPR ? 0 : 1; }
+
+class Scheduler {
+    MachineFunction &MF;
+    const SchedModel &Model;
+    bool BeforeRA;
+    std::unique_ptr<MachineLiveness> Liveness; // Before register allocation
+    std::vector<SUnit> Units;
+    std::vector<Edge> Edges;  // Grouped by From once built
+    std::vector<Register> VRegs;
+
+    // Building the graph, indexed by register: the node that last wrote it
+    // and the list of the nodes that read it since, as (node, next) links.
+    // Touched lists what to reset.
+    std::vector<unsigned> LastDef, FirstRead;
+    std::vector<std::pair<unsigned, unsigned>> Reads;
+    std::vector<Register> Touched;
+    std::vector<std::pair<unsigned, MemLoc>> MemOps;
+
+    ArrayRef<Edge> getSuccs(const SUnit &SU) const { return {Edges.data() + SU.SuccBegin, SU.SuccEnd - SU.SuccBegin}; }
+    ArrayRef<Register> getVRegUses(const SUnit &SU) const { return {VRegs.data() + SU.UseBegin, SU.UseEnd - SU.UseBegin}; }
+    ArrayRef<Register> getVRegDefs(const SUnit &SU) const { return {VRegs.data() + SU.DefBegin, SU.DefEnd - SU.DefBegin}; }
+    template <typename Fn> void forEachRead(Register R, Fn F) const {
+        for (unsigned K = FirstRead[R]; K != None; K = Reads[K].second) F(Reads[K].first);
+    }
+    void addVReg(unsigned Begin, Register R) {
+        if (std::find(VRegs.begin() + Begin, VRegs.end(), R) == VRegs.end()) VRegs.push_back(R);
+    }
+
+    // Register pressure before register allocation, counting the virtual
+    // registers live at once by class. Live is maintained walking the
+    // block upwards; while an order is tried out, Open tracks the values
+    // live so far and Remaining the uses of each not yet placed.
+    std::vector<char> Live, LiveAfter, Open;
+    std::vector<unsigned> NumUses, Remaining;
+    std::vector<Register> LiveTouched;
+    int LiveCount[2] = {0, 0}, StartCount[2], Cur[2], Limit[2];
+
+    // The earliest cycle each unit instance is free, while timing an order;
+    // the instances of unit U start at UnitStart[U].
+    std::vector<unsigned> Busy;
+    unsigned UnitStart[NumSchedUnits + 1];
+
+    // Scratch space, kept from region to region.
+    std::vector<unsigned> EdgeStart, PredsLeft, ReadyCycle, Available;
+    std::vector<Edge> SortedEdges;
+
+    void addEdge(unsigned From, unsigned To, unsigned Latency);
+    MemLoc getMemLoc(const MachineInstr &MI) const;
+    void constrainCopy(unsigned Copy);
+    void buildGraph(const std::vector<MachineInstr *> &Region);
+
+    void stepBackward(const MachineInstr &MI);
+    void resetPressure();
+    void applyPressure(const SUnit &SU, int Delta[2], bool Commit);
+    int getExcess(const int Delta[2]) const;
+    int getMaxExcess(const std::vector<unsigned> &Order);
+
+    void resetUnits();
+    unsigned *findUnit(const SUnit &SU);
+    unsigned estimateCycles(const std::vector<unsigned> &Order);
+    bool isBetter(unsigned A, int ExcessA, unsigned B, int ExcessB) const;
+    std::vector<unsigned> listSchedule();
+    void sinkConstants(std::vector<unsigned> &Order) const;
+
+    void scheduleRegion(MachineBasicBlock &MBB, const std::vector<MachineInstr *> &Region);
+    void runOnBlock(MachineBasicBlock &MBB);
+
+public:
+    Scheduler(MachineFunction &MF, const SchedModel &Model, bool BeforeRA);
+    void run();
+};
+
+Scheduler::Scheduler(MachineFunction &MF, const SchedModel &Model, bool BeforeRA)
+    : MF(MF), Model(Model), BeforeRA(BeforeRA) {
+    unsigned NumRegs = FirstVirtualReg + MF.getNumVirtualRegs();
+    LastDef.assign(NumRegs, None);
+    FirstRead.assign(NumRegs, None);
+    UnitStart[0] = 0;
+    for (unsigned U = 0; U < NumSchedUnits; ++U) UnitStart[U + 1] = UnitStart[U] + std::max(1u, Model.NumUnits[U]);
+    Busy.resize(UnitStart[NumSchedUnits]);
+    if (!BeforeRA) return;
+    Liveness = std::make_unique<MachineLiveness>(MF);
+    Live.assign(NumRegs, 0);
+    LiveAfter.assign(NumRegs, 0);
+    Open.assign(NumRegs, 0);
+    NumUses.assign(NumRegs, 0);
+    Remaining.assign(NumRegs, 0);
+    // A few registers short of all the allocatable ones, which spill code
+    // and values the region does not see may need.
+    for (RegClass RC : {RegClass::GPR, RegClass::FPR})
+        Limit[classIndex(RC)] = static_cast<int>(RISCV::getAllocationOrder(RC).size()) - 4;
+}
+
+void Scheduler::addEdge(unsigned From, unsigned To, unsigned Latency) {
+    Edges.push_back({From, To, Latency});
+    ++Units[To].NumPreds;
+}
+
+// Loads and stores are laid out as: value, base, offset.
+MemLoc Scheduler::getMemLoc(const MachineInstr &MI) const {
+    const MachineOperand &Base = MI.getOperand(1);
+    unsigned Size = getAccessSize(MI.getOpcode());
+    int64_t Offset = MI.getOperand(2).getImm();
+    if (Base.isFrameIndex()) return {true, static_cast<unsigned>(Base.getFrameIndex()), None, Offset, Size};
+    return {false, Base.getReg(), LastDef[Base.getReg()], Offset, Size};
+}
+
+// For a copy "mv P, V" where V is computed in the region: V is about to
+// replace P (or what P was copied from), as when a loop variable is
+// updated, and the allocator wants all of them in one register so the
+// copies go away. That fails if V is computed while P, or the operands V
+// is computed from, are still read. So those reads go first.
+void Scheduler::constrainCopy(unsigned Copy) {
+    const MachineInstr &MI = *Units[Copy].MI;
+    Register P = MI.getOperand(0).getReg(), V = MI.getOperand(1).getReg();
+    unsigned Def = LastDef[V];
+    if (!isVirtualReg(P) || !isVirtualReg(V) || Def == None) return;
+    // Reads placed after the def already overlap with it; an edge back
+    // from them would make a cycle.
+    auto readsGoFirst = [&](Register R) {
+        forEachRead(R, [&](unsigned Reader) {
+            if (Reader < Def) addEdge(Reader, Def, 0);
+        });
+    };
+    readsGoFirst(P);
+    for (Register U : getVRegUses(Units[Def])) readsGoFirst(U);
+}
+
+void Scheduler::buildGraph(const std::vector<MachineInstr *> &Region) {
+    Units.clear();
+    Edges.clear();
+    VRegs.clear();
+    Reads.clear();
+    MemOps.clear();
+    for (MachineInstr *MI : Region)
+        Units.emplace_back(MI, &Model.getClassInfo(RISCV::getSchedClass(MI->getOpcode())));
+
+    for (unsigned i = 0; i < Units.size(); ++i) {
+        SUnit &SU = Units[i];
+        const MachineInstr &MI = *SU.MI;
+        SU.UseBegin = static_cast<unsigned>(VRegs.size());
+        for (const MachineOperand &MO : MI) {
+            if (!MO.isUse() || MO.getReg() == RISCV::ZERO) continue;
+            Register R = MO.getReg();
+            Touched.push_back(R);
+            if (LastDef[R] != None) addEdge(LastDef[R], i, Units[LastDef[R]].Info->Latency);
+            Reads.push_back({i, FirstRead[R]});
+            FirstRead[R] = static_cast<unsigned>(Reads.size() - 1);
+            if (!BeforeRA) continue;
+            if (!isVirtualReg(R)) SU.ReadsPhysReg |= RISCV::isAllocatable(R);
+            else addVReg(SU.UseBegin, R);
+        }
+        SU.UseEnd = static_cast<unsigned>(VRegs.size());
+        if (BeforeRA && MI.isCopy()) constrainCopy(i);
+        if (MI.mayLoad() || MI.mayStore()) {
+            MemLoc Loc = getMemLoc(MI);
+            for (const auto &[j, Other] : MemOps) {
+                const MachineInstr &OtherMI = *Units[j].MI;
+                if (!MI.mayStore() && !OtherMI.mayStore()) continue;
+                if (!mayAlias(Loc, Other)) continue;
+                addEdge(j, i, OtherMI.mayStore() && MI.mayLoad() ? Units[j].Info->Latency : 0);
+            }
+            MemOps.push_back({i, Loc});
+        }
+        SU.DefBegin = static_cast<unsigned>(VRegs.size());
+        for (const MachineOperand &MO : MI) {
+            if (!MO.isDef() || MO.getReg() == RISCV::ZERO) continue;
+            Register R = MO.getReg();
+            Touched.push_back(R);
+            forEachRead(R, [&](unsigned Reader) {
+                if (Reader != i) addEdge(Reader, i, 0);
+            });
+            if (LastDef[R] != None && LastDef[R] != i) addEdge(LastDef[R], i, 1);
+            LastDef[R] = i;
+            FirstRead[R] = None;
+            if (!BeforeRA) continue;
+            if (!isVirtualReg(R)) SU.WritesPhysReg |= RISCV::isAllocatable(R);
+            else addVReg(SU.DefBegin, R);
+        }
+        SU.DefEnd = static_cast<unsigned>(VRegs.size());
+    }
+    for (Register R : Touched) {
+        LastDef[R] = None;
+        FirstRead[R] = None;
+    }
+    Touched.clear();
+
+    // Group the edges by their source, in place.
+    EdgeStart.assign(Units.size() + 1, 0);
+    for (const Edge &E : Edges) ++EdgeStart[E.From + 1];
+    for (size_t i = 0; i < Units.size(); ++i) {
+        EdgeStart[i + 1] += EdgeStart[i];
+        Units[i].SuccBegin = EdgeStart[i];
+        Units[i].SuccEnd = EdgeStart[i + 1];
+    }
+    SortedEdges.resize(Edges.size());
+    for (const Edge &E : Edges) SortedEdges[EdgeStart[E.From]++] = E;
+    Edges.swap(SortedEdges);
+
+    // Edges only go forward, so one backward pass settles the heights.
+    for (unsigned i = static_cast<unsigned>(Units.size()); i-- > 0;) {
+        SUnit &SU = Units[i];
+        SU.Height = SU.Info->Latency;
+        for (const Edge &E : getSuccs(SU)) SU.Height = std::max(SU.Height, E.Latency + Units[E.To].Height);
+    }
+}
+
+void Scheduler::stepBackward(const MachineInstr &MI) {
+    for (const MachineOperand &MO : MI) {
+        if (!MO.isDef() || !isVirtualReg(MO.getReg()) || !Live[MO.getReg()]) continue;
+        Live[MO.getReg()] = 0;
+        --LiveCount[classIndex(MF.getRegClass(MO.getReg()))];
+    }
+    for (const MachineOperand &MO : MI) {
+        if (!MO.isUse() || !isVirtualReg(MO.getReg()) || Live[MO.getReg()]) continue;
+        Live[MO.getReg()] = 1;
+        ++LiveCount[classIndex(MF.getRegClass(MO.getReg()))];
+        LiveTouched.push_back(MO.getReg());
+    }
+}
+
+void Scheduler::resetPressure() {
+    for (Register R : VRegs) {
+        Open[R] = Live[R];
+        Remaining[R] = NumUses[R];
+    }
+    Cur[0] = StartCount[0];
+    Cur[1] = StartCount[1];
+}
+
+// How placing \p SU next changes the number of live values of each class:
+// the values it reads last close, the values it writes that are read
+// later open.
+void Scheduler::applyPressure(const SUnit &SU, int Delta[2], bool Commit) {
+    Delta[0] = Delta[1] = 0;
+    auto isClosedHere = [&](Register R) { return Open[R] && Remaining[R] == 1 && !LiveAfter[R]; };
+    ArrayRef<Register> Uses = getVRegUses(SU), Defs = getVRegDefs(SU);
+    for (Register R : Uses) {
+        if (isClosedHere(R)) --Delta[classIndex(MF.getRegClass(R))];
+    }
+    for (Register R : Defs) {
+        bool ReadHere = std::find(Uses.begin(), Uses.end(), R) != Uses.end();
+        bool IsOpen = Open[R] && !(ReadHere && isClosedHere(R));
+        bool ReadLater = Remaining[R] > (ReadHere ? 1u : 0u) || LiveAfter[R];
+        if (!IsOpen && ReadLater) ++Delta[classIndex(MF.getRegClass(R))];
+    }
+    if (!Commit) return;
+    for (Register R : Uses) {
+        if (isClosedHere(R)) Open[R] = 0;
+        --Remaining[R];
+    }
+    for (Register R : Defs) {
+        if (Remaining[R] > 0 || LiveAfter[R]) Open[R] = 1;
+    }
+    Cur[0] += Delta[0];
+    Cur[1] += Delta[1];
+}
+
+// By how many values the classes would go over their limits.
+int Scheduler::getExcess(const int Delta[2]) const {
+    return std::max(0, Cur[0] + Delta[0] - Limit[0]) + std::max(0, Cur[1] + Delta[1] - Limit[1]);
+}
+
+int Scheduler::getMaxExcess(const std::vector<unsigned> &Order) {
+    resetPressure();
+    int Max = 0, Delta[2];
+    for (unsigned N : Order) {
+        applyPressure(Units[N], Delta, true);
+        const int Zero[2] = {0, 0};
+        Max = std::max(Max, getExcess(Zero));
+    }
+    return Max;
+}
+
+void Scheduler::resetUnits() { std::fill(Busy.begin(), Busy.end(), 0); }
+
+// The instance of the unit \p SU needs that frees up first.
+unsigned *Scheduler::findUnit(const SUnit &SU) {
+    unsigned U = static_cast<unsigned>(SU.Info->Unit);
+    return std::min_element(Busy.data() + UnitStart[U], Busy.data() + UnitStart[U + 1]);
+}
+
+// Cycles for an in-order pipeline to issue \p Order and finish the results.
+unsigned Scheduler::estimateCycles(const std::vector<unsigned> &Order) {
+    resetUnits();
+    ReadyCycle.assign(Units.size(), 0);
+    unsigned Cycle = 0, Issued = 0, End = 0;
+    for (unsigned N : Order) {
+        const SUnit &SU = Units[N];
+        unsigned *Unit = findUnit(SU);
+        unsigned C = std::max({Cycle, ReadyCycle[N], *Unit});
+        if (C == Cycle && Issued == Model.IssueWidth) ++C;
+        if (C != Cycle) {
+            Cycle = C;
+            Issued = 0;
+        }
+        ++Issued;
+        *Unit = C + SU.Info->Occupancy;
+        End = std::max(End, C + SU.Info->Latency);
+        for (const Edge &E : getSuccs(SU)) ReadyCycle[E.To] = std::max(ReadyCycle[E.To], C + E.Latency);
+    }
+    return End;
+}
+
+bool Scheduler::isBetter(unsigned A, int ExcessA, unsigned B, int ExcessB) const {
+    const SUnit &UA = Units[A], &UB = Units[B];
+    if (BeforeRA) {
+        if (ExcessA != ExcessB) return ExcessA < ExcessB;
+        if (UA.ReadsPhysReg != UB.ReadsPhysReg) return UA.ReadsPhysReg;
+        if (UA.WritesPhysReg != UB.WritesPhysReg) return UB.WritesPhysReg;
+    }
+    if (UA.Height != UB.Height) return UA.Height > UB.Height;
+    return A < B;
+}
+
+// Top down, cycle by cycle: of the instructions whose operands are ready
+// and whose unit is free, issue the best, until the cycle is full or none
+// is left; then go on to the next cycle.
+std::vector<unsigned> Scheduler::listSchedule() {
+    unsigned N = static_cast<unsigned>(Units.size());
+    std::vector<unsigned> Order;
+    PredsLeft.resize(N);
+    ReadyCycle.assign(N, 0);
+    Available.clear();
+    for (unsigned i = 0; i < N; ++i) {
+        PredsLeft[i] = Units[i].NumPreds;
+        if (!PredsLeft[i]) Available.push_back(i);
+    }
+    if (BeforeRA) resetPressure();
+    resetUnits();
+    unsigned Cycle = 0, Issued = 0;
+    while (Order.size() < N) {
+        unsigned Best = None;
+        size_t BestPos = 0;
+        int BestExcess = 0, Delta[2];
+        if (Issued < Model.IssueWidth) {
+            for (size_t k = 0; k < Available.size(); ++k) {
+                unsigned C = Available[k];
+                if (ReadyCycle[C] > Cycle || *findUnit(Units[C]) > Cycle) continue;
+                int Excess = 0;
+                if (BeforeRA) {
+                    applyPressure(Units[C], Delta, false);
+                    Excess = getExcess(Delta);
+                }
+                if (Best == None || isBetter(C, Excess, Best, BestExcess)) {
+                    Best = C;
+                    BestPos = k;
+                    BestExcess = Excess;
+                }
+            }
+        }
+        if (Best == None) {
+            // On to the next cycle something can issue in; the dividers
+            // can keep everything waiting for dozens.
+            unsigned Next = None;
+            for (unsigned C : Available) Next = std::min(Next, std::max(ReadyCycle[C], *findUnit(Units[C])));
+            Cycle = std::max(Cycle + 1, Next);
+            Issued = 0;
+            continue;
+        }
+        const SUnit &SU = Units[Best];
+        Available.erase(Available.begin() + BestPos);
+        Order.push_back(Best);
+        ++Issued;
+        *findUnit(SU) = Cycle + SU.Info->Occupancy;
+        if (BeforeRA) applyPressure(SU, Delta, true);
+        for (const Edge &E : getSuccs(SU)) {
+            ReadyCycle[E.To] = std::max(ReadyCycle[E.To], Cycle + E.Latency);
+            if (--PredsLeft[E.To] == 0) Available.push_back(E.To);
+        }
+    }
+    return Order;
+}
+
+// Constants go back down to their first user: issued early to fill a
+// cycle they would only hold a register for longer, and once allocated
+// the second scheduling finds them a slot again.
+void Scheduler::sinkConstants(std::vector<unsigned> &Order) const {
+    std::vector<unsigned> Position(Order.size());
+    for (unsigned i = 0; i < Order.size(); ++i) Position[Order[i]] = i;
+    // Each sunk node goes before its first successor, or to the end if it
+    // has none, in scheduled order. One that must precede another constant
+    // stays.
+    std::vector<std::vector<unsigned>> Before(Order.size());
+    std::vector<unsigned> Rest, AtEnd;
+    for (unsigned N : Order) {
+        const SUnit &SU = Units[N];
+        unsigned First = None;
+        bool CanSink = SU.MI->isRematerializable();
+        for (const Edge &E : getSuccs(SU)) {
+            if (Units[E.To].MI->isRematerializable()) CanSink = false;
+            if (First == None || Position[E.To] < Position[First]) First = E.To;
+        }
+        if (!CanSink) Rest.push_back(N);
+        else if (First == None) AtEnd.push_back(N);
+        else Before[First].push_back(N);
+    }
+    Order.clear();
+    for (unsigned N : Rest) {
+        Order.insert(Order.end(), Before[N].begin(), Before[N].end());
+        Order.push_back(N);
+    }
+    Order.insert(Order.end(), AtEnd.begin(), AtEnd.end());
+}
+
+void Scheduler::scheduleRegion(MachineBasicBlock &MBB, const std::vector<MachineInstr *> &Region) {
+    buildGraph(Region);
+    if (BeforeRA) {
+        for (Register R : VRegs) {
+            LiveAfter[R] = Live[R];
+            NumUses[R] = 0;
+        }
+        for (const SUnit &SU : Units) {
+            for (Register R : getVRegUses(SU)) ++NumUses[R];
+        }
+        for (size_t i = Region.size(); i-- > 0;) stepBackward(*Region[i]);
+        StartCount[0] = LiveCount[0];
+        StartCount[1] = LiveCount[1];
+    }
+
+    std::vector<unsigned> Original(Units.size());
+    for (unsigned i = 0; i < Original.size(); ++i) Original[i] = i;
+    std::vector<unsigned> Order = listSchedule();
+    if (BeforeRA) sinkConstants(Order);
+    if (Order == Original) return;
+    unsigned Before = estimateCycles(Original), After = estimateCycles(Order);
+    if (After >= Before) return;
+    if (BeforeRA && getMaxExcess(Order) > getMaxExcess(Original)) return;
+
+    // What follows may be the region below, already reordered.
+    MachineInstr *InsertPos = Region.back()->getNextNode();
+    for (MachineInstr *MI : Region) MBB.remove(MI);
+    for (unsigned N : Order) MBB.insert(InsertPos, Units[N].MI);
+    ++NumRegionsScheduled;
+    NumCyclesSaved += Before - After;
+}
+
+void Scheduler::runOnBlock(MachineBasicBlock &MBB) {
+    std::vector<MachineInstr *> Insts;
+    for (MachineInstr &MI : MBB) Insts.push_back(&MI);
+    // The regions, as [Begin, End) positions in Insts.
+    std::vector<std::pair<size_t, size_t>> Regions;
+    for (size_t i = 0; i < Insts.size();) {
+        if (isSchedulingBoundary(*Insts[i])) {
+            ++i;
+            continue;
+        }
+        size_t j = i;
+        while (j < Insts.size() && j - i < MaxRegionSize && !isSchedulingBoundary(*Insts[j])) ++j;
+        if (j - i > 1) Regions.push_back({i, j});
+        i = j;
+    }
+    if (Regions.empty()) return;
+
+    if (BeforeRA) {
+        for (Register R : Liveness->getLiveOut(&MBB)) {
+            if (!isVirtualReg(R)) continue;
+            Live[R] = 1;
+            ++LiveCount[classIndex(MF.getRegClass(R))];
+            LiveTouched.push_back(R);
+        }
+    }
+    // Bottom up, so that the liveness walk reaches each region from below.
+    size_t Pos = Insts.size();
+    for (size_t k = Regions.size(); k-- > 0;) {
+        auto [Begin, End] = Regions[k];
+        if (BeforeRA) {
+            while (Pos > End) stepBackward(*Insts[--Pos]);
+        }
+        std::vector<MachineInstr *> Region(Insts.begin() + Begin, Insts.begin() + End);
+        scheduleRegion(MBB, Region);
+        Pos = Begin;
+    }
+    if (!BeforeRA) return;
+    for (Register R : LiveTouched) Live[R] = 0;
+    LiveTouched.clear();
+    LiveCount[0] = LiveCount[1] = 0;
+}
+
+void Scheduler::run() {
+    for (MachineBasicBlock &MBB : MF) runOnBlock(MBB);
+}
+
+} // namespace
+
+void sysy::scheduleBeforeRegAlloc(MachineFunction &MF, const SchedModel &Model) {
+    Scheduler(MF, Model, true).run();
+}
+
+void sysy::scheduleAfterRegAlloc(MachineFunction &MF, const SchedModel &Model) {
+    Scheduler(MF, Model, false).run();
+}
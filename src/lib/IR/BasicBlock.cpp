@@ -0,0 +1,130 @@
+#include "IR/BasicBlock.h"
+#include "IR/Function.h"
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+
+using namespace sysy;
+
+BasicBlock::~BasicBlock() {
+    assert(!Parent && "deleting a block that is still in a function");
+    for (Instruction &I : InstList) I.dropAllReferences();
+    while (!InstList.empty()) {
+        Instruction *I = InstList.back();
+        InstList.remove(I);
+        I->Parent = nullptr;
+        delete I;
+    }
+}
+
+Instruction *BasicBlock::getTerminator() const {
+    Instruction *Last = InstList.back();
+    return Last && Last->isTerminator() ? Last : nullptr;
+}
+
+Instruction *BasicBlock::getFirstNonPhi() const {
+    for (Instruction &I : InstList) {
+        if (!isa<PhiInst>(&I)) return &I;
+    }
+    return nullptr;
+}
+
+unsigned BasicBlock::getNumSuccessors() const {
+    auto *Br = dyn_cast_or_null<BranchInst>(getTerminator());
+    return Br ? Br->getNumSuccessors() : 0;
+}
+
+BasicBlock *BasicBlock::getSuccessor(unsigned i) const {
+    return cast<BranchInst>(getTerminator())->getSuccessor(i);
+}
+
+std::vector<BasicBlock *> BasicBlock::getSuccessors() const {
+    std::vector<BasicBlock *> Succs;
+    for (unsigned i = 0, e = getNumSuccessors(); i != e; ++i) Succs.push_back(getSuccessor(i));
+    return Succs;
+}
+
+std::vector<BasicBlock *> BasicBlock::getPredecessors() const {
+    std::vector<BasicBlock *> Preds;
+    for (Use &U : uses()) {
+        Instruction *I = U.getUser();
+        if (!I->isTerminator() || !I->getParent()) continue;
+        if (std::find(Preds.begin(), Preds.end(), I->getParent()) == Preds.end())
+            Preds.push_back(I->getParent());
+    }
+    return Preds;
+}
+
+BasicBlock *BasicBlock::getSinglePredecessor() const {
+    BasicBlock *Pred = nullptr;
+    for (Use &U : uses()) {
+        Instruction *I = U.getUser();
+        if (!I->isTerminator() || !I->getParent()) continue;
+        if (Pred && Pred != I->getParent()) return nullptr;
+        Pred = I->getParent();
+    }
+    return Pred;
+}
+
+BasicBlock *BasicBlock::getSingleSuccessor() const {
+    unsigned N = getNumSuccessors();
+    if (N == 0) return nullptr;
+    BasicBlock *Succ = getSuccessor(0);
+    return N == 1 || getSuccessor(1) == Succ ? Succ : nullptr;
+}
+
+void BasicBlock::removePredecessor(BasicBlock *Pred) {
+    for (Instruction &I : InstList) {
+        auto *Phi = dyn_cast<PhiInst>(&I);
+        if (!Phi) break;
+        int Idx = Phi->getBasicBlockIndex(Pred);
+        if (Idx >= 0) Phi->removeIncoming(static_cast<unsigned>(Idx));
+    }
+}
+
+void BasicBlock::replacePhiUsesWith(BasicBlock *Old, BasicBlock *New) {
+    for (unsigned s = 0, e = getNumSuccessors(); s != e; ++s) {
+        for (Instruction &I : *getSuccessor(s)) {
+            auto *Phi = dyn_cast<PhiInst>(&I);
+            if (!Phi) break;
+            for (unsigned i = 0, n = Phi->getNumIncomingValues(); i != n; ++i) {
+                if (Phi->getIncomingBlock(i) == Old) Phi->setIncomingBlock(i, New);
+            }
+        }
+    }
+}
+
+BasicBlock *BasicBlock::splitBasicBlock(Instruction *I, std::string NewName) {
+    assert(I->getParent() == this && getTerminator() && "cannot split here");
+    auto *New = new BasicBlock(NewName.empty() ? Name + ".split" : std::move(NewName));
+    New->insertInto(Parent, getNextNode());
+    while (I) {
+        Instruction *Next = I->getNextNode();
+        I->removeFromParent();
+        New->push_back(I);
+        I = Next;
+    }
+    New->replacePhiUsesWith(this, New);
+    push_back(new BranchInst(New));
+    return New;
+}
+
+void BasicBlock::insertInto(Function *F, BasicBlock *Pos) {
+    assert(!Parent && "block is already in a function");
+    F->Blocks.insert(Pos, this);
+    Parent = F;
+}
+
+void BasicBlock::removeFromParent() {
+    Parent->Blocks.remove(this);
+    Parent = nullptr;
+}
+
+void BasicBlock::eraseFromParent() {
+    for (Instruction &I : InstList) I.dropAllReferences();
+    assert(use_empty() && "erasing a block that is still a branch target");
+    if (Parent) removeFromParent();
+    delete this;
+}
+
+void BasicBlock::dump() const { print(std::cerr); }
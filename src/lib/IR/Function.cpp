@@ -0,0 +1,112 @@
+#include "IR/Function.h"
+#include <cstring>
+#include <iostream>
+#include <unordered_set>
+
+using namespace sysy;
+
+Function::Function(std::string Name, Type RetTy, const std::vector<Type> &ParamTys)
+    : Name(std::move(Name)), RetTy(RetTy) {
+    for (unsigned i = 0; i < ParamTys.size(); ++i)
+        Args.push_back(std::make_unique<Argument>(ParamTys[i], this, i));
+}
+
+Function::~Function() {
+    // Instructions may refer to each other (and to blocks) in any order.
+    for (BasicBlock &BB : Blocks) {
+        for (Instruction &I : BB) I.dropAllReferences();
+    }
+    while (!Blocks.empty()) {
+        BasicBlock *BB = Blocks.front();
+        Blocks.remove(BB);
+        BB->Parent = nullptr;
+        delete BB;
+    }
+}
+
+ConstantInt *Function::getInt32(int32_t V) {
+    auto &Slot = Int32Constants[V];
+    if (!Slot) Slot.reset(new ConstantInt(Type::I32, V));
+    return Slot.get();
+}
+
+ConstantInt *Function::getBool(bool V) {
+    auto &Slot = BoolConstants[V];
+    if (!Slot) Slot.reset(new ConstantInt(Type::I1, V));
+    return Slot.get();
+}
+
+ConstantFloat *Function::getFloat(float V) {
+    uint32_t Bits;
+    std::memcpy(&Bits, &V, sizeof(Bits));
+    auto &Slot = FloatConstants[Bits];
+    if (!Slot) Slot.reset(new ConstantFloat(V));
+    return Slot.get();
+}
+
+UndefValue *Function::getUndef(Type T) {
+    unsigned Idx;
+    switch (T) {
+    case Type::I1: Idx = 0; break;
+    case Type::I32: Idx = 1; break;
+    case Type::F32: Idx = 2; break;
+    default: Idx = 3; break;
+    }
+    if (!Undefs[Idx]) Undefs[Idx].reset(new UndefValue(T));
+    return Undefs[Idx].get();
+}
+
+Value *Function::getZeroValue(Type T) {
+    switch (T) {
+    case Type::I1: return getBool(false);
+    case Type::F32: return getFloat(0.0f);
+    default: return getInt32(0);
+    }
+}
+
+unsigned Function::removeUnreachableBlocks() {
+    if (Blocks.empty()) return 0;
+    std::unordered_set<BasicBlock *> Reachable;
+    std::vector<BasicBlock *> Worklist{getEntryBlock()};
+    Reachable.insert(getEntryBlock());
+    while (!Worklist.empty()) {
+        BasicBlock *BB = Worklist.back();
+        Worklist.pop_back();
+        for (unsigned i = 0, e = BB->getNumSuccessors(); i != e; ++i) {
+            BasicBlock *Succ = BB->getSuccessor(i);
+            if (Reachable.insert(Succ).second) Worklist.push_back(Succ);
+        }
+    }
+    if (Reachable.size() == Blocks.size()) return 0;
+
+    std::vector<BasicBlock *> Dead;
+    for (BasicBlock &BB : Blocks) {
+        if (!Reachable.count(&BB)) Dead.push_back(&BB);
+    }
+    for (BasicBlock *BB : Dead) {
+        for (unsigned i = 0, e = BB->getNumSuccessors(); i != e; ++i) {
+            BasicBlock *Succ = BB->getSuccessor(i);
+            if (Reachable.count(Succ)) Succ->removePredecessor(BB);
+        }
+    }
+    for (BasicBlock *BB : Dead) {
+        for (Instruction &I : *BB) I.dropAllReferences();
+    }
+    // Reachable code cannot depend on a dead definition, except through
+    // (already removed) phi entries or other dead code; be safe anyway.
+    for (BasicBlock *BB : Dead) {
+        for (Instruction &I : *BB) {
+            if (!I.use_empty()) I.replaceAllUsesWith(getUndef(I.getType()));
+        }
+    }
+    for (BasicBlock *BB : Dead) BB->eraseFromParent();
+    return static_cast<unsigned>(Dead.size());
+}
+
+size_t Function::getInstructionCount() const {
+    size_t N = 0;
+    for (BasicBlock &BB : Blocks) N += BB.size();
+    return N;
+}
+
+void Function::dump() const { print(std::cerr); }
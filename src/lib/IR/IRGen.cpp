@@ -0,0 +1,371 @@
+#include "IR/IRGen.h"
+#include "Basic/ThreadPool.h"
+#include <atomic>
+#include <cassert>
+#include <iostream>
+
+using namespace sysy;
+
+Type IRGen::getIRType(tok::TokenKind K) {
+    switch (K) {
+        case tok::kw_int: return Type::I32;
+        case tok::kw_float: return Type::F32;
+        default: return Type::Void;
+    }
+}
+
+void IRGen::error(const char *Msg) {
+    ++NumErrors;
+    std::cerr << "Error: " << Msg << " in function '" << CurFn->getName() << "'" << std::endl;
+}
+
+Function *IRGen::getCallee(Symbol Name) {
+    std::string_view N = Name.getName();
+    if (Function *F = M.getFunction(N)) return F;
+#define BUILTIN(Name, RetType, ParamType)                                              \
+    if (N == #Name) {                                                                  \
+        std::vector<Type> ParamTys;                                                    \
+        if (tok::ParamType != tok::kw_void) ParamTys.push_back(getIRType(tok::ParamType)); \
+        return M.getOrInsertFunction(#Name, getIRType(tok::RetType), ParamTys);        \
+    }
+#include "Basic/Builtins.def"
+    return nullptr;
+}
+
+Value *IRGen::toBool(Value *V) {
+    switch (V->getType()) {
+        case Type::I1: return V;
+        case Type::Void:
+            error("void value not ignored as it ought to be");
+            return CurFn->getUndef(Type::I1);
+        case Type::F32: return Builder.createFCmp(CmpInst::NE, V, Builder.getFloat(0.0f));
+        default: return Builder.createICmp(CmpInst::NE, V, Builder.getInt32(0));
+    }
+}
+
+Value *IRGen::convertTo(Value *V, Type T) {
+    Type From = V->getType();
+    if (From == T) return V;
+    if (From == Type::Void) {
+        error("void value not ignored as it ought to be");
+        return CurFn->getUndef(T);
+    }
+    if (T == Type::I1) return toBool(V);
+    if (From == Type::I1) {
+        V = Builder.createCast(Opcode::ZExt, V, Type::I32);
+        return T == Type::I32 ? V : Builder.createCast(Opcode::SIToFP, V, Type::F32);
+    }
+    if (From == Type::I32 && T == Type::F32) return Builder.createCast(Opcode::SIToFP, V, T);
+    if (From == Type::F32 && T == Type::I32) return Builder.createCast(Opcode::FPToSI, V, T);
+    error("invalid conversion");
+    return CurFn->getUndef(T);
+}
+
+AllocaInst *IRGen::createEntryAlloca(Type T) {
+    auto *A = new AllocaInst(T);
+    if (LastAlloca) A->insertAfter(LastAlloca);
+    else A->insertInto(CurFn->getEntryBlock(), CurFn->getEntryBlock()->front());
+    LastAlloca = A;
+    return A;
+}
+
+void IRGen::startBlock(BasicBlock *BB) {
+    CurFn->push_back(BB);
+    Builder.setInsertPoint(BB);
+}
+
+void IRGen::declareFunctions(CompUnitAST &CU) {
+    for (ASTNode *Child : CU.getChildren()) {
+        auto *FD = dynamic_cast<FuncDefAST *>(Child);
+        if (!FD) continue;
+        std::vector<Type> ParamTys;
+        for (auto *Param : FD->getParams()) ParamTys.push_back(getIRType(Param->getType()));
+        M.createFunction(std::string(FD->getName().getName()), getIRType(FD->getRetType()), ParamTys);
+    }
+}
+
+void IRGen::visit(CompUnitAST &node) {
+    declareFunctions(node);
+    for (auto &child : node.getChildren()) {
+        child->accept(*this);
+    }
+    M.sortDeclarations();
+}
+
+void IRGen::visit(FuncDefAST &node) {
+    Type RetTy = getIRType(node.getRetType());
+    CurFn = M.getFunction(node.getName().getName());
+    assert(CurFn && CurFn->isDeclaration() && "function not declared up front");
+    LastAlloca = nullptr;
+    startBlock(new BasicBlock("entry"));
+
+    // The parameters and the outermost locals share one scope, as in Semant.
+    Locals.enterScope();
+    for (unsigned i = 0; i < CurFn->getNumArgs(); ++i) {
+        AllocaInst *Slot = createEntryAlloca(CurFn->getArg(i)->getType());
+        Locals.insert(node.getParams()[i]->getName(), Slot);
+        Builder.createStore(CurFn->getArg(i), Slot);
+    }
+    if (node.getBody()) {
+        for (auto &item : node.getBody()->getItems()) item->accept(*this);
+    }
+    Locals.exitScope();
+
+    // Falling off the end: C only allows it for void functions (and main,
+    // which returns 0); return zero rather than garbage in the other cases.
+    if (!Builder.getInsertBlock()->getTerminator()) {
+        if (RetTy == Type::Void) Builder.createRetVoid();
+        else Builder.createRet(CurFn->getZeroValue(RetTy));
+    }
+    // Drops the blocks started after a return.
+    CurFn->removeUnreachableBlocks();
+}
+
+void IRGen::visit(FuncFParamAST &) {
+    // Lowered by visit(FuncDefAST), which knows the matching argument.
+}
+
+void IRGen::visit(BlockAST &node) {
+    Locals.enterScope();
+    for (auto &item : node.getItems()) {
+        item->accept(*this);
+    }
+    Locals.exitScope();
+}
+
+void IRGen::visit(VarDeclAST &node) {
+    Type T = getIRType(node.getType());
+    // Like Semant, the initializer is evaluated before the name is visible.
+    Value *Init = node.getInit() ? convertTo(genExpr(node.getInit()), T) : nullptr;
+    AllocaInst *Slot = createEntryAlloca(T);
+    Locals.insert(node.getName(), Slot);
+    if (Init) Builder.createStore(Init, Slot);
+}
+
+void IRGen::visit(IfStmtAST &node) {
+    auto *ThenBB = new BasicBlock("if.then");
+    auto *ElseBB = node.getElse() ? new BasicBlock("if.else") : nullptr;
+    auto *EndBB = new BasicBlock("if.end");
+    genCondBr(node.getCond(), ThenBB, ElseBB ? ElseBB : EndBB);
+
+    startBlock(ThenBB);
+    if (node.getThen()) node.getThen()->accept(*this);
+    Builder.createBr(EndBB);
+
+    if (ElseBB) {
+        startBlock(ElseBB);
+        node.getElse()->accept(*this);
+        Builder.createBr(EndBB);
+    }
+    startBlock(EndBB);
+}
+
+void IRGen::visit(WhileStmtAST &node) {
+    auto *CondBB = new BasicBlock("while.cond");
+    auto *BodyBB = new BasicBlock("while.body");
+    auto *EndBB = new BasicBlock("while.end");
+    Builder.createBr(CondBB);
+
+    startBlock(CondBB);
+    genCondBr(node.getCond(), BodyBB, EndBB);
+
+    startBlock(BodyBB);
+    if (node.getBody()) node.getBody()->accept(*this);
+    Builder.createBr(CondBB);
+
+    startBlock(EndBB);
+}
+
+void IRGen::visit(ReturnStmtAST &node) {
+    Type RetTy = CurFn->getReturnType();
+    if (node.getRetVal()) {
+        Value *V = genExpr(node.getRetVal());
+        if (RetTy == Type::Void) {
+            error("void function should not return a value");
+            Builder.createRetVoid();
+        } else {
+            Builder.createRet(convertTo(V, RetTy));
+        }
+    } else if (RetTy == Type::Void) {
+        Builder.createRetVoid();
+    } else {
+        Builder.createRet(CurFn->getZeroValue(RetTy));
+    }
+    // Anything that follows is dead but still needs a block to go into.
+    startBlock(new BasicBlock("unreachable"));
+}
+
+void IRGen::visit(AssignStmtAST &node) {
+    Value *V = genExpr(node.getValue());
+    AllocaInst *const *Slot = Locals.lookup(node.getLVal()->getName());
+    if (!Slot) {
+        error("assignment to an undeclared variable");
+        return;
+    }
+    Builder.createStore(convertTo(V, (*Slot)->getAllocatedType()), *Slot);
+}
+
+void IRGen::visit(ExprStmtAST &node) {
+    if (node.getExpr()) genExpr(node.getExpr());
+}
+
+void IRGen::visit(CallExprAST &node) {
+    Function *Callee = getCallee(node.getCallee());
+    if (!Callee || Callee->getNumArgs() != node.getArgs().size()) {
+        error("call to an undeclared function or with the wrong arguments");
+        Result = CurFn->getUndef(Type::I32);
+        return;
+    }
+    std::vector<Value *> Args;
+    for (unsigned i = 0; i < Callee->getNumArgs(); ++i)
+        Args.push_back(convertTo(genExpr(node.getArgs()[i]), Callee->getArg(i)->getType()));
+    Result = Builder.createCall(Callee, ArrayRef<Value *>(Args.data(), Args.size()));
+}
+
+// a && b  =>        br a, rhs, F        a || b  =>        br a, T, rhs
+//             rhs:  br b, T, F                     rhs:  br b, T, F
+// and !a swaps T and F. The blocks on the way get the usual names.
+void IRGen::genCondBr(ExprAST *E, BasicBlock *True, BasicBlock *False) {
+    if (auto *Bin = dynamic_cast<BinaryExprAST *>(E); Bin && isLogicalOp(Bin->getOp())) {
+        bool IsAnd = Bin->getOp() == BinaryOpKind::LAnd;
+        auto *RHSBB = new BasicBlock(IsAnd ? "land.rhs" : "lor.rhs");
+        if (IsAnd) genCondBr(Bin->getLHS(), RHSBB, False);
+        else genCondBr(Bin->getLHS(), True, RHSBB);
+        startBlock(RHSBB);
+        genCondBr(Bin->getRHS(), True, False);
+        return;
+    }
+    if (auto *Un = dynamic_cast<UnaryExprAST *>(E); Un && Un->getOp() == UnaryOpKind::LNot) {
+        genCondBr(Un->getOperand(), False, True);
+        return;
+    }
+    Builder.createCondBr(genCond(E), True, False);
+}
+
+// In a value context the result is materialized:
+//
+// a && b  =>        br a, rhs, end       a || b  =>  br a, end, rhs
+//             rhs:  br end
+//             end:  phi [false/true, lhs-block], [b, rhs-block]
+Value *IRGen::genLogicalOp(BinaryExprAST &node) {
+    bool IsAnd = node.getOp() == BinaryOpKind::LAnd;
+    Value *LHS = genCond(node.getLHS());
+    BasicBlock *LHSBlock = Builder.getInsertBlock();
+    auto *RHSBB = new BasicBlock(IsAnd ? "land.rhs" : "lor.rhs");
+    auto *EndBB = new BasicBlock(IsAnd ? "land.end" : "lor.end");
+    if (IsAnd) Builder.createCondBr(LHS, RHSBB, EndBB);
+    else Builder.createCondBr(LHS, EndBB, RHSBB);
+
+    startBlock(RHSBB);
+    Value *RHS = genCond(node.getRHS());
+    BasicBlock *RHSBlock = Builder.getInsertBlock();
+    Builder.createBr(EndBB);
+
+    startBlock(EndBB);
+    PhiInst *Phi = Builder.createPhi(Type::I1);
+    Phi->addIncoming(Builder.getBool(!IsAnd), LHSBlock);
+    Phi->addIncoming(RHS, RHSBlock);
+    return Phi;
+}
+
+void IRGen::visit(BinaryExprAST &node) {
+    BinaryOpKind Op = node.getOp();
+    if (isLogicalOp(Op)) {
+        Result = genLogicalOp(node);
+        return;
+    }
+
+    Value *LHS = genExpr(node.getLHS());
+    Value *RHS = genExpr(node.getRHS());
+    // Usual arithmetic conversions: float wins, i1 is promoted to int.
+    bool IsFloat = LHS->getType() == Type::F32 || RHS->getType() == Type::F32;
+    Type T = IsFloat ? Type::F32 : Type::I32;
+    LHS = convertTo(LHS, T);
+    RHS = convertTo(RHS, T);
+
+    if (isComparisonOp(Op)) {
+        CmpInst::Predicate P;
+        switch (Op) {
+            case BinaryOpKind::LT: P = CmpInst::LT; break;
+            case BinaryOpKind::GT: P = CmpInst::GT; break;
+            case BinaryOpKind::LE: P = CmpInst::LE; break;
+            case BinaryOpKind::GE: P = CmpInst::GE; break;
+            case BinaryOpKind::EQ: P = CmpInst::EQ; break;
+            default: P = CmpInst::NE; break;
+        }
+        Result = IsFloat ? Builder.createFCmp(P, LHS, RHS) : Builder.createICmp(P, LHS, RHS);
+        return;
+    }
+
+    Opcode Opc;
+    switch (Op) {
+        case BinaryOpKind::Mul: Opc = IsFloat ? Opcode::FMul : Opcode::Mul; break;
+        case BinaryOpKind::Div: Opc = IsFloat ? Opcode::FDiv : Opcode::SDiv; break;
+        case BinaryOpKind::Add: Opc = IsFloat ? Opcode::FAdd : Opcode::Add; break;
+        case BinaryOpKind::Sub: Opc = IsFloat ? Opcode::FSub : Opcode::Sub; break;
+        default:
+            if (IsFloat) {
+                error("invalid operands to binary expression ('float' % ...)");
+                Result = CurFn->getUndef(T);
+                return;
+            }
+            Opc = Opcode::SRem;
+            break;
+    }
+    Result = Builder.createBinOp(Opc, LHS, RHS);
+}
+
+void IRGen::visit(UnaryExprAST &node) {
+    Value *V = genExpr(node.getOperand());
+    switch (node.getOp()) {
+        case UnaryOpKind::Plus:
+            Result = V->getType() == Type::I1 ? convertTo(V, Type::I32) : V;
+            break;
+        case UnaryOpKind::Minus:
+            if (V->getType() == Type::F32) {
+                Result = Builder.createFNeg(V);
+            } else {
+                Result = Builder.createBinOp(Opcode::Sub, Builder.getInt32(0), convertTo(V, Type::I32));
+            }
+            break;
+        default: // !x is x == 0
+            if (V->getType() == Type::F32)
+                Result = Builder.createFCmp(CmpInst::EQ, V, Builder.getFloat(0.0f));
+            else if (V->getType() == Type::I1)
+                Result = Builder.createICmp(CmpInst::EQ, V, Builder.getBool(false));
+            else
+                Result = Builder.createICmp(CmpInst::EQ, V, Builder.getInt32(0));
+            break;
+    }
+}
+
+void IRGen::visit(LValAST &node) {
+    AllocaInst *const *Slot = Locals.lookup(node.getName());
+    if (!Slot) {
+        error("use of an undeclared variable");
+        Result = CurFn->getUndef(Type::I32);
+        return;
+    }
+    Result = Builder.createLoad((*Slot)->getAllocatedType(), *Slot);
+}
+
+void IRGen::visit(NumberAST &node) {
+    if (node.isFloat()) Result = Builder.getFloat(node.getFloatValue());
+    else Result = Builder.getInt32(node.getIntValue());
+}
+
+// Every function exists before any body is lowered, so a body only looks
+// functions up (or declares a runtime function, which the Module makes
+// safe) and the tasks share nothing else.
+unsigned sysy::generateIR(CompUnitAST &CU, Module &M, ThreadPool *Pool) {
+    IRGen(M).declareFunctions(CU);
+    ArrayRef<ASTNode *> Children = CU.getChildren();
+    std::atomic<unsigned> NumErrors{0};
+    parallelFor(Pool, Children.size(), [&](size_t i) {
+        IRGen Gen(M);
+        Children[i]->accept(Gen);
+        NumErrors += Gen.getNumErrors();
+    });
+    M.sortDeclarations();
+    return NumErrors;
+}
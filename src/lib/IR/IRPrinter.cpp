@@ -0,0 +1,223 @@
+#include "IR/Module.h"
+#include "Basic/ThreadPool.h"
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <unordered_map>
+
+using namespace sysy;
+
+namespace {
+
+// Numbers the arguments, blocks and value-producing instructions of one
+// function in program order. Names are assigned while printing, the IR
+// stores none.
+class SlotTracker {
+    std::unordered_map<const Value *, unsigned> Slots;
+
+public:
+    explicit SlotTracker(const Function *F) {
+        if (!F) return;
+        unsigned NextBlock = 0, NextValue = 0;
+        for (unsigned i = 0, e = F->getNumArgs(); i != e; ++i) Slots[F->getArg(i)] = NextValue++;
+        for (BasicBlock &BB : *F) {
+            Slots[&BB] = NextBlock++;
+            for (Instruction &I : BB) {
+                if (I.getType() != Type::Void) Slots[&I] = NextValue++;
+            }
+        }
+    }
+
+    int getSlot(const Value *V) const {
+        auto It = Slots.find(V);
+        return It == Slots.end() ? -1 : static_cast<int>(It->second);
+    }
+};
+
+void printName(std::ostream &OS, const Value *V, const SlotTracker &Slots) {
+    if (auto *CI = dyn_cast<ConstantInt>(V)) {
+        if (CI->getType() == Type::I1) OS << (CI->getValue() ? "true" : "false");
+        else OS << CI->getValue();
+        return;
+    }
+    if (auto *CF = dyn_cast<ConstantFloat>(V)) {
+        // %.9g round-trips every float.
+        char Buf[32];
+        std::snprintf(Buf, sizeof(Buf), "%.9g", static_cast<double>(CF->getValue()));
+        OS << Buf;
+        return;
+    }
+    if (isa<UndefValue>(V)) {
+        OS << "undef";
+        return;
+    }
+    int Slot = Slots.getSlot(V);
+    if (auto *BB = dyn_cast<BasicBlock>(V)) {
+        OS << "%" << (BB->getName().empty() ? "bb" : BB->getName());
+        if (Slot >= 0) OS << Slot;
+        return;
+    }
+    if (Slot >= 0) OS << "%" << Slot;
+    else OS << "%<badref>";
+}
+
+void printOperand(std::ostream &OS, const Value *V, const SlotTracker &Slots) {
+    if (!V) {
+        OS << "<null operand>";
+        return;
+    }
+    OS << getTypeName(V->getType()) << " ";
+    printName(OS, V, Slots);
+}
+
+void printInstruction(std::ostream &OS, const Instruction &I, const SlotTracker &Slots) {
+    OS << "  ";
+    if (I.getType() != Type::Void) {
+        printName(OS, &I, Slots);
+        OS << " = ";
+    }
+    OS << I.getOpcodeName();
+
+    switch (I.getOpcode()) {
+    case Opcode::ICmp:
+    case Opcode::FCmp: {
+        auto &Cmp = *cast<CmpInst>(&I);
+        OS << " " << Cmp.getPredicateName() << " ";
+        printOperand(OS, Cmp.getLHS(), Slots);
+        OS << ", ";
+        printName(OS, Cmp.getRHS(), Slots);
+        break;
+    }
+    case Opcode::ZExt:
+    case Opcode::SIToFP:
+    case Opcode::FPToSI:
+        OS << " ";
+        printOperand(OS, I.getOperand(0), Slots);
+        OS << " to " << getTypeName(I.getType());
+        break;
+    case Opcode::Alloca:
+        OS << " " << getTypeName(cast<AllocaInst>(&I)->getAllocatedType());
+        break;
+    case Opcode::Load:
+        OS << " " << getTypeName(I.getType()) << ", ";
+        printOperand(OS, I.getOperand(0), Slots);
+        break;
+    case Opcode::Call: {
+        auto &Call = *cast<CallInst>(&I);
+        OS << " " << getTypeName(I.getType()) << " @" << Call.getCallee()->getName() << "(";
+        for (unsigned i = 0, e = Call.getNumArgs(); i != e; ++i) {
+            if (i) OS << ", ";
+            printOperand(OS, Call.getArg(i), Slots);
+        }
+        OS << ")";
+        break;
+    }
+    case Opcode::Phi: {
+        auto &Phi = *cast<PhiInst>(&I);
+        OS << " " << getTypeName(I.getType()) << " ";
+        for (unsigned i = 0, e = Phi.getNumIncomingValues(); i != e; ++i) {
+            OS << (i ? ", [ " : "[ ");
+            printName(OS, Phi.getIncomingValue(i), Slots);
+            OS << ", ";
+            printName(OS, Phi.getIncomingBlock(i), Slots);
+            OS << " ]";
+        }
+        break;
+    }
+    case Opcode::Ret:
+        if (I.getNumOperands() == 0) OS << " void";
+        else { OS << " "; printOperand(OS, I.getOperand(0), Slots); }
+        break;
+    default:
+        if (I.isBinaryOp()) {
+            // "add i32 %a, %b": both operands have the type of the result.
+            OS << " ";
+            printOperand(OS, I.getOperand(0), Slots);
+            OS << ", ";
+            printName(OS, I.getOperand(1), Slots);
+            break;
+        }
+        for (unsigned i = 0, e = I.getNumOperands(); i != e; ++i) {
+            OS << (i ? ", " : " ");
+            printOperand(OS, I.getOperand(i), Slots);
+        }
+        break;
+    }
+    OS << "\n";
+}
+
+void printBlock(std::ostream &OS, const BasicBlock &BB, const SlotTracker &Slots) {
+    std::string Label;
+    {
+        int Slot = Slots.getSlot(&BB);
+        Label = (BB.getName().empty() ? "bb" : BB.getName()) + (Slot >= 0 ? std::to_string(Slot) : "");
+    }
+    OS << Label << ":";
+    auto Preds = BB.getPredecessors();
+    if (!Preds.empty()) {
+        OS << std::string(Label.size() < 40 ? 40 - Label.size() : 1, ' ') << "; preds = ";
+        for (size_t i = 0; i < Preds.size(); ++i) {
+            if (i) OS << ", ";
+            printName(OS, Preds[i], Slots);
+        }
+    }
+    OS << "\n";
+    for (Instruction &I : BB) printInstruction(OS, I, Slots);
+}
+
+} // namespace
+
+void Value::printAsOperand(std::ostream &OS) const {
+    const Function *F = nullptr;
+    if (auto *A = dyn_cast<Argument>(this)) F = A->getParent();
+    else if (auto *I = dyn_cast<Instruction>(this)) F = I->getFunction();
+    else if (auto *BB = dyn_cast<BasicBlock>(this)) F = BB->getParent();
+    printOperand(OS, this, SlotTracker(F));
+}
+
+void Instruction::print(std::ostream &OS) const {
+    printInstruction(OS, *this, SlotTracker(getFunction()));
+}
+
+void BasicBlock::print(std::ostream &OS) const {
+    printBlock(OS, *this, SlotTracker(Parent));
+}
+
+void Function::print(std::ostream &OS) const {
+    SlotTracker Slots(this);
+    OS << (isDeclaration() ? "declare " : "define ") << getTypeName(RetTy) << " @" << Name << "(";
+    for (unsigned i = 0, e = getNumArgs(); i != e; ++i) {
+        if (i) OS << ", ";
+        if (isDeclaration()) OS << getTypeName(getArg(i)->getType());
+        else printOperand(OS, getArg(i), Slots);
+    }
+    if (isDeclaration()) {
+        OS << ")\n";
+        return;
+    }
+    OS << ") {\n";
+    for (BasicBlock &BB : Blocks) {
+        if (&BB != getEntryBlock()) OS << "\n";
+        printBlock(OS, BB, Slots);
+    }
+    OS << "}\n";
+}
+
+void Module::print(std::ostream &OS, ThreadPool *Pool) const {
+    if (!Pool) {
+        bool First = true;
+        for (const auto &F : Functions) {
+            if (!First) OS << "\n";
+            First = false;
+            F->print(OS);
+        }
+        return;
+    }
+    std::vector<std::string> Texts(Functions.size());
+    parallelFor(Pool, Functions.size(), [&](size_t i) {
+        std::ostringstream S;
+        Functions[i]->print(S);
+        Texts[i] = S.str();
+    });
+    for (size_t i = 0; i < Texts.size(); ++i) OS << (i ? "\n" : "") << Texts[i];
+}
@@ -0,0 +1,313 @@
+#include "IR/BasicBlock.h"
+#include "IR/Function.h"
+#include "Basic/Allocator.h"
+#include <cassert>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+using namespace sysy;
+
+const char *sysy::getOpcodeName(Opcode Op) {
+    switch (Op) {
+#define HANDLE_INST(Name, Spelling) case Opcode::Name: return Spelling;
+#include "IR/Instructions.def"
+    }
+    return "<invalid>";
+}
+
+namespace {
+
+// One allocator per thread, so threads never contend. An instruction may
+// be deleted by another thread than the one that created it (its memory
+// then simply moves to that thread's free list), so the slabs must outlive
+// their thread: the allocator is deliberately never destroyed. The list
+// keeps it reachable after its thread is gone, for leak checkers.
+RecyclingAllocator &getInstAllocator() {
+    thread_local RecyclingAllocator *Allocator = [] {
+        static std::mutex Lock;
+        static std::vector<RecyclingAllocator *> *All = new std::vector<RecyclingAllocator *>();
+        std::lock_guard<std::mutex> Guard(Lock);
+        All->push_back(new RecyclingAllocator());
+        return All->back();
+    }();
+    return *Allocator;
+}
+
+} // namespace
+
+void *Instruction::operator new(size_t Size) {
+    if (Size > RecyclingAllocator::MaxSize) return ::operator new(Size);
+    return getInstAllocator().allocate(Size);
+}
+
+void Instruction::operator delete(void *P, size_t Size) {
+    if (Size > RecyclingAllocator::MaxSize) ::operator delete(P);
+    else getInstAllocator().deallocate(P, Size);
+}
+
+Instruction::~Instruction() {
+    assert(!Parent && "deleting an instruction that is still in a block");
+    if (HungOffOperands) delete[] Operands;
+}
+
+void Instruction::initOperands(Use *Ops, unsigned Cap) {
+    assert(!Operands && NumOperands == 0 && "operands already set up");
+    if (!Ops) {
+        Ops = new Use[Cap];
+        HungOffOperands = true;
+    }
+    Operands = Ops;
+    Capacity = Cap;
+    for (unsigned i = 0; i < Cap; ++i) Operands[i].User = this;
+}
+
+Function *Instruction::getFunction() const {
+    return Parent ? Parent->getParent() : nullptr;
+}
+
+void Instruction::addOperand(Value *V) {
+    if (NumOperands == Capacity) {
+        // Uses are linked by address, so moving them means relinking.
+        unsigned NewCapacity = Capacity ? Capacity * 2 : 2;
+        Use *NewOperands = new Use[NewCapacity];
+        for (unsigned i = 0; i < NewCapacity; ++i) NewOperands[i].User = this;
+        for (unsigned i = 0; i < NumOperands; ++i) {
+            NewOperands[i].set(Operands[i].get());
+            Operands[i].set(nullptr);
+        }
+        if (HungOffOperands) delete[] Operands;
+        HungOffOperands = true;
+        Operands = NewOperands;
+        Capacity = NewCapacity;
+    }
+    Operands[NumOperands++].set(V);
+}
+
+void Instruction::shrinkOperands(unsigned N) {
+    assert(N <= NumOperands);
+    for (unsigned i = NumOperands - N; i < NumOperands; ++i) Operands[i].set(nullptr);
+    NumOperands -= N;
+}
+
+void Instruction::replaceUsesOfWith(Value *From, Value *To) {
+    for (unsigned i = 0; i < NumOperands; ++i) {
+        if (Operands[i].get() == From) Operands[i].set(To);
+    }
+}
+
+void Instruction::dropAllReferences() {
+    for (unsigned i = 0; i < NumOperands; ++i) Operands[i].set(nullptr);
+}
+
+void Instruction::insertInto(BasicBlock *BB, Instruction *Pos) {
+    assert(!Parent && "instruction is already in a block");
+    assert((!Pos || Pos->Parent == BB) && "insertion point is in another block");
+    BB->InstList.insert(Pos, this);
+    Parent = BB;
+}
+
+void Instruction::insertBefore(Instruction *Pos) { insertInto(Pos->Parent, Pos); }
+
+void Instruction::insertAfter(Instruction *Pos) {
+    insertInto(Pos->Parent, Pos->getNextNode());
+}
+
+void Instruction::moveBefore(Instruction *Pos) {
+    removeFromParent();
+    insertBefore(Pos);
+}
+
+void Instruction::removeFromParent() {
+    Parent->InstList.remove(this);
+    Parent = nullptr;
+}
+
+void Instruction::eraseFromParent() {
+    assert(use_empty() && "erasing an instruction that is still used");
+    if (Parent) removeFromParent();
+    delete this;
+}
+
+void Instruction::dump() const { print(std::cerr); }
+
+Instruction *Instruction::clone() const {
+    switch (Op) {
+        case Opcode::FNeg: return new FNegInst(getOperand(0));
+        case Opcode::ICmp:
+        case Opcode::FCmp: {
+            auto *C = cast<CmpInst>(this);
+            return new CmpInst(Op, C->getPredicate(), getOperand(0), getOperand(1));
+        }
+        case Opcode::ZExt:
+        case Opcode::SIToFP:
+        case Opcode::FPToSI: return new CastInst(Op, getOperand(0), getType());
+        case Opcode::Alloca: return new AllocaInst(cast<AllocaInst>(this)->getAllocatedType());
+        case Opcode::Load: return new LoadInst(getType(), getOperand(0));
+        case Opcode::Store: return new StoreInst(getOperand(0), getOperand(1));
+        case Opcode::Call: {
+            std::vector<Value *> Args(op_begin(), op_end());
+            return new CallInst(cast<CallInst>(this)->getCallee(), ArrayRef<Value *>(Args.data(), Args.size()));
+        }
+        case Opcode::Phi: {
+            auto *Phi = cast<PhiInst>(this);
+            auto *New = new PhiInst(getType(), Phi->getNumIncomingValues());
+            for (unsigned i = 0, e = Phi->getNumIncomingValues(); i != e; ++i)
+                New->addIncoming(Phi->getIncomingValue(i), Phi->getIncomingBlock(i));
+            return New;
+        }
+        case Opcode::Br: {
+            auto *Br = cast<BranchInst>(this);
+            if (Br->isConditional())
+                return new BranchInst(Br->getCondition(), Br->getSuccessor(0), Br->getSuccessor(1));
+            return new BranchInst(Br->getSuccessor(0));
+        }
+        case Opcode::Ret: return new ReturnInst(cast<ReturnInst>(this)->getReturnValue());
+        default:
+            assert(isBinaryOp() && "unhandled opcode in clone");
+            return new BinaryInst(Op, getOperand(0), getOperand(1));
+    }
+}
+
+BinaryInst::BinaryInst(Opcode Op, Value *LHS, Value *RHS) : Instruction(Op, LHS->getType()) {
+    initOperands(Ops, 2);
+    addOperand(LHS);
+    addOperand(RHS);
+}
+
+FNegInst::FNegInst(Value *Operand) : Instruction(Opcode::FNeg, Type::F32) {
+    initOperands(Ops, 1);
+    addOperand(Operand);
+}
+
+CmpInst::CmpInst(Opcode Op, Predicate P, Value *LHS, Value *RHS)
+    : Instruction(Op, Type::I1), Pred(P) {
+    initOperands(Ops, 2);
+    addOperand(LHS);
+    addOperand(RHS);
+}
+
+CmpInst::Predicate CmpInst::getInversePredicate(Predicate P) {
+    switch (P) {
+    case EQ: return NE;
+    case NE: return EQ;
+    case LT: return GE;
+    case LE: return GT;
+    case GT: return LE;
+    case GE: return LT;
+    }
+    return P;
+}
+
+CmpInst::Predicate CmpInst::getSwappedPredicate(Predicate P) {
+    switch (P) {
+    case LT: return GT;
+    case LE: return GE;
+    case GT: return LT;
+    case GE: return LE;
+    default: return P;
+    }
+}
+
+const char *CmpInst::getPredicateName() const {
+    static const char *const IntNames[] = {"eq", "ne", "slt", "sle", "sgt", "sge"};
+    static const char *const FloatNames[] = {"oeq", "une", "olt", "ole", "ogt", "oge"};
+    return isFloat() ? FloatNames[Pred] : IntNames[Pred];
+}
+
+CastInst::CastInst(Opcode Op, Value *V, Type DestTy) : Instruction(Op, DestTy) {
+    initOperands(Ops, 1);
+    addOperand(V);
+}
+
+AllocaInst::AllocaInst(Type T) : Instruction(Opcode::Alloca, Type::Ptr), AllocatedType(T) {}
+
+LoadInst::LoadInst(Type T, Value *Ptr) : Instruction(Opcode::Load, T) {
+    initOperands(Ops, 1);
+    addOperand(Ptr);
+}
+
+StoreInst::StoreInst(Value *Val, Value *Ptr) : Instruction(Opcode::Store, Type::Void) {
+    initOperands(Ops, 2);
+    addOperand(Val);
+    addOperand(Ptr);
+}
+
+CallInst::CallInst(Function *Callee, ArrayRef<Value *> Args)
+    : Instruction(Opcode::Call, Callee->getReturnType()), Callee(Callee) {
+    initOperands(nullptr, Args.empty() ? 1 : static_cast<unsigned>(Args.size()));
+    for (Value *Arg : Args) addOperand(Arg);
+}
+
+PhiInst::PhiInst(Type T, unsigned ReservedPreds) : Instruction(Opcode::Phi, T) {
+    initOperands(nullptr, 2 * (ReservedPreds ? ReservedPreds : 1));
+}
+
+BasicBlock *PhiInst::getIncomingBlock(unsigned i) const {
+    return cast<BasicBlock>(getOperand(2 * i + 1));
+}
+
+void PhiInst::setIncomingBlock(unsigned i, BasicBlock *BB) { setOperand(2 * i + 1, BB); }
+
+void PhiInst::addIncoming(Value *V, BasicBlock *BB) {
+    addOperand(V);
+    addOperand(BB);
+}
+
+void PhiInst::removeIncoming(unsigned i) {
+    unsigned Last = getNumIncomingValues() - 1;
+    if (i != Last) {
+        setIncomingValue(i, getIncomingValue(Last));
+        setIncomingBlock(i, getIncomingBlock(Last));
+    }
+    shrinkOperands(2);
+}
+
+int PhiInst::getBasicBlockIndex(const BasicBlock *BB) const {
+    for (unsigned i = 0, e = getNumIncomingValues(); i != e; ++i) {
+        if (getOperand(2 * i + 1) == BB) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+Value *PhiInst::getIncomingValueForBlock(const BasicBlock *BB) const {
+    int Idx = getBasicBlockIndex(BB);
+    return Idx < 0 ? nullptr : getIncomingValue(static_cast<unsigned>(Idx));
+}
+
+Value *PhiInst::hasConstantValue() const {
+    Value *Common = nullptr;
+    for (unsigned i = 0, e = getNumIncomingValues(); i != e; ++i) {
+        Value *V = getIncomingValue(i);
+        if (V == this || V == Common) continue;
+        if (Common) return nullptr;
+        Common = V;
+    }
+    return Common;
+}
+
+BranchInst::BranchInst(BasicBlock *Dest) : Instruction(Opcode::Br, Type::Void) {
+    initOperands(Ops, 3);
+    addOperand(Dest);
+}
+
+BranchInst::BranchInst(Value *Cond, BasicBlock *IfTrue, BasicBlock *IfFalse)
+    : Instruction(Opcode::Br, Type::Void) {
+    initOperands(Ops, 3);
+    addOperand(Cond);
+    addOperand(IfTrue);
+    addOperand(IfFalse);
+}
+
+BasicBlock *BranchInst::getSuccessor(unsigned i) const {
+    return cast<BasicBlock>(getOperand(isConditional() ? i + 1 : i));
+}
+
+void BranchInst::setSuccessor(unsigned i, BasicBlock *BB) {
+    setOperand(isConditional() ? i + 1 : i, BB);
+}
+
+ReturnInst::ReturnInst(Value *RetVal) : Instruction(Opcode::Ret, Type::Void) {
+    initOperands(Ops, 1);
+    if (RetVal) addOperand(RetVal);
+}
@@ -0,0 +1,54 @@
+#include "IR/Module.h"
+#include <algorithm>
+#include <iostream>
+
+using namespace sysy;
+
+Function *Module::createFunction(std::string Name, Type RetTy, const std::vector<Type> &ParamTys) {
+    std::lock_guard<std::mutex> Guard(Lock);
+    return createFunctionImpl(std::move(Name), RetTy, ParamTys);
+}
+
+Function *Module::createFunctionImpl(std::string Name, Type RetTy, const std::vector<Type> &ParamTys) {
+    Functions.push_back(std::make_unique<Function>(std::move(Name), RetTy, ParamTys));
+    Function *F = Functions.back().get();
+    F->Parent = this;
+    FunctionMap.emplace(F->getName(), F);
+    return F;
+}
+
+Function *Module::getFunction(std::string_view Name) const {
+    std::lock_guard<std::mutex> Guard(Lock);
+    auto It = FunctionMap.find(Name);
+    return It == FunctionMap.end() ? nullptr : It->second;
+}
+
+Function *Module::getOrInsertFunction(std::string_view Name, Type RetTy,
+                                       const std::vector<Type> &ParamTys) {
+    std::lock_guard<std::mutex> Guard(Lock);
+    auto It = FunctionMap.find(Name);
+    if (It != FunctionMap.end()) return It->second;
+    return createFunctionImpl(std::string(Name), RetTy, ParamTys);
+}
+
+void Module::sortDeclarations() {
+    auto FirstDecl = std::stable_partition(Functions.begin(), Functions.end(),
+                                           [](const auto &F) { return !F->isDeclaration(); });
+    std::sort(FirstDecl, Functions.end(),
+              [](const auto &A, const auto &B) { return A->getName() < B->getName(); });
+}
+
+void Module::eraseFunctions(const std::unordered_set<const Function *> &Dead) {
+    for (const Function *F : Dead) FunctionMap.erase(F->getName());
+    Functions.erase(std::remove_if(Functions.begin(), Functions.end(),
+                                   [&](const auto &F) { return Dead.count(F.get()); }),
+                    Functions.end());
+}
+
+size_t Module::getInstructionCount() const {
+    size_t N = 0;
+    for (const auto &F : Functions) N += F->getInstructionCount();
+    return N;
+}
+
+void Module::dump() const { print(std::cerr); }
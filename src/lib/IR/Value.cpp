@@ -0,0 +1,30 @@
+#include "IR/Instruction.h"
+#include <cassert>
+
+using namespace sysy;
+
+void Use::set(Value *V) {
+    if (Val) removeFromList();
+    Val = V;
+    if (V) addToList(&V->UseList);
+}
+
+unsigned Use::getOperandNo() const {
+    return static_cast<unsigned>(this - User->op_begin());
+}
+
+Value::~Value() {
+    assert(use_empty() && "deleting a value that is still used");
+}
+
+unsigned Value::getNumUses() const {
+    unsigned N = 0;
+    for (Use *U = UseList; U; U = U->getNext()) ++N;
+    return N;
+}
+
+void Value::replaceAllUsesWith(Value *V) {
+    assert(V != this && "replacing a value with itself");
+    assert(V->getType() == getType() && "replacing a value with one of another type");
+    while (UseList) UseList->set(V);
+}
@@ -0,0 +1,203 @@
+#include "IR/Verifier.h"
+#include "Analysis/Dominators.h"
+#include "IR/Module.h"
+#include <algorithm>
+#include <iostream>
+#include <unordered_map>
+
+using namespace sysy;
+
+namespace {
+
+class Verifier {
+    const Function &F;
+    std::ostream &OS;
+    bool Broken = false;
+    std::unordered_map<const Instruction *, unsigned> Order; // Position in its block
+    DominatorTree DT;
+
+    void fail(const char *Msg, const Value *V) {
+        Broken = true;
+        OS << "IR verifier: " << Msg << " in function '" << F.getName() << "'\n";
+        if (auto *I = dyn_cast_or_null<Instruction>(V)) I->print(OS);
+        else if (auto *BB = dyn_cast_or_null<BasicBlock>(V)) OS << "  in block " << BB->getName() << "\n";
+    }
+
+    bool isLocal(const Value *V) const {
+        if (auto *A = dyn_cast<Argument>(V)) return A->getParent() == &F;
+        if (auto *I = dyn_cast<Instruction>(V)) return I->getFunction() == &F;
+        if (auto *BB = dyn_cast<BasicBlock>(V)) return BB->getParent() == &F;
+        return true;
+    }
+
+    void verifyOperands(const Instruction &I);
+    void verifyTypes(const Instruction &I);
+    void verifyPhi(const PhiInst &Phi, const std::vector<BasicBlock *> &Preds);
+
+public:
+    Verifier(const Function &F, std::ostream &OS) : F(F), OS(OS) {}
+    bool run();
+};
+
+void Verifier::verifyOperands(const Instruction &I) {
+    for (unsigned i = 0, e = I.getNumOperands(); i != e; ++i) {
+        const Value *Op = I.getOperand(i);
+        if (!Op) {
+            fail("null operand", &I);
+            continue;
+        }
+        if (!isLocal(Op)) fail("operand from another function", &I);
+        if (isa<BasicBlock>(Op) && !isa<BranchInst>(&I) && !isa<PhiInst>(&I))
+            fail("block used as a value", &I);
+        // Definitions must dominate their uses; a phi uses its operands at
+        // the end of the incoming block.
+        auto *Def = dyn_cast<Instruction>(Op);
+        if (!Def || !Def->getParent() || !isLocal(Def)) continue;
+        bool Dominates;
+        if (auto *Phi = dyn_cast<PhiInst>(&I)) {
+            Dominates = i % 2 == 1 || DT.dominates(Def->getParent(), Phi->getIncomingBlock(i / 2));
+        } else if (Def->getParent() == I.getParent()) {
+            Dominates = Order[Def] < Order[&I];
+        } else {
+            Dominates = DT.dominates(Def->getParent(), I.getParent());
+        }
+        if (!Dominates) fail("instruction does not dominate all uses", &I);
+    }
+    for (Use &U : I.uses()) {
+        if (U.get() != &I || !U.getUser()) fail("corrupt use list", &I);
+        else if (U.getUser()->getFunction() != &F) fail("used in another function", &I);
+    }
+}
+
+void Verifier::verifyTypes(const Instruction &I) {
+    auto TypeOf = [&](unsigned i) { return I.getOperand(i) ? I.getOperand(i)->getType() : Type::Void; };
+    switch (I.getOpcode()) {
+    case Opcode::Add: case Opcode::Sub: case Opcode::Mul: case Opcode::SDiv: case Opcode::SRem:
+        if (I.getType() != Type::I32 || TypeOf(0) != Type::I32 || TypeOf(1) != Type::I32)
+            fail("integer arithmetic on non-i32 values", &I);
+        break;
+    case Opcode::FAdd: case Opcode::FSub: case Opcode::FMul: case Opcode::FDiv:
+        if (I.getType() != Type::F32 || TypeOf(0) != Type::F32 || TypeOf(1) != Type::F32)
+            fail("float arithmetic on non-f32 values", &I);
+        break;
+    case Opcode::FNeg:
+        if (TypeOf(0) != Type::F32) fail("fneg of a non-f32 value", &I);
+        break;
+    case Opcode::ICmp:
+        if (!isIntegerType(TypeOf(0)) || TypeOf(0) != TypeOf(1)) fail("bad icmp operands", &I);
+        break;
+    case Opcode::FCmp:
+        if (TypeOf(0) != Type::F32 || TypeOf(1) != Type::F32) fail("bad fcmp operands", &I);
+        break;
+    case Opcode::ZExt:
+        if (TypeOf(0) != Type::I1 || I.getType() != Type::I32) fail("bad zext", &I);
+        break;
+    case Opcode::SIToFP:
+        if (TypeOf(0) != Type::I32 || I.getType() != Type::F32) fail("bad sitofp", &I);
+        break;
+    case Opcode::FPToSI:
+        if (TypeOf(0) != Type::F32 || I.getType() != Type::I32) fail("bad fptosi", &I);
+        break;
+    case Opcode::Load:
+        if (TypeOf(0) != Type::Ptr) fail("load from a non-pointer", &I);
+        break;
+    case Opcode::Store:
+        if (TypeOf(1) != Type::Ptr) fail("store to a non-pointer", &I);
+        break;
+    case Opcode::Call: {
+        auto *Call = cast<CallInst>(&I);
+        const Function *Callee = Call->getCallee();
+        if (!Callee || Callee->getParent() != F.getParent()) {
+            fail("call to a function of another module", &I);
+            break;
+        }
+        if (Call->getNumArgs() != Callee->getNumArgs()) {
+            fail("call with the wrong number of arguments", &I);
+            break;
+        }
+        for (unsigned i = 0, e = Call->getNumArgs(); i != e; ++i) {
+            if (TypeOf(i) != Callee->getArg(i)->getType()) fail("call argument type mismatch", &I);
+        }
+        if (I.getType() != Callee->getReturnType()) fail("call result type mismatch", &I);
+        break;
+    }
+    case Opcode::Br:
+        if (cast<BranchInst>(&I)->isConditional()) {
+            auto *Br = cast<BranchInst>(&I);
+            if (TypeOf(0) != Type::I1) fail("branch condition is not i1", &I);
+            else if (Br->getSuccessor(0) == Br->getSuccessor(1))
+                fail("conditional branch with identical successors", &I);
+        }
+        break;
+    case Opcode::Ret: {
+        Type RetTy = I.getNumOperands() ? TypeOf(0) : Type::Void;
+        if (RetTy != F.getReturnType()) fail("return type mismatch", &I);
+        break;
+    }
+    default:
+        break;
+    }
+}
+
+void Verifier::verifyPhi(const PhiInst &Phi, const std::vector<BasicBlock *> &Preds) {
+    if (Phi.getNumIncomingValues() != Preds.size()) {
+        fail("phi does not have one entry per predecessor", &Phi);
+        return;
+    }
+    for (unsigned i = 0, e = Phi.getNumIncomingValues(); i != e; ++i) {
+        const Value *V = Phi.getIncomingValue(i);
+        if (V && V->getType() != Phi.getType()) fail("phi operand type mismatch", &Phi);
+        if (std::find(Preds.begin(), Preds.end(), Phi.getIncomingBlock(i)) == Preds.end())
+            fail("phi entry for a non-predecessor", &Phi);
+        if (Phi.getBasicBlockIndex(Phi.getIncomingBlock(i)) != static_cast<int>(i))
+            fail("phi has two entries for one block", &Phi);
+    }
+}
+
+bool Verifier::run() {
+    if (F.isDeclaration()) return true;
+    for (BasicBlock &BB : F) {
+        unsigned N = 0;
+        for (Instruction &I : BB) Order[&I] = N++;
+    }
+    if (!F.getEntryBlock()->getPredecessors().empty())
+        fail("entry block has predecessors", F.getEntryBlock());
+    for (BasicBlock &BB : F) {
+        if (!BB.getTerminator()) {
+            fail("block does not end in a terminator", &BB);
+            return false; // The CFG cannot be walked
+        }
+    }
+    DT.recalculate(F);
+
+    for (BasicBlock &BB : F) {
+        if (BB.getParent() != &F) fail("block has a wrong parent", &BB);
+        std::vector<BasicBlock *> Preds = BB.getPredecessors();
+        bool SeenNonPhi = false;
+        for (Instruction &I : BB) {
+            if (I.getParent() != &BB) fail("instruction has a wrong parent", &I);
+            if (I.isTerminator() && &I != BB.back()) fail("terminator in the middle of a block", &I);
+            if (auto *Phi = dyn_cast<PhiInst>(&I)) {
+                if (SeenNonPhi) fail("phi after a non-phi instruction", &I);
+                verifyPhi(*Phi, Preds);
+            } else {
+                SeenNonPhi = true;
+            }
+            verifyOperands(I);
+            verifyTypes(I);
+        }
+    }
+    return !Broken;
+}
+
+} // namespace
+
+bool sysy::verifyFunction(const Function &F, std::ostream &OS) {
+    return Verifier(F, OS).run();
+}
+
+bool sysy::verifyModule(const Module &M, std::ostream &OS) {
+    bool Ok = true;
+    for (const auto &F : M) Ok &= verifyFunction(*F, OS);
+    return Ok;
+}
@@ -1,31 +1,275 @@
 #include "Lex/Lexer.h"
-#include <cctype>
-#include <map>
+#include "Basic/CharInfo.h"
+#include <array>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SYSY_LEXER_SIMD 1
+#elif defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SYSY_LEXER_SIMD 1
+#endif
+
 using namespace sysy;
 
+namespace {
+
+//===----------------------------------------------------------------------===//
+// Keyword lookup: a perfect hash over TokenKinds.def, built at compile time.
+//===----------------------------------------------------------------------===//
+
+struct KeywordInfo {
+    const char *Spelling;
+    unsigned Len;
+    tok::TokenKind Kind;
+};
+
+constexpr KeywordInfo Keywords[] = {
+#define KEYWORD(X) {#X, sizeof(#X) - 1, tok::kw_##X},
+#include "Basic/TokenKinds.def"
+};
+
+constexpr unsigned NumKeywords = sizeof(Keywords) / sizeof(Keywords[0]);
+constexpr unsigned KeywordTableSize = 32; // Power of two, > NumKeywords
+static_assert(NumKeywords < KeywordTableSize, "keyword table too small");
+
+constexpr unsigned keywordMinLen() {
+    unsigned Min = ~0u;
+    for (const auto &KW : Keywords) Min = KW.Len < Min ? KW.Len : Min;
+    return Min;
+}
+
+constexpr unsigned keywordMaxLen() {
+    unsigned Max = 0;
+    for (const auto &KW : Keywords) Max = KW.Len > Max ? KW.Len : Max;
+    return Max;
+}
+
+// Hashes the length and the first and last characters.
+constexpr unsigned hashKeyword(const char *S, unsigned Len, unsigned Seed) {
+    return (static_cast<unsigned char>(S[0]) * Seed +
+            static_cast<unsigned char>(S[Len - 1]) * (Seed >> 8) + Len) &
+           (KeywordTableSize - 1);
+}
+
+// Search for a seed that maps every keyword to a distinct slot.
+constexpr unsigned findKeywordSeed() {
+    for (unsigned Seed = 0x101; Seed < 0x10000; ++Seed) {
+        bool Used[KeywordTableSize] = {};
+        bool Ok = true;
+        for (const auto &KW : Keywords) {
+            unsigned H = hashKeyword(KW.Spelling, KW.Len, Seed);
+            if (Used[H]) { Ok = false; break; }
+            Used[H] = true;
+        }
+        if (Ok) return Seed;
+    }
+    return 0;
+}
+
+constexpr unsigned KeywordSeed = findKeywordSeed();
+static_assert(KeywordSeed != 0, "no perfect hash for the keyword set");
+constexpr unsigned KeywordMinLen = keywordMinLen();
+constexpr unsigned KeywordMaxLen = keywordMaxLen();
+
+struct KeywordTable {
+    KeywordInfo Slots[KeywordTableSize] = {};
+};
+
+constexpr KeywordTable buildKeywordTable() {
+    KeywordTable Table;
+    for (auto &Slot : Table.Slots) Slot = {"", 0, tok::identifier};
+    for (const auto &KW : Keywords)
+        Table.Slots[hashKeyword(KW.Spelling, KW.Len, KeywordSeed)] = KW;
+    return Table;
+}
+
+constexpr KeywordTable KeywordSlots = buildKeywordTable();
+
+tok::TokenKind getKeywordOrIdentifier(std::string_view Text) {
+    unsigned Len = Text.size();
+    if (Len < KeywordMinLen || Len > KeywordMaxLen) return tok::identifier;
+    const KeywordInfo &KW = KeywordSlots.Slots[hashKeyword(Text.data(), Len, KeywordSeed)];
+    if (KW.Len == Len && std::memcmp(KW.Spelling, Text.data(), Len) == 0)
+        return KW.Kind;
+    return tok::identifier;
+}
+
+//===----------------------------------------------------------------------===//
+// Punctuator lookup: a 256-entry table indexed by the first byte.
+//===----------------------------------------------------------------------===//
+
+struct PunctuatorInfo {
+    tok::TokenKind Single = tok::unknown; // One-character punctuator, if any
+    char Second = 0;                      // Second character of a two-character one
+    tok::TokenKind Double = tok::unknown;
+};
+
+struct PunctuatorTable {
+    std::array<PunctuatorInfo, 256> Entries{};
+    bool Ambiguous = false; // Two two-character punctuators share a first byte
+};
+
+constexpr PunctuatorTable buildPunctuatorTable() {
+    PunctuatorTable Table;
+#define PUNCTUATOR(X, Y)                                                      \
+    {                                                                         \
+        auto &E = Table.Entries[static_cast<unsigned char>(Y[0])];            \
+        if (sizeof(Y) == 2) {                                                 \
+            E.Single = tok::X;                                                \
+        } else {                                                              \
+            if (E.Second != 0) Table.Ambiguous = true;                        \
+            E.Second = Y[1];                                                  \
+            E.Double = tok::X;                                                \
+        }                                                                     \
+    }
+#include "Basic/TokenKinds.def"
+    return Table;
+}
+
+constexpr PunctuatorTable Punctuators = buildPunctuatorTable();
+static_assert(!Punctuators.Ambiguous,
+              "two-character punctuators must have distinct first characters");
+
+//===----------------------------------------------------------------------===//
+// Bulk scanning of whitespace and comments.
+//
+// Each vector step turns VecWidth bytes into a bit mask (bit i <-> byte i).
+// AVX2 is used when the compiler targets it (-mavx2 / -march=native), SSE2
+// otherwise on x86-64; other targets take the scalar loops only.
+//===----------------------------------------------------------------------===//
+
+#if SYSY_LEXER_SIMD
+#if defined(__AVX2__)
+constexpr long VecWidth = 32;
+
+inline uint32_t byteMask(const char *P, char C) {
+    __m256i V = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(P));
+    return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(V, _mm256_set1_epi8(C))));
+}
+
+// ' ' or '\t' .. '\r'
+inline uint32_t whitespaceMask(const char *P) {
+    __m256i V = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(P));
+    __m256i Space = _mm256_cmpeq_epi8(V, _mm256_set1_epi8(' '));
+    __m256i Off = _mm256_sub_epi8(V, _mm256_set1_epi8('\t'));
+    __m256i Ctrl = _mm256_cmpeq_epi8(_mm256_min_epu8(Off, _mm256_set1_epi8(4)), Off);
+    return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(Space, Ctrl)));
+}
+#else
+constexpr long VecWidth = 16;
+
+inline uint32_t byteMask(const char *P, char C) {
+    __m128i V = _mm_loadu_si128(reinterpret_cast<const __m128i *>(P));
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(V, _mm_set1_epi8(C))));
+}
+
+// ' ' or '\t' .. '\r'
+inline uint32_t whitespaceMask(const char *P) {
+    __m128i V = _mm_loadu_si128(reinterpret_cast<const __m128i *>(P));
+    __m128i Space = _mm_cmpeq_epi8(V, _mm_set1_epi8(' '));
+    __m128i Off = _mm_sub_epi8(V, _mm_set1_epi8('\t'));
+    __m128i Ctrl = _mm_cmpeq_epi8(_mm_min_epu8(Off, _mm_set1_epi8(4)), Off);
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_or_si128(Space, Ctrl)));
+}
+#endif
+
+constexpr uint32_t FullMask = VecWidth == 32 ? ~0u : (1u << VecWidth) - 1;
+#endif
+
+// Returns the first non-whitespace character in [P, End), or End.
+const char *scanWhitespace(const char *P, const char *End) {
+#if SYSY_LEXER_SIMD
+    while (End - P >= VecWidth) {
+        uint32_t NotSpace = ~whitespaceMask(P) & FullMask;
+        if (NotSpace) return P + __builtin_ctz(NotSpace);
+        P += VecWidth;
+    }
+#endif
+    while (P < End && isWhitespace(*P)) ++P;
+    return P;
+}
+
+// Returns the '*' of the first "*/" in [P, End), or End.
+const char *scanBlockCommentEnd(const char *P, const char *End) {
+#if SYSY_LEXER_SIMD
+    while (End - P > VecWidth) {
+        uint32_t Hit = byteMask(P, '*') & byteMask(P + 1, '/');
+        if (Hit) return P + __builtin_ctz(Hit);
+        P += VecWidth;
+    }
+#endif
+    for (; P + 1 < End; ++P) {
+        if (P[0] == '*' && P[1] == '/') return P;
+    }
+    return End;
+}
+
+// Counts the '\n' in [P, End) and remembers the last one.
+unsigned countNewlines(const char *P, const char *End, const char *&LastNewline) {
+    unsigned Count = 0;
+#if SYSY_LEXER_SIMD
+    while (End - P >= VecWidth) {
+        uint32_t NL = byteMask(P, '\n');
+        if (NL) {
+            Count += __builtin_popcount(NL);
+            LastNewline = P + (31 - __builtin_clz(NL));
+        }
+        P += VecWidth;
+    }
+#endif
+    for (; P < End; ++P) {
+        if (*P == '\n') { ++Count; LastNewline = P; }
+    }
+    return Count;
+}
+
+} // namespace
+
+void Lexer::advanceTo(const char *NewPtr) {
+    const char *LastNewline = nullptr;
+    unsigned Lines = countNewlines(CurPtr, NewPtr, LastNewline);
+    if (Lines) {
+        CurLine += Lines;
+        CurCol = static_cast<int>(NewPtr - LastNewline);
+    } else {
+        CurCol += static_cast<int>(NewPtr - CurPtr);
+    }
+    CurPtr = NewPtr;
+}
+
 void Lexer::skipWhitespace() {
-    while (CurPtr < Buffer.end() && std::isspace(*CurPtr)) {
+    // Most runs are a single space or a newline plus a little indentation,
+    // which is cheaper to walk byte by byte than to build vector masks for.
+    for (int i = 0; i < 16; ++i) {
+        if (CurPtr >= Buffer.end() || !isWhitespace(*CurPtr)) return;
         consume();
     }
+    advanceTo(scanWhitespace(CurPtr, Buffer.end()));
 }
 
 void Lexer::skipComment() {
     if (peek() == '/') {
         if (CurPtr + 1 < Buffer.end() && *(CurPtr + 1) == '/') {
-            while (CurPtr < Buffer.end() && peek() != '\n') consume();
+            // A line comment has no newline before its end, only the column moves.
+            const void *NL = std::memchr(CurPtr, '\n', Buffer.end() - CurPtr);
+            const char *End = NL ? static_cast<const char *>(NL) : Buffer.end();
+            CurCol += static_cast<int>(End - CurPtr);
+            CurPtr = End;
         } else if (CurPtr + 1 < Buffer.end() && *(CurPtr + 1) == '*') {
-            consume(); consume();
-            while (CurPtr < Buffer.end()) {
-                if (peek() == '*' && (CurPtr + 1 < Buffer.end()) && *(CurPtr + 1) == '/') {
-                    consume(); consume();
-                    return;
-                }
-                consume();
+            int StartLine = CurLine;
+            const char *End = scanBlockCommentEnd(CurPtr + 2, Buffer.end());
+            if (End != Buffer.end()) {
+                advanceTo(End + 2);
+                return;
             }
+            advanceTo(End);
             // Without finding */ before EOF.
-            std::cerr << "Lexical Error: Unterminated multi-line comment starting at Line " << CurLine << std::endl;
+            ++NumErrors;
+            std::cerr << "Lexical Error: Unterminated multi-line comment starting at Line " << StartLine << std::endl;
         }
     }
 }
@@ -39,36 +283,36 @@ Token Lexer::lexNumericConstant() {
 
     // Check for hex prefixes 0x or 0X.
     if (peek() == '0' && (CurPtr + 1 < Buffer.end()) && 
-    (std::tolower(*(CurPtr + 1)) == 'x')) {
+    (toLowercase(*(CurPtr + 1)) == 'x')) {
         consume(); // '0'
         consume(); // 'x' or 'X'
 
         // Scan hexadecimal digits or decimal point.
-        while (std::isxdigit(peek()) || peek() == '.') {
+        while (isHexDigit(peek()) || peek() == '.') {
             if (consume() == '.') isFloat = true;
         }
 
         // Hexadecimal floating-point specific exponent part: p or P.
-        if (std::tolower(peek()) == 'p') {
+        if (toLowercase(peek()) == 'p') {
             isFloat = true;
             consume(); // 'p'
             if (peek() == '+' || peek() == '-') consume();
-            while (std::isdigit(peek())) consume();
+            while (isDigit(peek())) consume();
         }
     } 
 
   // Decimal or octal.
     else {
-        while (std::isdigit(peek()) || peek() == '.') {
+        while (isDigit(peek()) || peek() == '.') {
             if (consume() == '.') isFloat = true;
         }
 
         // Decimal floating-point scientific notation: e or E.
-        if (std::tolower(peek()) == 'e') {
+        if (toLowercase(peek()) == 'e') {
             isFloat = true;
             consume(); // 'e'
             if (peek() == '+' || peek() == '-') consume();
-            while (std::isdigit(peek())) consume();
+            while (isDigit(peek())) consume();
         }
     }
 
@@ -79,6 +323,7 @@ Token Lexer::lexNumericConstant() {
 }
 
 Token Lexer::nextToken() {
+    ++NumTokens;
     skipWhitespace();
   
     while (CurPtr < Buffer.end() && peek() == '/') {
@@ -99,47 +344,42 @@ Token Lexer::nextToken() {
     char c = peek();
     const char *StartPtr = CurPtr;
 
-    if (std::isalpha(c) || c == '_') {
-        consume();
-        while (std::isalnum(peek()) || peek() == '_') consume();
-        
+    if (isIdentifierHead(c)) {
+        const char *End = CurPtr + 1;
+        while (isIdentifierBody(*End)) ++End;
+        // Identifiers never contain a newline, so the column moves in bulk.
+        CurCol += End - CurPtr;
+        CurPtr = End;
+
         std::string_view Text(StartPtr, CurPtr - StartPtr);
         Result.setText(Text);
-
-        tok::TokenKind Kind = tok::identifier;
-        #define KEYWORD(X) if (Text == #X) Kind = tok::kw_##X; else
-        #include "Basic/TokenKinds.def"
-        { Kind = tok::identifier; }
-        
+        tok::TokenKind Kind = getKeywordOrIdentifier(Text);
         Result.setKind(Kind);
+        if (Kind == tok::identifier) Result.setIdentifier(Idents.get(Text));
         return Result;
     }
 
-    if (std::isdigit(c) || (c == '.' && std::isdigit(*(CurPtr + 1)))) {
+    if (isDigit(c) || (c == '.' && isDigit(*(CurPtr + 1)))) {
         return lexNumericConstant();
     }
 
-    std::string_view SingleChar(StartPtr, 1);
-    std::string_view DoubleChar = SingleChar;
-    // Prevent out-of-bounds access.
-    if (CurPtr < Buffer.end()) {
-        DoubleChar = std::string_view(StartPtr, 2);
-    }
-
-    #define PUNCTUATOR(X, Y) \
-        if (std::string_view(Y).size() == 2 && DoubleChar == Y) { \
-            consume(); consume(); \
-            Result.setKind(tok::X); Result.setText(DoubleChar); return Result; \
+    if (isPunctuatorHead(c)) {
+        const PunctuatorInfo &P = Punctuators.Entries[static_cast<unsigned char>(c)];
+        if (P.Second != 0 && *(CurPtr + 1) == P.Second) {
+            CurPtr += 2; CurCol += 2;
+            Result.setKind(P.Double);
+            Result.setText(std::string_view(StartPtr, 2));
+            return Result;
         }
-    #include "Basic/TokenKinds.def"
-
-    #define PUNCTUATOR(X, Y) \
-            if (std::string_view(Y).size() == 1 && SingleChar == Y) { \
-                consume(); \
-                Result.setKind(tok::X); Result.setText(SingleChar); return Result; \
-            }
-    #include "Basic/TokenKinds.def"
+        if (P.Single != tok::unknown) {
+            CurPtr += 1; CurCol += 1;
+            Result.setKind(P.Single);
+            Result.setText(std::string_view(StartPtr, 1));
+            return Result;
+        }
+    }
 
+    ++NumErrors;
     std::cerr << "Lexical Error at (Line: " << Result.getLine() 
             << ", Col: " << Result.getColumn() << "): Unknown character '" 
             << c << "'" << std::endl;
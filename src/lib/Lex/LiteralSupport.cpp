@@ -0,0 +1,123 @@
+#include "Lex/LiteralSupport.h"
+#include "Basic/CharInfo.h"
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+using namespace sysy;
+
+const char *sysy::getLiteralErrorMessage(LiteralError E) {
+    switch (E) {
+        case LiteralError::None: return "no error";
+        case LiteralError::InvalidDigit: return "invalid digit in numeric constant";
+        case LiteralError::TooLarge: return "numeric constant is too large for its type";
+        case LiteralError::MissingExponent: return "exponent has no digits or is missing";
+        case LiteralError::Malformed: return "malformed numeric constant";
+    }
+    return "unknown error";
+}
+
+namespace {
+
+bool hasHexPrefix(std::string_view S) {
+    return S.size() >= 2 && S[0] == '0' && toLowercase(S[1]) == 'x';
+}
+
+unsigned digitValue(char c) {
+    if (isDigit(c)) return c - '0';
+    return toLowercase(c) - 'a' + 10;
+}
+
+// Checks "[+-]digits" at S[i..] up to the end of the literal.
+LiteralError checkExponentDigits(std::string_view S, size_t i) {
+    if (i < S.size() && (S[i] == '+' || S[i] == '-')) ++i;
+    if (i == S.size()) return LiteralError::MissingExponent;
+    for (; i < S.size(); ++i) {
+        if (!isDigit(S[i])) return LiteralError::Malformed;
+    }
+    return LiteralError::None;
+}
+
+// Checks the mantissa "digits[.digits]" and the exponent of a float literal.
+LiteralError checkFloatSyntax(std::string_view S) {
+    bool Hex = hasHexPrefix(S);
+    size_t i = Hex ? 2 : 0;
+    bool SawDigit = false, SawDot = false;
+    for (; i < S.size(); ++i) {
+        char c = S[i];
+        if (c == '.') {
+            if (SawDot) return LiteralError::Malformed;
+            SawDot = true;
+        } else if (Hex ? isHexDigit(c) : isDigit(c)) {
+            SawDigit = true;
+        } else {
+            break;
+        }
+    }
+    if (!SawDigit) return LiteralError::Malformed;
+
+    if (i == S.size()) {
+        // A hex float needs its binary exponent, "0x1.8" is not valid C.
+        return Hex ? LiteralError::MissingExponent : LiteralError::None;
+    }
+    char ExpChar = toLowercase(S[i]);
+    if (ExpChar != (Hex ? 'p' : 'e')) return LiteralError::Malformed;
+    return checkExponentDigits(S, i + 1);
+}
+
+} // namespace
+
+LiteralError sysy::evalIntLiteral(std::string_view S, int32_t &Value) {
+    Value = 0;
+    if (S.empty()) return LiteralError::Malformed;
+
+    unsigned Radix = 10;
+    size_t i = 0;
+    if (hasHexPrefix(S)) {
+        Radix = 16;
+        i = 2;
+        if (i == S.size()) return LiteralError::Malformed;
+    } else if (S[0] == '0') {
+        Radix = 8;
+    }
+
+    // -2147483648 is the negation of a literal, which must itself fit.
+    uint64_t Max = Radix == 10 ? uint64_t(INT32_MAX) + 1 : UINT32_MAX;
+    uint64_t Result = 0;
+    for (; i < S.size(); ++i) {
+        char c = S[i];
+        bool Valid = Radix == 16 ? isHexDigit(c) : (isDigit(c) && unsigned(c - '0') < Radix);
+        if (!Valid) return LiteralError::InvalidDigit;
+        Result = Result * Radix + digitValue(c);
+        if (Result > Max) return LiteralError::TooLarge;
+    }
+    Value = static_cast<int32_t>(static_cast<uint32_t>(Result));
+    return LiteralError::None;
+}
+
+LiteralError sysy::evalFloatLiteral(std::string_view S, float &Value) {
+    Value = 0.0f;
+    LiteralError E = checkFloatSyntax(S);
+    if (E != LiteralError::None) return E;
+
+    // The syntax is known to be valid, so strtof only does the conversion
+    // (with correct rounding, hex floats included). It needs a terminated
+    // string; literals fit in the stack buffer except in contrived inputs.
+    char Buf[128];
+    std::string Long;
+    const char *Str = Buf;
+    if (S.size() < sizeof(Buf)) {
+        std::memcpy(Buf, S.data(), S.size());
+        Buf[S.size()] = '\0';
+    } else {
+        Long.assign(S.data(), S.size());
+        Str = Long.c_str();
+    }
+
+    errno = 0;
+    Value = std::strtof(Str, nullptr);
+    if (errno == ERANGE && std::isinf(Value)) return LiteralError::TooLarge;
+    return LiteralError::None;
+}
@@ -8,35 +8,47 @@ bool Parser::expect(tok::TokenKind K) {
         getNextToken();
         return true;
     }
+    ++NumErrors;
     std::cerr << "Parser Error: Expected '" << tok::getTokenName(K) 
               << "' but found '" << tok::getTokenName(CurTok.getKind()) 
               << "' at Line " << CurTok.getLine() << ", Col " << CurTok.getColumn() << std::endl;
     return false;
 }
 
-std::string Parser::parseType() {
-    std::string typeStr;
-    if (CurTok.is(tok::kw_int)) typeStr = "int";
-    else if (CurTok.is(tok::kw_float)) typeStr = "float";
-    else if (CurTok.is(tok::kw_void)) typeStr = "void";
-    else return "";
+void Parser::reportLiteralError(LiteralError E) {
+    ++NumErrors;
+    std::cerr << "Error: " << getLiteralErrorMessage(E) << " '" << CurTok.getText()
+              << "' at Line " << CurTok.getLine() << ", Col " << CurTok.getColumn() << std::endl;
+}
+
+ArrayRef<ASTNode *> Parser::takeItems(size_t Start) {
+    auto Items = Ctx.copyArray(ItemStack.data() + Start, ItemStack.size() - Start);
+    ItemStack.resize(Start);
+    return Items;
+}
+
+tok::TokenKind Parser::parseType() {
+    tok::TokenKind type = CurTok.getKind();
+    if (type != tok::kw_int && type != tok::kw_float && type != tok::kw_void)
+        return tok::unknown;
 
     getNextToken();
-    return typeStr;
+    return type;
 }
 
-std::unique_ptr<VarDeclAST> Parser::parseDecl() {
-    std::string type = parseType();
-    if (type.empty()) return nullptr;
+VarDeclAST *Parser::parseDecl() {
+    tok::TokenKind type = parseType();
+    if (type == tok::unknown) return nullptr;
 
     if (CurTok.isNot(tok::identifier)) {
+        ++NumErrors;
         std::cerr << "Error: Expected variable name after type" << std::endl;
         return nullptr;
     }
-    std::string name(CurTok.getText());
+    Symbol name = CurTok.getIdentifier();
     getNextToken();
 
-    std::unique_ptr<ExprAST> init = nullptr;
+    ExprAST *init = nullptr;
     if (CurTok.is(tok::equal)) {
         getNextToken();
         init = parseExpr();
@@ -44,143 +56,193 @@ std::unique_ptr<VarDeclAST> Parser::parseDecl() {
 
     if (!expect(tok::semi)) return nullptr;
 
-    return std::make_unique<VarDeclAST>(type, name, std::move(init));
+    return Ctx.create<VarDeclAST>(type, name, (init));
+}
+
+namespace {
+
+// Binding strength of the binary operators, 0 for tokens that are not one.
+// All of them are left-associative.
+enum Precedence : unsigned char {
+    PrecNone = 0,
+    PrecLogicalOr,     // ||
+    PrecLogicalAnd,    // &&
+    PrecEquality,      // == !=
+    PrecRelational,    // < > <= >=
+    PrecAdditive,      // + -
+    PrecMultiplicative, // * / %
+    PrecUnary           // Prefix + - !, binds tighter than any binary operator
+};
+
+constexpr Precedence getBinOpPrecedence(tok::TokenKind K) {
+    switch (K) {
+        case tok::pipe_pipe: return PrecLogicalOr;
+        case tok::amp_amp: return PrecLogicalAnd;
+        case tok::equal_equal: case tok::not_equal: return PrecEquality;
+        case tok::less: case tok::greater:
+        case tok::less_equal: case tok::greater_equal: return PrecRelational;
+        case tok::plus: case tok::minus: return PrecAdditive;
+        case tok::star: case tok::slash: case tok::percent: return PrecMultiplicative;
+        default: return PrecNone;
+    }
+}
+
+struct PrecedenceTable {
+    Precedence Prec[tok::NUM_TOKENS] = {};
+};
+
+constexpr PrecedenceTable buildPrecedenceTable() {
+    PrecedenceTable T;
+    for (unsigned K = 0; K < tok::NUM_TOKENS; ++K)
+        T.Prec[K] = getBinOpPrecedence(static_cast<tok::TokenKind>(K));
+    return T;
 }
 
-std::unique_ptr<ExprAST> Parser:: parsePrimaryExpr() {
+constexpr PrecedenceTable BinOpPrec = buildPrecedenceTable();
+
+} // namespace
+
+ExprAST *Parser::parsePrimaryExpr() {
     if (CurTok.is(tok::int_const)) {
-        int val = std::stoi(std::string(CurTok.getText()));
+        int32_t val;
+        LiteralError err = evalIntLiteral(CurTok.getText(), val);
+        if (err != LiteralError::None) reportLiteralError(err);
         getNextToken();
-        return std::make_unique<NumberAST>(val);
+        return Ctx.create<NumberAST>(val);
     }
     else if (CurTok.is(tok::float_const)) {
-        float val = std::stof(std::string(CurTok.getText()));
+        float val;
+        LiteralError err = evalFloatLiteral(CurTok.getText(), val);
+        if (err != LiteralError::None) reportLiteralError(err);
         getNextToken();
-        return std::make_unique<NumberAST>(val);
+        return Ctx.create<NumberAST>(val);
     }
-    else if (CurTok.is(tok::l_paren)) {
-        auto expr = parseExpr();
-        if (!expr) return nullptr;
-        if (!expect(tok::r_paren)) return nullptr;
-        return expr;
-    } 
     else if (CurTok.is(tok::identifier)) {
-        std::string name(CurTok.getText());
+        Symbol name = CurTok.getIdentifier();
         getNextToken();
-        return std::make_unique<LValAST>(name);
+        if (CurTok.is(tok::l_paren)) return parseCallArgs(name);
+        return Ctx.create<LValAST>(name);
     }
 
+    ++NumErrors;
     std::cerr << "Error: Unexpected token in expression: " << CurTok.getText() << std::endl;
     return nullptr;
 }
 
-std::unique_ptr<ExprAST> Parser::parseUnaryExpr() {
-    if (CurTok.is(tok::plus) || CurTok.is(tok::minus) || CurTok.is(tok::exclaim)) {
-        std::string op(CurTok.getText());
-        getNextToken();
-        auto operand = parseUnaryExpr();
-        if (!operand) return nullptr;
-        return std::make_unique<UnaryExprAST>(op, std::move(operand));
+// Each argument is a full expression parsed on top of the caller's operator
+// stacks; parseExpr() never reduces below the base it started from.
+ExprAST *Parser::parseCallArgs(Symbol callee) {
+    getNextToken(); // consume '('
+    size_t firstArg = ItemStack.size();
+    if (CurTok.isNot(tok::r_paren)) {
+        while (true) {
+            ExprAST *arg = parseExpr();
+            if (!arg) {
+                ItemStack.resize(firstArg);
+                return nullptr;
+            }
+            ItemStack.push_back(arg);
+            if (CurTok.isNot(tok::comma)) break;
+            getNextToken(); // consume ','
+        }
     }
-    return parsePrimaryExpr();
-}
-
-std::unique_ptr<ExprAST> Parser::parseMulExpr() {
-    auto lhs = parsePrimaryExpr();
-    if (!lhs) return nullptr;
-
-    while (CurTok.is(tok::star) || CurTok.is(tok::slash) || CurTok.is(tok::percent)) {
-        std::string op(CurTok.getText());
-        getNextToken();
-        auto rhs = parseUnaryExpr();
-        if (!rhs) return nullptr;
-        lhs = std::make_unique<BinaryExprAST>(op, std::move(lhs), std::move(rhs));
+    if (!expect(tok::r_paren)) {
+        ItemStack.resize(firstArg);
+        return nullptr;
     }
-    return lhs;
+    return Ctx.create<CallExprAST>(callee, takeItemsAs<ExprAST>(firstArg));
 }
 
-std::unique_ptr<ExprAST> Parser::Parser::parseAddExpr() {
-    auto lhs = parseMulExpr();
-    if (!lhs) return nullptr;
-
-    while (CurTok.is(tok::plus) || CurTok.is(tok::minus)) {
-        std::string op(CurTok.getText());
-        getNextToken();
-        auto rhs = parseMulExpr();
-        if (!rhs) return nullptr;
-        lhs = std::make_unique<BinaryExprAST>(op, std::move(lhs), std::move(rhs));
+void Parser::reduceOperator() {
+    PendingOp op = OpStack.back();
+    OpStack.pop_back();
+    if (op.Prec == PrecUnary) {
+        ExprAST *operand = OperandStack.back();
+        OperandStack.back() = Ctx.create<UnaryExprAST>(getUnaryOpForToken(op.Kind), operand);
+    } else {
+        ExprAST *rhs = OperandStack.back();
+        OperandStack.pop_back();
+        ExprAST *lhs = OperandStack.back();
+        OperandStack.back() = Ctx.create<BinaryExprAST>(getBinaryOpForToken(op.Kind), lhs, rhs);
     }
-    return lhs;
 }
 
-std::unique_ptr<ExprAST> Parser::parseRelExpr() {
-    auto lhs = parseAddExpr();
-    if (!lhs) return nullptr;
-    while (CurTok.is(tok::less) || CurTok.is(tok::greater) || 
-           CurTok.is(tok::less_equal) || CurTok.is(tok::greater_equal)) {
-        std::string op(CurTok.getText());
-        getNextToken();
-        auto rhs = parseAddExpr();
-        if (!rhs) return nullptr;
-        lhs = std::make_unique<BinaryExprAST>(op, std::move(lhs), std::move(rhs));
-    }
-    return lhs;
-}
+// Operator-precedence parsing with explicit stacks instead of one recursive
+// function per precedence level. Prefix operators and '(' are pushed while
+// an operand is expected; a binary operator first reduces everything on the
+// stack that binds at least as tightly. Neither nesting depth nor operator
+// count grows the C++ stack, so deeply nested generated expressions are safe.
+ExprAST *Parser::parseExpr() {
+    size_t opBase = OpStack.size();
+    size_t operandBase = OperandStack.size();
+    auto fail = [&]() -> ExprAST * {
+        OpStack.resize(opBase);
+        OperandStack.resize(operandBase);
+        return nullptr;
+    };
+
+    while (true) {
+        // Expecting an operand: any number of prefix operators and '('.
+        tok::TokenKind K = CurTok.getKind();
+        if (K == tok::plus || K == tok::minus || K == tok::exclaim) {
+            OpStack.push_back({K, PrecUnary});
+            getNextToken();
+            continue;
+        }
+        if (K == tok::l_paren) {
+            // PrecNone: no operator can reduce past an open parenthesis.
+            OpStack.push_back({K, PrecNone});
+            getNextToken();
+            continue;
+        }
 
-std::unique_ptr<ExprAST> Parser::parseEqExpr() {
-    auto lhs = parseRelExpr();
-    if (!lhs) return nullptr;
-    while (CurTok.is(tok::equal_equal) || CurTok.is(tok::not_equal)) {
-        std::string op(CurTok.getText());
-        getNextToken();
-        auto rhs = parseRelExpr();
-        if (!rhs) return nullptr;
-        lhs = std::make_unique<BinaryExprAST>(op, std::move(lhs), std::move(rhs));
-    }
-    return lhs;
-}
+        ExprAST *operand = parsePrimaryExpr();
+        if (!operand) return fail();
+        OperandStack.push_back(operand);
+
+        // Expecting an operator: first close any parentheses. A ')' without
+        // a matching '(' belongs to the enclosing construct (e.g. 'if (...)').
+        while (CurTok.is(tok::r_paren)) {
+            while (OpStack.size() > opBase && OpStack.back().Kind != tok::l_paren)
+                reduceOperator();
+            if (OpStack.size() == opBase) break;
+            OpStack.pop_back();
+            getNextToken();
+        }
 
-std::unique_ptr<ExprAST> Parser::parseLogicAndExpr() {
-    auto lhs = parseEqExpr();
-    if (!lhs) return nullptr;
-    while (CurTok.is(tok::amp_amp)) {
-        std::string op(CurTok.getText());
+        // Anything but a binary operator ends the expression.
+        K = CurTok.getKind();
+        Precedence prec = BinOpPrec.Prec[K];
+        if (prec == PrecNone) break;
+        while (OpStack.size() > opBase && OpStack.back().Prec >= prec)
+            reduceOperator();
+        OpStack.push_back({K, prec});
         getNextToken();
-        auto rhs = parseEqExpr();
-        if (!rhs) return nullptr;
-        lhs = std::make_unique<BinaryExprAST>(op, std::move(lhs), std::move(rhs));
     }
-    return lhs;
-}
 
-std::unique_ptr<ExprAST> Parser::parseLogicOrExpr() {
-    auto lhs = parseLogicAndExpr();
-    if (!lhs) return nullptr;
-    while (CurTok.is(tok::pipe_pipe)) {
-        std::string op(CurTok.getText());
-        getNextToken();
-        auto rhs = parseLogicAndExpr();
-        if (!rhs) return nullptr;
-        lhs = std::make_unique<BinaryExprAST>(op, std::move(lhs), std::move(rhs));
+    while (OpStack.size() > opBase) {
+        if (OpStack.back().Kind == tok::l_paren) {
+            expect(tok::r_paren);
+            return fail();
+        }
+        reduceOperator();
     }
-    return lhs;
+    ExprAST *result = OperandStack.back();
+    OperandStack.pop_back();
+    return result;
 }
 
-std::unique_ptr<ExprAST> Parser::parseExpr() {
-    return parseLogicOrExpr();
-}
-
-std::unique_ptr<StmtAST> Parser::parseStmt() {
+StmtAST *Parser::parseStmt() {
     if (CurTok.is(tok::kw_return)) {
         getNextToken(); // consume 'return'
 
-        std::unique_ptr<ExprAST> val = nullptr;
+        ExprAST *val = nullptr;
         if (CurTok.isNot(tok::semi)) {
             val = parseExpr();
         }
 
         if (!expect(tok::semi)) return nullptr;
-        return std::make_unique<ReturnStmtAST>(std::move(val));
+        return Ctx.create<ReturnStmtAST>(val);
     }
     else if (CurTok.is(tok::l_brace)) {
         return parseBlock();
@@ -191,12 +253,12 @@ std::unique_ptr<StmtAST> Parser::parseStmt() {
         auto cond = parseExpr();
         expect(tok::r_paren);
         auto thenStmt = parseStmt();
-        std::unique_ptr<StmtAST> elseStmt = nullptr;
+        StmtAST *elseStmt = nullptr;
         if (CurTok.is(tok::kw_else)) {
             getNextToken(); // consume 'else'
             elseStmt = parseStmt();
         }
-        return std::make_unique<IfStmtAST>(std::move(cond), std::move(thenStmt), std::move(elseStmt));
+        return Ctx.create<IfStmtAST>(cond, thenStmt, elseStmt);
     }
     else if (CurTok.is(tok::kw_while)) {
         getNextToken(); // consume 'while'
@@ -204,31 +266,31 @@ std::unique_ptr<StmtAST> Parser::parseStmt() {
         auto cond = parseExpr();
         expect(tok::r_paren);
         auto body = parseStmt();
-        return std::make_unique<WhileStmtAST>(std::move(cond), std::move(body));
+        return Ctx.create<WhileStmtAST>(cond, body);
     }
     else if (CurTok.is(tok::identifier)) {
         auto expr = parseExpr();
         if (CurTok.is(tok::equal)) {
-            LValAST *lval = dynamic_cast<LValAST *>(expr.get());
+            LValAST *lval = dynamic_cast<LValAST *>(expr);
             if (!lval) {
+                ++NumErrors;
                 std::cerr << "Error: Left side of assignment must be a variable." << std::endl;
                 return nullptr;
             }
-            auto lvalNode = std::make_unique<LValAST>(lval->getName());
 
             getNextToken(); // consume '='
             auto val = parseExpr();
             if (!expect(tok::semi)) return nullptr;
-            return std::make_unique<AssignStmtAST>(std::move(lvalNode), std::move(val));
+            return Ctx.create<AssignStmtAST>(lval, val);
         } else {
             if (!expect(tok::semi)) return nullptr;
-            return std::make_unique<ExprStmtAST>(std::move(expr));
+            return Ctx.create<ExprStmtAST>(expr);
         }
     }
     else if (CurTok.isNot(tok::r_brace) && CurTok.isNot(tok::semi)) {
         auto expr = parseExpr();
         if (!expect(tok::semi)) return nullptr;
-        return std::make_unique<ExprStmtAST>(std::move(expr));
+        return Ctx.create<ExprStmtAST>(expr);
     }
     else if (CurTok.is(tok::semi)) {
         getNextToken(); // consume ';'
@@ -238,57 +300,99 @@ std::unique_ptr<StmtAST> Parser::parseStmt() {
     return nullptr;
 }
 
-std::unique_ptr<BlockAST> Parser::parseBlock() {
+BlockAST *Parser::parseBlock() {
     if (!expect(tok::l_brace)) return nullptr;
 
-    auto block = std::make_unique<BlockAST>();
+    auto block = Ctx.create<BlockAST>();
+    size_t firstItem = ItemStack.size();
 
     while (CurTok.isNot(tok::r_brace) && CurTok.isNot(tok::eof)) {
         if (CurTok.is(tok::kw_int) || CurTok.is(tok::kw_float)) {
             if (auto decl = parseDecl()) {
-                block->addItem(std::move(decl));
+                ItemStack.push_back(decl);
             } 
         } else {
             if (auto stmt = parseStmt()) {
-                block->addItem(std::move(stmt));
+                ItemStack.push_back(stmt);
             } else {
                 getNextToken(); // Skip Error.
             }
         }
     }
 
+    block->setItems(takeItems(firstItem));
     if (!expect(tok::r_brace)) return nullptr;
     return block;
 }
 
-std::unique_ptr<FuncDefAST> Parser::parseFuncDef() {
-    std::string retType = parseType();
-    if (retType.empty()) return nullptr;
+FuncDefAST *Parser::parseFuncDef() {
+    tok::TokenKind retType = parseType();
+    if (retType == tok::unknown) return nullptr;
 
     if (CurTok.isNot(tok::identifier)) {
+        ++NumErrors;
         std::cerr << "Error: Expected function name after type" << std::endl;
         return nullptr;
     }
-    std::string name(CurTok.getText());
+    Symbol name = CurTok.getIdentifier();
     getNextToken();
 
     if (!expect(tok::l_paren)) return nullptr;
-    if (!expect(tok::r_paren)) return nullptr;
+    size_t firstParam = ItemStack.size();
+    if (CurTok.isNot(tok::r_paren)) {
+        while (true) {
+            FuncFParamAST *param = parseFuncFParam();
+            if (!param) {
+                ItemStack.resize(firstParam);
+                return nullptr;
+            }
+            ItemStack.push_back(param);
+            if (CurTok.isNot(tok::comma)) break;
+            getNextToken(); // consume ','
+        }
+    }
+    if (!expect(tok::r_paren)) {
+        ItemStack.resize(firstParam);
+        return nullptr;
+    }
+    auto params = takeItemsAs<FuncFParamAST>(firstParam);
 
     auto body = parseBlock();
     if (!body) return nullptr;
 
-    return std::make_unique<FuncDefAST>(name, retType, std::move(body));
+    return Ctx.create<FuncDefAST>(name, retType, params, body);
+}
+
+FuncFParamAST *Parser::parseFuncFParam() {
+    tok::TokenKind type = CurTok.getKind();
+    if (type != tok::kw_int && type != tok::kw_float) {
+        ++NumErrors;
+        std::cerr << "Error: Expected parameter type but found '" << CurTok.getText()
+                  << "' at Line " << CurTok.getLine() << ", Col " << CurTok.getColumn() << std::endl;
+        return nullptr;
+    }
+    getNextToken();
+
+    if (CurTok.isNot(tok::identifier)) {
+        ++NumErrors;
+        std::cerr << "Error: Expected parameter name after type" << std::endl;
+        return nullptr;
+    }
+    Symbol name = CurTok.getIdentifier();
+    getNextToken();
+    return Ctx.create<FuncFParamAST>(type, name);
 }
 
-std::unique_ptr<CompUnitAST> Parser::parseCompUnit() {
-    auto unit = std::make_unique<CompUnitAST>();
+CompUnitAST *Parser::parseCompUnit() {
+    auto unit = Ctx.create<CompUnitAST>();
+    size_t firstChild = ItemStack.size();
     while (CurTok.isNot(tok::eof)) {
         if (auto func = parseFuncDef()) {
-            unit->addChild(std::move(func));
+            ItemStack.push_back(func);
         } else {
             getNextToken(); 
         }
     }
+    unit->setChildren(takeItems(firstChild));
     return unit;
 }
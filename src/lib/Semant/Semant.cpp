@@ -1,28 +1,50 @@
 #include "Semant/Semant.h"
+#include "Basic/Statistic.h"
 
 using namespace sysy;
 
-bool Semant::defineSymbol(const std::string &name, const std::string &type) {
-    auto &currScope = Scopes.back();
-    if (currScope.find(name) != currScope.end()) {
-        std::cerr << "Semantic Error: Redefinition of variable '" << name << "'" << std::endl;
+STATISTIC(NumSymbolsDefined, "semant", "Number of symbols defined");
+STATISTIC(NumSymbolLookups, "semant", "Number of symbol lookups");
+
+bool Semant::defineSymbol(Symbol name, SymbolInfo info) {
+    if (!Symbols.insert(name, info)) {
+        ++NumErrors;
+        std::cerr << "Semantic Error: Redefinition of variable '" << name.getName() << "'" << std::endl;
         return false;
     }
-    currScope[name] = type;
-    std::cout<< "Debug: Defined '" << name << "' type: " << type << std::endl;
+    ++NumSymbolsDefined;
+    if (Verbose) {
+        std::cout << "Debug: Defined '" << name.getName() << "' type: "
+                  << (info.IsFunc ? "func" : tok::getKeywordSpelling(info.Type)) << std::endl;
+    }
     return true;
 }
 
-bool Semant::checkSymbol(const std::string &name) {
-    for (auto scopeIt = Scopes.rbegin(); scopeIt != Scopes.rend(); ++scopeIt) {
-        if (scopeIt->find(name) != scopeIt->end()) {
-            return true;
-        }
+const SymbolInfo *Semant::checkSymbol(Symbol name) {
+    ++NumSymbolLookups;
+    if (const SymbolInfo *info = Symbols.lookup(name)) {
+        return info;
     }
-    std::cerr << "Semantic Error: Undeclared variable '" << name << "'" << std::endl;
+    ++NumErrors;
+    std::cerr << "Semantic Error: Undeclared variable '" << name.getName() << "'" << std::endl;
+    return nullptr;
+}
+
+namespace {
+
+// The runtime library is visible everywhere unless a definition hides it.
+bool lookupBuiltin(std::string_view name, SymbolInfo &info) {
+#define BUILTIN(Name, RetType, ParamType)                                      \
+    if (name == #Name) {                                                       \
+        info = {true, tok::RetType, tok::ParamType == tok::kw_void ? 0u : 1u}; \
+        return true;                                                           \
+    }
+#include "Basic/Builtins.def"
     return false;
 }
 
+} // namespace
+
 void Semant::visit(CompUnitAST &node) {
     for (auto &child : node.getChildren()) {
         child->accept(*this);
@@ -30,8 +52,26 @@ void Semant::visit(CompUnitAST &node) {
 }
 
 void Semant::visit(FuncDefAST &node) {
-    defineSymbol(node.getName(), "func");
-    if (node.getBody()) node.getBody()->accept(*this);
+    SymbolInfo builtin;
+    if (lookupBuiltin(node.getName().getName(), builtin)) {
+        ++NumErrors;
+        std::cerr << "Semantic Error: Redefinition of runtime library function '"
+                  << node.getName().getName() << "'" << std::endl;
+    }
+    // Defined before the body, so that the function can call itself.
+    unsigned numParams = static_cast<unsigned>(node.getParams().size());
+    defineSymbol(node.getName(), {true, node.getRetType(), numParams});
+    // As in C, the parameters and the outermost locals share one scope.
+    enterScope();
+    for (auto *param : node.getParams()) param->accept(*this);
+    if (node.getBody()) {
+        for (auto &item : node.getBody()->getItems()) item->accept(*this);
+    }
+    exitScope();
+}
+
+void Semant::visit(FuncFParamAST &node) {
+    defineSymbol(node.getName(), {false, node.getType()});
 }
 
 void Semant::visit(BlockAST &node) {
@@ -46,7 +86,7 @@ void Semant::visit(VarDeclAST &node) {
     if (node.getInit()) {
         node.getInit()->accept(*this);
     }
-    defineSymbol(node.getName(), node.getType());
+    defineSymbol(node.getName(), {false, node.getType()});
 }
 
 void Semant::visit(AssignStmtAST &node) {
@@ -55,7 +95,35 @@ void Semant::visit(AssignStmtAST &node) {
 }
 
 void Semant::visit(LValAST &node) {
-    checkSymbol(node.getName());
+    const SymbolInfo *info = checkSymbol(node.getName());
+    if (info && info->IsFunc) {
+        ++NumErrors;
+        std::cerr << "Semantic Error: Function '" << node.getName().getName()
+                  << "' used as a variable" << std::endl;
+    }
+}
+
+void Semant::visit(CallExprAST &node) {
+    ++NumSymbolLookups;
+    Symbol name = node.getCallee();
+    SymbolInfo builtin;
+    const SymbolInfo *info = Symbols.lookup(name);
+    if (!info && lookupBuiltin(name.getName(), builtin)) info = &builtin;
+
+    if (!info) {
+        ++NumErrors;
+        std::cerr << "Semantic Error: Undeclared function '" << name.getName() << "'" << std::endl;
+    } else if (!info->IsFunc) {
+        ++NumErrors;
+        std::cerr << "Semantic Error: Called object '" << name.getName()
+                  << "' is not a function" << std::endl;
+    } else if (node.getArgs().size() != info->NumParams) {
+        ++NumErrors;
+        std::cerr << "Semantic Error: Function '" << name.getName() << "' expects "
+                  << info->NumParams << " argument(s) but " << node.getArgs().size()
+                  << " were given" << std::endl;
+    }
+    for (auto *arg : node.getArgs()) arg->accept(*this);
 }
 
 void Semant::visit(IfStmtAST &node) {
@@ -0,0 +1,94 @@
+#include "Transforms/Cloning.h"
+#include "IR/BasicBlock.h"
+#include "IR/Function.h"
+#include <cassert>
+
+using namespace sysy;
+
+Value *sysy::lookupValue(const ValueMap &VMap, Value *V) {
+    auto It = VMap.find(V);
+    return It == VMap.end() ? V : It->second;
+}
+
+BasicBlock *sysy::cloneBasicBlock(const BasicBlock *BB, ValueMap &VMap, const std::string &Suffix,
+                                  BasicBlock *InsertBefore, Function *F) {
+    auto *New = new BasicBlock(BB->getName() + Suffix);
+    New->insertInto(F ? F : BB->getParent(), InsertBefore);
+    for (Instruction &I : *BB) {
+        Instruction *C = I.clone();
+        New->push_back(C);
+        VMap[&I] = C;
+    }
+    VMap[BB] = New;
+    return New;
+}
+
+void sysy::remapInstruction(Instruction *I, const ValueMap &VMap) {
+    for (unsigned i = 0, e = I->getNumOperands(); i != e; ++i) {
+        auto It = VMap.find(I->getOperand(i));
+        if (It != VMap.end()) I->setOperand(i, It->second);
+    }
+}
+
+namespace {
+
+// Constants are uniqued per function, so copied code must switch to the
+// caller's.
+Value *getLocalConstant(Value *C, Function &F) {
+    if (auto *CI = dyn_cast<ConstantInt>(C))
+        return CI->getType() == Type::I1 ? F.getBool(CI->getValue()) : F.getInt32(CI->getValue());
+    if (auto *CF = dyn_cast<ConstantFloat>(C)) return F.getFloat(CF->getValue());
+    return F.getUndef(C->getType());
+}
+
+} // namespace
+
+void sysy::inlineFunction(CallInst *Call) {
+    Function *Callee = Call->getCallee();
+    Function *Caller = Call->getFunction();
+    assert(!Callee->isDeclaration() && Callee != Caller && "cannot inline this call");
+    BasicBlock *CallBB = Call->getParent();
+    BasicBlock *After = CallBB->splitBasicBlock(Call, Callee->getName() + ".exit");
+
+    ValueMap VMap;
+    for (unsigned i = 0, e = Call->getNumArgs(); i != e; ++i) VMap[Callee->getArg(i)] = Call->getArg(i);
+    std::vector<BasicBlock *> NewBlocks;
+    for (BasicBlock &BB : *Callee) NewBlocks.push_back(cloneBasicBlock(&BB, VMap, ".i", After, Caller));
+
+    std::vector<std::pair<Value *, BasicBlock *>> Returns;
+    Instruction *EntryPos = Caller->getEntryBlock()->front();
+    for (BasicBlock *BB : NewBlocks) {
+        for (Instruction *I = BB->front(); I;) {
+            Instruction *Next = I->getNextNode();
+            remapInstruction(I, VMap);
+            for (unsigned i = 0, e = I->getNumOperands(); i != e; ++i) {
+                if (isConstant(I->getOperand(i))) I->setOperand(i, getLocalConstant(I->getOperand(i), *Caller));
+            }
+            if (isa<AllocaInst>(I)) {
+                I->moveBefore(EntryPos);
+            } else if (auto *Ret = dyn_cast<ReturnInst>(I)) {
+                Returns.push_back({Ret->getReturnValue(), BB});
+                Ret->eraseFromParent();
+                BB->push_back(new BranchInst(After));
+            }
+            I = Next;
+        }
+    }
+    cast<BranchInst>(CallBB->getTerminator())->setSuccessor(0, NewBlocks.front());
+
+    if (Call->getType() != Type::Void) {
+        Value *Result;
+        if (Returns.empty()) {
+            Result = Caller->getUndef(Call->getType()); // The callee never returns
+        } else if (Returns.size() == 1) {
+            Result = Returns.front().first;
+        } else {
+            auto *Phi = new PhiInst(Call->getType(), static_cast<unsigned>(Returns.size()));
+            for (auto &R : Returns) Phi->addIncoming(R.first, R.second);
+            Phi->insertBefore(After->front());
+            Result = Phi;
+        }
+        Call->replaceAllUsesWith(Result);
+    }
+    Call->eraseFromParent();
+}
@@ -0,0 +1,182 @@
+#include "Transforms/GVN.h"
+#include "Analysis/Dominators.h"
+#include "Basic/ScopedHashTable.h"
+#include "Basic/Statistic.h"
+#include "IR/Function.h"
+#include <functional>
+
+using namespace sysy;
+
+STATISTIC(NumCSE, "gvn", "Number of redundant expressions removed");
+STATISTIC(NumCSELoad, "gvn", "Number of redundant loads removed");
+STATISTIC(NumForwarded, "gvn", "Number of loads replaced by a stored value");
+
+namespace {
+
+/// A pure expression with at most two operands.
+struct Expression {
+    Opcode Op;
+    unsigned Extra; // Result type, plus the predicate of compares
+    Value *Ops[2];
+
+    bool operator==(const Expression &RHS) const {
+        return Op == RHS.Op && Extra == RHS.Extra && Ops[0] == RHS.Ops[0] && Ops[1] == RHS.Ops[1];
+    }
+};
+
+struct ExpressionHash {
+    size_t operator()(const Expression &E) const {
+        std::hash<const void *> H;
+        size_t Seed = static_cast<size_t>(E.Op) * 31 + E.Extra;
+        Seed ^= H(E.Ops[0]) + 0x9e3779b9 + (Seed << 6) + (Seed >> 2);
+        Seed ^= H(E.Ops[1]) + 0x9e3779b9 + (Seed << 6) + (Seed >> 2);
+        return Seed;
+    }
+};
+
+/// The value last loaded from or stored to a pointer, and the memory
+/// generation it belongs to.
+struct AvailableValue {
+    Value *Val = nullptr;
+    unsigned Generation = 0;
+    bool operator==(const AvailableValue &RHS) const {
+        return Val == RHS.Val && Generation == RHS.Generation;
+    }
+};
+
+class GVN {
+    DominatorTree &DT;
+    ScopedHashTable<Expression, Value *, ExpressionHash> Exprs;
+    ScopedHashTable<Value *, AvailableValue> Loads;
+    // A loaded or stored value is only reused within its generation. Every
+    // store starts a new one, and so does every block that can be entered
+    // from somewhere other than its immediate dominator.
+    unsigned CurrentGeneration = 0;
+    unsigned LastGeneration = 0;
+    unsigned NumExprs = 0, NumLoads = 0, NumStores = 0;
+
+    void startGeneration() { CurrentGeneration = ++LastGeneration; }
+
+    static bool getExpression(const Instruction *I, Expression &E);
+    bool processBlock(BasicBlock *BB);
+
+public:
+    explicit GVN(DominatorTree &DT) : DT(DT) {}
+    bool run();
+    void updateStatistics() {
+        NumCSE += NumExprs;
+        NumCSELoad += NumLoads;
+        NumForwarded += NumStores;
+    }
+};
+
+} // namespace
+
+bool GVN::getExpression(const Instruction *I, Expression &E) {
+    if (!I->isBinaryOp() && !isa<CmpInst>(I) && !isa<CastInst>(I) && !isa<FNegInst>(I)) return false;
+    E.Op = I->getOpcode();
+    E.Extra = static_cast<unsigned>(I->getType());
+    E.Ops[0] = I->getOperand(0);
+    E.Ops[1] = nullptr;
+    if (I->isBinaryOp()) {
+        E.Ops[1] = I->getOperand(1);
+        if (I->isCommutative() && std::less<Value *>()(E.Ops[1], E.Ops[0])) std::swap(E.Ops[0], E.Ops[1]);
+    } else if (auto *Cmp = dyn_cast<CmpInst>(I)) {
+        CmpInst::Predicate P = Cmp->getPredicate();
+        E.Ops[1] = I->getOperand(1);
+        if (std::less<Value *>()(E.Ops[1], E.Ops[0])) {
+            std::swap(E.Ops[0], E.Ops[1]);
+            P = CmpInst::getSwappedPredicate(P);
+        }
+        E.Extra = E.Extra * 8 + static_cast<unsigned>(P);
+    }
+    return true;
+}
+
+bool GVN::processBlock(BasicBlock *BB) {
+    bool Changed = false;
+    for (Instruction *I = BB->front(); I;) {
+        Instruction *Next = I->getNextNode();
+        Value *Replacement = nullptr;
+
+        Expression E;
+        if (auto *LI = dyn_cast<LoadInst>(I)) {
+            AvailableValue AV = Loads.lookup(LI->getPointerOperand());
+            if (AV.Val && AV.Generation == CurrentGeneration && AV.Val->getType() == LI->getType()) {
+                Replacement = AV.Val;
+                ++(isa<LoadInst>(AV.Val) ? NumLoads : NumStores);
+            } else {
+                Loads.insert(LI->getPointerOperand(), {LI, CurrentGeneration});
+            }
+        } else if (auto *SI = dyn_cast<StoreInst>(I)) {
+            startGeneration();
+            Loads.insert(SI->getPointerOperand(), {SI->getValueOperand(), CurrentGeneration});
+        } else if (I->mayWriteMemory()) {
+            startGeneration();
+        } else if (getExpression(I, E)) {
+            if (Value *V = Exprs.lookup(E)) {
+                Replacement = V;
+                ++NumExprs;
+            } else {
+                Exprs.insert(E, I);
+            }
+        }
+
+        if (Replacement) {
+            I->replaceAllUsesWith(Replacement);
+            I->eraseFromParent();
+            Changed = true;
+        }
+        I = Next;
+    }
+    return Changed;
+}
+
+bool GVN::run() {
+    // Iterative preorder walk; each entry is (node, next child, generation
+    // at the end of the node, for its children to start from).
+    struct StackEntry {
+        DomTreeNode *Node;
+        unsigned NextChild;
+        unsigned Generation;
+    };
+    bool Changed = false;
+    std::vector<StackEntry> Stack;
+
+    DomTreeNode *Root = DT.getRootNode();
+    if (!Root) return false;
+    Exprs.enterScope();
+    Loads.enterScope();
+    Changed |= processBlock(Root->getBlock());
+    Stack.push_back({Root, 0, CurrentGeneration});
+
+    while (!Stack.empty()) {
+        StackEntry &Top = Stack.back();
+        if (Top.NextChild == Top.Node->getChildren().size()) {
+            Exprs.exitScope();
+            Loads.exitScope();
+            Stack.pop_back();
+            continue;
+        }
+        DomTreeNode *Child = Top.Node->getChildren()[Top.NextChild++];
+        BasicBlock *BB = Child->getBlock();
+        // Memory may have changed on another way into the block.
+        if (BB->getSinglePredecessor() == Top.Node->getBlock())
+            CurrentGeneration = Top.Generation;
+        else
+            startGeneration();
+        Exprs.enterScope();
+        Loads.enterScope();
+        Changed |= processBlock(BB);
+        Stack.push_back({Child, 0, CurrentGeneration});
+    }
+    return Changed;
+}
+
+bool sysy::runGVN(Function &F, DominatorTree &DT) {
+    if (F.empty()) return false;
+    GVN Pass(DT);
+    bool Changed = Pass.run();
+    Pass.updateStatistics();
+    return Changed;
+}
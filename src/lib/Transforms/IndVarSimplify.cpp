@@ -0,0 +1,170 @@
+#include "Transforms/IndVarSimplify.h"
+#include "Analysis/LoopInfo.h"
+#include "Analysis/ScalarEvolution.h"
+#include "Basic/Statistic.h"
+
+using namespace sysy;
+
+STATISTIC(NumStrengthReduced, "indvars", "Number of multiplies strength-reduced");
+STATISTIC(NumExitValues, "indvars", "Number of loop exit values replaced");
+STATISTIC(NumExitTests, "indvars", "Number of exit tests rewritten");
+
+namespace {
+
+bool containsAddRec(const SCEV *S) {
+    if (isa<SCEVAddRecExpr>(S)) return true;
+    if (auto *B = dyn_cast<SCEVBinaryExpr>(S)) return containsAddRec(B->getLHS()) || containsAddRec(B->getRHS());
+    return false;
+}
+
+/// A recurrence with constant start and step.
+bool getConstantAddRec(const SCEV *S, const Loop *L, int64_t &Start, int64_t &Step) {
+    auto *AR = dyn_cast<SCEVAddRecExpr>(S);
+    int32_t S32, C32;
+    if (!AR || AR->getLoop() != L || !ScalarEvolution::getConstantValue(AR->getStart(), S32) ||
+        !ScalarEvolution::getConstantValue(AR->getStep(), C32))
+        return false;
+    Start = S32;
+    Step = C32;
+    return true;
+}
+
+class IndVarSimplify {
+    Function &F;
+    ScalarEvolution SE;
+    unsigned Reduced = 0, ExitValues = 0, ExitTests = 0;
+
+    bool reduceMultiplies(Loop &L);
+    bool rewriteExitValues(Loop &L, int64_t TripCount);
+    bool rewriteExitTest(Loop &L, int64_t TripCount);
+
+public:
+    IndVarSimplify(Function &F, LoopInfo &LI) : F(F), SE(F, LI) {}
+    bool runOnLoop(Loop &L);
+    void updateStatistics() {
+        NumStrengthReduced += Reduced;
+        NumExitValues += ExitValues;
+        NumExitTests += ExitTests;
+    }
+};
+
+} // namespace
+
+bool IndVarSimplify::reduceMultiplies(Loop &L) {
+    BasicBlock *Preheader = L.getLoopPreheader();
+    BasicBlock *Latch = L.getLoopLatch();
+    std::vector<Instruction *> Muls;
+    for (BasicBlock *BB : L.getBlocks()) {
+        for (Instruction &I : *BB) {
+            if (I.getOpcode() != Opcode::Mul) continue;
+            auto *AR = dyn_cast<SCEVAddRecExpr>(SE.getSCEV(&I));
+            if (AR && AR->getLoop() == &L && !containsAddRec(AR->getStart()) &&
+                !containsAddRec(AR->getStep()))
+                Muls.push_back(&I);
+        }
+    }
+    // The phi yields Start + k * Step on the k-th trip through the header,
+    // which is what the multiply computed in that iteration.
+    for (Instruction *I : Muls) {
+        auto *AR = cast<SCEVAddRecExpr>(SE.getSCEV(I));
+        Value *Start = SE.expand(AR->getStart(), Preheader->getTerminator());
+        Value *Step = SE.expand(AR->getStep(), Preheader->getTerminator());
+        auto *Phi = new PhiInst(Type::I32, 2);
+        Phi->insertInto(L.getHeader(), L.getHeader()->front());
+        auto *Inc = new BinaryInst(Opcode::Add, Phi, Step);
+        Inc->insertBefore(Latch->getTerminator());
+        Phi->addIncoming(Start, Preheader);
+        Phi->addIncoming(Inc, Latch);
+        I->replaceAllUsesWith(Phi);
+        I->eraseFromParent();
+        ++Reduced;
+    }
+    if (!Muls.empty()) SE.forgetAll();
+    return !Muls.empty();
+}
+
+/// The loop leaves from its header on the trip where the test first fails,
+/// so a recurrence read by an exit phi has its value for k = TripCount.
+bool IndVarSimplify::rewriteExitValues(Loop &L, int64_t TripCount) {
+    BasicBlock *Exit = L.getExitBlock();
+    bool Changed = false;
+    for (Instruction &I : *Exit) {
+        auto *Phi = dyn_cast<PhiInst>(&I);
+        if (!Phi) break;
+        for (unsigned i = 0, e = Phi->getNumIncomingValues(); i != e; ++i) {
+            Value *V = Phi->getIncomingValue(i);
+            int64_t Start, Step;
+            if (!L.contains(Phi->getIncomingBlock(i)) || !isa<Instruction>(V) ||
+                !getConstantAddRec(SE.getSCEV(V), &L, Start, Step))
+                continue;
+            uint32_t Final = static_cast<uint32_t>(Start) + static_cast<uint32_t>(TripCount) * static_cast<uint32_t>(Step);
+            Phi->setIncomingValue(i, F.getInt32(static_cast<int32_t>(Final)));
+            ++ExitValues;
+            Changed = true;
+        }
+    }
+    return Changed;
+}
+
+bool IndVarSimplify::rewriteExitTest(Loop &L, int64_t TripCount) {
+    LoopExitTest T;
+    if (!SE.getLoopExitTest(&L, T)) return false;
+    BasicBlock *Header = L.getHeader();
+    BasicBlock *Latch = L.getLoopLatch();
+
+    // The tested induction variable must be dead apart from the test and
+    // its own increment.
+    auto *IV = dyn_cast<PhiInst>(T.IVValue);
+    if (!IV || IV->getParent() != Header || IV->getNumIncomingValues() != 2) return false;
+    auto *Inc = dyn_cast<Instruction>(IV->getIncomingValueForBlock(Latch));
+    if (!Inc || !Inc->hasOneUse()) return false;
+    for (Use &U : IV->uses()) {
+        if (U.getUser() != Inc && U.getUser() != T.Compare) return false;
+    }
+    if (!T.Compare->hasOneUse()) return false;
+
+    // Another recurrence that steps, and whose values over the run do not
+    // wrap, so each trip has a distinct value and the last one can be
+    // tested for.
+    for (Instruction &I : *Header) {
+        auto *Other = dyn_cast<PhiInst>(&I);
+        if (!Other) break;
+        int64_t Start, Step;
+        if (Other == IV || !getConstantAddRec(SE.getSCEV(Other), &L, Start, Step) || Step == 0) continue;
+        int64_t Final = Start + TripCount * Step;
+        if (Final < INT32_MIN || Final > INT32_MAX) continue;
+
+        CmpInst::Predicate P = T.StaySuccessor == 0 ? CmpInst::NE : CmpInst::EQ;
+        auto *Cmp = new CmpInst(Opcode::ICmp, P, Other, F.getInt32(static_cast<int32_t>(Final)));
+        Cmp->insertBefore(T.Branch);
+        T.Branch->setOperand(0, Cmp);
+        T.Compare->eraseFromParent();
+        IV->dropAllReferences();
+        Inc->dropAllReferences();
+        IV->eraseFromParent();
+        Inc->eraseFromParent();
+        SE.forgetAll();
+        ++ExitTests;
+        return true;
+    }
+    return false;
+}
+
+bool IndVarSimplify::runOnLoop(Loop &L) {
+    if (!L.getLoopPreheader() || !L.getLoopLatch()) return false;
+    bool Changed = reduceMultiplies(L);
+    int64_t TripCount = SE.getConstantTripCount(&L);
+    if (TripCount < 0 || !L.getExitBlock()) return Changed;
+    Changed |= rewriteExitValues(L, TripCount);
+    Changed |= rewriteExitTest(L, TripCount);
+    return Changed;
+}
+
+bool sysy::runIndVarSimplify(Function &F, LoopInfo &LI) {
+    if (LI.empty()) return false;
+    IndVarSimplify Pass(F, LI);
+    bool Changed = false;
+    for (Loop *L : LI.getLoopsInPostorder()) Changed |= Pass.runOnLoop(*L);
+    Pass.updateStatistics();
+    return Changed;
+}
@@ -0,0 +1,152 @@
+#include "Transforms/Inliner.h"
+#include "Analysis/CallGraph.h"
+#include "Analysis/Dominators.h"
+#include "Analysis/LoopInfo.h"
+#include "Basic/Statistic.h"
+#include "IR/Module.h"
+#include "Transforms/Cloning.h"
+#include <unordered_map>
+#include <unordered_set>
+
+using namespace sysy;
+
+STATISTIC(NumInlined, "inline", "Number of call sites inlined");
+STATISTIC(NumDeleted, "inline", "Number of functions deleted after inlining");
+
+namespace {
+
+constexpr int InlineThreshold = 45;
+constexpr int LoopCallBonus = 60;       // The call runs many times
+constexpr int LastCallBonus = 200;      // The callee is deleted afterwards
+constexpr int ConstantArgBonus = 10;    // Lets SCCP fold parts of the body
+constexpr unsigned MaxCallerSize = 10000;
+
+/// Instructions the callee adds to the caller once inlined. Allocas, phis
+/// and jumps mostly disappear in later passes.
+int getFunctionCost(const Function &F) {
+    int Cost = 0;
+    for (BasicBlock &BB : F) {
+        for (Instruction &I : BB) {
+            switch (I.getOpcode()) {
+            case Opcode::Alloca:
+            case Opcode::Phi:
+            case Opcode::Br:
+            case Opcode::Ret: break;
+            default: ++Cost;
+            }
+        }
+    }
+    return Cost;
+}
+
+class Inliner {
+    Module &M;
+    CallGraph CG;
+    std::unordered_map<const Function *, unsigned> NumCalls; // Call sites left
+    std::unordered_map<const Function *, int> Costs;
+    unsigned Inlined = 0;
+
+    int getCost(const Function *F) {
+        auto It = Costs.find(F);
+        if (It == Costs.end()) It = Costs.emplace(F, getFunctionCost(*F)).first;
+        return It->second;
+    }
+    bool shouldInline(CallInst *Call, bool InLoop);
+    void inlineCall(CallInst *Call);
+    void runOnFunction(Function &F);
+    unsigned deleteDeadFunctions();
+
+public:
+    explicit Inliner(Module &M) : M(M), CG(M) {
+        for (const auto &F : M) NumCalls[F.get()] = static_cast<unsigned>(CG.getCallSites(F.get()).size());
+    }
+    bool run();
+};
+
+} // namespace
+
+bool Inliner::shouldInline(CallInst *Call, bool InLoop) {
+    Function *Callee = Call->getCallee();
+    if (Callee->isDeclaration() || CG.isRecursive(Callee)) return false;
+
+    int Cost = getCost(Callee) - 1 - static_cast<int>(Call->getNumArgs());
+    for (unsigned i = 0, e = Call->getNumArgs(); i != e; ++i) {
+        if (isConstant(Call->getArg(i))) Cost -= ConstantArgBonus;
+    }
+    int Threshold = InlineThreshold;
+    if (InLoop) Threshold += LoopCallBonus;
+    if (NumCalls[Callee] == 1 && Callee->getName() != "main") Threshold += LastCallBonus;
+    return Cost <= Threshold;
+}
+
+void Inliner::inlineCall(CallInst *Call) {
+    Function *Callee = Call->getCallee();
+    // The copied body brings its own calls along.
+    for (BasicBlock &BB : *Callee) {
+        for (Instruction &I : BB) {
+            if (auto *C = dyn_cast<CallInst>(&I)) ++NumCalls[C->getCallee()];
+        }
+    }
+    --NumCalls[Callee];
+    inlineFunction(Call);
+    ++Inlined;
+}
+
+void Inliner::runOnFunction(Function &F) {
+    // The copied bodies were visited before this function (bottom-up), so
+    // only the calls present now are candidates.
+    std::vector<std::pair<CallInst *, bool>> Calls;
+    for (BasicBlock &BB : F) {
+        for (Instruction &I : BB) {
+            if (auto *Call = dyn_cast<CallInst>(&I)) Calls.push_back({Call, false});
+        }
+    }
+    if (Calls.empty()) return;
+    DominatorTree DT(F);
+    LoopInfo LI(DT);
+    for (auto &C : Calls) C.second = LI.getLoopFor(C.first->getParent()) != nullptr;
+
+    size_t Size = F.getInstructionCount();
+    for (auto &C : Calls) {
+        if (Size > MaxCallerSize || !shouldInline(C.first, C.second)) continue;
+        Size += C.first->getCallee()->getInstructionCount();
+        inlineCall(C.first);
+    }
+    Costs.erase(&F);
+}
+
+// Callers come last in the SCC order, so walking it backwards finds a dead
+// function before the callees it made look alive. Without a main, any
+// function may be the entry point.
+unsigned Inliner::deleteDeadFunctions() {
+    if (!M.getFunction("main")) return 0;
+    std::unordered_set<const Function *> Dead;
+    const auto &SCCs = CG.getSCCs();
+    for (auto It = SCCs.rbegin(); It != SCCs.rend(); ++It) {
+        for (Function *F : *It) {
+            if (F->isDeclaration() || NumCalls[F] || F->getName() == "main") continue;
+            for (BasicBlock &BB : *F) {
+                for (Instruction &I : BB) {
+                    if (auto *C = dyn_cast<CallInst>(&I)) --NumCalls[C->getCallee()];
+                }
+            }
+            Dead.insert(F);
+        }
+    }
+    M.eraseFunctions(Dead);
+    return static_cast<unsigned>(Dead.size());
+}
+
+bool Inliner::run() {
+    for (const auto &SCC : CG.getSCCs()) {
+        for (Function *F : SCC) {
+            if (!F->isDeclaration()) runOnFunction(*F);
+        }
+    }
+    unsigned Deleted = deleteDeadFunctions();
+    NumInlined += Inlined;
+    NumDeleted += Deleted;
+    return Inlined || Deleted;
+}
+
+bool sysy::runInliner(Module &M) { return Inliner(M).run(); }
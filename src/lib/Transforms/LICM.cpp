@@ -0,0 +1,225 @@
+#include "Transforms/LICM.h"
+#include "Analysis/LoopInfo.h"
+#include "Basic/Statistic.h"
+#include <algorithm>
+#include <unordered_map>
+
+using namespace sysy;
+
+STATISTIC(NumHoisted, "licm", "Number of instructions hoisted out of loops");
+STATISTIC(NumHoistedLoads, "licm", "Number of loads hoisted out of loops");
+STATISTIC(NumPromoted, "licm", "Number of variables promoted to registers in loops");
+STATISTIC(NumSunkStores, "licm", "Number of stores sunk out of loops");
+
+namespace {
+
+/// Distinct allocas never overlap; anything else might.
+bool mayAlias(const Value *P, const Value *Q) {
+    if (P == Q) return true;
+    return !(isa<AllocaInst>(P) && isa<AllocaInst>(Q));
+}
+
+/// The memory written anywhere in a loop, subloops included.
+struct LoopMemory {
+    std::vector<Value *> StoredPtrs;
+    bool WritesUnknown = false; // Something other than a plain store
+
+    explicit LoopMemory(const Loop &L) {
+        for (BasicBlock *BB : L.getBlocks()) {
+            for (Instruction &I : *BB) {
+                if (auto *SI = dyn_cast<StoreInst>(&I)) {
+                    Value *Ptr = SI->getPointerOperand();
+                    if (std::find(StoredPtrs.begin(), StoredPtrs.end(), Ptr) == StoredPtrs.end())
+                        StoredPtrs.push_back(Ptr);
+                } else if (I.mayWriteMemory()) {
+                    WritesUnknown = true;
+                }
+            }
+        }
+    }
+
+    bool mayBeClobbered(const Value *Ptr) const {
+        if (WritesUnknown) return true;
+        return std::any_of(StoredPtrs.begin(), StoredPtrs.end(),
+                           [&](const Value *S) { return mayAlias(S, Ptr); });
+    }
+};
+
+class LICM {
+    LoopInfo &LI;
+    unsigned Hoisted = 0, HoistedLoads = 0, Promoted = 0, SunkStores = 0;
+
+    bool isSafeToHoist(const Instruction *I, const Loop &L, const LoopMemory &Mem) const;
+    bool hoist(Loop &L, const LoopMemory &Mem);
+    bool canPromote(const Loop &L, Value *Ptr, const LoopMemory &Mem) const;
+    void promote(Loop &L, AllocaInst *AI);
+
+public:
+    explicit LICM(LoopInfo &LI) : LI(LI) {}
+    bool runOnLoop(Loop &L);
+    void updateStatistics() {
+        NumHoisted += Hoisted;
+        NumHoistedLoads += HoistedLoads;
+        NumPromoted += Promoted;
+        NumSunkStores += SunkStores;
+    }
+};
+
+} // namespace
+
+bool LICM::isSafeToHoist(const Instruction *I, const Loop &L, const LoopMemory &Mem) const {
+    for (unsigned i = 0, e = I->getNumOperands(); i != e; ++i) {
+        if (!L.isLoopInvariant(I->getOperand(i))) return false;
+    }
+    // Hoisted code also runs when the loop body would not, so it must not
+    // trap: only division by a constant other than zero may move.
+    if (I->getOpcode() == Opcode::SDiv || I->getOpcode() == Opcode::SRem) {
+        auto *C = dyn_cast<ConstantInt>(I->getOperand(1));
+        return C && !C->isZero();
+    }
+    if (I->isBinaryOp() || isa<CmpInst>(I) || isa<CastInst>(I) || isa<FNegInst>(I)) return true;
+    if (auto *LD = dyn_cast<LoadInst>(I)) {
+        // Loading a local variable is always safe to do early.
+        return isa<AllocaInst>(LD->getPointerOperand()) && !Mem.mayBeClobbered(LD->getPointerOperand());
+    }
+    return false;
+}
+
+bool LICM::hoist(Loop &L, const LoopMemory &Mem) {
+    Instruction *InsertPt = L.getLoopPreheader()->getTerminator();
+    bool Changed = false;
+    // Blocks of subloops had their turn; what stayed there varies in them.
+    // The RPO walk sees definitions before uses, so chains move together.
+    for (BasicBlock *BB : L.getBlocks()) {
+        if (LI.getLoopFor(BB) != &L) continue;
+        for (Instruction *I = BB->front(); I;) {
+            Instruction *Next = I->getNextNode();
+            if (isSafeToHoist(I, L, Mem)) {
+                I->moveBefore(InsertPt);
+                ++(isa<LoadInst>(I) ? HoistedLoads : Hoisted);
+                Changed = true;
+            }
+            I = Next;
+        }
+    }
+    return Changed;
+}
+
+/// \p Ptr can live in a register while the loop runs if it is a local
+/// variable whose every access in the loop is a load or store of the whole
+/// variable, and nothing else in the loop may write memory behind our back.
+bool LICM::canPromote(const Loop &L, Value *Ptr, const LoopMemory &Mem) const {
+    auto *AI = dyn_cast<AllocaInst>(Ptr);
+    if (!AI || !L.isLoopInvariant(AI) || Mem.WritesUnknown) return false;
+    for (Use &U : AI->uses()) {
+        Instruction *User = U.getUser();
+        if (!L.contains(User)) continue;
+        if (auto *LD = dyn_cast<LoadInst>(User)) {
+            if (LD->getType() != AI->getAllocatedType()) return false;
+        } else if (auto *SI = dyn_cast<StoreInst>(User)) {
+            if (U.getOperandNo() != 1 || SI->getValueOperand()->getType() != AI->getAllocatedType())
+                return false;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+void LICM::promote(Loop &L, AllocaInst *AI) {
+    Type Ty = AI->getAllocatedType();
+    BasicBlock *Preheader = L.getLoopPreheader();
+    auto *Init = new LoadInst(Ty, AI);
+    Init->insertBefore(Preheader->getTerminator());
+
+    // Value of the variable at the end of each block, filled in RPO. Only
+    // the header has predecessors outside the loop, and any block with
+    // several predecessors gets a phi, completed once every block is done.
+    std::unordered_map<const BasicBlock *, Value *> EndValue;
+    std::vector<PhiInst *> Phis;
+    EndValue[Preheader] = Init;
+    for (BasicBlock *BB : L.getBlocks()) {
+        Value *Cur;
+        std::vector<BasicBlock *> Preds = BB->getPredecessors();
+        if (Preds.size() == 1) {
+            Cur = EndValue[Preds[0]];
+        } else {
+            auto *Phi = new PhiInst(Ty, static_cast<unsigned>(Preds.size()));
+            Phi->insertInto(BB, BB->front());
+            Phis.push_back(Phi);
+            Cur = Phi;
+        }
+        for (Instruction *I = BB->front(); I;) {
+            Instruction *Next = I->getNextNode();
+            if (auto *LD = dyn_cast<LoadInst>(I)) {
+                if (LD->getPointerOperand() == AI) {
+                    LD->replaceAllUsesWith(Cur);
+                    LD->eraseFromParent();
+                }
+            } else if (auto *SI = dyn_cast<StoreInst>(I)) {
+                if (SI->getPointerOperand() == AI) {
+                    Cur = SI->getValueOperand();
+                    SI->eraseFromParent();
+                }
+            }
+            I = Next;
+        }
+        EndValue[BB] = Cur;
+    }
+    for (PhiInst *Phi : Phis) {
+        for (BasicBlock *P : Phi->getParent()->getPredecessors()) Phi->addIncoming(EndValue[P], P);
+    }
+
+    // Write the final value back once on the way out.
+    for (BasicBlock *Exit : L.getExitBlocks()) {
+        std::vector<BasicBlock *> Preds = Exit->getPredecessors();
+        Value *Final = EndValue[Preds[0]];
+        if (Preds.size() > 1) {
+            auto *Phi = new PhiInst(Ty, static_cast<unsigned>(Preds.size()));
+            for (BasicBlock *P : Preds) Phi->addIncoming(EndValue[P], P);
+            Phi->insertInto(Exit, Exit->front());
+            Phis.push_back(Phi);
+            Final = Phi;
+        }
+        (new StoreInst(Final, AI))->insertBefore(Exit->getFirstNonPhi());
+        ++SunkStores;
+    }
+
+    // Most of the phis merge one value with itself.
+    for (bool Changed = true; Changed;) {
+        Changed = false;
+        for (PhiInst *&Phi : Phis) {
+            if (!Phi) continue;
+            Value *V = Phi->hasConstantValue();
+            if (!V) continue;
+            Phi->replaceAllUsesWith(V);
+            Phi->eraseFromParent();
+            Phi = nullptr;
+            Changed = true;
+        }
+    }
+    ++Promoted;
+}
+
+bool LICM::runOnLoop(Loop &L) {
+    if (!L.getLoopPreheader() || !L.hasDedicatedExits()) return false;
+    LoopMemory Mem(L);
+    bool Changed = false;
+    for (Value *Ptr : Mem.StoredPtrs) {
+        if (!canPromote(L, Ptr, Mem)) continue;
+        promote(L, cast<AllocaInst>(Ptr));
+        Changed = true;
+    }
+    if (Changed) Mem = LoopMemory(L);
+    Changed |= hoist(L, Mem);
+    return Changed;
+}
+
+bool sysy::runLICM(Function &F, LoopInfo &LI) {
+    if (F.empty()) return false;
+    LICM Pass(LI);
+    bool Changed = false;
+    for (Loop *L : LI.getLoopsInPostorder()) Changed |= Pass.runOnLoop(*L);
+    Pass.updateStatistics();
+    return Changed;
+}
@@ -0,0 +1,270 @@
+#include "Transforms/LoopUnroll.h"
+#include "Analysis/LoopInfo.h"
+#include "Analysis/ScalarEvolution.h"
+#include "Basic/Statistic.h"
+#include "Transforms/Cloning.h"
+#include "Transforms/LoopUtils.h"
+
+using namespace sysy;
+
+STATISTIC(NumFullyUnrolled, "loop-unroll", "Number of loops unrolled completely");
+STATISTIC(NumPartiallyUnrolled, "loop-unroll", "Number of loops unrolled with a remainder loop");
+
+namespace {
+
+constexpr unsigned FullUnrollMaxSize = 256;    // Instructions after unrolling
+constexpr unsigned UnrollCount = 4;
+constexpr unsigned PartialUnrollMaxSize = 160; // Instructions after unrolling
+
+unsigned getLoopSize(const Loop &L) {
+    unsigned Size = 0;
+    for (BasicBlock *BB : L.getBlocks()) Size += static_cast<unsigned>(BB->size());
+    return Size;
+}
+
+/// Replace the conditional branch ending \p BB by a jump to successor
+/// \p Keep. The condition goes too if nothing else uses it.
+void foldBranch(BasicBlock *BB, unsigned Keep) {
+    auto *Br = cast<BranchInst>(BB->getTerminator());
+    BasicBlock *Dest = Br->getSuccessor(Keep);
+    Br->getSuccessor(1 - Keep)->removePredecessor(BB);
+    Value *Cond = Br->getCondition();
+    Br->eraseFromParent();
+    BB->push_back(new BranchInst(Dest));
+    if (auto *I = dyn_cast<Instruction>(Cond)) {
+        if (I->use_empty()) I->eraseFromParent();
+    }
+}
+
+class LoopUnroller {
+    Function &F;
+    ScalarEvolution SE;
+    unsigned Full = 0, Partial = 0;
+
+    void unrollIterations(Loop &L, unsigned Count, std::vector<ValueMap> &Maps);
+    void fullyUnroll(Loop &L, unsigned StaySucc, int64_t TripCount);
+    bool partiallyUnroll(Loop &L, const LoopExitTest &T);
+
+public:
+    LoopUnroller(Function &F, LoopInfo &LI) : F(F), SE(F, LI) {}
+    bool runOnLoop(Loop &L);
+    void updateStatistics() {
+        NumFullyUnrolled += Full;
+        NumPartiallyUnrolled += Partial;
+    }
+};
+
+} // namespace
+
+/// Chain Count - 1 copies of the loop body after the original one. Copy j
+/// starts from the values copy j - 1 carries around the back edge instead
+/// of from header phis, and the back edge of the last copy returns to the
+/// original header. Each copy keeps its exit test; the exit block's phis
+/// get an entry for every copied header. Maps[j] maps the original loop
+/// to copy j (Maps[0] is empty: copy 0 is the original).
+void LoopUnroller::unrollIterations(Loop &L, unsigned Count, std::vector<ValueMap> &Maps) {
+    BasicBlock *Header = L.getHeader();
+    BasicBlock *Latch = L.getLoopLatch();
+    auto *HeaderBr = cast<BranchInst>(Header->getTerminator());
+    BasicBlock *Exit = HeaderBr->getSuccessor(L.contains(HeaderBr->getSuccessor(0)) ? 1 : 0);
+    std::vector<PhiInst *> HeaderPhis;
+    for (Instruction &I : *Header) {
+        auto *Phi = dyn_cast<PhiInst>(&I);
+        if (!Phi) break;
+        HeaderPhis.push_back(Phi);
+    }
+
+    Maps.assign(Count, ValueMap());
+    std::vector<BasicBlock *> NewBlocks;
+    std::vector<Value *> Carried;
+    for (unsigned j = 1; j < Count; ++j) {
+        ValueMap &VMap = Maps[j];
+        NewBlocks.clear();
+        for (BasicBlock *BB : L.getBlocks()) NewBlocks.push_back(cloneBasicBlock(BB, VMap, "", Exit));
+        for (BasicBlock *BB : NewBlocks) {
+            for (Instruction &I : *BB) remapInstruction(&I, VMap);
+        }
+
+        Carried.clear();
+        for (PhiInst *Phi : HeaderPhis)
+            Carried.push_back(lookupValue(Maps[j - 1], Phi->getIncomingValueForBlock(Latch)));
+        for (size_t k = 0; k < HeaderPhis.size(); ++k) {
+            auto *Copy = cast<PhiInst>(VMap[HeaderPhis[k]]);
+            Copy->replaceAllUsesWith(Carried[k]);
+            Copy->eraseFromParent();
+            VMap[HeaderPhis[k]] = Carried[k];
+        }
+
+        auto *CopyHeader = cast<BasicBlock>(VMap[Header]);
+        for (Instruction &I : *Exit) {
+            auto *Phi = dyn_cast<PhiInst>(&I);
+            if (!Phi) break;
+            if (Value *V = Phi->getIncomingValueForBlock(Header)) Phi->addIncoming(lookupValue(VMap, V), CopyHeader);
+        }
+    }
+    if (Count < 2) return;
+
+    // Chain the back edges only now: cloning copies the original latch,
+    // which must still branch to the original header.
+    for (unsigned j = 1; j < Count; ++j) {
+        auto *PrevLatch = cast<BasicBlock>(lookupValue(Maps[j - 1], Latch));
+        PrevLatch->getTerminator()->replaceUsesOfWith(lookupValue(Maps[j - 1], Header), Maps[j][Header]);
+    }
+    ValueMap &Last = Maps[Count - 1];
+    auto *LastLatch = cast<BasicBlock>(Last[Latch]);
+    LastLatch->getTerminator()->replaceUsesOfWith(Last[Header], Header);
+    for (PhiInst *Phi : HeaderPhis) {
+        auto Idx = static_cast<unsigned>(Phi->getBasicBlockIndex(Latch));
+        Phi->setIncomingValue(Idx, lookupValue(Last, Phi->getIncomingValue(Idx)));
+        Phi->setIncomingBlock(Idx, LastLatch);
+    }
+}
+
+/// TripCount + 1 copies: every header but the last one is known to enter
+/// the body, the last one to leave.
+void LoopUnroller::fullyUnroll(Loop &L, unsigned StaySucc, int64_t TripCount) {
+    BasicBlock *Header = L.getHeader();
+    std::vector<ValueMap> Maps;
+    unrollIterations(L, static_cast<unsigned>(TripCount) + 1, Maps);
+    for (int64_t j = 0; j <= TripCount; ++j) {
+        auto *CopyHeader = cast<BasicBlock>(lookupValue(Maps[j], Header));
+        foldBranch(CopyHeader, j < TripCount ? StaySucc : 1 - StaySucc);
+    }
+    // The last copy's body, and with it the back edge, is dead now.
+    F.removeUnreachableBlocks();
+    for (Instruction *I = Header->front(); I && isa<PhiInst>(I);) {
+        Instruction *Next = I->getNextNode();
+        if (Value *V = cast<PhiInst>(I)->hasConstantValue()) {
+            I->replaceAllUsesWith(V);
+            I->eraseFromParent();
+        }
+        I = Next;
+    }
+    ++Full;
+}
+
+/// The unrolled loop runs UnrollCount trips per round while
+///   IV Pred Bound - (UnrollCount - 1) * Step
+/// holds, which is when all of them would pass the original test (and the
+/// IV cannot wrap in between). A copy of the original loop, entered when
+/// that fails, runs the rest. If the adjusted bound could wrap, a guard in
+/// the preheader sends such runs straight to the remainder loop.
+bool LoopUnroller::partiallyUnroll(Loop &L, const LoopExitTest &T) {
+    int32_t Step;
+    ScalarEvolution::getConstantValue(T.IV->getStep(), Step);
+    bool Up = T.Pred == CmpInst::LT || T.Pred == CmpInst::LE;
+    bool Down = T.Pred == CmpInst::GT || T.Pred == CmpInst::GE;
+    if (!(Up && Step > 0) && !(Down && Step < 0)) return false;
+    int64_t Adjust = static_cast<int64_t>(UnrollCount - 1) * Step;
+    if (Adjust < INT32_MIN || Adjust > INT32_MAX) return false;
+
+    Value *NewBound = nullptr;
+    Value *Guard = nullptr;
+    BasicBlock *Preheader = L.getLoopPreheader();
+    if (auto *C = dyn_cast<ConstantInt>(T.Bound)) {
+        int64_t B = static_cast<int64_t>(C->getValue()) - Adjust;
+        if (B < INT32_MIN || B > INT32_MAX) return false;
+        NewBound = F.getInt32(static_cast<int32_t>(B));
+    } else {
+        Instruction *Pos = Preheader->getTerminator();
+        NewBound = new BinaryInst(Opcode::Sub, T.Bound, F.getInt32(static_cast<int32_t>(Adjust)));
+        cast<Instruction>(NewBound)->insertBefore(Pos);
+        int64_t Limit = Up ? INT32_MIN + Adjust : INT32_MAX + Adjust;
+        Guard = new CmpInst(Opcode::ICmp, Up ? CmpInst::GE : CmpInst::LE, T.Bound,
+                            F.getInt32(static_cast<int32_t>(Limit)));
+        cast<Instruction>(Guard)->insertBefore(Pos);
+    }
+
+    BasicBlock *Header = L.getHeader();
+    unsigned Leave = 1 - T.StaySuccessor;
+    BasicBlock *Exit = T.Branch->getSuccessor(Leave);
+
+    // The remainder loop, entered through its own preheader.
+    ValueMap RMap;
+    std::vector<BasicBlock *> RemBlocks;
+    for (BasicBlock *BB : L.getBlocks()) RemBlocks.push_back(cloneBasicBlock(BB, RMap, ".rem", Exit));
+    for (BasicBlock *BB : RemBlocks) {
+        for (Instruction &I : *BB) remapInstruction(&I, RMap);
+    }
+    auto *RemHeader = cast<BasicBlock>(RMap[Header]);
+    auto *RemPreheader = new BasicBlock(Header->getName() + ".rem.preheader");
+    RemPreheader->insertInto(&F, RemHeader);
+    RemPreheader->push_back(new BranchInst(RemHeader));
+
+    for (Instruction &I : *Exit) {
+        auto *Phi = dyn_cast<PhiInst>(&I);
+        if (!Phi) break;
+        int Idx = Phi->getBasicBlockIndex(Header);
+        if (Idx < 0) continue;
+        Phi->setIncomingValue(Idx, lookupValue(RMap, Phi->getIncomingValue(Idx)));
+        Phi->setIncomingBlock(Idx, RemHeader);
+    }
+    T.Branch->setSuccessor(Leave, RemPreheader);
+    if (Guard) {
+        Preheader->getTerminator()->eraseFromParent();
+        Preheader->push_back(new BranchInst(Guard, Header, RemPreheader));
+    }
+    for (Instruction &I : *Header) {
+        auto *Phi = dyn_cast<PhiInst>(&I);
+        if (!Phi) break;
+        auto *RemPhi = cast<PhiInst>(RMap[Phi]);
+        auto Idx = static_cast<unsigned>(RemPhi->getBasicBlockIndex(Preheader));
+        Value *Resume = Phi;
+        if (Guard) {
+            auto *Merge = new PhiInst(Phi->getType(), 2);
+            Merge->addIncoming(Phi, Header);
+            Merge->addIncoming(Phi->getIncomingValueForBlock(Preheader), Preheader);
+            Merge->insertInto(RemPreheader, RemPreheader->front());
+            Resume = Merge;
+        }
+        RemPhi->setIncomingValue(Idx, Resume);
+        RemPhi->setIncomingBlock(Idx, RemPreheader);
+    }
+
+    // The unrolled loop; only the first header of a round keeps a test.
+    std::vector<ValueMap> Maps;
+    unrollIterations(L, UnrollCount, Maps);
+    for (unsigned j = 1; j < UnrollCount; ++j)
+        foldBranch(cast<BasicBlock>(Maps[j][Header]), T.StaySuccessor);
+
+    CmpInst::Predicate P = T.StaySuccessor == 0 ? T.Pred : CmpInst::getInversePredicate(T.Pred);
+    auto *Cmp = new CmpInst(Opcode::ICmp, P, T.IVValue, NewBound);
+    Cmp->insertBefore(T.Branch);
+    T.Branch->setOperand(0, Cmp);
+    if (T.Compare->use_empty()) T.Compare->eraseFromParent();
+    ++Partial;
+    return true;
+}
+
+bool LoopUnroller::runOnLoop(Loop &L) {
+    BasicBlock *Latch = L.getLoopLatch();
+    if (!L.getSubLoops().empty() || !L.getLoopPreheader() || !Latch || Latch == L.getHeader() ||
+        !L.getExitBlock() || !L.hasDedicatedExits() || !isLCSSAForm(L))
+        return false;
+    LoopExitTest T;
+    if (!SE.getLoopExitTest(&L, T)) return false;
+
+    bool Changed = false;
+    int64_t Size = getLoopSize(L);
+    int64_t TripCount = SE.getConstantTripCount(&L);
+    if (TripCount >= 0 && (TripCount + 1) * Size <= FullUnrollMaxSize) {
+        fullyUnroll(L, T.StaySuccessor, TripCount);
+        Changed = true;
+    } else if ((TripCount < 0 || TripCount >= UnrollCount) && L.getBlocks().size() == 2 &&
+               Size * UnrollCount <= PartialUnrollMaxSize) {
+        // Only straight-line bodies: with branches inside, a round saves
+        // little beyond the exit tests but copies the whole body five times.
+        Changed = partiallyUnroll(L, T);
+    }
+    if (Changed) SE.forgetAll();
+    return Changed;
+}
+
+bool sysy::runLoopUnroll(Function &F, LoopInfo &LI) {
+    if (LI.empty()) return false;
+    LoopUnroller Pass(F, LI);
+    bool Changed = false;
+    for (Loop *L : LI.getLoopsInPostorder()) Changed |= Pass.runOnLoop(*L);
+    Pass.updateStatistics();
+    return Changed;
+}
@@ -0,0 +1,159 @@
+#include "Transforms/LoopUtils.h"
+#include "Analysis/Dominators.h"
+#include "Analysis/LoopInfo.h"
+#include "Basic/Statistic.h"
+#include <algorithm>
+#include <unordered_map>
+
+using namespace sysy;
+
+STATISTIC(NumPreheaders, "loop-simplify", "Number of preheaders inserted");
+STATISTIC(NumExitBlocks, "loop-simplify", "Number of dedicated exit blocks inserted");
+STATISTIC(NumLCSSAPhis, "lcssa", "Number of loop-closing phis inserted");
+
+BasicBlock *sysy::splitBlockPredecessors(BasicBlock *BB, const std::vector<BasicBlock *> &Preds,
+                                         const std::string &Suffix) {
+    auto *New = new BasicBlock(BB->getName() + Suffix);
+    New->insertInto(BB->getParent(), BB);
+    New->push_back(new BranchInst(BB));
+    for (BasicBlock *P : Preds) P->getTerminator()->replaceUsesOfWith(BB, New);
+
+    for (Instruction &I : *BB) {
+        auto *Phi = dyn_cast<PhiInst>(&I);
+        if (!Phi) break;
+        // Pull out the entries of the moved edges, last first so removal
+        // does not disturb the indices still to visit.
+        PhiInst *NewPhi = nullptr;
+        Value *Common = nullptr;
+        bool Same = true;
+        for (unsigned i = Phi->getNumIncomingValues(); i-- > 0;) {
+            BasicBlock *In = Phi->getIncomingBlock(i);
+            if (std::find(Preds.begin(), Preds.end(), In) == Preds.end()) continue;
+            Value *V = Phi->getIncomingValue(i);
+            if (!NewPhi) {
+                NewPhi = new PhiInst(Phi->getType(), static_cast<unsigned>(Preds.size()));
+                Common = V;
+            }
+            Same &= V == Common;
+            NewPhi->addIncoming(V, In);
+            Phi->removeIncoming(i);
+        }
+        if (!NewPhi) continue;
+        if (Same) {
+            delete NewPhi;
+            Phi->addIncoming(Common, New);
+        } else {
+            NewPhi->insertInto(New, New->front());
+            Phi->addIncoming(NewPhi, New);
+        }
+    }
+    return New;
+}
+
+bool sysy::simplifyLoop(Loop *L, LoopInfo &LI) {
+    bool Changed = false;
+    BasicBlock *Header = L->getHeader();
+    if (!L->getLoopPreheader()) {
+        std::vector<BasicBlock *> Outside;
+        for (BasicBlock *P : Header->getPredecessors()) {
+            if (!L->contains(P)) Outside.push_back(P);
+        }
+        if (!Outside.empty()) {
+            BasicBlock *PH = splitBlockPredecessors(Header, Outside, ".preheader");
+            LI.addBlockToLoop(PH, L->getParentLoop());
+            ++NumPreheaders;
+            Changed = true;
+        }
+    }
+
+    for (BasicBlock *Exit : L->getExitBlocks()) {
+        std::vector<BasicBlock *> Inside;
+        bool Dedicated = true;
+        for (BasicBlock *P : Exit->getPredecessors()) {
+            if (L->contains(P)) Inside.push_back(P);
+            else Dedicated = false;
+        }
+        if (Dedicated) continue;
+        BasicBlock *New = splitBlockPredecessors(Exit, Inside, ".loopexit");
+        // The new block sits in every loop around L that also holds Exit.
+        Loop *Outer = L->getParentLoop();
+        while (Outer && !Outer->contains(Exit)) Outer = Outer->getParentLoop();
+        LI.addBlockToLoop(New, Outer);
+        ++NumExitBlocks;
+        Changed = true;
+    }
+    return Changed;
+}
+
+namespace {
+
+// The block where a use reads its value: phis read at the end of the
+// incoming block.
+BasicBlock *getUseBlock(const Use &U) {
+    Instruction *User = U.getUser();
+    if (auto *Phi = dyn_cast<PhiInst>(User)) return Phi->getIncomingBlock(U.getOperandNo() / 2);
+    return User->getParent();
+}
+
+} // namespace
+
+bool sysy::formLCSSA(Loop &L, const DominatorTree &DT) {
+    std::vector<BasicBlock *> Exits = L.getExitBlocks();
+    if (Exits.empty()) return false;
+
+    bool Changed = false;
+    std::vector<Use *> OutsideUses;
+    std::unordered_map<BasicBlock *, PhiInst *> ExitPhis;
+    for (BasicBlock *BB : L.getBlocks()) {
+        for (Instruction &I : *BB) {
+            OutsideUses.clear();
+            for (Use &U : I.uses()) {
+                if (!L.contains(getUseBlock(U))) OutsideUses.push_back(&U);
+            }
+            if (OutsideUses.empty()) continue;
+
+            ExitPhis.clear();
+            for (Use *U : OutsideUses) {
+                BasicBlock *UseBB = getUseBlock(*U);
+                auto It = std::find_if(Exits.begin(), Exits.end(), [&](BasicBlock *Exit) {
+                    return DT.dominates(BB, Exit) && DT.dominates(Exit, UseBB);
+                });
+                if (It == Exits.end()) continue;
+                PhiInst *&Phi = ExitPhis[*It];
+                if (!Phi) {
+                    std::vector<BasicBlock *> Preds = (*It)->getPredecessors();
+                    Phi = new PhiInst(I.getType(), static_cast<unsigned>(Preds.size()));
+                    for (BasicBlock *P : Preds) Phi->addIncoming(&I, P);
+                    Phi->insertInto(*It, (*It)->front());
+                    ++NumLCSSAPhis;
+                    Changed = true;
+                }
+                U->set(Phi);
+            }
+        }
+    }
+    return Changed;
+}
+
+bool sysy::isLCSSAForm(const Loop &L) {
+    for (BasicBlock *BB : L.getBlocks()) {
+        for (Instruction &I : *BB) {
+            for (Use &U : I.uses()) {
+                if (!L.contains(getUseBlock(U))) return false;
+            }
+        }
+    }
+    return true;
+}
+
+bool sysy::simplifyLoops(Function &F, DominatorTree &DT, LoopInfo &LI) {
+    bool CFGChanged = false;
+    for (Loop *L : LI.getLoopsInPostorder()) CFGChanged |= simplifyLoop(L, LI);
+    if (CFGChanged) {
+        DT.recalculate(F);
+        LI.recalculate(DT);
+    }
+    bool Changed = CFGChanged;
+    for (Loop *L : LI.getLoopsInPostorder()) Changed |= formLCSSA(*L, DT);
+    return Changed;
+}
@@ -0,0 +1,287 @@
+#include "Transforms/Mem2Reg.h"
+#include "Analysis/Dominators.h"
+#include "Basic/Statistic.h"
+#include <memory>
+
+using namespace sysy;
+
+STATISTIC(NumPromoted, "mem2reg", "Number of allocas promoted");
+STATISTIC(NumDeadAlloca, "mem2reg", "Number of allocas that were never read");
+STATISTIC(NumPHIInsert, "mem2reg", "Number of phis inserted");
+STATISTIC(NumPHISimplified, "mem2reg", "Number of inserted phis that were redundant");
+
+bool sysy::isAllocaPromotable(const AllocaInst *AI) {
+    for (Use &U : AI->uses()) {
+        Instruction *I = U.getUser();
+        if (auto *LI = dyn_cast<LoadInst>(I)) {
+            if (LI->getType() != AI->getAllocatedType()) return false;
+        } else if (auto *SI = dyn_cast<StoreInst>(I)) {
+            // Storing the address itself lets it escape.
+            if (U.getOperandNo() != 1 || SI->getValueOperand()->getType() != AI->getAllocatedType())
+                return false;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+namespace {
+
+class PromoteMem2Reg {
+    Function &F;
+    DominatorTree &DT;
+    std::vector<AllocaInst *> Allocas;
+    std::unordered_map<const AllocaInst *, unsigned> AllocaIndex;
+    std::unordered_map<const PhiInst *, unsigned> PhiToAlloca;
+    std::vector<PhiInst *> NewPhis;
+    std::vector<std::vector<unsigned>> Preds; // By RPO index
+
+    // Scratch flags by RPO index, cleared after each alloca.
+    std::vector<char> IsDefBlock, IsUseBlock, IsLiveIn, HasPhi;
+
+    unsigned indexOf(const BasicBlock *BB) const { return DT.getNode(BB)->getIndex(); }
+    int getAllocaIndex(const Value *Ptr) const {
+        auto *AI = dyn_cast<AllocaInst>(Ptr);
+        if (!AI) return -1;
+        auto It = AllocaIndex.find(AI);
+        return It == AllocaIndex.end() ? -1 : static_cast<int>(It->second);
+    }
+
+    void computeLiveInBlocks(AllocaInst *AI, const std::vector<unsigned> &UseBlocks,
+                             std::vector<unsigned> &LiveIn);
+    void placePhis(unsigned AllocaNo, const std::vector<unsigned> &DefBlocks,
+                   const DominanceFrontier &DF);
+    void rename();
+    void renameBlock(BasicBlock *BB, std::vector<Value *> &Cur,
+                     std::vector<std::pair<unsigned, Value *>> &Undo);
+    void simplifyPhis();
+
+public:
+    PromoteMem2Reg(Function &F, DominatorTree &DT) : F(F), DT(DT) {}
+    bool run();
+};
+
+// A block needs the incoming value of the variable if it reads it before
+// (re)defining it, or if a successor needs it and the block does not define
+// it. Walk backwards from the reads.
+void PromoteMem2Reg::computeLiveInBlocks(AllocaInst *AI, const std::vector<unsigned> &UseBlocks,
+                                         std::vector<unsigned> &LiveIn) {
+    std::vector<unsigned> Worklist;
+    for (unsigned B : UseBlocks) {
+        if (IsDefBlock[B]) {
+            // Defined and used here: live-in only if a load comes first.
+            bool LoadFirst = false;
+            for (Instruction &I : *DT.getBlock(B)) {
+                if (auto *SI = dyn_cast<StoreInst>(&I)) {
+                    if (SI->getPointerOperand() == AI) break;
+                } else if (auto *LI = dyn_cast<LoadInst>(&I)) {
+                    if (LI->getPointerOperand() == AI) {
+                        LoadFirst = true;
+                        break;
+                    }
+                }
+            }
+            if (!LoadFirst) continue;
+        }
+        Worklist.push_back(B);
+    }
+
+    while (!Worklist.empty()) {
+        unsigned B = Worklist.back();
+        Worklist.pop_back();
+        if (IsLiveIn[B]) continue;
+        IsLiveIn[B] = true;
+        LiveIn.push_back(B);
+        for (unsigned P : Preds[B]) {
+            if (!IsDefBlock[P] && !IsLiveIn[P]) Worklist.push_back(P);
+        }
+    }
+}
+
+void PromoteMem2Reg::placePhis(unsigned AllocaNo, const std::vector<unsigned> &DefBlocks,
+                               const DominanceFrontier &DF) {
+    AllocaInst *AI = Allocas[AllocaNo];
+    std::vector<unsigned> Worklist(DefBlocks);
+    std::vector<unsigned> Touched;
+    while (!Worklist.empty()) {
+        unsigned B = Worklist.back();
+        Worklist.pop_back();
+        for (unsigned Y : DF.getFrontier(B)) {
+            if (HasPhi[Y] || !IsLiveIn[Y]) continue;
+            HasPhi[Y] = true;
+            Touched.push_back(Y);
+            BasicBlock *BB = DT.getBlock(Y);
+            auto *Phi = new PhiInst(AI->getAllocatedType(), static_cast<unsigned>(Preds[Y].size()));
+            Phi->insertInto(BB, BB->front());
+            PhiToAlloca[Phi] = AllocaNo;
+            NewPhis.push_back(Phi);
+            ++NumPHIInsert;
+            // The phi is a new definition of the variable.
+            if (!IsDefBlock[Y]) Worklist.push_back(Y);
+        }
+    }
+    for (unsigned Y : Touched) HasPhi[Y] = false;
+}
+
+void PromoteMem2Reg::renameBlock(BasicBlock *BB, std::vector<Value *> &Cur,
+                                 std::vector<std::pair<unsigned, Value *>> &Undo) {
+    auto Define = [&](unsigned Idx, Value *V) {
+        Undo.push_back({Idx, Cur[Idx]});
+        Cur[Idx] = V;
+    };
+    for (auto It = BB->begin(); It != BB->end();) {
+        Instruction *I = &*It++;
+        if (auto *Phi = dyn_cast<PhiInst>(I)) {
+            auto P = PhiToAlloca.find(Phi);
+            if (P != PhiToAlloca.end()) Define(P->second, Phi);
+        } else if (auto *LI = dyn_cast<LoadInst>(I)) {
+            int Idx = getAllocaIndex(LI->getPointerOperand());
+            if (Idx < 0) continue;
+            LI->replaceAllUsesWith(Cur[Idx]);
+            LI->eraseFromParent();
+        } else if (auto *SI = dyn_cast<StoreInst>(I)) {
+            int Idx = getAllocaIndex(SI->getPointerOperand());
+            if (Idx < 0) continue;
+            Define(static_cast<unsigned>(Idx), SI->getValueOperand());
+            SI->eraseFromParent();
+        }
+    }
+    for (unsigned s = 0, e = BB->getNumSuccessors(); s != e; ++s) {
+        for (Instruction &I : *BB->getSuccessor(s)) {
+            auto *Phi = dyn_cast<PhiInst>(&I);
+            if (!Phi) break;
+            auto P = PhiToAlloca.find(Phi);
+            if (P != PhiToAlloca.end()) Phi->addIncoming(Cur[P->second], BB);
+        }
+    }
+}
+
+// Walk the dominator tree keeping the current value of every variable. A
+// block sees the values left by its immediate dominator; the undo log puts
+// them back when the walk leaves a subtree.
+void PromoteMem2Reg::rename() {
+    std::vector<Value *> Cur;
+    for (AllocaInst *AI : Allocas) Cur.push_back(F.getUndef(AI->getAllocatedType()));
+    std::vector<std::pair<unsigned, Value *>> Undo;
+
+    struct Frame {
+        DomTreeNode *Node;
+        size_t NextChild;
+        size_t UndoMark;
+    };
+    std::vector<Frame> Stack;
+    Stack.push_back({DT.getRootNode(), 0, Undo.size()});
+    renameBlock(DT.getRootNode()->getBlock(), Cur, Undo);
+    while (!Stack.empty()) {
+        Frame &Top = Stack.back();
+        if (Top.NextChild < Top.Node->getChildren().size()) {
+            DomTreeNode *Child = Top.Node->getChildren()[Top.NextChild++];
+            Stack.push_back({Child, 0, Undo.size()});
+            renameBlock(Child->getBlock(), Cur, Undo);
+            continue;
+        }
+        while (Undo.size() > Top.UndoMark) {
+            Cur[Undo.back().first] = Undo.back().second;
+            Undo.pop_back();
+        }
+        Stack.pop_back();
+    }
+}
+
+// Pruning keeps most useless phis out, but a phi whose inputs all turn out
+// to be the same value (a variable only re-assigned on some paths to the
+// value it already had) is still possible.
+void PromoteMem2Reg::simplifyPhis() {
+    for (bool Changed = true; Changed;) {
+        Changed = false;
+        for (PhiInst *&Phi : NewPhis) {
+            if (!Phi) continue;
+            Value *V = Phi->hasConstantValue();
+            if (V) Phi->replaceAllUsesWith(V);
+            else if (!Phi->use_empty()) continue;
+            Phi->eraseFromParent();
+            Phi = nullptr;
+            ++NumPHISimplified;
+            Changed = true;
+        }
+    }
+}
+
+bool PromoteMem2Reg::run() {
+    BasicBlock *Entry = F.getEntryBlock();
+    for (Instruction &I : *Entry) {
+        auto *AI = dyn_cast<AllocaInst>(&I);
+        if (AI && isAllocaPromotable(AI)) {
+            AllocaIndex[AI] = static_cast<unsigned>(Allocas.size());
+            Allocas.push_back(AI);
+        }
+    }
+    if (Allocas.empty()) return false;
+
+    unsigned NumBlocks = DT.getNumBlocks();
+    Preds.assign(NumBlocks, {});
+    for (unsigned i = 0; i < NumBlocks; ++i) {
+        for (BasicBlock *P : DT.getBlock(i)->getPredecessors()) {
+            if (DomTreeNode *N = DT.getNode(P)) Preds[i].push_back(N->getIndex());
+        }
+    }
+    IsDefBlock.assign(NumBlocks, false);
+    IsUseBlock.assign(NumBlocks, false);
+    IsLiveIn.assign(NumBlocks, false);
+    HasPhi.assign(NumBlocks, false);
+
+    std::unique_ptr<DominanceFrontier> DF; // Only needed once a variable has a read
+    std::vector<unsigned> DefBlocks, UseBlocks, LiveIn;
+    for (unsigned A = 0; A < Allocas.size(); ++A) {
+        AllocaInst *AI = Allocas[A];
+        DefBlocks.clear();
+        UseBlocks.clear();
+        bool HasLoad = false;
+        for (Use &U : AI->uses()) {
+            Instruction *I = U.getUser();
+            DomTreeNode *N = DT.getNode(I->getParent());
+            if (!N) continue;
+            if (isa<StoreInst>(I)) {
+                if (!IsDefBlock[N->getIndex()]) DefBlocks.push_back(N->getIndex());
+                IsDefBlock[N->getIndex()] = true;
+            } else {
+                HasLoad = true;
+                if (!IsUseBlock[N->getIndex()]) UseBlocks.push_back(N->getIndex());
+                IsUseBlock[N->getIndex()] = true;
+            }
+        }
+        if (HasLoad && !DefBlocks.empty()) {
+            if (!DF) DF = std::make_unique<DominanceFrontier>(DT);
+            LiveIn.clear();
+            computeLiveInBlocks(AI, UseBlocks, LiveIn);
+            placePhis(A, DefBlocks, *DF);
+            for (unsigned B : LiveIn) IsLiveIn[B] = false;
+        }
+        if (!HasLoad) ++NumDeadAlloca;
+        for (unsigned B : DefBlocks) IsDefBlock[B] = false;
+        for (unsigned B : UseBlocks) IsUseBlock[B] = false;
+    }
+
+    rename();
+
+    // Only loads and stores in unreachable blocks are left.
+    for (AllocaInst *AI : Allocas) {
+        while (Use *U = AI->getFirstUse()) {
+            Instruction *I = U->getUser();
+            if (!I->use_empty()) I->replaceAllUsesWith(F.getUndef(I->getType()));
+            I->eraseFromParent();
+        }
+        AI->eraseFromParent();
+        ++NumPromoted;
+    }
+
+    simplifyPhis();
+    return true;
+}
+
+} // namespace
+
+bool sysy::promoteMemoryToRegister(Function &F, DominatorTree &DT) {
+    return PromoteMem2Reg(F, DT).run();
+}
@@ -0,0 +1,277 @@
+#include "Transforms/PassManager.h"
+#include "Basic/Statistic.h"
+#include "Basic/ThreadPool.h"
+#include "IR/Module.h"
+#include "Transforms/GVN.h"
+#include "Transforms/IndVarSimplify.h"
+#include "Transforms/Inliner.h"
+#include "Transforms/LICM.h"
+#include "Transforms/LoopUnroll.h"
+#include "Transforms/LoopUtils.h"
+#include "Transforms/Mem2Reg.h"
+#include "Transforms/SCCP.h"
+#include "Transforms/SimplifyCFG.h"
+
+using namespace sysy;
+
+STATISTIC(NumDomTrees, "analysis", "Number of dominator trees computed");
+STATISTIC(NumLoopInfos, "analysis", "Number of loop infos computed");
+
+DominatorTree &FunctionAnalysisManager::getDomTree() {
+    if (!DT) {
+        TimeRecord Start = Times ? TimeRecord::nowForThread() : TimeRecord();
+        DT = std::make_unique<DominatorTree>(F);
+        ++NumDomTrees;
+        if (Times) {
+            Times->DomTree += TimeRecord::nowForThread() - Start;
+            ++Times->NumDomTrees;
+        }
+    }
+    return *DT;
+}
+
+LoopInfo &FunctionAnalysisManager::getLoopInfo() {
+    if (!LI) {
+        DominatorTree &DomTree = getDomTree();
+        TimeRecord Start = Times ? TimeRecord::nowForThread() : TimeRecord();
+        LI = std::make_unique<LoopInfo>(DomTree);
+        ++NumLoopInfos;
+        if (Times) {
+            Times->Loops += TimeRecord::nowForThread() - Start;
+            ++Times->NumLoopInfos;
+        }
+    }
+    return *LI;
+}
+
+void FunctionAnalysisManager::invalidate(PreservedAnalyses PA) {
+    if (PA != PreservedAnalyses::None) return;
+    LI.reset();
+    DT.reset();
+}
+
+void PassManager::addPass(std::unique_ptr<FunctionPass> P, bool OnlyAfterChange) {
+    if (Steps.empty() || Steps.back().MP) Steps.emplace_back();
+    Steps.back().FPs.push_back({std::move(P), OnlyAfterChange});
+}
+
+void PassManager::addPass(std::unique_ptr<ModulePass> P) {
+    Steps.emplace_back();
+    Steps.back().MP = std::move(P);
+}
+
+// Timing sums locally and reports once per pass, instead of taking the
+// TimerGroup's lock for every function. Each task keeps its own sums and
+// adds them to the shared ones when its function is done.
+void PassManager::runFunctionPasses(const Step &S, Module &M, TimerGroup *Timers, ThreadPool *Pool) {
+    struct Times {
+        std::vector<TimeRecord> Passes;
+        std::vector<unsigned> Runs;
+        AnalysisTimes Analyses;
+    };
+    Times Total{std::vector<TimeRecord>(S.FPs.size()), std::vector<unsigned>(S.FPs.size()), {}};
+    std::mutex TotalLock;
+
+    std::vector<Function *> Defs;
+    for (const auto &F : M) {
+        if (!F->isDeclaration()) Defs.push_back(F.get());
+    }
+    parallelFor(Pool, Defs.size(), [&](size_t FnIdx) {
+        Function &F = *Defs[FnIdx];
+        Times T{std::vector<TimeRecord>(S.FPs.size()), std::vector<unsigned>(S.FPs.size()), {}};
+        AnalysisTimes &ATimes = T.Analyses;
+        FunctionAnalysisManager AM(F, Timers ? &ATimes : nullptr);
+        bool Changed = false; // By the last pass without OnlyAfterChange
+        for (size_t i = 0; i < S.FPs.size(); ++i) {
+            const FunctionStep &FS = S.FPs[i];
+            if (FS.OnlyAfterChange && !Changed) continue;
+            TimeRecord Start, AnalysisStart;
+            if (Timers) {
+                Start = TimeRecord::nowForThread();
+                AnalysisStart = ATimes.DomTree + ATimes.Loops;
+            }
+            PreservedAnalyses PA = FS.P->run(F, AM);
+            AM.invalidate(PA);
+            if (!FS.OnlyAfterChange) Changed = PA != PreservedAnalyses::All;
+            // Analyses computed on the pass's behalf get their own rows.
+            if (Timers) {
+                T.Passes[i] += (TimeRecord::nowForThread() - Start) - (ATimes.DomTree + ATimes.Loops - AnalysisStart);
+                ++T.Runs[i];
+            }
+        }
+        if (!Timers) return;
+        std::lock_guard<std::mutex> Guard(TotalLock);
+        for (size_t i = 0; i < S.FPs.size(); ++i) {
+            Total.Passes[i] += T.Passes[i];
+            Total.Runs[i] += T.Runs[i];
+        }
+        Total.Analyses.DomTree += ATimes.DomTree;
+        Total.Analyses.Loops += ATimes.Loops;
+        Total.Analyses.NumDomTrees += ATimes.NumDomTrees;
+        Total.Analyses.NumLoopInfos += ATimes.NumLoopInfos;
+    });
+    if (!Timers) return;
+    for (size_t i = 0; i < S.FPs.size(); ++i) {
+        if (Total.Runs[i]) Timers->addTime(S.FPs[i].P->getName(), Total.Passes[i], Total.Runs[i]);
+    }
+    const AnalysisTimes &ATimes = Total.Analyses;
+    if (ATimes.NumDomTrees) Timers->addTime("Dominator tree construction", ATimes.DomTree, ATimes.NumDomTrees);
+    if (ATimes.NumLoopInfos) Timers->addTime("Natural loop construction", ATimes.Loops, ATimes.NumLoopInfos);
+}
+
+void PassManager::run(Module &M, TimerGroup *Timers, ThreadPool *Pool) {
+    for (const Step &S : Steps) {
+        if (!S.MP) {
+            runFunctionPasses(S, M, Timers, Pool);
+            continue;
+        }
+        TimeRegion T(Timers, S.MP->getName());
+        S.MP->run(M);
+    }
+}
+
+namespace {
+
+class Mem2RegPass : public FunctionPass {
+public:
+    const char *getName() const override { return "Promote memory to registers"; }
+    PreservedAnalyses run(Function &F, FunctionAnalysisManager &AM) override {
+        return promoteMemoryToRegister(F, AM.getDomTree()) ? PreservedAnalyses::CFG
+                                                            : PreservedAnalyses::All;
+    }
+};
+
+class SCCPPass : public FunctionPass {
+public:
+    const char *getName() const override { return "Sparse conditional constant propagation"; }
+    PreservedAnalyses run(Function &F, FunctionAnalysisManager &) override {
+        return runSCCP(F) ? PreservedAnalyses::None : PreservedAnalyses::All;
+    }
+};
+
+class SimplifyCFGPass : public FunctionPass {
+public:
+    const char *getName() const override { return "Simplify the CFG"; }
+    PreservedAnalyses run(Function &F, FunctionAnalysisManager &) override {
+        return runSimplifyCFG(F) ? PreservedAnalyses::None : PreservedAnalyses::All;
+    }
+};
+
+class GVNPass : public FunctionPass {
+public:
+    const char *getName() const override { return "Global value numbering"; }
+    PreservedAnalyses run(Function &F, FunctionAnalysisManager &AM) override {
+        return runGVN(F, AM.getDomTree()) ? PreservedAnalyses::CFG : PreservedAnalyses::All;
+    }
+};
+
+/// Changes the CFG but keeps the dominator tree and loops up to date.
+class LoopSimplifyPass : public FunctionPass {
+public:
+    const char *getName() const override { return "Canonicalize natural loops"; }
+    PreservedAnalyses run(Function &F, FunctionAnalysisManager &AM) override {
+        DominatorTree &DT = AM.getDomTree();
+        return simplifyLoops(F, DT, AM.getLoopInfo()) ? PreservedAnalyses::CFG
+                                                       : PreservedAnalyses::All;
+    }
+};
+
+class LICMPass : public FunctionPass {
+public:
+    const char *getName() const override { return "Loop invariant code motion"; }
+    PreservedAnalyses run(Function &F, FunctionAnalysisManager &AM) override {
+        return runLICM(F, AM.getLoopInfo()) ? PreservedAnalyses::CFG : PreservedAnalyses::All;
+    }
+};
+
+class IndVarSimplifyPass : public FunctionPass {
+public:
+    const char *getName() const override { return "Induction variable simplification"; }
+    PreservedAnalyses run(Function &F, FunctionAnalysisManager &AM) override {
+        return runIndVarSimplify(F, AM.getLoopInfo()) ? PreservedAnalyses::CFG
+                                                       : PreservedAnalyses::All;
+    }
+};
+
+class LoopUnrollPass : public FunctionPass {
+public:
+    const char *getName() const override { return "Unroll loops"; }
+    PreservedAnalyses run(Function &F, FunctionAnalysisManager &AM) override {
+        return runLoopUnroll(F, AM.getLoopInfo()) ? PreservedAnalyses::None
+                                                   : PreservedAnalyses::All;
+    }
+};
+
+class InlinerPass : public ModulePass {
+public:
+    const char *getName() const override { return "Function inlining"; }
+    bool run(Module &M) override { return runInliner(M); }
+};
+
+template <typename PassT> std::unique_ptr<FunctionPass> createPass() { return std::make_unique<PassT>(); }
+
+// The function passes by their -passes name.
+struct NamedPass {
+    const char *Name;
+    std::unique_ptr<FunctionPass> (*Create)();
+};
+
+const NamedPass FunctionPasses[] = {
+    {"mem2reg", createPass<Mem2RegPass>},
+    {"sccp", createPass<SCCPPass>},
+    {"simplifycfg", createPass<SimplifyCFGPass>},
+    {"gvn", createPass<GVNPass>},
+    {"loop-simplify", createPass<LoopSimplifyPass>},
+    {"licm", createPass<LICMPass>},
+    {"indvars", createPass<IndVarSimplifyPass>},
+    {"loop-unroll", createPass<LoopUnrollPass>},
+};
+
+} // namespace
+
+void sysy::buildPipeline(PassManager &PM, OptLevel Level) {
+    if (Level == OptLevel::O0) return;
+    PM.addPass(std::make_unique<Mem2RegPass>());
+    if (Level == OptLevel::O1) {
+        PM.addPass(std::make_unique<SCCPPass>());
+        PM.addPass(std::make_unique<SimplifyCFGPass>());
+        PM.addPass(std::make_unique<GVNPass>());
+        return;
+    }
+
+    // The inliner estimates sizes, which only mean something after mem2reg.
+    PM.addPass(std::make_unique<InlinerPass>());
+    PM.addPass(std::make_unique<SCCPPass>());
+    PM.addPass(std::make_unique<SimplifyCFGPass>());
+    PM.addPass(std::make_unique<GVNPass>());
+    PM.addPass(std::make_unique<LoopSimplifyPass>());
+    PM.addPass(std::make_unique<LICMPass>());
+    PM.addPass(std::make_unique<IndVarSimplifyPass>());
+    PM.addPass(std::make_unique<LoopUnrollPass>());
+    // Unrolled bodies fold further.
+    PM.addPass(std::make_unique<SCCPPass>(), /*OnlyAfterChange=*/true);
+    PM.addPass(std::make_unique<GVNPass>(), /*OnlyAfterChange=*/true);
+    PM.addPass(std::make_unique<SimplifyCFGPass>());
+}
+
+bool sysy::buildPipeline(PassManager &PM, std::string_view Names, std::string &Unknown) {
+    while (!Names.empty()) {
+        size_t Comma = Names.find(',');
+        std::string_view Name = Names.substr(0, Comma);
+        Names = Comma == std::string_view::npos ? std::string_view() : Names.substr(Comma + 1);
+        if (Name == "inline") {
+            PM.addPass(std::make_unique<InlinerPass>());
+            continue;
+        }
+        const NamedPass *Found = nullptr;
+        for (const NamedPass &NP : FunctionPasses) {
+            if (Name == NP.Name) Found = &NP;
+        }
+        if (!Found) {
+            Unknown = Name;
+            return false;
+        }
+        PM.addPass(Found->Create());
+    }
+    return true;
+}
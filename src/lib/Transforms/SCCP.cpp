@@ -0,0 +1,268 @@
+#include "Transforms/SCCP.h"
+#include "Analysis/ConstantFolding.h"
+#include "Basic/Statistic.h"
+#include "IR/Function.h"
+#include <unordered_map>
+#include <unordered_set>
+
+using namespace sysy;
+
+STATISTIC(NumInstRemoved, "sccp", "Number of instructions replaced by constants");
+STATISTIC(NumBranchesFolded, "sccp", "Number of conditional branches folded");
+STATISTIC(NumDeadBlocks, "sccp", "Number of unreachable blocks removed");
+
+namespace {
+
+/// Unknown -> Constant -> Overdefined; values only ever move to the right.
+class LatticeVal {
+public:
+    enum State : unsigned char { Unknown, Constant, Overdefined };
+
+private:
+    State S = Unknown;
+    Value *C = nullptr;
+
+public:
+    bool isUnknown() const { return S == Unknown; }
+    bool isConstant() const { return S == Constant; }
+    bool isOverdefined() const { return S == Overdefined; }
+    Value *getConstant() const { return C; }
+
+    /// Return true if the state changed.
+    bool markConstant(Value *V) {
+        if (S == Constant) {
+            if (C == V) return false;
+            return markOverdefined();
+        }
+        if (S == Overdefined) return false;
+        S = Constant;
+        C = V;
+        return true;
+    }
+    bool markOverdefined() {
+        if (S == Overdefined) return false;
+        S = Overdefined;
+        C = nullptr;
+        return true;
+    }
+    /// Lower this to the meet of itself and \p RHS.
+    bool mergeIn(const LatticeVal &RHS) {
+        if (RHS.isUnknown()) return false;
+        if (RHS.isOverdefined()) return markOverdefined();
+        return markConstant(RHS.C);
+    }
+};
+
+class SCCPSolver {
+    Function &F;
+    std::unordered_map<const Value *, LatticeVal> Values;
+    std::unordered_set<const BasicBlock *> Executable;
+    std::vector<BasicBlock *> BlockWorklist;
+    std::vector<Instruction *> InstWorklist;
+
+    bool isEdgeFeasible(const BasicBlock *From, const BasicBlock *To) const;
+    void markEdgeExecutable(BasicBlock *To);
+    void markOverdefined(Instruction *I) {
+        if (Values[I].markOverdefined()) pushUsers(I);
+    }
+    void markConstant(Instruction *I, Value *C) {
+        if (Values[I].markConstant(C)) pushUsers(I);
+    }
+    void pushUsers(Instruction *I) {
+        for (Use &U : I->uses()) {
+            if (Executable.count(U.getUser()->getParent())) InstWorklist.push_back(U.getUser());
+        }
+    }
+
+    void visit(Instruction *I);
+    void visitPhi(PhiInst *Phi);
+    void visitBranch(BranchInst *Br);
+
+public:
+    explicit SCCPSolver(Function &F) : F(F) {}
+
+    LatticeVal getValueState(const Value *V) const;
+    void solve();
+    bool resolveUnknownBranches();
+    bool isBlockExecutable(const BasicBlock *BB) const { return Executable.count(BB) != 0; }
+};
+
+} // namespace
+
+// Edges are not stored: whether one is taken follows from the state of
+// the branch condition in its source block.
+bool SCCPSolver::isEdgeFeasible(const BasicBlock *From, const BasicBlock *To) const {
+    if (!Executable.count(From)) return false;
+    const Instruction *Term = From->getTerminator();
+    auto *Br = dyn_cast_or_null<BranchInst>(Term);
+    if (!Br || !Br->isConditional()) return true;
+    LatticeVal Cond = getValueState(Br->getCondition());
+    if (Cond.isOverdefined()) return true;
+    if (Cond.isUnknown()) return false;
+    bool Taken = cast<ConstantInt>(Cond.getConstant())->getValue() != 0;
+    return Br->getSuccessor(Taken ? 0 : 1) == To;
+}
+
+void SCCPSolver::markEdgeExecutable(BasicBlock *To) {
+    if (Executable.insert(To).second) {
+        BlockWorklist.push_back(To);
+        return;
+    }
+    // A new way into a block that already runs: only its phis can change.
+    for (Instruction &I : *To) {
+        if (!isa<PhiInst>(&I)) break;
+        InstWorklist.push_back(&I);
+    }
+}
+
+LatticeVal SCCPSolver::getValueState(const Value *V) const {
+    LatticeVal L;
+    if (isa<ConstantInt>(V) || isa<ConstantFloat>(V)) {
+        L.markConstant(const_cast<Value *>(V));
+    } else if (isa<Instruction>(V)) {
+        auto It = Values.find(V);
+        if (It != Values.end()) L = It->second;
+    } else {
+        // Arguments and undef: any value at all.
+        L.markOverdefined();
+    }
+    return L;
+}
+
+void SCCPSolver::visitPhi(PhiInst *Phi) {
+    LatticeVal &Cur = Values[Phi];
+    if (Cur.isOverdefined()) return;
+    LatticeVal New;
+    for (unsigned i = 0, e = Phi->getNumIncomingValues(); i != e; ++i) {
+        if (!isEdgeFeasible(Phi->getIncomingBlock(i), Phi->getParent())) continue;
+        Value *In = Phi->getIncomingValue(i);
+        // An uninitialized variable may take whatever the other paths give.
+        if (isa<UndefValue>(In)) continue;
+        New.mergeIn(getValueState(In));
+        if (New.isOverdefined()) break;
+    }
+    if (Cur.mergeIn(New)) pushUsers(Phi);
+}
+
+void SCCPSolver::visitBranch(BranchInst *Br) {
+    if (!Br->isConditional()) {
+        markEdgeExecutable(Br->getSuccessor(0));
+        return;
+    }
+    LatticeVal Cond = getValueState(Br->getCondition());
+    if (Cond.isUnknown()) return;
+    if (Cond.isConstant()) {
+        bool Taken = cast<ConstantInt>(Cond.getConstant())->getValue() != 0;
+        markEdgeExecutable(Br->getSuccessor(Taken ? 0 : 1));
+        return;
+    }
+    markEdgeExecutable(Br->getSuccessor(0));
+    markEdgeExecutable(Br->getSuccessor(1));
+}
+
+void SCCPSolver::visit(Instruction *I) {
+    if (auto *Phi = dyn_cast<PhiInst>(I)) return visitPhi(Phi);
+    if (auto *Br = dyn_cast<BranchInst>(I)) return visitBranch(Br);
+    if (I->getType() == Type::Void) return;
+
+    bool Foldable = I->isBinaryOp() || isa<CmpInst>(I) || isa<CastInst>(I) || isa<FNegInst>(I);
+    if (!Foldable) return markOverdefined(I);
+    if (Values[I].isOverdefined()) return;
+
+    Value *Ops[2] = {};
+    bool HasUnknown = false;
+    for (unsigned i = 0, e = I->getNumOperands(); i != e; ++i) {
+        LatticeVal L = getValueState(I->getOperand(i));
+        if (L.isOverdefined()) {
+            // x * 0 is 0 whatever x is.
+            Value *Other = I->getOperand(1 - i);
+            if (I->getOpcode() == Opcode::Mul && isa<ConstantInt>(Other) &&
+                cast<ConstantInt>(Other)->isZero())
+                return markConstant(I, Other);
+            return markOverdefined(I);
+        }
+        if (L.isUnknown()) HasUnknown = true;
+        Ops[i] = L.getConstant();
+    }
+    if (HasUnknown) return;
+    if (Value *C = constantFoldInstruction(I, ArrayRef<Value *>(Ops, I->getNumOperands()), F))
+        markConstant(I, C);
+    else
+        markOverdefined(I); // Division by zero is left for run time
+}
+
+void SCCPSolver::solve() {
+    if (Executable.empty()) {
+        Executable.insert(F.getEntryBlock());
+        BlockWorklist.push_back(F.getEntryBlock());
+    }
+    while (!BlockWorklist.empty() || !InstWorklist.empty()) {
+        // Drain the SSA worklist first, values settle before new blocks open.
+        while (!InstWorklist.empty()) {
+            Instruction *I = InstWorklist.back();
+            InstWorklist.pop_back();
+            visit(I);
+        }
+        while (!BlockWorklist.empty()) {
+            BasicBlock *BB = BlockWorklist.back();
+            BlockWorklist.pop_back();
+            for (Instruction &I : *BB) visit(&I);
+        }
+    }
+}
+
+/// A branch whose condition never settled (it only depends on undefined
+/// values) would leave both successors dead. Pick a side by treating the
+/// condition as overdefined and solve again. Returns true if it did so.
+bool SCCPSolver::resolveUnknownBranches() {
+    bool Changed = false;
+    for (BasicBlock &BB : F) {
+        if (!Executable.count(&BB)) continue;
+        auto *Br = dyn_cast_or_null<BranchInst>(BB.getTerminator());
+        if (!Br || !Br->isConditional() || !getValueState(Br->getCondition()).isUnknown()) continue;
+        if (auto *Cond = dyn_cast<Instruction>(Br->getCondition())) markOverdefined(Cond);
+        visitBranch(Br);
+        Changed = true;
+    }
+    return Changed;
+}
+
+bool sysy::runSCCP(Function &F) {
+    if (F.empty()) return false;
+    SCCPSolver Solver(F);
+    do {
+        Solver.solve();
+    } while (Solver.resolveUnknownBranches());
+
+    unsigned NumReplaced = 0, NumFolded = 0;
+    for (BasicBlock &BB : F) {
+        if (!Solver.isBlockExecutable(&BB)) continue;
+        for (Instruction *I = BB.front(); I;) {
+            Instruction *Next = I->getNextNode();
+            LatticeVal L = Solver.getValueState(I);
+            if (L.isConstant()) {
+                I->replaceAllUsesWith(L.getConstant());
+                I->eraseFromParent();
+                ++NumReplaced;
+            }
+            I = Next;
+        }
+    }
+    // Conditions are all replaced now, fold the branches on them.
+    for (BasicBlock &BB : F) {
+        auto *Br = dyn_cast_or_null<BranchInst>(BB.getTerminator());
+        if (!Br || !Br->isConditional() || !isa<ConstantInt>(Br->getCondition())) continue;
+        bool Taken = cast<ConstantInt>(Br->getCondition())->getValue() != 0;
+        BasicBlock *Dest = Br->getSuccessor(Taken ? 0 : 1);
+        Br->getSuccessor(Taken ? 1 : 0)->removePredecessor(&BB);
+        Br->eraseFromParent();
+        BB.push_back(new BranchInst(Dest));
+        ++NumFolded;
+    }
+    unsigned NumRemoved = F.removeUnreachableBlocks();
+
+    NumInstRemoved += NumReplaced;
+    NumBranchesFolded += NumFolded;
+    NumDeadBlocks += NumRemoved;
+    return NumReplaced || NumFolded || NumRemoved;
+}
@@ -0,0 +1,200 @@
+#include "Transforms/SimplifyCFG.h"
+#include "Basic/Statistic.h"
+#include "IR/Function.h"
+#include <algorithm>
+#include <unordered_set>
+
+using namespace sysy;
+
+STATISTIC(NumUnreachable, "simplifycfg", "Number of unreachable blocks removed");
+STATISTIC(NumBranchesFolded, "simplifycfg", "Number of conditional branches made unconditional");
+STATISTIC(NumPhisRemoved, "simplifycfg", "Number of phis replaced by their only value");
+STATISTIC(NumBlocksMerged, "simplifycfg", "Number of blocks merged into their predecessor");
+STATISTIC(NumJumpsThreaded, "simplifycfg", "Number of jump-only blocks bypassed");
+STATISTIC(NumDeadInsts, "simplifycfg", "Number of dead instructions removed");
+
+namespace {
+
+class CFGSimplifier {
+    Function &F;
+    unsigned Folded = 0, Phis = 0, Merged = 0, Threaded = 0;
+
+    bool foldBranch(BasicBlock *BB);
+    bool removeTrivialPhis(BasicBlock *BB);
+    bool mergeIntoPredecessor(BasicBlock *BB);
+    bool threadJump(BasicBlock *BB);
+    unsigned removeDeadInstructions();
+
+public:
+    explicit CFGSimplifier(Function &F) : F(F) {}
+    bool run();
+};
+
+} // namespace
+
+/// A branch on a constant, or to the same block both ways, becomes a jump.
+bool CFGSimplifier::foldBranch(BasicBlock *BB) {
+    auto *Br = dyn_cast_or_null<BranchInst>(BB->getTerminator());
+    if (!Br || !Br->isConditional()) return false;
+    BasicBlock *Dest;
+    if (Br->getSuccessor(0) == Br->getSuccessor(1)) {
+        Dest = Br->getSuccessor(0);
+    } else if (auto *C = dyn_cast<ConstantInt>(Br->getCondition())) {
+        Dest = Br->getSuccessor(C->isZero() ? 1 : 0);
+        Br->getSuccessor(C->isZero() ? 0 : 1)->removePredecessor(BB);
+    } else {
+        return false;
+    }
+    Br->eraseFromParent();
+    BB->push_back(new BranchInst(Dest));
+    ++Folded;
+    return true;
+}
+
+/// Only reachable blocks are left, where such a value dominates the phi.
+bool CFGSimplifier::removeTrivialPhis(BasicBlock *BB) {
+    bool Changed = false;
+    for (Instruction *I = BB->front(); I && isa<PhiInst>(I);) {
+        auto *Phi = cast<PhiInst>(I);
+        I = I->getNextNode();
+        Value *V = Phi->hasConstantValue();
+        if (!V) {
+            if (Phi->getNumIncomingValues()) continue;
+            V = F.getUndef(Phi->getType()); // Only refers to itself
+        }
+        Phi->replaceAllUsesWith(V);
+        Phi->eraseFromParent();
+        ++Phis;
+        Changed = true;
+    }
+    return Changed;
+}
+
+/// Pred: ...          Pred: ...
+///       br BB    =>        (BB's instructions)
+/// BB:   ...
+bool CFGSimplifier::mergeIntoPredecessor(BasicBlock *BB) {
+    BasicBlock *Pred = BB->getSinglePredecessor();
+    if (!Pred || Pred == BB || BB == F.getEntryBlock()) return false;
+    auto *Br = cast<BranchInst>(Pred->getTerminator());
+    if (Br->isConditional()) return false;
+
+    // With a single predecessor every phi has one entry.
+    while (auto *Phi = dyn_cast<PhiInst>(BB->front())) {
+        Phi->replaceAllUsesWith(Phi->getIncomingValue(0));
+        Phi->eraseFromParent();
+    }
+    BB->replacePhiUsesWith(BB, Pred);
+    Br->eraseFromParent();
+    while (Instruction *I = BB->front()) {
+        I->removeFromParent();
+        Pred->push_back(I);
+    }
+    BB->eraseFromParent();
+    ++Merged;
+    return true;
+}
+
+/// Send the predecessors of a block that only jumps to Succ straight to
+/// Succ. A predecessor already branching to Succ is only redirected if
+/// Succ's phis expect the same values from both edges.
+bool CFGSimplifier::threadJump(BasicBlock *BB) {
+    if (BB->size() != 1 || BB == F.getEntryBlock()) return false;
+    auto *Br = dyn_cast<BranchInst>(BB->getTerminator());
+    if (!Br || Br->isConditional()) return false;
+    BasicBlock *Succ = Br->getSuccessor(0);
+    if (Succ == BB) return false;
+
+    bool Changed = false;
+    std::vector<BasicBlock *> SuccPreds = Succ->getPredecessors();
+    for (BasicBlock *Pred : BB->getPredecessors()) {
+        bool AlreadyPred = std::find(SuccPreds.begin(), SuccPreds.end(), Pred) != SuccPreds.end();
+        bool Compatible = true;
+        for (Instruction &I : *Succ) {
+            auto *Phi = dyn_cast<PhiInst>(&I);
+            if (!Phi) break;
+            if (AlreadyPred && Phi->getIncomingValueForBlock(Pred) != Phi->getIncomingValueForBlock(BB))
+                Compatible = false;
+        }
+        if (!Compatible) continue;
+
+        for (Instruction &I : *Succ) {
+            auto *Phi = dyn_cast<PhiInst>(&I);
+            if (!Phi) break;
+            if (!AlreadyPred) Phi->addIncoming(Phi->getIncomingValueForBlock(BB), Pred);
+        }
+        if (!AlreadyPred) SuccPreds.push_back(Pred);
+        Pred->getTerminator()->replaceUsesOfWith(BB, Succ);
+        Changed = true;
+    }
+    if (!Changed) return false;
+
+    ++Threaded;
+    if (!BB->getPredecessors().empty()) return true;
+    Succ->removePredecessor(BB);
+    BB->eraseFromParent();
+    return true;
+}
+
+/// Everything a side effect does not depend on is dead. Marking from the
+/// side effects, rather than deleting unused instructions, also catches
+/// cycles of phis that only feed each other.
+unsigned CFGSimplifier::removeDeadInstructions() {
+    std::unordered_set<Instruction *> Live;
+    std::vector<Instruction *> Worklist;
+    for (BasicBlock &BB : F) {
+        for (Instruction &I : BB) {
+            if (I.mayHaveSideEffects() && Live.insert(&I).second) Worklist.push_back(&I);
+        }
+    }
+    while (!Worklist.empty()) {
+        Instruction *I = Worklist.back();
+        Worklist.pop_back();
+        for (unsigned i = 0, e = I->getNumOperands(); i != e; ++i) {
+            auto *Op = dyn_cast_or_null<Instruction>(I->getOperand(i));
+            if (Op && Live.insert(Op).second) Worklist.push_back(Op);
+        }
+    }
+
+    std::vector<Instruction *> Dead;
+    for (BasicBlock &BB : F) {
+        for (Instruction &I : BB) {
+            if (!Live.count(&I)) Dead.push_back(&I);
+        }
+    }
+    for (Instruction *I : Dead) I->dropAllReferences();
+    for (Instruction *I : Dead) I->eraseFromParent();
+    return static_cast<unsigned>(Dead.size());
+}
+
+bool CFGSimplifier::run() {
+    bool Changed = false;
+    unsigned Unreachable = 0;
+    for (bool LocalChange = true; LocalChange;) {
+        LocalChange = false;
+        if (unsigned N = F.removeUnreachableBlocks()) {
+            Unreachable += N;
+            LocalChange = true;
+        }
+        // Each step may only erase BB itself, which Next has moved past.
+        for (BasicBlock *BB = F.getEntryBlock(); BB;) {
+            BasicBlock *Next = BB->getNextNode();
+            LocalChange |= foldBranch(BB);
+            LocalChange |= removeTrivialPhis(BB);
+            if (mergeIntoPredecessor(BB) || threadJump(BB)) LocalChange = true;
+            BB = Next;
+        }
+        Changed |= LocalChange;
+    }
+    unsigned Dead = removeDeadInstructions();
+
+    NumUnreachable += Unreachable;
+    NumBranchesFolded += Folded;
+    NumPhisRemoved += Phis;
+    NumBlocksMerged += Merged;
+    NumJumpsThreaded += Threaded;
+    NumDeadInsts += Dead;
+    return Changed || Dead;
+}
+
+bool sysy::runSimplifyCFG(Function &F) { return CFGSimplifier(F).run(); }
@@ -1,45 +1,363 @@
+#include "Basic/MemoryBuffer.h"
+#include "Basic/Statistic.h"
+#include "Basic/ThreadPool.h"
+#include "Basic/Timer.h"
+#include "CodeGen/CodeGen.h"
+#include "CodeGen/SchedModel.h"
+#include "IR/IRGen.h"
+#include "IR/Verifier.h"
 #include "Lex/Lexer.h"
 #include "Parse/Parser.h"
 #include "Semant/Semant.h"
+#include "Transforms/PassManager.h"
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
 #include <iostream>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
 
 using namespace sysy;
 
-int main() {
-    std::string code = 
-        "int main() {\n"
-        "    int a = 10;\n"
-        "    int b = 5;\n"
-        "    if (a > b) {\n"
-        "        int temp = a;\n"
-        "        a = b;\n"
-        "        b = temp;\n"
-        "    }\n"
-        "    b = a + 1;\n"
-        "    return 0;\n"
-        "}\n";
-
-    std::cout << "--- Starting Compilation ---" << std::endl;
-
-    Lexer lexer(code);
-    Parser parser(lexer);
+STATISTIC(NumInputs, "driver", "Number of input files");
+STATISTIC(NumTokens, "lexer", "Number of tokens lexed");
+STATISTIC(NumIdentifiers, "lexer", "Number of distinct identifiers");
+STATISTIC(NumASTNodes, "ast", "Number of AST nodes");
+#define AST_NODE(Class) STATISTIC(Num##Class, "ast", "Number of " #Class " nodes");
+#include "AST/ASTNodes.def"
+STATISTIC(NumASTBytes, "ast", "Bytes allocated for AST nodes");
+STATISTIC(NumIdentBytes, "lexer", "Bytes allocated for the identifier table");
+STATISTIC(NumIRFunctions, "ir", "Number of functions lowered to IR");
+STATISTIC(NumIRInstructions, "ir", "Number of IR instructions generated");
+
+namespace {
+
+constexpr unsigned long MaxJobs = 1024;     // -j beyond this is a typo, not a machine
+constexpr unsigned long MaxLatency = 1000;  // Likewise for -msched-latency
+
+struct DriverOptions {
+    std::vector<std::string> Inputs;
+    std::string Output;     // -o, only valid with a single input; "-" is stdout
+    bool DumpAST = false;
+    bool EmitIR = false;     // -emit-ir: print the IR to stdout
+    bool SyntaxOnly = false; // -fsyntax-only: stop after semantic analysis
+    bool Verbose = false;
+    bool TimeReport = false; // -ftime-report
+    bool Stats = false;      // -stats
+    bool JSONReport = false; // -report-json: both reports as one JSON object
+    OptLevel Level = OptLevel::O2;
+    std::optional<std::string> Passes; // -passes: run these instead of the -O pipeline
+    SchedModel Tune = getDefaultSchedModel(); // -mtune, with the -msched-latency changes
+    unsigned Jobs = 0;       // -j: threads per input, 0 for one per core
+};
+
+void printUsage(const char *Argv0) {
+    std::cerr << "Usage: " << Argv0 << " [options] <file.sy>...\n"
+              << "Options:\n"
+              << "  -o <file>     Write the assembly to <file> (single input only, - for stdout)\n"
+              << "  -O0, -O1, -O2 Optimization level (default: -O2)\n"
+              << "  -passes=<list>\n"
+              << "                Run the comma-separated IR passes instead of the -O\n"
+              << "                pipeline (the -O level still applies to code generation)\n"
+              << "  -mtune=<cpu>  Schedule instructions for <cpu>: sifive-u74 (default), rocket\n"
+              << "  -msched-latency=<class>=<n>,...\n"
+              << "                Override latencies of the -mtune model, e.g. IntDiv=8\n"
+              << "  -j <n>        Compile the functions of an input on <n> threads\n"
+              << "                (default: one per core)\n"
+              << "  -dump-ast     Print the AST of each input\n"
+              << "  -emit-ir      Print the IR of each input\n"
+              << "  -fsyntax-only Stop after semantic analysis; no output is written\n"
+              << "  -v            Verbose output (symbols defined, ...)\n"
+              << "  -ftime-report Print the time spent in each compilation phase\n"
+              << "  -stats        Print compilation statistics\n"
+              << "  -report-json  Print -ftime-report/-stats as JSON instead\n"
+              << "  -h, --help    Show this message\n"
+              << "With several inputs, each 'name.sy' is compiled to 'name.s'.\n";
+}
+
+// A decimal number from 1 to \p Max. strtoul alone would also take a sign,
+// and wrap "-1" around to ULONG_MAX.
+bool parseCount(const char *S, unsigned long Max, unsigned &N) {
+    if (*S < '0' || *S > '9') return false;
+    char *End;
+    unsigned long V = std::strtoul(S, &End, 10);
+    if (*End != '\0' || V == 0 || V > Max) return false;
+    N = static_cast<unsigned>(V);
+    return true;
+}
+
+bool parseArgs(int argc, char **argv, DriverOptions &Opts) {
+    // Latency changes apply to the -mtune model wherever that comes.
+    const SchedModel *CPU = &getDefaultSchedModel();
+    std::vector<std::pair<RISCV::SchedClass, unsigned>> Latencies;
+    for (int i = 1; i < argc; ++i) {
+        const char *Arg = argv[i];
+        if (std::strcmp(Arg, "-o") == 0) {
+            if (i + 1 >= argc) {
+                std::cerr << "error: missing filename after '-o'" << std::endl;
+                return false;
+            }
+            Opts.Output = argv[++i];
+        } else if (std::strncmp(Arg, "-o", 2) == 0) {
+            Opts.Output = Arg + 2;
+        } else if (std::strcmp(Arg, "-O0") == 0) {
+            Opts.Level = OptLevel::O0;
+        } else if (std::strcmp(Arg, "-O1") == 0) {
+            Opts.Level = OptLevel::O1;
+        } else if (std::strcmp(Arg, "-O2") == 0) {
+            Opts.Level = OptLevel::O2;
+        } else if (std::strncmp(Arg, "-passes=", 8) == 0) {
+            Opts.Passes = Arg + 8;
+            PassManager PM;
+            std::string Unknown;
+            if (!buildPipeline(PM, *Opts.Passes, Unknown)) {
+                std::cerr << "error: unknown pass '" << Unknown << "' for '-passes'" << std::endl;
+                return false;
+            }
+        } else if (std::strncmp(Arg, "-mtune=", 7) == 0) {
+            CPU = findSchedModel(Arg + 7);
+            if (!CPU) {
+                std::cerr << "error: unknown CPU '" << Arg + 7 << "' for '-mtune'" << std::endl;
+                return false;
+            }
+        } else if (std::strncmp(Arg, "-msched-latency=", 16) == 0) {
+            std::string_view List = Arg + 16;
+            do {
+                size_t Comma = List.find(',');
+                std::string_view Item = List.substr(0, Comma);
+                List = Comma == std::string_view::npos ? std::string_view() : List.substr(Comma + 1);
+                size_t Eq = Item.find('=');
+                RISCV::SchedClass SC;
+                unsigned Cycles;
+                if (Eq == std::string_view::npos || !findSchedClass(Item.substr(0, Eq), SC) ||
+                    !parseCount(std::string(Item.substr(Eq + 1)).c_str(), MaxLatency, Cycles)) {
+                    std::cerr << "error: invalid latency '" << Item << "' for '-msched-latency'"
+                              << std::endl;
+                    return false;
+                }
+                Latencies.emplace_back(SC, Cycles);
+            } while (!List.empty());
+        } else if (std::strncmp(Arg, "-j", 2) == 0) {
+            const char *N = Arg[2] ? Arg + 2 : (i + 1 < argc ? argv[++i] : "");
+            if (!parseCount(N, MaxJobs, Opts.Jobs)) {
+                std::cerr << "error: invalid thread count '" << N << "' for '-j'" << std::endl;
+                return false;
+            }
+        } else if (std::strcmp(Arg, "-dump-ast") == 0) {
+            Opts.DumpAST = true;
+        } else if (std::strcmp(Arg, "-emit-ir") == 0) {
+            Opts.EmitIR = true;
+        } else if (std::strcmp(Arg, "-fsyntax-only") == 0) {
+            Opts.SyntaxOnly = true;
+        } else if (std::strcmp(Arg, "-v") == 0) {
+            Opts.Verbose = true;
+        } else if (std::strcmp(Arg, "-ftime-report") == 0) {
+            Opts.TimeReport = true;
+        } else if (std::strcmp(Arg, "-stats") == 0) {
+            Opts.Stats = true;
+        } else if (std::strcmp(Arg, "-report-json") == 0) {
+            Opts.JSONReport = true;
+        } else if (std::strcmp(Arg, "-h") == 0 || std::strcmp(Arg, "--help") == 0) {
+            printUsage(argv[0]);
+            std::exit(0);
+        } else if (Arg[0] == '-' && Arg[1] != '\0') {
+            std::cerr << "error: unknown argument '" << Arg << "'" << std::endl;
+            return false;
+        } else {
+            Opts.Inputs.push_back(Arg);
+        }
+    }
+    Opts.Tune = *CPU;
+    for (auto [SC, Cycles] : Latencies) Opts.Tune.Classes[static_cast<unsigned>(SC)].Latency = Cycles;
+
+    if (Opts.Inputs.empty()) {
+        std::cerr << "error: no input files" << std::endl;
+        return false;
+    }
+    if (!Opts.Output.empty() && Opts.Inputs.size() > 1) {
+        std::cerr << "error: cannot specify '-o' with multiple input files" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// foo/bar.sy -> foo/bar.s
+std::string getDefaultOutput(const std::string &Input) {
+    size_t Slash = Input.find_last_of('/');
+    size_t Dot = Input.find_last_of('.');
+    if (Dot == std::string::npos || (Slash != std::string::npos && Dot < Slash))
+        return Input + ".s";
+    return Input.substr(0, Dot) + ".s";
+}
+
+// The Parser pulls tokens on demand, so lexing has no phase of its own.
+// For -ftime-report the buffer is lexed once more up front, on its own, to
+// show how the "Parsing" time splits.
+void timeLexing(std::string_view Buffer, TimerGroup *Timers) {
+    TimeRegion T(Timers, "Lexing (standalone re-scan)");
+    IdentifierTable Idents;
+    Lexer lexer(Buffer, Idents);
+    while (lexer.nextToken().isNot(tok::eof)) {
+    }
+}
+
+void recordFrontendStats(const Lexer &L, const IdentifierTable &Idents,
+                         const ASTContext &Context) {
+    NumTokens += L.getNumTokens();
+    NumIdentifiers += Idents.size();
+    NumIdentBytes += Idents.getBytesAllocated();
+    NumASTNodes += Context.getNumNodes();
+    NumASTBytes += Context.getAllocator().getBytesAllocated();
+#define AST_NODE(Class) Num##Class += Context.getNumNodes(ASTNodeClass::Class);
+#include "AST/ASTNodes.def"
+}
+
+// Pool may be null, for a serial compile.
+bool compileFile(const std::string &Input, const std::string &Output, const DriverOptions &Opts,
+                 TimerGroup *Timers, TimerGroup *PassTimers, ThreadPool *Pool) {
+    ++NumInputs;
+    std::unique_ptr<MemoryBuffer> Buffer;
+    {
+        TimeRegion T(Timers, "Reading input");
+        std::string ErrMsg;
+        Buffer = MemoryBuffer::getFile(Input, ErrMsg);
+        if (!Buffer) {
+            std::cerr << "error: cannot open '" << Input << "': " << ErrMsg << std::endl;
+            return false;
+        }
+    }
+
+    if (Timers) timeLexing(Buffer->getBuffer(), Timers);
+
+    // The Lexer works directly on the mapped file, no copy is made.
+    IdentifierTable Idents;
+    Lexer lexer(Buffer->getBuffer(), Idents);
+    ASTContext Context;
+    Parser parser(lexer, Context);
 
     // 1. Parsing
-    auto ast = parser.parseCompUnit();
-    if (!ast) {
-        std::cerr << "Parsing failed!" << std::endl;
-        return 1;
+    CompUnitAST *ast;
+    {
+        TimeRegion T(Timers, "Parsing (incl. lexing)");
+        ast = parser.parseCompUnit();
+    }
+    recordFrontendStats(lexer, Idents, Context);
+    if (!ast || parser.getNumErrors()) {
+        std::cerr << Input << ": parsing failed" << std::endl;
+        return false;
     }
 
-    std::cout << "\n[AST Dump]" << std::endl;
-    ast->dump(0);
+    if (Opts.DumpAST) ast->dump(0);
 
     // 2. Semantic Analysis
-    std::cout << "\n[Semantic Analysis]" << std::endl;
-    Semant semant;
-    ast->accept(semant);
+    {
+        TimeRegion T(Timers, "Semantic analysis");
+        Semant semant(Opts.Verbose);
+        ast->accept(semant);
+        if (semant.getNumErrors()) {
+            std::cerr << Input << ": semantic analysis failed" << std::endl;
+            return false;
+        }
+    }
+    if (Opts.SyntaxOnly) return true;
+
+    // 3. IR generation. From here on each function is compiled on its own,
+    // in parallel with the others.
+    Module M;
+    {
+        TimeRegion T(Timers, "IR generation");
+        if (generateIR(*ast, M, Pool)) {
+            std::cerr << Input << ": IR generation failed" << std::endl;
+            return false;
+        }
+    }
+    NumIRFunctions += M.size();
+    NumIRInstructions += M.getInstructionCount();
+
+    // 4. Optimization
+    {
+        TimeRegion T(Timers, "Optimization");
+        PassManager PM;
+        std::string Unknown;
+        if (!Opts.Passes) buildPipeline(PM, Opts.Level);
+        else buildPipeline(PM, *Opts.Passes, Unknown);
+        PM.run(M, PassTimers, Pool);
+    }
+#ifndef NDEBUG
+    if (!verifyModule(M, std::cerr)) {
+        std::cerr << Input << ": internal error: invalid IR after optimization" << std::endl;
+        return false;
+    }
+#endif
+
+    if (Opts.EmitIR) M.print(std::cout, Pool);
+
+    // 5. Code generation
+    {
+        TimeRegion T(Timers, "Code generation");
+        std::ofstream File;
+        if (Output != "-") {
+            File.open(Output);
+            if (!File) {
+                std::cerr << "error: cannot open '" << Output << "' for writing" << std::endl;
+                return false;
+            }
+        }
+        emitAssembly(M, Output == "-" ? std::cout : File, Opts.Level, Opts.Tune, Pool, PassTimers);
+    }
+    return true;
+}
 
-    std::cout << "\n--- TEST COMPLETED ---" << std::endl;
-    return 0;
-}
\ No newline at end of file
+} // namespace
+
+int main(int argc, char **argv) {
+    DriverOptions Opts;
+    if (!parseArgs(argc, argv, Opts)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    TimerGroup Timers("Compilation phases");
+    TimerGroup PassTimers("Pass execution timing report");
+    TimerGroup *TimersOrNull = Opts.TimeReport ? &Timers : nullptr;
+    TimerGroup *PassTimersOrNull = Opts.TimeReport ? &PassTimers : nullptr;
+
+    unsigned Jobs = Opts.Jobs ? Opts.Jobs : std::thread::hardware_concurrency();
+    std::unique_ptr<ThreadPool> Pool;
+    if (Jobs > 1) Pool = std::make_unique<ThreadPool>(Jobs);
+
+    // Batch mode reuses one process for every input, so the startup cost is
+    // paid once per CI run instead of once per test case.
+    bool Success = true;
+    for (const auto &Input : Opts.Inputs) {
+        std::string Output = Opts.Output.empty() ? getDefaultOutput(Input) : Opts.Output;
+        Success &= compileFile(Input, Output, Opts, TimersOrNull, PassTimersOrNull, Pool.get());
+    }
+
+    // Reports go to stderr so they never mix with the compiler's output.
+    if (Opts.JSONReport && (Opts.TimeReport || Opts.Stats)) {
+        std::cerr << "{";
+        if (Opts.TimeReport) {
+            std::cerr << "\"time\": ";
+            Timers.printJSON(std::cerr);
+            std::cerr << ",\n\"passes\": ";
+            PassTimers.printJSON(std::cerr);
+        }
+        if (Opts.Stats) {
+            std::cerr << (Opts.TimeReport ? ",\n" : "") << "\"stats\": ";
+            printStatisticsJSON(std::cerr);
+        }
+        std::cerr << "}" << std::endl;
+    } else {
+        if (Opts.TimeReport) {
+            Timers.print(std::cerr);
+            PassTimers.print(std::cerr);
+        }
+        if (Opts.Stats) printStatistics(std::cerr);
+    }
+    return Success ? 0 : 1;
+}
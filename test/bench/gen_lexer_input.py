@@ -0,0 +1,44 @@
+#!/usr/bin/env python3
+"""Writes a valid SysY program of about the given size in MB to stdout, for
+lexer.sh: every token kind, keywords and identifiers that start like them,
+all literal forms, line and block comments, and runs of whitespace."""
+import random
+import sys
+
+FUNCTION = """\
+// f{k}: keyword-like names, literals of every form, and comments
+int f{k}(int integer, float floaty) {{
+    /* a block comment ** with stars * and / slashes
+       spanning lines */
+    int whilex = 0x{hex:X} + 0{oct:o} - {dec};
+    float returned = {f1}e-3 + 0x1.8p{e} + .5 + {f2}.;
+    int if_{k} = integer;        // trailing line comment
+    while (whilex < {bound} && if_{k} != whilex || !integer) {{
+        if (whilex % 3 == 0) whilex = whilex + 1; else whilex = whilex * 2;
+        if_{k} = (if_{k} - whilex) / (integer + {c});
+        if (whilex >= if_{k} && whilex <= {bound}) returned = returned * floaty;
+    }}
+    return whilex;
+}}
+
+"""
+
+
+def main():
+    megabytes = float(sys.argv[1]) if len(sys.argv) > 1 else 32
+    rng = random.Random(1)
+    out = sys.stdout
+    written = k = 0
+    while written < megabytes * 1e6:
+        text = FUNCTION.format(k=k, hex=rng.randrange(1 << 16), oct=rng.randrange(1 << 12),
+                               dec=rng.randrange(100000), f1=rng.randrange(1000),
+                               e=rng.randrange(-8, 8), f2=rng.randrange(100),
+                               bound=rng.randrange(10, 1000), c=rng.randrange(1, 9))
+        out.write(text)
+        written += len(text)
+        k += 1
+    out.write("int main() {\n    return 0;\n}\n")
+
+
+if __name__ == "__main__":
+    main()
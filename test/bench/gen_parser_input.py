@@ -0,0 +1,50 @@
+#!/usr/bin/env python3
+"""Writes an expression-heavy SysY program to stdout, for parser.sh.
+
+  gen_parser_input.py flat N     N statements of 30 random binary operators
+  gen_parser_input.py parens N   one expression nested in N parentheses
+  gen_parser_input.py unary N    a chain of N prefix operators
+  gen_parser_input.py sum N      a sum of N + 1 terms
+"""
+import random
+import sys
+
+BINARY_OPS = ["+", "-", "*", "/", "%", "<", ">", "<=", ">=", "==", "!=", "&&", "||"]
+
+
+def flat(n, out):
+    rng = random.Random(1)
+    names = ["a", "b", "c", "d"]
+    out.write("int main() {\n    int a = 1;\n    int b = 2;\n    int c = 3;\n    int d = 4;\n")
+    for _ in range(n):
+        terms = [rng.choice(names) if rng.random() < 0.7 else str(rng.randrange(1, 100)) for _ in range(31)]
+        expr = terms[0]
+        for term in terms[1:]:
+            expr += " " + rng.choice(BINARY_OPS) + " " + ("-" if rng.random() < 0.1 else "") + term
+        out.write("    " + rng.choice(names) + " = " + expr + ";\n")
+    out.write("    return a;\n}\n")
+
+
+def deep(shape, n, out):
+    out.write("int main() {\n    int a = 1;\n    return ")
+    if shape == "parens":
+        out.write("(" * n + "a" + ")" * n)
+    elif shape == "unary":
+        out.write("".join("-" if i % 2 else "!" for i in range(n)) + "a")
+    else:
+        out.write("a" + " + a" * n)
+    out.write(";\n}\n")
+
+
+def main():
+    if len(sys.argv) != 3 or sys.argv[1] not in ("flat", "parens", "unary", "sum"):
+        sys.exit(__doc__)
+    shape, n = sys.argv[1], int(sys.argv[2])
+    if shape == "flat":
+        flat(n, sys.stdout)
+    else:
+        deep(shape, n, sys.stdout)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,35 @@
+#!/usr/bin/env bash
+# Lexer throughput in tokens per second, on a generated input of $MB
+# megabytes. The driver re-lexes each input on its own for -ftime-report;
+# that time and the token count from -stats give the rate, best of $RUNS.
+#
+#   test/bench/lexer.sh [path/to/sysy_rvcp]
+#
+# MB    defaults to 32
+# RUNS  defaults to 5
+set -e
+
+CC_BIN=${1:-build/sysy_rvcp}
+MB=${MB:-32}
+RUNS=${RUNS:-5}
+TMP=$(mktemp -d)
+trap 'rm -rf "$TMP"' EXIT
+
+python3 "$(dirname "$0")/gen_lexer_input.py" "$MB" > "$TMP/input.sy"
+for _ in $(seq "$RUNS"); do
+    "$CC_BIN" -fsyntax-only -ftime-report -stats -report-json "$TMP/input.sy" 2>> "$TMP/reports"
+done
+
+python3 - "$TMP/reports" <<'PY'
+import json, sys
+decoder = json.JSONDecoder()
+text = open(sys.argv[1]).read()
+best = None
+while text.strip():
+    report, end = decoder.raw_decode(text.lstrip())
+    text = text.lstrip()[end:]
+    tokens = report["stats"]["lexer.NumTokens"]
+    wall = next(t["wall"] for t in report["time"] if t["name"].startswith("Lexing"))
+    best = wall if best is None else min(best, wall)
+print(f"{tokens / 1e6:.1f}M tokens in {best:.3f} s: {tokens / best / 1e6:.1f}M tokens/s")
+PY
@@ -0,0 +1,52 @@
+#!/usr/bin/env bash
+# Times the nested-loop matrix benchmark compiled by sysy_rvcp with the -O2
+# pipeline, with and without LICM. The programs are assembled and linked
+# with $RISCV_CC and run with $RISCV_RUN, best of $RUNS runs each.
+#
+#   test/bench/licm.sh [path/to/sysy_rvcp]
+#
+# RISCV_CC   defaults to riscv64-linux-gnu-gcc
+# RISCV_RUN  defaults to qemu-riscv64; set it empty on a RISC-V host
+# RUNS       defaults to 5
+set -e
+
+CC_BIN=${1:-build/sysy_rvcp}
+RISCV_CC=${RISCV_CC-riscv64-linux-gnu-gcc}
+RISCV_RUN=${RISCV_RUN-qemu-riscv64}
+RUNS=${RUNS:-5}
+SRC=$(dirname "$0")/licm_matrix.sy
+TMP=$(mktemp -d)
+trap 'rm -rf "$TMP"' EXIT
+
+# -O2 as a -passes list, so licm alone can be left out.
+WITH=mem2reg,inline,sccp,simplifycfg,gvn,loop-simplify,licm,indvars,loop-unroll,sccp,gvn,simplifycfg
+WITHOUT=${WITH/licm,/}
+
+# Prints the best wall time of $RUNS runs in ms; the exit status goes to
+# $TMP/$1.status.
+run() {
+    local best= start end ms status
+    for _ in $(seq "$RUNS"); do
+        start=$(date +%s%N)
+        status=0
+        $RISCV_RUN "$TMP/$1" > /dev/null || status=$?
+        end=$(date +%s%N)
+        ms=$(( (end - start) / 1000000 ))
+        [ -z "$best" ] || [ "$ms" -lt "$best" ] && best=$ms
+    done
+    echo "$status" > "$TMP/$1.status"
+    echo "$best"
+}
+
+for Name in WITH WITHOUT; do
+    "$CC_BIN" -O2 -passes="${!Name}" "$SRC" -o "$TMP/$Name.s"
+    $RISCV_CC -static "$TMP/$Name.s" -o "$TMP/$Name"
+done
+With=$(run WITH)
+Without=$(run WITHOUT)
+if ! cmp -s "$TMP/WITH.status" "$TMP/WITHOUT.status"; then
+    echo "error: exit status differs with and without licm" >&2
+    exit 1
+fi
+echo "without licm: $Without ms"
+echo "with licm:    $With ms"
@@ -0,0 +1,41 @@
+#!/usr/bin/env bash
+# Expression parser time on generated inputs: many flat statements, and
+# expressions nested in parentheses, in prefix operators and in a long sum.
+# The time is the driver's "Parsing (incl. lexing)" phase less its
+# standalone lexing pass, from -ftime-report, best of $RUNS.
+#
+#   test/bench/parser.sh [path/to/sysy_rvcp]
+#
+# FLAT  statements of 30 operators, defaults to 40000
+# DEPTH nesting depth and chain length, defaults to 100000
+# RUNS  defaults to 5
+set -e
+
+CC_BIN=${1:-build/sysy_rvcp}
+FLAT=${FLAT:-40000}
+DEPTH=${DEPTH:-100000}
+RUNS=${RUNS:-5}
+TMP=$(mktemp -d)
+trap 'rm -rf "$TMP"' EXIT
+
+for Shape in flat parens unary sum; do
+    N=$([ "$Shape" = flat ] && echo "$FLAT" || echo "$DEPTH")
+    python3 "$(dirname "$0")/gen_parser_input.py" "$Shape" "$N" > "$TMP/$Shape.sy"
+    for _ in $(seq "$RUNS"); do
+        "$CC_BIN" -fsyntax-only -ftime-report -report-json "$TMP/$Shape.sy" 2>> "$TMP/$Shape.json"
+    done
+    python3 - "$Shape" "$N" "$TMP/$Shape.json" <<'PY'
+import json, sys
+shape, n, path = sys.argv[1], sys.argv[2], sys.argv[3]
+decoder = json.JSONDecoder()
+text = open(path).read()
+best = None
+while text.strip():
+    report, end = decoder.raw_decode(text.lstrip())
+    text = text.lstrip()[end:]
+    times = {t["name"]: t["wall"] for t in report["time"]}
+    parse = times["Parsing (incl. lexing)"] - times["Lexing (standalone re-scan)"]
+    best = parse if best is None else min(best, parse)
+print(f"{shape:>6} {n:>7}: {best * 1000:8.2f} ms")
+PY
+done
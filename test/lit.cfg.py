@@ -0,0 +1,27 @@
+# lit configuration: run with
+#   lit test --param sysy_rvcp=build/sysy_rvcp
+# Tests are SysY sources with // RUN: lines, checked with FileCheck.
+import os
+import sys
+
+import lit.formats
+
+config.name = 'sysy_rvcp'
+config.test_format = lit.formats.ShTest(True)
+config.suffixes = ['.sy']
+config.excludes = ['Inputs', 'bench']
+config.test_source_root = os.path.dirname(__file__)
+
+compiler = lit_config.params.get(
+    'sysy_rvcp', os.path.join(os.path.dirname(config.test_source_root), 'build', 'sysy_rvcp'))
+config.substitutions.append(('%sysy_rvcp', os.path.abspath(compiler)))
+config.substitutions.append(('%python', sys.executable))
+
+# Tests marked REQUIRES: riscv-run link the output with $RISCV_CC and run it
+# with $RISCV_RUN, as test/bench/licm.sh does. Set RISCV_RUN empty on a
+# RISC-V host.
+riscv_cc = os.environ.get('RISCV_CC')
+if riscv_cc:
+    config.available_features.add('riscv-run')
+    config.substitutions.append(('%riscv_cc', riscv_cc))
+    config.substitutions.append(('%riscv_run', os.environ.get('RISCV_RUN', 'qemu-riscv64')))